@@ -1,4 +1,6 @@
 set(headers ${headers}
+	src/CellsInRange.h
+	src/Clipping.h
 	src/DebugMenu/BoxHandler.h
 	src/DebugMenu/CellHandler.h
 	src/DebugMenu/CollisionHandler.h
@@ -6,9 +8,16 @@ set(headers ${headers}
 	src/DebugMenu/DebugMenu.h
 	src/DebugMenu/InfoHandler.h
 	src/DebugMenu/MarkerHandler.h
+	src/DebugMenu/MarkerModelCache.h
+	src/DebugMenu/NavmeshCacheFile.h
+	src/DebugMenu/NavmeshDiskCache.h
+	src/DebugMenu/NavmeshGrid.h
 	src/DebugMenu/NavmeshHandler.h
 	src/DebugMenu/RefInspectorHandler.h
+	src/DebugMenu/RefSnapshot.h
+	src/DebugMenu/WorkerPool.h
 	src/DebugUIMenu.h
+	src/DrawCommandBuffer.h
 	src/DrawHandler.h
 	src/DrawMenu.h
 	src/FreeCamHandler.h
@@ -30,16 +39,25 @@ set(headers ${headers}
 	src/Linalg.h
 	src/MCM.h
 	src/PCH.h
+	src/Picking.h
+	src/Profiler.h
+	src/QuickHull.h
 	src/RE.h
 	src/Renderer/BasicDetour.h
 	src/Renderer/CBuffer.h
 	src/Renderer/D3DContext.h
 	src/Renderer/Drawer.h
+	src/Renderer/InstancedMeshDrawer.h
 	src/Renderer/MeshDrawer.h
 	src/Renderer/Model.h
+	src/Renderer/OverlayGeometry.h
 	src/Renderer/Renderer.h
+	src/Renderer/RingBufferAllocator.h
+	src/Renderer/ShaderDiskCache.h
 	src/Renderer/Shaders.h
 	src/Renderer/VertexBuffer.h
+	src/ScreenLOD.h
+	src/ShapeQueue.h
 	src/Utils.h
 	src/logger.h
 )
@@ -1,4 +1,5 @@
 set(sources ${sources}
+	src/Clipping.cpp
 	src/DebugMenu/BoxHandler.cpp
 	src/DebugMenu/CellHandler.cpp
 	src/DebugMenu/CollisionHandler.cpp
@@ -6,9 +7,16 @@ set(sources ${sources}
 	src/DebugMenu/DebugMenu.cpp
 	src/DebugMenu/InfoHandler.cpp
 	src/DebugMenu/MarkerHandler.cpp
+	src/DebugMenu/MarkerModelCache.cpp
+	src/DebugMenu/NavmeshCacheFile.cpp
+	src/DebugMenu/NavmeshDiskCache.cpp
+	src/DebugMenu/NavmeshGrid.cpp
 	src/DebugMenu/NavmeshHandler.cpp
 	src/DebugMenu/RefInspectorHandler.cpp
+	src/DebugMenu/RefSnapshot.cpp
+	src/DebugMenu/WorkerPool.cpp
 	src/DebugUIMenu.cpp
+	src/DrawCommandBuffer.cpp
 	src/DrawHandler.cpp
 	src/DrawMenu.cpp
 	src/FreeCamHandler.cpp
@@ -26,15 +34,23 @@ set(sources ${sources}
 	src/Interface_prismaUI/InterfaceHandler.cpp
 	src/Linalg.cpp
 	src/MCM.cpp
+	src/Picking.cpp
+	src/Profiler.cpp
+	src/QuickHull.cpp
 	src/RE.cpp
 	src/Renderer/CBuffer.cpp
 	src/Renderer/D3DContext.cpp
 	src/Renderer/Drawer.cpp
+	src/Renderer/InstancedMeshDrawer.cpp
 	src/Renderer/MeshDrawer.cpp
 	src/Renderer/Model.cpp
+	src/Renderer/OverlayGeometry.cpp
 	src/Renderer/Renderer.cpp
+	src/Renderer/RingBufferAllocator.cpp
+	src/Renderer/ShaderDiskCache.cpp
 	src/Renderer/Shaders.cpp
 	src/Renderer/VertexBuffer.cpp
+	src/ScreenLOD.cpp
 	src/Utils.cpp
 	src/main.cpp
 )
@@ -0,0 +1,41 @@
+#pragma once
+
+// The loop of Utils::ForEachCellInRange over a list of cells with their bounds.
+// Apart from the NiPoint types it does not depend on the game, so it can be tested on its own
+namespace Utils
+{
+	struct AttachedCell
+	{
+		const RE::TESObjectCELL*	cell;
+		float						minX;	// the interior and sky cells have infinite bounds
+		float						minY;
+		float						maxX;
+		float						maxY;
+	};
+
+	// Calls a_callback(const RE::TESObjectCELL*) for the cells of a_cells that are partly within a_range of a_origin. If
+	// a_callback returns bool, false stops the loop. Returns false if it was stopped
+	template <class Callback>
+	inline bool		ForEachCellInRange(std::span<const AttachedCell> a_cells, const RE::NiPoint3& a_origin, float a_range, Callback&& a_callback)
+	{
+		const float xMinus = a_origin.x - a_range;
+		const float xPlus = a_origin.x + a_range;
+		const float yMinus = a_origin.y - a_range;
+		const float yPlus = a_origin.y + a_range;
+
+		for (const auto& attachedCell : a_cells)
+		{
+			if (attachedCell.minX >= xPlus || attachedCell.maxX <= xMinus || attachedCell.minY >= yPlus || attachedCell.maxY <= yMinus) continue;
+
+			if constexpr (std::is_same_v<std::invoke_result_t<Callback&, const RE::TESObjectCELL*>, bool>)
+			{
+				if (!a_callback(attachedCell.cell)) return false;
+			}
+			else
+			{
+				a_callback(attachedCell.cell);
+			}
+		}
+		return true;
+	}
+}
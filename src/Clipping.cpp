@@ -0,0 +1,126 @@
+#include "Clipping.h"
+
+namespace Clipping
+{
+	void VertexStream::Clear()
+	{
+		x.clear();
+		y.clear();
+		z.clear();
+		w.clear();
+	}
+
+	void VertexStream::Resize(size_t a_size)
+	{
+		x.resize(a_size);
+		y.resize(a_size);
+		z.resize(a_size);
+		w.resize(a_size);
+	}
+
+	void VertexStream::Push(float a_x, float a_y, float a_z, float a_w)
+	{
+		x.push_back(a_x);
+		y.push_back(a_y);
+		z.push_back(a_z);
+		w.push_back(a_w);
+	}
+
+	bool PolygonClipper::IsOffScreen(const VertexStream& a_points, uint32_t a_offset, uint32_t a_count, float a_canvasScale)
+	{
+		bool areAllPointsBehind = true;
+		bool areAllPointsInFront = true;
+		bool areAllPointsToTheLeft = true;
+		bool areAllPointsToTheRight = true;
+		bool areAllPointsAbove = true;
+		bool areAllPointsBelow = true;
+
+		const float* x = a_points.x.data() + a_offset;
+		const float* y = a_points.y.data() + a_offset;
+		const float* z = a_points.z.data() + a_offset;
+		const float* w = a_points.w.data() + a_offset;
+
+		for (uint32_t i = 0; i < a_count; i++)
+		{
+			float scaled_w = w[i]*a_canvasScale;
+
+			areAllPointsBehind		&= z[i] < -w[i];
+			areAllPointsInFront		&= z[i] >  w[i];
+
+			areAllPointsToTheLeft	&= x[i] < -scaled_w;
+			areAllPointsToTheRight	&= x[i] >  scaled_w;
+			areAllPointsBelow		&= y[i] < -scaled_w;
+			areAllPointsAbove		&= y[i] >  scaled_w;
+		}
+		return areAllPointsBehind || areAllPointsInFront || areAllPointsToTheLeft || areAllPointsToTheRight || areAllPointsAbove || areAllPointsBelow;
+	}
+
+	const VertexStream* PolygonClipper::Clip(const VertexStream& a_points, uint32_t a_offset, uint32_t a_count, float a_canvasScale)
+	{
+		if (IsOffScreen(a_points, a_offset, a_count, a_canvasScale)) return nullptr;
+
+		// planes: left, right, bottom, top, near, far
+		ClipAgainstPlane(a_points, a_offset, a_count, scratch[0], 0, a_canvasScale);
+
+		int current = 0;
+		for (int plane = 1; plane < 6; plane++)
+		{
+			ClipAgainstPlane(scratch[current], 0, scratch[current].Size(), scratch[1 - current], plane, a_canvasScale);
+			current = 1 - current;
+		}
+		return &scratch[current];
+	}
+
+	void PolygonClipper::ClipAgainstPlane(const VertexStream& a_input, uint32_t a_offset, uint32_t a_count, VertexStream& a_output, int a_plane, float a_canvasScale)
+	{
+		a_output.Clear();
+		if (a_count == 0) return;
+
+		int sgn = a_plane % 2 == 0 ? -1 : 1; // -1 for the left, bottom and near plane
+		float scale = a_plane < 4 ? a_canvasScale : 1;
+
+		const std::vector<float>& coords = a_plane < 2 ? a_input.x : (a_plane < 4 ? a_input.y : a_input.z);
+
+		const float* coord = coords.data() + a_offset;
+		const float* x = a_input.x.data() + a_offset;
+		const float* y = a_input.y.data() + a_offset;
+		const float* z = a_input.z.data() + a_offset;
+		const float* w = a_input.w.data() + a_offset;
+
+		for (uint32_t current = 0; current < a_count; current++) // loop over all points
+		{
+			uint32_t prev = current == 0 ? a_count - 1 : current - 1;
+
+			// sgn*coord < w*scale covers both sides, e.g. left: x > -w*canvasScale, right: x < w*canvasScale
+			bool isCurrentPointInside = sgn*coord[current] < w[current]*scale;
+			bool isPrevPointOutside = sgn*coord[prev] > w[prev]*scale;
+
+			if (isCurrentPointInside == isPrevPointOutside)
+			{
+				float delta_w = w[current] - w[prev];
+
+				float t = (sgn * w[prev] * scale - coord[prev]) / (coord[current] - coord[prev] - sgn * delta_w * scale);
+				/*// ---Definitions of t for the 6 planes borders (prev point (1) --> current point (2) ) --O
+				|  (-w1 * canvasScale - x1) / ( x2 - x1 + (w2 - w1)*cavasScale );	// left					|
+				|  (+w1 * canvasScale - x1) / ( x2 - x1 - (w2 - w1)*cavasScale );	// right				|
+				|  (-w1 * canvasScale - y1) / ( y2 - y1 + (w2 - w1)*cavasScale );	// bottom				|
+				|  (+w1 * canvasScale - y1) / ( y2 - y1 - (w2 - w1)*cavasScale );	// top					|
+				|  (-w1				  - z1)	/ ( z2 - z1 + (w2 - w1)			   );	// near					|
+				|  (+w1				  - z1) / ( z2 - z1 - (w2 - w1)			   );	// top					|
+				\*/// --------------------------------------------------------------------------------------O
+
+				// we know 0 < t < 1 because current point and prev point is to either side of the plane
+				a_output.Push(
+					x[prev] + (x[current] - x[prev])*t,
+					y[prev] + (y[current] - y[prev])*t,
+					z[prev] + (z[current] - z[prev])*t,
+					w[prev] + delta_w*t);
+			}
+
+			if (isCurrentPointInside)
+			{
+				a_output.Push(x[current], y[current], z[current], w[current]);
+			}
+		}
+	}
+}
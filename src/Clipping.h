@@ -0,0 +1,38 @@
+#pragma once
+
+// Clipping of the queued polygons against the view frustum, in clip space. The x and y planes are moved in by the canvas scale.
+// It does not depend on the game, so it can be tested on its own
+namespace Clipping
+{
+	// structure of arrays, so each clip plane only has to walk the coordinate it tests against
+	struct VertexStream
+	{
+		std::vector<float> x;
+		std::vector<float> y;
+		std::vector<float> z;
+		std::vector<float> w;
+
+		void		Clear();
+		void		Resize(size_t a_size);
+		void		Push(float a_x, float a_y, float a_z, float a_w);
+		size_t		Size() const { return w.size(); }
+	};
+
+	// Sutherland-Hodgman https://en.wikipedia.org/wiki/Sutherland%E2%80%93Hodgman_algorithm
+	// A polygon is read from a range of a stream holding many polygons, and bounced between two scratch buffers, one plane at a time.
+	// The scratch buffers are never shrunk, so clipping stops allocating once it has warmed up
+	class PolygonClipper
+	{
+		public:
+			// nullptr if the entire polygon is off screen. The returned stream is only valid until the next call
+			const VertexStream*	Clip(const VertexStream& a_points, uint32_t a_offset, uint32_t a_count, float a_canvasScale);
+
+			// first check if all points are at one side of the frustum, so not visible
+			static bool			IsOffScreen(const VertexStream& a_points, uint32_t a_offset, uint32_t a_count, float a_canvasScale);
+
+		private:
+			VertexStream scratch[2]; // ping-pong buffers for the 6 clip planes
+
+			static void ClipAgainstPlane(const VertexStream& a_input, uint32_t a_offset, uint32_t a_count, VertexStream& a_output, int a_plane, float a_canvasScale);
+	};
+}
@@ -10,6 +10,8 @@ namespace DebugMenu
 
 	void BoxHandler::Draw()
 	{
+		PROFILE_SCOPE("BoxHandler::Draw");
+
 		if (MCM::settings::showBoxes) DrawBoxes();
 	}
 
@@ -23,33 +25,19 @@ namespace DebugMenu
 		RE::NiPoint3 origin = GetCenter();
 		float range = GetRange();
 
-		Utils::ForEachCellInRange(origin, range, [&](const RE::TESObjectCELL* a_cell)
-		{
-			a_cell->ForEachReference([&](RE::TESObjectREFR* a_ref)
-			{
+		uint32_t categories = 0;
+		if (MCM::settings::showOcclusion) categories |= RefSnapshot::kPlaneMarker;
+		if (MCM::settings::showCollisionMarkers) categories |= RefSnapshot::kCollisionMarker;
+		if (categories == 0) return;
 
-				switch (a_ref->GetBaseObject()->formID)
-				{
-					case planeMarkerID:
-					{
-						if (MCM::settings::showOcclusion && IsRefWithinRange(a_ref))
-						{
-							DrawOcclusion(a_ref, a_cell);
-						}
-						break;
-					}
-					case collisionMarkerID:
-					{
-						if (MCM::settings::showCollisionMarkers && IsRefWithinRange(a_ref))
-						{
-							DrawCollisionBox(a_ref, a_cell);
-						}
-						break;
-					}
-				}
-				return RE::BSContainer::ForEachResult::kContinue;
-			});
+		uint32_t visited = GetRefSnapshot()->ForEachRefInRange(categories, origin, range, [&](RE::TESObjectREFR* a_ref, const RE::TESObjectCELL* a_cell)
+		{
+			if (a_ref->GetBaseObject()->formID == planeMarkerID)
+				DrawOcclusion(a_ref, a_cell);
+			else
+				DrawCollisionBox(a_ref, a_cell);
 		});
+		PROFILE_VALUE("BoxHandler refs visited", visited);
 	}
 
 	void BoxHandler::DrawOcclusion(RE::TESObjectREFR* a_ref, const RE::TESObjectCELL* a_cell)
@@ -78,6 +66,7 @@ namespace DebugMenu
 				metaData.ref = a_ref;
 				metaData.infoType = InfoType::kOcclusion;
 
+				DrawHandler::ScopedBackend backend(GetDrawHandler().get(), MCM::settings::occlusionBackend);
 				DrawBox(center, primitive->halfExtents, rotation, baseColor,
 						MCM::settings::occlusionBorderColor, MCM::settings::occlusionAlpha,
 						MCM::settings::occlusionBorderAlpha, metaData);
@@ -131,18 +120,6 @@ namespace DebugMenu
 
 	}
 
-	bool BoxHandler::IsRefWithinRange(RE::TESObjectREFR* a_ref)
-	{
-		RE::NiPoint3 origin = GetCenter();
-
-		float dx = a_ref->GetPositionX() - origin.x;
-		float dy = a_ref->GetPositionY() - origin.y;
-
-		float range = GetRange();
-
-		return dx * dx + dy * dy < range * range;
-	}
-
 	void BoxHandler::DrawBox(const RE::NiPoint3& a_center, const RE::NiPoint3& a_halfExtents,
 							 const RE::NiMatrix3 a_rotation, uint32_t a_baseColor, uint32_t a_edgeColor,
 							 uint32_t a_baseAlpha, uint32_t a_edgeAlpha, MetaData& a_shapeMetaData)
@@ -160,12 +137,12 @@ namespace DebugMenu
 		RE::NiPoint3 lowerRight2 = a_rotation * RE::NiPoint3(-xBound, -yBound, -zBound);
 		RE::NiPoint3 lowerLeft2  = a_rotation * RE::NiPoint3(+xBound, -yBound, -zBound);
 
-		std::vector<RE::NiPoint3>  frontPlane{ a_center + upperLeft1,  a_center + upperRight1, a_center + lowerRight1, a_center + lowerLeft1 };
-		std::vector<RE::NiPoint3>   backPlane{ a_center + upperLeft2,  a_center + upperRight2, a_center + lowerRight2, a_center + lowerLeft2 };
-		std::vector<RE::NiPoint3>   leftPlane{ a_center + upperLeft1,  a_center + lowerLeft1,  a_center + lowerLeft2,  a_center + upperLeft2 };
-		std::vector<RE::NiPoint3>  rightPlane{ a_center + upperRight1, a_center + upperRight2, a_center + lowerRight2, a_center + lowerRight1 };
-		std::vector<RE::NiPoint3>    topPlane{ a_center + upperLeft1,  a_center + upperLeft2,  a_center + upperRight2, a_center + upperRight1 };
-		std::vector<RE::NiPoint3> bottomPlane{ a_center + lowerLeft1,  a_center + lowerLeft2,  a_center + lowerRight2, a_center + lowerRight1 };
+		std::array<RE::NiPoint3, 4>  frontPlane{ a_center + upperLeft1,  a_center + upperRight1, a_center + lowerRight1, a_center + lowerLeft1 };
+		std::array<RE::NiPoint3, 4>   backPlane{ a_center + upperLeft2,  a_center + upperRight2, a_center + lowerRight2, a_center + lowerLeft2 };
+		std::array<RE::NiPoint3, 4>   leftPlane{ a_center + upperLeft1,  a_center + lowerLeft1,  a_center + lowerLeft2,  a_center + upperLeft2 };
+		std::array<RE::NiPoint3, 4>  rightPlane{ a_center + upperRight1, a_center + upperRight2, a_center + lowerRight2, a_center + lowerRight1 };
+		std::array<RE::NiPoint3, 4>    topPlane{ a_center + upperLeft1,  a_center + upperLeft2,  a_center + upperRight2, a_center + upperRight1 };
+		std::array<RE::NiPoint3, 4> bottomPlane{ a_center + lowerLeft1,  a_center + lowerLeft2,  a_center + lowerRight2, a_center + lowerRight1 };
 
 		GetDrawHandler()->DrawPolygon(frontPlane,	0, a_baseColor, a_baseAlpha, 0, 0, false, a_shapeMetaData);
 		GetDrawHandler()->DrawPolygon(backPlane,	0, a_baseColor, a_baseAlpha, 0, 0, false, a_shapeMetaData);
@@ -11,8 +11,12 @@ namespace DebugMenu
 
 	void CellHandler::Draw()
 	{
+		PROFILE_SCOPE("CellHandler::Draw");
+
 		if (!MCM::settings::showCellBorders) return;
 
+		DrawHandler::ScopedBackend backend(GetDrawHandler().get(), MCM::settings::cellBorderBackend);
+
 		RE::TESObjectCELL* cell = RE::PlayerCharacter::GetSingleton()->GetParentCell();
 		if (!cell || cell->IsInteriorCell()) return;
 
@@ -425,7 +429,7 @@ namespace DebugMenu
 			if (triangles.size() != 0)
 			{
 				CollisionHandler::CollisionMesh landscapeMesh{ triangles };
-				Renderer::DrawMesh(landscapeMesh.meshDrawer);
+				Renderer::DrawMesh(landscapeMesh.meshDrawer, MCM::settings::collisionColor);
 
 			}
 			else logger::info("no triangles");
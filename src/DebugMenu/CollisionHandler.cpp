@@ -1,7 +1,6 @@
 #include "CollisionHandler.h"
 #include "math.h"
 
-//#define COLLISIONS_PROFILING
 //#define LOG_COLLISION
 
 
@@ -21,216 +20,214 @@ namespace DebugMenu
 		return std::pair<CollisionTriangle, CollisionTriangle>(triangle1, triangle2);
 	}
 
-	void CollisionHandler::RefCollisionData::AddCollisionLine(vec3u& a_start, vec3u& a_end)
+	void CollisionHandler::RefCollisionData::AddCollisionLine(CollisionGeometry& a_geometry, const vec3u& a_start, const vec3u& a_end, const glm::vec4& a_color)
 	{
-		collisionLines.push_back(CollisionLine(a_start, a_end, MCM::settings::collisionColor));
+		a_geometry.lines.push_back(CollisionLine(a_start, a_end, a_color));
 	}
 
-	void CollisionHandler::RefCollisionData::AddCollisionLine(vec3u& a_start, vec3u& a_end, glm::vec4& a_color)
+	static CollisionHandler::GeometryKey GetGeometryKey(const CollisionHandler::CollisionObject& a_object)
 	{
-		collisionLines.push_back(CollisionLine(a_start, a_end, a_color));
+		return CollisionHandler::GeometryKey{ a_object.hkpShape, a_object.collisionScale, MCM::settings::cleanCollisions, MCM::settings::collisionColor,
+			MCM::settings::capsuleCylinderSegments, MCM::settings::capsuleSphereSegments };
 	}
 
-	void CollisionHandler::RefCollisionData::AddCollisionMesh(std::vector<CollisionTriangle>& a_triangles)
+	void CollisionHandler::RefCollisionData::AddCollisionGeometry(std::shared_ptr<CollisionGeometry> a_geometry, const glm::mat4& a_localToWorld)
 	{
-		if (a_triangles.size() > 0) collisionMeshes.push_back(CollisionMesh(a_triangles));
-	}
+		a_geometry->Upload();
+		if (!a_geometry->meshDrawer && a_geometry->lines.empty()) return;
 
-	#ifdef COLLISIONS_PROFILING
-		struct CollisionProfileData
+		// only the transform is applied here, so moving refs don't extract their shapes again
+		for (const auto& line : a_geometry->lines)
 		{
-			struct SubDelta
-			{
-				std::string name;
-				std::vector<long long> deltas;
-			};
-			std::string	name;
-			std::vector<long long> deltas;
-			std::vector<SubDelta> subDeltas;
-			uint32_t numCollisions;
-
-			float Avg(std::vector<long long> a_list)
-			{
-				if (a_list.empty()) return -1.0;
-
-				long long sum = 0;
-				for (auto item : a_list)
-				{
-					sum += item;
-				}
-				return static_cast<float>(sum) / a_list.size();
-			}
-
-			// 1% top decentile
-			long long NearMax(std::vector<long long> a_list)
-			{
-				if (a_list.empty()) return 0;
-				auto copy = a_list;
-				std::sort(copy.begin(), copy.end());
-				uint32_t length = copy.size() - 1;
-				uint32_t index = static_cast<uint32_t>(length*0.99);
-				if (index > length) index = length;
-				return copy[index];
-			}
-
-			// 1% low decentile
-			long long NearMin(std::vector<long long> a_list)
-			{
-				if (a_list.empty()) return 0;
-				auto copy = a_list;
-				std::sort(copy.begin(), copy.end());
-				uint32_t length = copy.size() - 1;
-				uint32_t index = static_cast<uint32_t>(length * 0.01);
-				if (index > length) index = length;
-				return copy[index];
-			}
+			vec3u start{ a_localToWorld * glm::vec4(line.start, 1.0f) };
+			vec3u end{ a_localToWorld * glm::vec4(line.end, 1.0f) };
+			collisionLines.push_back(CollisionLine(start, end, line.color));
+		}
 
-			float AvgDelta()
-			{
-				return Avg(deltas);
-			}
+		collisionGeometries.push_back(CollisionGeometryInstance{ std::move(a_geometry), a_localToWorld, MCM::settings::collisionColor });
+	}
 
-			bool operator==(CollisionProfileData& other)
-			{
-				return name == other.name;
-			}
-		};
+	// identical shapes (eg. the same rock placed many times) share the geometry, so it is only extracted and uploaded once
+	bool CollisionHandler::RefCollisionData::TryAddCachedCollisionGeometry(const CollisionObject& a_object)
+	{
+		auto& stats = geometryCacheStats[a_object.hkpShape->type];
+		if (!a_object.isShapeCacheable)
+		{
+			stats.misses++;
+			return false;
+		}
 
-		static CollisionProfileData allCollisionsTotalData{			"All colisions" };
-		static CollisionProfileData boxCollisionsData{				"Boxes" };
-		static CollisionProfileData capsuleCollisionsData{			"Capsules" };
-		static CollisionProfileData compressedMeshCollisionsData{	"Compress meshes" };
-		static CollisionProfileData convexVerticesCollisionsData{	"Convex vertices" };
-		static CollisionProfileData collisionMeshData{				"collision mesh" };
-
-		static std::vector<CollisionProfileData*> allProfilingData{ &allCollisionsTotalData,
-																	&boxCollisionsData, 
-																	&capsuleCollisionsData,
-																	&compressedMeshCollisionsData,
-																	&convexVerticesCollisionsData,
-																	&collisionMeshData };
-		
+		auto key = GetGeometryKey(a_object);
 
-		static void AddCount(CollisionProfileData& a_data)
+		// another ref is waiting for the same shape to be built
+		if (geometriesInFlight.contains(key))
 		{
-			a_data.numCollisions++;
-			if (a_data != collisionMeshData)
-				allCollisionsTotalData.numCollisions++;
+			stats.hits++;
+			pendingGeometries.push_back(PendingGeometry{ key, a_object.GetLocalToWorld() });
+			return true;
 		}
 
-		static void AddDelta(CollisionProfileData& a_data, long long a_delta)
+		std::shared_ptr<CollisionGeometry> geometry = nullptr;
+		auto cachedGeometry = geometryCache.find(key);
+		if (cachedGeometry != geometryCache.end())
 		{
-			a_data.deltas.push_back(a_delta);
-
-			if (a_data != allCollisionsTotalData) AddCount(a_data);	
+			geometry = cachedGeometry->second.lock();
+			if (!geometry) geometryCache.erase(cachedGeometry);
 		}
 
-		static void AddSubDelta(CollisionProfileData& a_data, long long a_delta, std::string a_name)
+		if (!geometry)
 		{
-			for (int i = 0; i < a_data.subDeltas.size(); i++)
-			{
-				if (a_data.subDeltas[i].name == a_name)
-				{
-					a_data.subDeltas[i].deltas.push_back(a_delta);
-					return;
-				}
-			}
-			a_data.subDeltas.push_back(CollisionProfileData::SubDelta(a_name, std::vector<long long>{ a_delta }));
+			stats.misses++;
+			return false;
 		}
 
-		static void ResetCounts()
+		stats.hits++;
+		geometryCacheHits++;
+		AddCollisionGeometry(std::move(geometry), a_object.GetLocalToWorld());
+		return true;
+	}
+
+	CollisionHandler::ShapeDescription CollisionHandler::RefCollisionData::GetShapeDescription(ShapeDescription::Type a_type)
+	{
+		ShapeDescription description;
+		description.type = a_type;
+		description.cleanCollisions = MCM::settings::cleanCollisions;
+		description.color = MCM::settings::collisionColor;
+		description.cylinderSegments = MCM::settings::capsuleCylinderSegments;
+		description.sphereSegments = MCM::settings::capsuleSphereSegments;
+		return description;
+	}
+
+	// Cacheable shapes are built on a worker, and added to the ref when they are published. The others (temporary shapes
+	// in a shape buffer and char controllers) could change or be freed after the world is unlocked, so they are built here
+	void CollisionHandler::RefCollisionData::AddDescribedGeometry(ShapeDescription&& a_description, const CollisionObject& a_object)
+	{
+		// only cached geometry holds a reference to its shape. A shape in a shape buffer is on the stack of the caller
+		auto geometry = std::make_shared<CollisionGeometry>(a_object.isShapeCacheable ? a_object.hkpShape : nullptr);
+
+		if (!a_object.isShapeCacheable)
 		{
-			for (const auto& data : allProfilingData)
-			{
-				data->numCollisions = 0;
-			}
+			BuildGeometry(a_description, *geometry);
+			AddCollisionGeometry(std::move(geometry), a_object.GetLocalToWorld());
+			return;
 		}
 
-		static void PrintProfiling()
+		auto key = GetGeometryKey(a_object);
+		pendingGeometries.push_back(PendingGeometry{ key, a_object.GetLocalToWorld() });
+
+		// the geometry (and the reference to the shape it holds) is created and released on the main thread, since havok
+		// reference counting is not thread safe. The worker only fills in the lines and triangles
+		geometriesInFlight.emplace(key, geometry);
+		GetWorkerPool().Submit([key, geometry = std::move(geometry), description = std::move(a_description)]() mutable
+		{
+			BuildGeometry(description, *geometry);
+			builtGeometries.Push(BuiltGeometry{ key, std::move(geometry) });
+		});
+	}
+
+	// Adds the geometry that was published since the last update. Pending geometry that is not in flight
+	// nor in the cache anymore (the shape had no geometry, or nobody else kept it alive) is dropped
+	void CollisionHandler::RefCollisionData::AddPublishedGeometries()
+	{
+		std::erase_if(pendingGeometries, [&](const PendingGeometry& a_pending)
 		{
-			logger::debug("{:<30}     {:>12} [{:>5}:{:>5}] {:>10}", "Collision Profiling :", "Avg (s)", "1% lo", "1% hi", "Last frame");
-			for (const auto& data : allProfilingData)
+			if (geometriesInFlight.contains(a_pending.key)) return false;
+
+			auto cachedGeometry = geometryCache.find(a_pending.key);
+			if (cachedGeometry != geometryCache.end())
 			{
-				logger::debug("{:<30}     {:>12.2f} [{:>5}:{:>5}] {:>10} | {} shapes", data->name, data->AvgDelta(), data->NearMin(data->deltas), data->NearMax(data->deltas), data->deltas.back(), data->numCollisions);
-				for (const auto& subDelta : data->subDeltas)
-				{
-					//                  30-3
-					logger::debug("    {:<27}     {:>12.2f} [{:>5}:{:>5}]", subDelta.name, data->Avg(subDelta.deltas), data->NearMin(subDelta.deltas), data->NearMax(subDelta.deltas));
-					
-				}
+				if (auto geometry = cachedGeometry->second.lock()) AddCollisionGeometry(std::move(geometry), a_pending.localToWorld);
 			}
+			return true;
+		});
+	}
 
-			ResetCounts();
+	void CollisionHandler::RefCollisionData::BuildGeometry(const ShapeDescription& a_description, CollisionGeometry& a_geometry)
+	{
+		switch (a_description.type)
+		{
+			case ShapeDescription::Type::kBox:				BuildBoxGeometry(a_description, a_geometry); break;
+			case ShapeDescription::Type::kCapsule:			BuildCapsuleGeometry(a_description, a_geometry); break;
+			case ShapeDescription::Type::kConvexFaces:		BuildConvexGeometry(a_description, a_geometry); break;
+			case ShapeDescription::Type::kCompressedMesh:	BuildCompressedMeshGeometry(a_description, a_geometry); break;
 		}
-	#endif
+	}
 
 	CollisionHandler::CollisionMesh::CollisionMesh(std::vector<CollisionTriangle>& a_triangles)
 	{
-		#ifdef COLLISIONS_PROFILING
-			auto start = std::chrono::system_clock::now();
-		#endif
+		PROFILE_SCOPE("Collision mesh");
 
-		std::vector<Renderer::Model::Vertex> vertices;
+		// the mesh is drawn in a single color, so only the welded positions are uploaded
+		std::vector<vec3u> vertices;
+		vertices.reserve(a_triangles.size() * 3);
 
 		for (const auto& triangle : a_triangles)
 		{
-			vec2u uv{ 0.0f, 0.0f };
-			vec3u normal = { 0.0f, 0.0f, 0.0f }; //glm::cross(p2 - p1, p3 - p1); // Not needed for simple wireframes
-			vec4u color = MCM::settings::collisionColor;
+			vertices.push_back(triangle.point1);
+			vertices.push_back(triangle.point2);
+			vertices.push_back(triangle.point3);
+		}
+
+		Renderer::Model::PositionMesh mesh;
+		{
+			PROFILE_SCOPE("Collision mesh / welding triangles");
+			mesh = Renderer::Model::WeldVertices(vertices);
+		}
+
+		auto& ctx = Renderer::GetContext();
+		auto perObjectBuffer = Renderer::GetPerObjectCBuffer();
+
+		Renderer::MeshCreateInfo meshInfo;
+		meshInfo.positionMesh = &mesh;
+		meshInfo.vs = Renderer::GetPositionMeshVS();
+		meshInfo.ps = Renderer::GetMeshPS();
+
+		meshDrawer = std::make_shared<Renderer::MeshDrawer>(meshInfo, perObjectBuffer, ctx);
+	}
 
-			Renderer::Model::Vertex v1{ triangle.point1, uv, normal, color };
-			Renderer::Model::Vertex v2{ triangle.point2, uv, normal, color };
-			Renderer::Model::Vertex v3{ triangle.point3, uv, normal, color };
+	void CollisionHandler::CollisionGeometry::SetTriangles(std::vector<CollisionTriangle>& a_triangles)
+	{
+		if (a_triangles.size() == 0) return;
+
+		// the color is set per instance, so only the positions are kept
+		std::vector<vec3u> vertices;
+		vertices.reserve(a_triangles.size() * 3);
 
-			vertices.push_back(v1);
-			vertices.push_back(v2);
-			vertices.push_back(v3);
+		for (const auto& triangle : a_triangles)
+		{
+			vertices.push_back(triangle.point1);
+			vertices.push_back(triangle.point2);
+			vertices.push_back(triangle.point3);
 		}
 
-		#ifdef COLLISIONS_PROFILING
-			auto convertingTriangles = std::chrono::system_clock::now();
-			auto delta_convertingTriangles = std::chrono::duration_cast<std::chrono::microseconds>(convertingTriangles - start).count();
-			AddSubDelta(collisionMeshData, delta_convertingTriangles, "Converting triangles");
-		#endif
-		
-		Renderer::Model::MeshHeader meshHeader{ "ello", vertices.size() };
-		Renderer::Model::Mesh mesh{ meshHeader, vertices };
-		Renderer::Model::ModelHeader modelHeader{ 0, 0, 1 };
+		mesh = Renderer::Model::WeldVertices(vertices);
+	}
 
-		std::vector<Renderer::Model::Mesh> meshes{ mesh };
+	void CollisionHandler::CollisionGeometry::SetTriangles(const std::vector<vec3u>& a_vertices, const std::vector<uint32_t>& a_indices)
+	{
+		if (a_indices.size() < 3) return;
 
-		Renderer::Model::Model mdl{ modelHeader, meshes };
+		// the compressed mesh chunks share vertices between chunks at the same position, so the indexed mesh is welded as well
+		mesh = Renderer::Model::WeldVertices(a_vertices, a_indices);
+	}
 
-		auto& ctx = Renderer::GetContext();
-		auto perObjectBuffer = Renderer::GetPerObjectCBuffer();
+	// the triangles can be welded on a worker, but D3D objects are only created on the main thread
+	void CollisionHandler::CollisionGeometry::Upload()
+	{
+		if (mesh.indices.size() < 3) return;
 
-		#ifdef COLLISIONS_PROFILING
-			auto setupModel = std::chrono::system_clock::now();
-			auto delta_setupModel = std::chrono::duration_cast<std::chrono::microseconds>(setupModel - convertingTriangles).count();
-			AddSubDelta(collisionMeshData, delta_setupModel, "Setup model");
-		#endif
+		PROFILE_SCOPE("Collision geometry upload");
 
 		Renderer::MeshCreateInfo meshInfo;
-		meshInfo.mesh = &mdl.meshes[0];
-		meshInfo.vs = Renderer::GetMeshVS();
+		meshInfo.positionMesh = &mesh;
+		meshInfo.vs = Renderer::GetInstancedPositionMeshVS();
 		meshInfo.ps = Renderer::GetMeshPS();
 
-		#ifdef COLLISIONS_PROFILING
-			auto creatingMeshInfo = std::chrono::system_clock::now();
-			auto delta_creatingMeshInfo = std::chrono::duration_cast<std::chrono::microseconds>(creatingMeshInfo - setupModel).count();
-			AddSubDelta(collisionMeshData, delta_creatingMeshInfo, "Creating mesh info");
-		#endif
-
-		meshDrawer = std::make_shared<Renderer::MeshDrawer>(meshInfo, perObjectBuffer, ctx);
-
-		#ifdef COLLISIONS_PROFILING
-			auto end = std::chrono::system_clock::now();
-			auto delta = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
-			AddDelta(collisionMeshData, delta);
+		meshDrawer = std::make_shared<Renderer::InstancedMeshDrawer>(meshInfo, Renderer::GetContext());
+		mesh = {};
 
-			auto delta_makingMeshDrawer = std::chrono::duration_cast<std::chrono::microseconds>(end - creatingMeshInfo).count();
-			AddSubDelta(collisionMeshData, delta_makingMeshDrawer, "Creating mesh drawer");
-		#endif
+		geometryUploads++;
+		geometryUploadBytes += meshDrawer->Size();
 	}
 
 	float CollisionHandler::GetRange()
@@ -247,17 +244,49 @@ namespace DebugMenu
 
 	void CollisionHandler::Draw()
 	{
+		PROFILE_SCOPE("CollisionHandler::Draw");
+
+		PublishBuiltGeometries();
+
 		if (MCM::settings::showCollision && MCM::settings::useD3D) DrawCollisions();
-		#ifdef COLLISIONS_PROFILING
-			PrintProfiling();
-		#endif
+
+		// every visible ref has picked up the geometry it waited for, the rest is only kept alive by the refs using it
+		publishedGeometries.clear();
+		std::erase_if(geometryCache, [](const auto& a_entry) { return a_entry.second.expired(); });
+
+		if (Profiler::IsEnabled())
+		{
+			auto drawStats = Renderer::GetDrawStats();
+			PROFILE_VALUE("D3D11 draw calls", drawStats.drawCalls);
+			PROFILE_VALUE("D3D11 instances", drawStats.instances);
+			PROFILE_VALUE("D3D11 bytes uploaded", drawStats.uploadBytes);
+
+			PROFILE_VALUE("Collision geometry uploads", geometryUploads);
+			PROFILE_VALUE("Collision geometry bytes uploaded", geometryUploadBytes);
+			PROFILE_VALUE("Collision geometry cache hits", geometryCacheHits);
+			PROFILE_VALUE("Collision geometry cached shapes", geometryCache.size());
+			PROFILE_VALUE("Collision geometry being built", geometriesInFlight.size());
+			PROFILE_VALUE("Worker tasks queued", GetWorkerPool().GetNumberOfQueuedTasks());
+
+			for (const auto& [type, stats] : geometryCacheStats)
+			{
+				auto lookups = stats.hits + stats.misses;
+				if (lookups == 0) continue;
+				auto& zone = Profiler::GetZone(fmt::format("Collision cache hit rate (%) / {}", Utils::GethkpShapeTypeName(type)), Profiler::ZoneType::kCounter);
+				Profiler::RecordValue(zone, 100 * stats.hits / lookups);
+			}
+		}
+		geometryUploads = 0;
+		geometryUploadBytes = 0;
+		geometryCacheHits = 0;
+		geometryCacheStats.clear();
 	}
 
 	void CollisionHandler::DrawCollisions()
 	{
-		#ifdef COLLISIONS_PROFILING
-			auto start = std::chrono::system_clock::now();
-		#endif
+		PROFILE_SCOPE("CollisionHandler::DrawCollisions");
+
+		extractionStart = std::chrono::steady_clock::now();
 
 		auto consoleRef = RE::Console::GetSelectedRef().get();
 
@@ -269,21 +298,11 @@ namespace DebugMenu
 		{
 			case MCM::settings::CollisionDisplayMode::inRange:
 			{
-				Utils::ForEachCellInRange(RE::PlayerCharacter::GetSingleton()->GetPosition(), GetRange(), [&](const RE::TESObjectCELL* a_cell)
+				uint32_t visited = GetRefSnapshot()->ForEachRefInRange(RefSnapshot::kAll, GetCenter(), GetRange(), [&](RE::TESObjectREFR* a_ref, const RE::TESObjectCELL*)
 				{
-					a_cell->ForEachReference([&](RE::TESObjectREFR* a_ref)
-					{
-						if (!a_ref) return RE::BSContainer::ForEachResult::kContinue;
-
-						float dx = GetCenter().x - a_ref->GetPositionX();
-						float dy = GetCenter().y - a_ref->GetPositionY();
-						if (dx * dx + dy * dy < GetRange() * GetRange())
-						{
-							DrawCollision(a_ref);
-						}
-						return RE::BSContainer::ForEachResult::kContinue;
-					});
+					DrawCollision(a_ref);
 				});
+				PROFILE_VALUE("CollisionHandler refs visited", visited);
 				break;
 			}
 			case MCM::settings::CollisionDisplayMode::consoleSelected:
@@ -304,13 +323,30 @@ namespace DebugMenu
 			}			
 
 		}
+	}
 
-		#ifdef COLLISIONS_PROFILING
-			auto end = std::chrono::system_clock::now();
-			auto delta = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
-			AddDelta(allCollisionsTotalData, delta);
-		#endif
+	// the built geometry is handed over by the workers, and is uploaded and cached here on the main thread
+	void CollisionHandler::PublishBuiltGeometries()
+	{
+		for (auto& built : builtGeometries.TakeAll())
+		{
+			geometriesInFlight.erase(built.key);
+
+			built.geometry->Upload();
+			if (!built.geometry->meshDrawer && built.geometry->lines.empty()) continue;
+
+			geometryCache[built.key] = built.geometry;
+			publishedGeometries.push_back(std::move(built.geometry));
+		}
+	}
+
+	// new refs are only extracted while the budget lasts, the rest are extracted on the next updates
+	bool CollisionHandler::IsExtractionBudgetExceeded() const
+	{
+		if (MCM::settings::collisionExtractionBudget == 0) return false;
 
+		auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - extractionStart).count();
+		return elapsed > MCM::settings::collisionExtractionBudget;
 	}
 
 	void CollisionHandler::UpdateSelectedRefs(RE::TESObjectREFR* a_ref)
@@ -466,6 +502,8 @@ namespace DebugMenu
 		auto node = a_ref->Get3D() ? a_ref->Get3D()->AsNode() : nullptr;
 		if (!node || node->GetAppCulled()) return;
 
+		if (IsExtractionBudgetExceeded()) return;
+
 		#ifdef LOG_COLLISION
 			logger::debug("REF: {:X}; scale: {}", a_ref->formID, a_ref->GetScale());
 		#endif
@@ -504,11 +542,15 @@ namespace DebugMenu
 	{
 		if (isCreature || !isStatic || previousPosition != ref->GetPosition())
 		{
+			// the previous geometry is kept alive until the shapes have been looked up again, so it is found in the cache
+			auto previousGeometries = std::move(collisionGeometries);
+			collisionGeometries.clear();
 			collisionLines.clear();
-			collisionMeshes.clear();
+			pendingGeometries.clear();
 			GetCollisionCoordinates();
 			previousPosition = ref->GetPosition();
 		}
+		AddPublishedGeometries();
 		DrawObject();
 	}
 
@@ -636,6 +678,7 @@ namespace DebugMenu
 			charController->GetPosition(pos, false);
 
 			a_object.isCharController = true;
+			a_object.isShapeCacheable = false;
 			a_object.charControllerOffset = Utils::hkvec4toNiVec3(pos);
 			a_object.charControllerRotation = Utils::GetRotationMatrixZ(-actor->data.angle.z);
 			hasCharControllerCollision = true;
@@ -651,50 +694,23 @@ namespace DebugMenu
 		{
 			case RE::hkpShapeType::kBox:
 			{
-				#ifdef COLLISIONS_PROFILING
-					auto start = std::chrono::system_clock::now();
-				#endif
-
+				PROFILE_SCOPE("Collision extraction / Box");
 				GetBoxCollisionCoordinates(a_object);
 
-				#ifdef COLLISIONS_PROFILING
-					auto end = std::chrono::system_clock::now();
-					auto delta = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
-					AddDelta(boxCollisionsData, delta);
-				#endif
-
 				break;
 			}
 			case RE::hkpShapeType::kCapsule:
 			{
-				#ifdef COLLISIONS_PROFILING
-					auto start = std::chrono::system_clock::now();
-				#endif
-
+				PROFILE_SCOPE("Collision extraction / Capsule");
 				GetCapsuleCollisionCoordnates(a_object);
 
-				#ifdef COLLISIONS_PROFILING
-					auto end = std::chrono::system_clock::now();
-					auto delta = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
-					AddDelta(capsuleCollisionsData, delta);
-				#endif
-
 				break;
 			}
 			case RE::hkpShapeType::kCompressedMesh:
 			{
-				#ifdef COLLISIONS_PROFILING
-					auto start = std::chrono::system_clock::now();
-				#endif
-
+				PROFILE_SCOPE("Collision extraction / Compressed mesh");
 				GetCompresshedMeshCollisionCoordinates(a_object);
 
-				#ifdef COLLISIONS_PROFILING
-					auto end = std::chrono::system_clock::now();
-					auto delta = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
-					AddDelta(compressedMeshCollisionsData, delta);
-				#endif
-
 				break;
 			}
 			case RE::hkpShapeType::kConvexTransform:
@@ -704,18 +720,9 @@ namespace DebugMenu
 			}
 			case RE::hkpShapeType::kConvexVertices:
 			{
-				#ifdef COLLISIONS_PROFILING
-					auto start = std::chrono::system_clock::now();
-				#endif
-
+				PROFILE_SCOPE("Collision extraction / Convex vertices");
 				GetConvexVerticesCollisionCoordinates(a_object);
 
-				#ifdef COLLISIONS_PROFILING
-					auto end = std::chrono::system_clock::now();
-					auto delta = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
-					AddDelta(convexVerticesCollisionsData, delta);
-				#endif
-
 				break;
 			}
 			case RE::hkpShapeType::kList:
@@ -735,12 +742,17 @@ namespace DebugMenu
 	{
 		const auto* boxShape = static_cast<const RE::hkpBoxShape*>(a_object.hkpShape);
 		if (!boxShape) return;
-		auto sides = Utils::hkvec4toNiVec3(boxShape->halfExtents);
+		if (TryAddCachedCollisionGeometry(a_object)) return;
 
-		auto cornerToWorldPos = [&](RE::NiPoint3 a_corner)
-		{
-			return Utils::NiToGLMVec3(a_object.GetWorldPos(a_corner));
-		};
+		auto description = GetShapeDescription(ShapeDescription::Type::kBox);
+		description.halfExtents = Utils::NiToGLMVec3(Utils::hkvec4toNiVec3(boxShape->halfExtents));
+		AddDescribedGeometry(std::move(description), a_object);
+	}
+
+	void CollisionHandler::RefCollisionData::BuildBoxGeometry(const ShapeDescription& a_description, CollisionGeometry& a_geometry)
+	{
+		const auto& sides = a_description.halfExtents;
+		const auto& color = a_description.color;
 
 		//
 		//			ULB ------- URB
@@ -759,43 +771,45 @@ namespace DebugMenu
 		// LLF ------- LRF
 		//
 
-		vec3u upperRightBack  = cornerToWorldPos(RE::NiPoint3(  sides.x,  sides.y,  sides.z ));
-		vec3u lowerRightBack  = cornerToWorldPos(RE::NiPoint3(  sides.x,  sides.y, -sides.z ));
-		vec3u lowerLeftBack   = cornerToWorldPos(RE::NiPoint3( -sides.x,  sides.y, -sides.z ));
-		vec3u upperLeftBack   = cornerToWorldPos(RE::NiPoint3( -sides.x,  sides.y,  sides.z ));
-		vec3u upperRightFront = cornerToWorldPos(RE::NiPoint3(  sides.x, -sides.y,  sides.z ));
-		vec3u lowerRightFront = cornerToWorldPos(RE::NiPoint3(  sides.x, -sides.y, -sides.z ));
-		vec3u lowerLeftFront  = cornerToWorldPos(RE::NiPoint3( -sides.x, -sides.y, -sides.z ));
-		vec3u upperLeftFront  = cornerToWorldPos(RE::NiPoint3( -sides.x, -sides.y,  sides.z ));
+		vec3u upperRightBack  {  sides.x,  sides.y,  sides.z };
+		vec3u lowerRightBack  {  sides.x,  sides.y, -sides.z };
+		vec3u lowerLeftBack   { -sides.x,  sides.y, -sides.z };
+		vec3u upperLeftBack   { -sides.x,  sides.y,  sides.z };
+		vec3u upperRightFront {  sides.x, -sides.y,  sides.z };
+		vec3u lowerRightFront {  sides.x, -sides.y, -sides.z };
+		vec3u lowerLeftFront  { -sides.x, -sides.y, -sides.z };
+		vec3u upperLeftFront  { -sides.x, -sides.y,  sides.z };
 
 		
-		if (MCM::settings::cleanCollisions)
+		if (a_description.cleanCollisions)
 		{
-			AddCollisionLine(upperRightBack, lowerRightBack);
-			AddCollisionLine(lowerRightBack, lowerLeftBack);
-			AddCollisionLine(lowerLeftBack, upperLeftBack);
-			AddCollisionLine(upperLeftBack, upperRightBack);
+			AddCollisionLine(a_geometry, upperRightBack, lowerRightBack, color);
+			AddCollisionLine(a_geometry, lowerRightBack, lowerLeftBack, color);
+			AddCollisionLine(a_geometry, lowerLeftBack, upperLeftBack, color);
+			AddCollisionLine(a_geometry, upperLeftBack, upperRightBack, color);
 
 			// Front square
-			AddCollisionLine(upperRightFront, lowerRightFront);
-			AddCollisionLine(lowerRightFront, lowerLeftFront);
-			AddCollisionLine(lowerLeftFront, upperLeftFront);
-			AddCollisionLine(upperLeftFront, upperRightFront);
+			AddCollisionLine(a_geometry, upperRightFront, lowerRightFront, color);
+			AddCollisionLine(a_geometry, lowerRightFront, lowerLeftFront, color);
+			AddCollisionLine(a_geometry, lowerLeftFront, upperLeftFront, color);
+			AddCollisionLine(a_geometry, upperLeftFront, upperRightFront, color);
 
 			//Middle part
-			AddCollisionLine(upperRightBack, upperRightFront);
-			AddCollisionLine(lowerRightBack, lowerRightFront);
-			AddCollisionLine(lowerLeftBack, lowerLeftFront);
-			AddCollisionLine(upperLeftBack, upperLeftFront);
+			AddCollisionLine(a_geometry, upperRightBack, upperRightFront, color);
+			AddCollisionLine(a_geometry, lowerRightBack, lowerRightFront, color);
+			AddCollisionLine(a_geometry, lowerLeftBack, lowerLeftFront, color);
+			AddCollisionLine(a_geometry, upperLeftBack, upperLeftFront, color);
 		}
 		else
 		{
-			auto back = SquareToTriangles(upperLeftBack, lowerLeftBack, lowerRightBack, upperRightBack);
-			auto right = SquareToTriangles(upperRightFront, upperRightBack, lowerRightBack, lowerLeftBack);
-			auto bottom = SquareToTriangles(lowerLeftBack, lowerLeftFront, lowerRightFront, lowerRightBack);
-			auto left = SquareToTriangles(upperLeftFront, lowerLeftFront, lowerLeftBack, upperLeftBack);
-			auto top = SquareToTriangles(upperLeftFront, upperLeftBack, upperRightBack, upperRightFront);
-			auto front = SquareToTriangles(upperLeftFront, upperRightFront, lowerRightFront, lowerLeftFront);
+			// the default color of SquareToTriangles reads the settings, which the workers must not do
+			vec4u triangleColor = color;
+			auto back = SquareToTriangles(upperLeftBack, lowerLeftBack, lowerRightBack, upperRightBack, triangleColor);
+			auto right = SquareToTriangles(upperRightFront, upperRightBack, lowerRightBack, lowerLeftBack, triangleColor);
+			auto bottom = SquareToTriangles(lowerLeftBack, lowerLeftFront, lowerRightFront, lowerRightBack, triangleColor);
+			auto left = SquareToTriangles(upperLeftFront, lowerLeftFront, lowerLeftBack, upperLeftBack, triangleColor);
+			auto top = SquareToTriangles(upperLeftFront, upperLeftBack, upperRightBack, upperRightFront, triangleColor);
+			auto front = SquareToTriangles(upperLeftFront, upperRightFront, lowerRightFront, lowerLeftFront, triangleColor);
 
 			std::vector<CollisionTriangle> triangles;
 			triangles.push_back(back.first);
@@ -811,12 +825,12 @@ namespace DebugMenu
 			triangles.push_back(front.first);
 			triangles.push_back(front.second);
 
-			AddCollisionMesh(triangles);
+			a_geometry.SetTriangles(triangles);
 		}
 	}
 
 	std::vector<vec3u> CollisionHandler::RefCollisionData::GetCircle
-	(uint32_t a_segments, float a_radius, vec3u& a_unitXVector, vec3u& a_unitYVector, vec3u& a_center)
+	(uint32_t a_segments, float a_radius, const vec3u& a_unitXVector, const vec3u& a_unitYVector, const vec3u& a_center)
 	{
 		float PI = 3.14159265358f;
 		float thetaStep = 2 * PI / a_segments;
@@ -863,15 +877,28 @@ namespace DebugMenu
 	{
 		const auto* capsuleShape = static_cast<const RE::hkpCapsuleShape*>(a_object.hkpShape);
 		if (!capsuleShape) return;
+		if (TryAddCachedCollisionGeometry(a_object)) return;
 
-		uint32_t segments = MCM::settings::capsuleCylinderSegments;
+		auto description = GetShapeDescription(ShapeDescription::Type::kCapsule);
+		description.vertexA = Utils::NiToGLMVec3(Utils::hkvec4toNiVec3(capsuleShape->vertexA));
+		description.vertexB = Utils::NiToGLMVec3(Utils::hkvec4toNiVec3(capsuleShape->vertexB));
+		description.radius = capsuleShape->radius;
+		AddDescribedGeometry(std::move(description), a_object);
+	}
+
+	void CollisionHandler::RefCollisionData::BuildCapsuleGeometry(const ShapeDescription& a_description, CollisionGeometry& a_geometry)
+	{
+		const auto& color = a_description.color;
+
+		uint32_t segments = a_description.cylinderSegments;
 		float PI = 3.14159265358f;
 		float thetaStep = 2 * PI / segments;
 
-		float r = capsuleShape->radius * a_object.collisionScale;
+		// built in the local space of the shape, the collision scale is applied by the transform of the instance
+		float r = a_description.radius;
 
-		vec3u topPt = Utils::NiToGLMVec3(a_object.GetWorldPos(Utils::hkvec4toNiVec3(capsuleShape->vertexA)));
-		vec3u bottomPt = Utils::NiToGLMVec3(a_object.GetWorldPos(Utils::hkvec4toNiVec3(capsuleShape->vertexB)));
+		vec3u topPt = a_description.vertexA;
+		vec3u bottomPt = a_description.vertexB;
 
 		auto vertical = topPt - bottomPt;
 		auto unitVertical = vertical / glm::length(vertical);
@@ -908,13 +935,13 @@ namespace DebugMenu
 			auto top1 = topCircle[i];
 			auto top2 = topCircle[j];
 
-			AddCollisionLine(bottom1,bottom2);
-			AddCollisionLine(top1, top2);
-			AddCollisionLine(bottom1,top1);
+			AddCollisionLine(a_geometry, bottom1,bottom2, color);
+			AddCollisionLine(a_geometry, top1, top2, color);
+			AddCollisionLine(a_geometry, bottom1,top1, color);
 		}
 
 		// Draw the hemispheres at the ends of cylinder
-		uint32_t sphereSegments = MCM::settings::capsuleSphereSegments;
+		uint32_t sphereSegments = a_description.sphereSegments;
 		thetaStep = PI/2 / sphereSegments;
 		std::vector<std::vector<vec3u>> smallerCircles;
 		std::vector<std::vector<vec3u>> topSphere{ topCircle };
@@ -961,8 +988,8 @@ namespace DebugMenu
 				auto bottom1 = bottomSphere[j][i];
 				auto bottom2 = j < sphereSegments-1 ? bottomSphere[j+1][i] : bottomSphereApex;
 			
-				AddCollisionLine(top1, top2);
-				AddCollisionLine(bottom1, bottom2);
+				AddCollisionLine(a_geometry, top1, top2, color);
+				AddCollisionLine(a_geometry, bottom1, bottom2, color);
 			}
 		}
 	}
@@ -971,20 +998,27 @@ namespace DebugMenu
 	{
 		const auto* hkpCompressedMeshShape = static_cast<const RE::hkpCompressedMeshShape*>(a_object.hkpShape);
 		if (!hkpCompressedMeshShape) return;
+		if (TryAddCachedCollisionGeometry(a_object)) return;
+
+		auto description = GetShapeDescription(ShapeDescription::Type::kCompressedMesh);
+		description.compressedMesh = hkpCompressedMeshShape;
+		AddDescribedGeometry(std::move(description), a_object);
+	}
+
+	// only reads the shape, which is kept alive by the geometry, so it is safe to run on a worker
+	void CollisionHandler::RefCollisionData::BuildCompressedMeshGeometry(const ShapeDescription& a_description, CollisionGeometry& a_geometry)
+	{
+		const auto* hkpCompressedMeshShape = a_description.compressedMesh;
+		if (!hkpCompressedMeshShape) return;
 	
 		//////////////////////////////////////////////////////////////////////////////////////////////////////
 		// The scale of collision meshes mostly baked into the vertices, but not for compressed mesh shapes //
 		// However, the precalculated bounds of the mesh are scaled correctly, so we can scale the vertices //
 		//   to all fit withing these bounds																//
-		// To optimize getting the world points of the mesh, we must first run through all local vertices   //
-		//   to determine the local scale																	//
+		// The vertices are dequantized once, and the unscaled bounds are found in the same pass. The		//
+		//   triangles index into the shared vertices, so a vertex is only decoded and scaled once			//
 		//////////////////////////////////////////////////////////////////////////////////////////////////////
 
-		bool hasUnscaledBoundsChanged = false;
-
-		RE::NiPoint3 unscaledMinBounds{ 0.0f, 0.0f, 0.0f };
-		RE::NiPoint3 unscaledMaxBounds{ 0.0f, 0.0f, 0.0f };
-
 		float minBoundsMargin = hkpCompressedMeshShape->bounds.min.quad.m128_f32[3];
 		float maxBoundsMargin = hkpCompressedMeshShape->bounds.max.quad.m128_f32[3];
 		RE::NiPoint3 scaledMinBounds = Utils::hkvec4toNiVec3(hkpCompressedMeshShape->bounds.min);
@@ -997,61 +1031,80 @@ namespace DebugMenu
 		scaledMaxBounds.x -= maxBoundsMargin;
 		scaledMaxBounds.y -= maxBoundsMargin;
 		scaledMaxBounds.z -= maxBoundsMargin;
-		
-
-		auto UpdateBounds = [&](RE::NiPoint3& a_point)
-		{
-			if (!hasUnscaledBoundsChanged)
-			{
-				unscaledMinBounds = a_point;
-				unscaledMaxBounds = a_point;
-				hasUnscaledBoundsChanged = true;
-				return;
-			}
 
-			if (a_point.x < unscaledMinBounds.x) unscaledMinBounds.x = a_point.x;
-			else if (a_point.x > unscaledMaxBounds.x) unscaledMaxBounds.x = a_point.x;
+		float unscaledMinBounds[3]{ FLT_MAX, FLT_MAX, FLT_MAX };
+		float unscaledMaxBounds[3]{ -FLT_MAX, -FLT_MAX, -FLT_MAX };
 
-			if (a_point.y < unscaledMinBounds.y) unscaledMinBounds.y = a_point.y;
-			else if (a_point.y > unscaledMaxBounds.y) unscaledMaxBounds.y = a_point.y;
-
-			if (a_point.z < unscaledMinBounds.z) unscaledMinBounds.z = a_point.z;
-			else if (a_point.z > unscaledMaxBounds.z) unscaledMaxBounds.z = a_point.z;
-		};
+		static_assert(sizeof(vec3u) == 3 * sizeof(float));
+		std::vector<vec3u> vertices;
+		std::vector<uint32_t> indices;
 
 		float error = hkpCompressedMeshShape->error;
 		for (const auto& chunk : hkpCompressedMeshShape->chunks)
 		{
-			RE::NiPoint3 chunkOffset = Utils::hkvec4toNiVec3(chunk.offset);
+			// calculate collision mesh vertices https://github.com/niftools/nifskope/blob/3a85ac55e65cc60abc3434cc4aaca2a5cc712eef/src/gl/gltools.cpp#L968
+			// Transforms seem to all be identity
+			// auto& transform = hkpCompressedMeshShape->transforms[chunk.transformIndex];
+			#ifdef LOG_COLLISION
+				auto chunkOffset = Utils::hkvec4toNiVec3(chunk.offset);
+				logger::debug("  -CHUNK:");
+				logger::debug("     >Offset: {} {} {}", chunkOffset.x, chunkOffset.y, chunkOffset.z);
+			#endif
 
+			uint32_t baseVertex = static_cast<uint32_t>(vertices.size());
+			size_t numberOfVertices = chunk.vertices.size() / 3;
+			vertices.resize(baseVertex + numberOfVertices);
 
-			for (int i = 0; i < chunk.vertices.size() / 3; i++)
+			float chunkOffset[3]{ chunk.offset.quad.m128_f32[0], chunk.offset.quad.m128_f32[1], chunk.offset.quad.m128_f32[2] };
+			Linalg::DequantizePoints(chunk.vertices._data, numberOfVertices, error, chunkOffset, 
+				reinterpret_cast<float*>(vertices.data() + baseVertex), unscaledMinBounds, unscaledMaxBounds);
+
+			int32_t numberOfIndices = chunk.indices.size();
+			int32_t indexOffset = 0;
+			for (int s = 0; s < (int)chunk.stripLengths.size(); s++)
 			{
-				RE::NiPoint3 localPos{ chunk.vertices[3 * i] * error,
-									   chunk.vertices[3 * i + 1] * error,
-									   chunk.vertices[3 * i + 2] * error };
+				for (int i = 0; i < chunk.stripLengths[s] - 2; i++)
+				{
+					indices.push_back(baseVertex + chunk.indices[indexOffset + i]);
+					indices.push_back(baseVertex + chunk.indices[indexOffset + i + 1]);
+					indices.push_back(baseVertex + chunk.indices[indexOffset + i + 2]);
+				}
+				indexOffset += chunk.stripLengths[s];
+			}
 
-				localPos += chunkOffset;
-				UpdateBounds(localPos);
+			for (int i = indexOffset; i + 2 < numberOfIndices; i += 3)
+			{
+				indices.push_back(baseVertex + chunk.indices[i]);
+				indices.push_back(baseVertex + chunk.indices[i + 1]);
+				indices.push_back(baseVertex + chunk.indices[i + 2]);
 			}
 		}
 
-		for (auto& triangle : hkpCompressedMeshShape->bigTriangles)
+		uint32_t baseBigVertex = static_cast<uint32_t>(vertices.size());
+		for (const auto& bigVertex : hkpCompressedMeshShape->bigVertices)
 		{
-			auto localPt1 = Utils::hkvec4toNiVec3(hkpCompressedMeshShape->bigVertices[triangle.a]);
-			auto localPt2 = Utils::hkvec4toNiVec3(hkpCompressedMeshShape->bigVertices[triangle.b]);
-			auto localPt3 = Utils::hkvec4toNiVec3(hkpCompressedMeshShape->bigVertices[triangle.c]);
+			vertices.push_back(Utils::NiToGLMVec3(Utils::hkvec4toNiVec3(bigVertex)));
+		}
 
-			UpdateBounds(localPt1);
-			UpdateBounds(localPt2);
-			UpdateBounds(localPt3);
+		for (const auto& triangle : hkpCompressedMeshShape->bigTriangles)
+		{
+			for (auto index : { triangle.a, triangle.b, triangle.c })
+			{
+				const auto& vertex = vertices[baseBigVertex + index];
+				for (int axis = 0; axis < 3; axis++)
+				{
+					unscaledMinBounds[axis] = std::min(unscaledMinBounds[axis], vertex[axis]);
+					unscaledMaxBounds[axis] = std::max(unscaledMaxBounds[axis], vertex[axis]);
+				}
+				indices.push_back(baseBigVertex + index);
+			}
 		}
 
-		auto unscaledBounds = unscaledMaxBounds - unscaledMinBounds;
-		auto scaledBounds = scaledMaxBounds - scaledMinBounds;
-		auto xRatio = unscaledBounds.x != 0 ? scaledBounds.x / unscaledBounds.x : 0.0f;
-		auto yRatio = unscaledBounds.y != 0 ? scaledBounds.y / unscaledBounds.y : 0.0f;
-		auto zRatio = unscaledBounds.z != 0 ? scaledBounds.z / unscaledBounds.z : 0.0f;
+		if (indices.empty()) return;
+
+		auto xRatio = unscaledMaxBounds[0] != unscaledMinBounds[0] ? (scaledMaxBounds.x - scaledMinBounds.x) / (unscaledMaxBounds[0] - unscaledMinBounds[0]) : 0.0f;
+		auto yRatio = unscaledMaxBounds[1] != unscaledMinBounds[1] ? (scaledMaxBounds.y - scaledMinBounds.y) / (unscaledMaxBounds[1] - unscaledMinBounds[1]) : 0.0f;
+		auto zRatio = unscaledMaxBounds[2] != unscaledMinBounds[2] ? (scaledMaxBounds.z - scaledMinBounds.z) / (unscaledMaxBounds[2] - unscaledMinBounds[2]) : 0.0f;
 
 		uint8_t nonZeroRatios = 0;
 		if (xRatio != 0) nonZeroRatios += 1;
@@ -1067,111 +1120,12 @@ namespace DebugMenu
 			logger::debug("  -BigTris: {}", hkpCompressedMeshShape->bigTriangles.size());
 		#endif
 
-		std::vector<CollisionTriangle> triangles;
-		for (const auto& chunk : hkpCompressedMeshShape->chunks)
+		for (auto& vertex : vertices)
 		{
-
-			
-			// calculate collision mesh vertices https://github.com/niftools/nifskope/blob/3a85ac55e65cc60abc3434cc4aaca2a5cc712eef/src/gl/gltools.cpp#L968
-			RE::NiPoint3 chunkOffset = Utils::hkvec4toNiVec3(chunk.offset);
-			
-			// Transforms seem to all be identity
-			// auto& transform = hkpCompressedMeshShape->transforms[chunk.transformIndex];	 
-			 
-			 // could use Chunk::decompressVertex instead of finding all vertices manually
-			 #ifdef LOG_COLLISION
-				auto pos = chunkOffset * a_object.collisionScale;
-				logger::debug("  -CHUNK:");
-				logger::debug("     >Offset: {} {} {}", chunkOffset.x, chunkOffset.y, chunkOffset.z);
-				logger::debug("     >Scaled Offset: {} {} {}", pos.x, pos.y, pos.z);
-			 #endif
-			
-				
-
-			std::vector<vec3u> vertices;
-			for (int i = 0; i < chunk.vertices.size() / 3; i++)
-			{
-				RE::NiPoint3 localPos{ chunk.vertices[3 * i] * error,
-									   chunk.vertices[3 * i + 1] * error,
-									   chunk.vertices[3 * i + 2] * error };
-				
-				localPos += chunkOffset;
-				localPos *= localScale;
-				// localPos *= Utils::hkvec4toNiVec3(transform.scale);
-				// localPos = Utils::RotateNiPoint3(localPos, transform.rotation);
-				// localPos += Utils::hkvec4toNiVec3(transform.translation);
-				vertices.push_back(Utils::NiToGLMVec3(a_object.GetWorldPos(localPos)));
-			}
-
-			int indexOffset = 0;
-			for (int s = 0; s < (int)chunk.stripLengths.size(); s++)
-			{
-				for (int i = 0; i < chunk.stripLengths[s] - 2; i++)
-				{
-					auto pt1 = vertices[chunk.indices[indexOffset + i]];
-					auto pt2 = vertices[chunk.indices[indexOffset + i + 1]];
-					auto pt3 = vertices[chunk.indices[indexOffset + i + 2]];
-
-					triangles.push_back(CollisionTriangle{ pt1, pt2, pt3 });
-				}
-				indexOffset += chunk.stripLengths[s];
-			}				
-		
-			for (int i = indexOffset; i < chunk.indices.size() - 2; i += 3)
-			{
-
-				auto pt1 = vertices[chunk.indices[i]];
-				auto pt2 = vertices[chunk.indices[i + 1]];
-				auto pt3 = vertices[chunk.indices[i + 2]];
-
-				triangles.push_back(CollisionTriangle{ pt1, pt2, pt3 });
-			}
-
-			//std::string indicesStr = "Indices = [ "s;
-			//for (auto i : chunk.indices)
-			//{
-			//	indicesStr += fmt::format("{}, ", i);
-			//}
-			//indicesStr += "999][:-1]";
-			//logger::debug("{}", indicesStr);
-			//
-			//std::string verticesStr = "Vertices = [ "s;
-			//
-			//for (auto v : chunk.vertices)
-			//{
-			//	verticesStr += fmt::format("{}, ", v);
-			//}
-			//verticesStr += "999][:-1]";
-			//logger::debug("{}", verticesStr);
-			//
-			//std::string stripsStr = "Strips = [";
-			//for (auto s : chunk.stripLengths)
-			//{
-			//	stripsStr += fmt::format("{}, ", s);
-			//}
-			//stripsStr += "999][:-1]";
-			//logger::debug("{}", stripsStr);
-
-		}
-
-		for (auto& triangle : hkpCompressedMeshShape->bigTriangles)
-		{
-			auto localPt1 = Utils::hkvec4toNiVec3(hkpCompressedMeshShape->bigVertices[triangle.a]);
-			auto localPt2 = Utils::hkvec4toNiVec3(hkpCompressedMeshShape->bigVertices[triangle.b]);
-			auto localPt3 = Utils::hkvec4toNiVec3(hkpCompressedMeshShape->bigVertices[triangle.c]);
-
-			localPt1 *= localScale;
-			localPt2 *= localScale;
-			localPt3 *= localScale;
-
-			auto pt1 = Utils::NiToGLMVec3(a_object.GetWorldPos(localPt1));
-			auto pt2 = Utils::NiToGLMVec3(a_object.GetWorldPos(localPt2));
-			auto pt3 = Utils::NiToGLMVec3(a_object.GetWorldPos(localPt3));
-
-			triangles.push_back(CollisionTriangle{ pt1, pt2, pt3 });
+			vertex *= localScale;
 		}
 
-		AddCollisionMesh(triangles);
+		a_geometry.SetTriangles(vertices, indices);
 	}
 
 	void CollisionHandler::RefCollisionData::GetConvexTransformCollisionCoordinates(CollisionObject& a_object)
@@ -1194,6 +1148,7 @@ namespace DebugMenu
 
 		const auto* convexVerticesShape = static_cast<const RE::hkpConvexVerticesShape*>(a_object.hkpShape);
 		if (!convexVerticesShape) return;
+		if (TryAddCachedCollisionGeometry(a_object)) return;
 
 		if (!convexVerticesShape->connectivity)
 		{
@@ -1248,63 +1203,66 @@ namespace DebugMenu
 				convexVerticesShape->connectivity->numVerticesPerFace = newConvexHull.verticesPerFace;
 			}
 
-			int faceStartIndex = 0;
+			auto description = GetShapeDescription(ShapeDescription::Type::kConvexFaces);
+			description.vertices.reserve(vertices.size());
+			for (const auto& vertex : vertices)
+			{
+				description.vertices.push_back(Utils::NiToGLMVec3(Utils::hkvec4toNiVec3(vertex)));
+			}
 
-			if (MCM::settings::cleanCollisions)
+			int faceStartIndex = 0;
+			for (int i = 0; i < verticesPerFaceArray.size(); i++)
 			{
-				for (int i = 0; i < verticesPerFaceArray.size(); i++)
+				auto verticesPerFace = verticesPerFaceArray[i];
+				if (verticesPerFace >= 3)
 				{
-					auto verticesPerFace = verticesPerFaceArray[i];
-					if (verticesPerFace >= 3)
-					{
-						for (int k = faceStartIndex; k < faceStartIndex + verticesPerFace; k++)
-						{
-							auto index1 = vertexIndices[k];
-							auto index2 = k < faceStartIndex + verticesPerFace - 1 ? vertexIndices[k + 1] : vertexIndices[faceStartIndex];
-
-							auto vertex1 = Utils::NiToGLMVec3(a_object.GetWorldPos(Utils::hkvec4toNiVec3(vertices[index1])));
-							auto vertex2 = Utils::NiToGLMVec3(a_object.GetWorldPos(Utils::hkvec4toNiVec3(vertices[index2])));
-
-							AddCollisionLine(vertex1, vertex2);
-						}
-					}
-					faceStartIndex += verticesPerFace;
+					description.faces.emplace_back(vertexIndices.begin() + faceStartIndex, vertexIndices.begin() + faceStartIndex + verticesPerFace);
 				}
+				faceStartIndex += verticesPerFace;
 			}
-			else
-			{
-				std::vector<CollisionTriangle> triangles;
-
-				std::vector<std::vector<uint16_t>> faces;
-				for (int i = 0; i < verticesPerFaceArray.size(); i++)
-				{
-					auto verticesPerFace = verticesPerFaceArray[i];
-					if (verticesPerFace >= 3)
-					{
-						std::vector<uint16_t> faceIndices;
 
-						for (int k = faceStartIndex; k < faceStartIndex + verticesPerFace; k++)
-						{
-							faceIndices.push_back(vertexIndices[k]);
-						}
-						faceStartIndex += verticesPerFace;
-						faces.push_back(faceIndices);
-					}
-				}
+			AddDescribedGeometry(std::move(description), a_object);
+		}
+	}
 
-				auto triangleIndices = Utils::ConvexHullPlanesIndicesToTriangleIndices(faces);
+	void CollisionHandler::RefCollisionData::BuildConvexGeometry(const ShapeDescription& a_description, CollisionGeometry& a_geometry)
+	{
+		const auto& vertices = a_description.vertices;
 
-				for (const auto& triangle : triangleIndices)
+		if (a_description.cleanCollisions)
+		{
+			for (const auto& face : a_description.faces)
+			{
+				for (size_t k = 0; k < face.size(); k++)
 				{
-					auto pt1 = Utils::NiToGLMVec3(a_object.GetWorldPos(Utils::hkvec4toNiVec3(vertices[triangle.index1])));
-					auto pt2 = Utils::NiToGLMVec3(a_object.GetWorldPos(Utils::hkvec4toNiVec3(vertices[triangle.index2])));
-					auto pt3 = Utils::NiToGLMVec3(a_object.GetWorldPos(Utils::hkvec4toNiVec3(vertices[triangle.index3])));
-
-					triangles.push_back(CollisionTriangle{ pt1, pt2, pt3 });
+					auto index1 = face[k];
+					auto index2 = k < face.size() - 1 ? face[k + 1] : face[0];
+					AddCollisionLine(a_geometry, vertices[index1], vertices[index2], a_description.color);
 				}
-				AddCollisionMesh(triangles);
 			}
 		}
+		else
+		{
+			auto triangleIndices = Utils::ConvexHullPlanesIndicesToTriangleIndices(a_description.faces);
+
+			std::vector<uint32_t> indices;
+			indices.reserve(triangleIndices.size() * 3);
+			for (const auto& triangle : triangleIndices)
+			{
+				indices.push_back(triangle.index1);
+				indices.push_back(triangle.index2);
+				indices.push_back(triangle.index3);
+			}
+			a_geometry.SetTriangles(vertices, indices);
+		}
+	}
+
+	// some containers build the child shape in the buffer, which is reused for the next child, so it cannot be cached by address
+	static bool IsShapeInBuffer(const RE::hkpShape* a_shape, const RE::hkpShapeBuffer& a_buffer)
+	{
+		auto address = reinterpret_cast<uintptr_t>(a_shape);
+		auto bufferStart = reinterpret_cast<uintptr_t>(&a_buffer);
+		return address >= bufferStart && address < bufferStart + sizeof(RE::hkpShapeBuffer);
 	}
 
 	void CollisionHandler::RefCollisionData::GetListCollisionCoordinates(CollisionObject& a_object)
@@ -1322,6 +1280,7 @@ namespace DebugMenu
 			auto childShape = listShape->GetChildShape(key, buffer);
 			CollisionObject childObject = a_object;
 			childObject.hkpShape = childShape;
+			if (IsShapeInBuffer(childShape, buffer)) childObject.isShapeCacheable = false;
 
 			GetObjectCollisionCoordinates(childObject);
 
@@ -1361,6 +1320,7 @@ namespace DebugMenu
 			auto childShape = a_singleShapeContainer.GetChildShape(key, buffer);
 			CollisionObject childObject = a_object;
 			childObject.hkpShape = childShape;
+			if (IsShapeInBuffer(childShape, buffer)) childObject.isShapeCacheable = false;
 
 			GetObjectCollisionCoordinates(childObject);
 		}
@@ -1374,9 +1334,9 @@ namespace DebugMenu
 			Renderer::DrawLine(line.start, line.end, line.color);
 		}
 
-		for (auto& mesh : collisionMeshes)
+		for (auto& instance : collisionGeometries)
 		{
-			Renderer::DrawMesh(mesh.meshDrawer);
+			if (instance.geometry->meshDrawer) Renderer::DrawMeshInstance(instance.geometry->meshDrawer, instance.localToWorld, instance.color);
 		}
 	}
 
@@ -1408,5 +1368,44 @@ namespace DebugMenu
 
 	}
 
+	glm::mat4 CollisionHandler::CollisionObject::GetLocalToWorld() const
+	{
+		auto toMatrix = [](const RE::NiMatrix3& a_rotation, const RE::NiPoint3& a_translation)
+		{
+			glm::mat4 matrix{ 1.0f };
+			for (int row = 0; row < 3; row++)
+			{
+				for (int column = 0; column < 3; column++)
+				{
+					matrix[column][row] = a_rotation.entry[row][column]; // glm is column major
+				}
+			}
+			matrix[3] = glm::vec4(a_translation.x, a_translation.y, a_translation.z, 1.0f);
+			return matrix;
+		};
+
+		glm::mat4 matrix = glm::scale(glm::mat4{ 1.0f }, vec3u(collisionScale));
+
+		if (useRBTransform)
+		{
+			RE::NiMatrix3 rbRotationMatrix;
+			RE::NiPoint3 axes[3]{ { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } };
+			for (int column = 0; column < 3; column++)
+			{
+				auto rotatedAxis = Utils::RotateNiPoint3(axes[column], rbRotation);
+				rbRotationMatrix.entry[0][column] = rotatedAxis.x;
+				rbRotationMatrix.entry[1][column] = rotatedAxis.y;
+				rbRotationMatrix.entry[2][column] = rotatedAxis.z;
+			}
+			matrix = matrix * toMatrix(rbRotationMatrix, rbOffset);
+		}
+
+		if (useLocalTransform) matrix = matrix * toMatrix(localRotation, localOffset);
+
+		if (isCharController) return toMatrix(charControllerRotation, charControllerOffset * collisionScale) * matrix;
+
+		return toMatrix(parent->world.rotate, parent->world.translate) * matrix;
+	}
+
 
 }
\ No newline at end of file
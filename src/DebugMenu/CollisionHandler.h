@@ -1,6 +1,7 @@
 #pragma once
 
 #include "DebugItem.h"
+#include "WorkerPool.h"
 #include "Renderer/Renderer.h"
 
 namespace DebugMenu
@@ -38,8 +39,11 @@ namespace DebugMenu
 
 				RE::NiPoint3		testOffset{ 0.0f, 0.0f, 0.0f };
 
+				bool				isShapeCacheable = true; // false if the shape was created in a temporary hkpShapeBuffer, or may change (char controllers)
+
 				CollisionObject(RE::NiAVObject* a_parent) : parent(a_parent) {}
 				RE::NiPoint3		GetWorldPos(RE::NiPoint3 a_position);
+				glm::mat4			GetLocalToWorld() const; // the same transform as GetWorldPos, as a matrix
 			};
 
 			struct CollisionLine
@@ -67,6 +71,98 @@ namespace DebugMenu
 				CollisionMesh(std::vector<CollisionTriangle>& a_triangles);
 			};
 
+			// The triangles or lines of a shape in its local space. Shared by all refs using the shape, the triangles are drawn
+			// as instances and the lines are transformed to world space by each ref
+			struct CollisionGeometry
+			{
+				std::shared_ptr<Renderer::InstancedMeshDrawer>	meshDrawer = nullptr; // null if the shape has no triangles
+				std::vector<CollisionLine>						lines{};
+				Renderer::Model::PositionMesh					mesh{}; // the triangles until they are uploaded on the main thread
+				RE::hkRefPtr<RE::hkpShape>						shape; // keeps a cached shape alive, so its address is not reused by another shape. Null if not cached
+
+				CollisionGeometry(const RE::hkpShape* a_shape) : shape(const_cast<RE::hkpShape*>(a_shape)) {}
+				void SetTriangles(std::vector<CollisionTriangle>& a_triangles);
+				void SetTriangles(const std::vector<vec3u>& a_vertices, const std::vector<uint32_t>& a_indices); // 3 indices per triangle
+				void Upload();
+			};
+
+			// What is needed to build the geometry of a shape, read from the shape and the settings while the havok world is locked,
+			// so the geometry can be built on a worker thread
+			struct ShapeDescription
+			{
+				enum class Type
+				{
+					kBox,
+					kCapsule,
+					kConvexFaces,
+					kCompressedMesh
+				};
+
+				Type								type = Type::kBox;
+				bool								cleanCollisions = false;
+				vec4u								color{ 1.0f };
+
+				vec3u								halfExtents{ 0.0f };	// box
+
+				vec3u								vertexA{ 0.0f };		// capsule
+				vec3u								vertexB{ 0.0f };
+				float								radius = 0.0f;
+				uint32_t							cylinderSegments = 0;
+				uint32_t							sphereSegments = 0;
+
+				std::vector<vec3u>					vertices{};				// convex vertices
+				std::vector<std::vector<uint16_t>>	faces{};
+
+				const RE::hkpCompressedMeshShape*	compressedMesh = nullptr; // only read, the geometry it is built into keeps it alive
+			};
+
+			// the extracted geometry depends on the scale of the havok world, on whether clean collisions (lines) are drawn,
+			// and on the settings baked into it: the line color and the capsule segments
+			struct GeometryKey
+			{
+				const RE::hkpShape*	shape = nullptr;
+				float				collisionScale = 0.0f;
+				bool				cleanCollisions = false;
+				vec4u				color{ 0.0f };
+				uint32_t			cylinderSegments = 0;
+				uint32_t			sphereSegments = 0;
+
+				bool operator==(const GeometryKey&) const = default;
+			};
+
+			struct GeometryKeyHash
+			{
+				size_t operator()(const GeometryKey& a_key) const
+				{
+					size_t hash = std::hash<const RE::hkpShape*>{}(a_key.shape);
+					Utils::HashCombine(hash, a_key.collisionScale);
+					Utils::HashCombine(hash, a_key.cleanCollisions);
+					for (int i = 0; i < 4; i++) Utils::HashCombine(hash, a_key.color[i]);
+					Utils::HashCombine(hash, a_key.cylinderSegments);
+					Utils::HashCombine(hash, a_key.sphereSegments);
+					return hash;
+				}
+			};
+
+			struct GeometryCacheStats
+			{
+				uint32_t hits = 0;
+				uint32_t misses = 0;
+			};
+
+			struct BuiltGeometry
+			{
+				GeometryKey							key;
+				std::shared_ptr<CollisionGeometry>	geometry;
+			};
+
+			struct CollisionGeometryInstance
+			{
+				std::shared_ptr<CollisionGeometry>	geometry;
+				glm::mat4							localToWorld;
+				vec4u								color;
+			};
+
 			class RefCollisionData
 			{
 				public:
@@ -79,7 +175,15 @@ namespace DebugMenu
 					bool						isCreature = false;
 					bool						hasCharControllerCollision = false;
 					std::vector<CollisionLine>	collisionLines{};
-					std::vector<CollisionMesh>	collisionMeshes{};
+					std::vector<CollisionGeometryInstance>	collisionGeometries{}; // also keeps the cached geometry of the lines alive
+
+					// geometry that is being built on a worker, added when it is published
+					struct PendingGeometry
+					{
+						GeometryKey	key;
+						glm::mat4	localToWorld;
+					};
+					std::vector<PendingGeometry>	pendingGeometries{};
 
 					RefCollisionData(RE::TESObjectREFR* a_ref);
 					void	DrawObject();
@@ -88,15 +192,22 @@ namespace DebugMenu
 					void	MarkForDeletion() { ref = nullptr; }
 					float	GetSquareDistance(const RE::NiPoint3& a_point);
 
+					void	AddPublishedGeometries();
+
 					static std::pair<CollisionTriangle, CollisionTriangle> SquareToTriangles(vec3u& a_point1, vec3u& a_point2, vec3u& a_point3, vec3u& a_point4, vec4u& a_color = MCM::settings::collisionColor);
+					// only reads the description, so it can run on a worker thread
+					static void BuildGeometry(const ShapeDescription& a_description, CollisionGeometry& a_geometry);
 
 
 				private:
 					RE::NiPoint3 previousPosition{ 0.0f, 0.0f, 0.0f };
 
-					void AddCollisionLine(vec3u& a_start, vec3u& a_end);
-					void AddCollisionLine(vec3u& a_start, vec3u& a_end, glm::vec4& a_color);
-					void AddCollisionMesh(std::vector<CollisionTriangle>& a_triangles);
+					// the lines and triangles are in the local space of the shape, and are cached together under the shape
+					static void AddCollisionLine(CollisionGeometry& a_geometry, const vec3u& a_start, const vec3u& a_end, const glm::vec4& a_color);
+					void AddCollisionGeometry(std::shared_ptr<CollisionGeometry> a_geometry, const glm::mat4& a_localToWorld);
+					bool TryAddCachedCollisionGeometry(const CollisionObject& a_object);
+					void AddDescribedGeometry(ShapeDescription&& a_description, const CollisionObject& a_object);
+					static ShapeDescription GetShapeDescription(ShapeDescription::Type a_type);
 					void HandleActors(CollisionObject& a_object);
 					void GetObjectCollisionCoordinates(CollisionObject& a_object);
 					void GetBoxCollisionCoordinates(CollisionObject& a_object);
@@ -108,17 +219,36 @@ namespace DebugMenu
 					void GetMOPPCollisionCoordinates(CollisionObject& a_object);
 					void LoopOverSingleShapeContainer(CollisionObject& a_object, const RE::hkpSingleShapeContainer& a_singleShapeContainer);
 					
-					std::vector<vec3u>								GetCircle(uint32_t a_segments, float a_radius, vec3u& a_unitXVector, vec3u& a_unitYVector, vec3u& a_center);
+					static void BuildBoxGeometry(const ShapeDescription& a_description, CollisionGeometry& a_geometry);
+					static void BuildCapsuleGeometry(const ShapeDescription& a_description, CollisionGeometry& a_geometry);
+					static void BuildConvexGeometry(const ShapeDescription& a_description, CollisionGeometry& a_geometry);
+					static void BuildCompressedMeshGeometry(const ShapeDescription& a_description, CollisionGeometry& a_geometry);
+					
+					static std::vector<vec3u>						GetCircle(uint32_t a_segments, float a_radius, const vec3u& a_unitXVector, const vec3u& a_unitYVector, const vec3u& a_center);
 					
 					static std::vector<RE::FormID> refsWithBadConvexHulls;
 			};
 
 			std::vector<std::unique_ptr<RefCollisionData>> visibleCollisions;
+
+			static inline std::unordered_map<GeometryKey, std::weak_ptr<CollisionGeometry>, GeometryKeyHash> geometryCache;
+			static inline std::map<RE::hkpShapeType, GeometryCacheStats> geometryCacheStats;
+			static inline uint32_t	geometryUploads = 0;
+			static inline size_t	geometryUploadBytes = 0;
+			static inline uint32_t	geometryCacheHits = 0;
+
+			// shapes that are not cached yet are built on the workers, and published to the cache by the main thread on a later frame
+			static inline HandoffQueue<BuiltGeometry>																	builtGeometries;
+			static inline std::unordered_map<GeometryKey, std::shared_ptr<CollisionGeometry>, GeometryKeyHash>	geometriesInFlight;
+			static inline std::vector<std::shared_ptr<CollisionGeometry>>									publishedGeometries; // kept alive until the refs waiting for them have them
+			std::chrono::steady_clock::time_point															extractionStart;
 			std::vector<RE::TESObjectREFRPtr> selectedRefs;
 			RE::TESObjectREFRPtr previousConsoleSelectedRef = nullptr;
 
 
 			void  DrawCollisions();
+			void  PublishBuiltGeometries();
+			bool  IsExtractionBudgetExceeded() const;
 			void  DrawCollision(RE::TESObjectREFR* a_ref);
 			void  UpdateSelectedRefs(RE::TESObjectREFR* a_ref);
 			float GetRange() override;
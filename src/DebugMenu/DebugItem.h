@@ -2,6 +2,7 @@
 
 #include "DrawHandler.h"
 #include "MCM.h"
+#include "Profiler.h"
 #include "Utils.h"
 
 using InfoType = DrawHandler::ShapeMetaData::InfoType;
@@ -16,6 +16,7 @@ namespace DebugMenu
 	std::unique_ptr<MarkerHandler>& GetMarkerHandler() { return debugMenuHandler->markerHandler; }
 	std::unique_ptr<CollisionHandler>& GetCollisionHandler() { return debugMenuHandler->collisionHandler; }
 	std::unique_ptr<RefInspectorHandler>& GetRefInspectorHandler() { return debugMenuHandler->refInspectorHandler; }
+	std::unique_ptr<RefSnapshot>& GetRefSnapshot() { return debugMenuHandler->refSnapshot; }
 
 	void DebugMenuHandler::Init()
 	{
@@ -27,6 +28,7 @@ namespace DebugMenu
 		markerHandler = std::make_unique<MarkerHandler>();
 		collisionHandler = std::make_unique<CollisionHandler>();
 		refInspectorHandler = std::make_unique<RefInspectorHandler>();
+		refSnapshot = std::make_unique<RefSnapshot>();
 
 		MCM::DebugMenuMCM::UpdateCollisionColor();
 
@@ -70,6 +72,9 @@ namespace DebugMenu
 
 	void DebugMenuHandler::Update()
 	{
+		Profiler::Collect();
+		if (navmeshHandler) navmeshHandler->FinishDiskCacheWrite();
+
 		if (!Utils::IsPlayerLoaded()) return;
 
 		if (!hasDebugMenuBeenOpenedBefore || !isDebugMenuActive) return;
@@ -81,6 +86,9 @@ namespace DebugMenu
 
 		if (drawHandler && drawHandler->g_DrawMenu)
 		{
+			Utils::InvalidateAttachedCells();
+			refSnapshot->Invalidate(); // the refs are gathered again by the first debug item that needs them
+
 			if (MCM::settings::updateRate == 0 || timeSinceLastUpdate > 1.0f / MCM::settings::updateRate)
 			{
 				timeSinceLastUpdate = 0;
@@ -184,6 +192,7 @@ namespace DebugMenu
 		ScaleformUI::GetDrawMenu()->Close();
 		drawHandler->ClearScaleform();
 		drawHandler->ClearD3D11();
+		drawHandler->ClearOverlay();
 		drawHandler->g_DrawMenu = nullptr;
 	}
 
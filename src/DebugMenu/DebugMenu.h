@@ -8,6 +8,7 @@
 #include "CollisionHandler.h"
 #include "RefInspectorHandler.h"
 #include "InfoHandler.h"
+#include "RefSnapshot.h"
 
 namespace DebugMenu
 {
@@ -21,6 +22,7 @@ namespace DebugMenu
 			std::unique_ptr<MarkerHandler>			markerHandler;
 			std::unique_ptr<CollisionHandler>		collisionHandler;
 			std::unique_ptr<RefInspectorHandler>	refInspectorHandler;
+			std::unique_ptr<RefSnapshot>			refSnapshot;
 			
 			bool isDrawMenuOpen = false;
 			bool isCoordinatesBoxVisible = false;
@@ -61,5 +63,6 @@ namespace DebugMenu
 	std::unique_ptr<MarkerHandler>&			GetMarkerHandler();
 	std::unique_ptr<CollisionHandler>&		GetCollisionHandler();
 	std::unique_ptr<RefInspectorHandler>&	GetRefInspectorHandler();
+	std::unique_ptr<RefSnapshot>&			GetRefSnapshot();
 		
 }
\ No newline at end of file
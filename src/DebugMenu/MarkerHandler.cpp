@@ -12,16 +12,25 @@ namespace DebugMenu
 	void MarkerHandler::InitPostDataLoaded()
 	{
 		CopyEffectShaderMaterial("marker_light.nif"s, "marker_light:0"s, lightBulbMaterial);
+
+		// the models of the markers that are attached to refs, the models of the refs that are markers themselves are kept when first shown
+		std::vector<std::string> paths = { "marker_halfomni.nif"s, "marker_spotlight.nif"s, "marker_lightshadow.nif"s, "MarkerTeleport.nif"s, "marker_sound.nif"s };
+		for (RE::FormID furnitureMarkerID : { 0x64, 0x65, 0x66 }) // sit, sleep and lean markers
+		{
+			if (auto markerStatic = RE::TESForm::LookupByID<RE::TESObjectSTAT>(furnitureMarkerID); markerStatic && markerStatic->model.data())
+			{
+				paths.push_back(markerStatic->model.data());
+			}
+		}
+		modelCache.Preload(std::move(paths));
 	}
 
 	void MarkerHandler::CopyEffectShaderMaterial(const std::string& a_filepath, const std::string& a_shapeName, RE::BSEffectShaderMaterial*& a_materialOut)
 	{
-		RE::NiPointer<RE::NiNode> model;
-		RE::BSModelDB::DBTraits::ArgsType args;
-		RE::BSResource::ErrorCode errorCode = RE::BSModelDB::Demand(a_filepath.c_str(), model, args);
-		if (errorCode == RE::BSResource::ErrorCode::kNone && model)
+		// only read, so the prototype is used without cloning it
+		if (auto model = modelCache.GetPrototype(a_filepath.c_str()))
 		{
-			if (auto shape = model->AsNode()->GetObjectByName(a_shapeName))
+			if (auto shape = model->GetObjectByName(a_shapeName))
 			{
 				if (auto shaderProperty = netimmerse_cast<RE::BSEffectShaderProperty*>(shape->AsGeometry()->GetGeometryRuntimeData().shaderProperty.get()))
 				{
@@ -50,6 +59,8 @@ namespace DebugMenu
 
 	void MarkerHandler::Draw()
 	{
+		PROFILE_SCOPE("MarkerHandler::Draw");
+
 		if (MCM::settings::showMarkers) 
 		{
 			DrawMarkers();
@@ -92,84 +103,238 @@ namespace DebugMenu
 		#endif
 		}
 
+		showOperations = 0;
+		hideOperations = 0;
+
 		for (int i = visibleMarkers.size() - 1; i > -1; i--)
 		{
-			std::unique_ptr<Marker>& marker = visibleMarkers[i];
-
-			if (!IsMarkerLoaded(marker)) // whenever worldspaces change, the reference is still loaded in memory, and may still be in range, but there is no reason to keep them in the list
+			if (!IsMarkerLoaded(visibleMarkers[i])) // whenever worldspaces change, the reference is still loaded in memory, and may still be in range, but there is no reason to keep them in the list
 			{
+				hideOperations++;
 				HideMarker(i);
-				continue;
+				areCandidatesSorted = false; // to be shown again if it is loaded again
 			}
+		}
 
-			float dx = origin.x - marker->ref->GetPositionX();
-			float dy = origin.y - marker->ref->GetPositionY();
+		UpdateCandidateCells();
 
-			float range = GetRange();
-			if (marker->drawWhenFar) range = drawWhenFarRange;
+		// Only the candidates whose distance to the anchor is within the offset of the center from the range can have moved
+		// in or out of it, the others are on the same side as in the last update
+		float offset = std::sqrt((origin.x - anchor.x)*(origin.x - anchor.x) + (origin.y - anchor.y)*(origin.y - anchor.y));
+		if (!areCandidatesSorted || offset > reanchorDistance || nearCandidates.range != GetRange())
+		{
+			SortCandidates(origin);
+		}
+		else
+		{
+			RetryPendingCandidates(nearCandidates);
+			RetryPendingCandidates(farCandidates);
+			UpdateCandidatesNearRange(nearCandidates, origin, std::max(offset, anchorOffset));
+			UpdateCandidatesNearRange(farCandidates, origin, std::max(offset, anchorOffset));
+			anchorOffset = offset;
+		}
+
+		DrawMarkerInfo();
 
-			if (dx * dx + dy * dy > range * range)
+		PROFILE_VALUE("MarkerHandler candidates", nearCandidates.candidates.size() + farCandidates.candidates.size());
+		PROFILE_VALUE("MarkerHandler shows", showOperations);
+		PROFILE_VALUE("MarkerHandler hides", hideOperations);
+
+		auto modelStats = modelCache.TakeStats();
+		PROFILE_VALUE("MarkerModelCache hits", modelStats.hits);
+		PROFILE_VALUE("MarkerModelCache misses", modelStats.misses);
+		PROFILE_VALUE("MarkerModelCache evicted", modelStats.evicted);
+	}
+
+	void MarkerHandler::DrawMarkerInfo()
+	{
+		if (!MCM::settings::showInfoOnHover || !MCM::settings::showMarkerInfo) return;
+
+		for (const auto& marker : visibleMarkers)
+		{
+			auto baseObject = marker.ref->GetBaseObject();
+			if (!baseObject) continue;
+
+			DrawHandler::ShapeMetaData metaData;
+			metaData.cell = marker.ref->parentCell;
+			metaData.ref = marker.ref.get();
+
+			if (baseObject->GetFormType() == RE::FormType::Light)
 			{
-				HideMarker(i);
+				metaData.infoType = InfoType::kLightMarker;
+				GetDrawHandler()->DrawPoint(marker.ref->GetPosition(), 20.0f, MCM::settings::lightBulbInfoColor, MCM::settings::markerInfoAlpha, metaData);
+			}
+			else if (baseObject->GetFormType() == RE::FormType::Sound)
+			{
+				metaData.infoType = InfoType::kSoundMarker;
+				GetDrawHandler()->DrawPoint(marker.ref->GetPosition(), 20.0f, MCM::settings::soundMarkerInfoColor, MCM::settings::markerInfoAlpha, metaData);
 			}
 		}
+	}
+
+	// registers the refs of the newly attached cells and drops the refs of the detached ones
+	void MarkerHandler::UpdateCandidateCells()
+	{
+		const auto& attachedCells = Utils::GetAttachedCells();
 
-		Utils::ForEachCellInRange(origin, drawWhenFarRange, [&](const RE::TESObjectCELL* a_cell)
+		bool hasDroppedCells = false;
+		std::erase_if(registeredCells, [&](const RE::TESObjectCELL* a_cell)
 		{
-			a_cell->ForEachReference([&](RE::TESObjectREFR* ref)
-			{
-				if (!ref) return RE::BSContainer::ForEachResult::kContinue;
+			bool isAttached = std::ranges::any_of(attachedCells, [&](const Utils::AttachedCell& a_attachedCell) { return a_attachedCell.cell == a_cell; });
+			hasDroppedCells = hasDroppedCells || !isAttached;
+			return !isAttached;
+		});
 
-				#ifdef TRACEOBJECTS
+		if (hasDroppedCells)
+		{
+			for (auto* list : { &nearCandidates, &farCandidates })
+			{
+				std::erase_if(list->candidates, [&](const Candidate& a_candidate)
+				{
+					if (std::ranges::find(registeredCells, a_candidate.cell) != registeredCells.end()) return false;
+					HideCandidate(a_candidate);
+					return true;
+				});
+			}
+			areCandidatesSorted = false;
+		}
 
-					auto base = ref->GetBaseObject();
-					auto pos = ref->GetPosition();
+		for (const auto& attachedCell : attachedCells)
+		{
+			if (std::ranges::find(registeredCells, attachedCell.cell) != registeredCells.end()) continue;
 
-					if (ref->formID == debugFormID)
-					{
-						logger::debug("");
-						logger::debug("Tracing object {:X} edid: <{}> address: {:X}", ref->formID, ref->GetFormEditorID(), reinterpret_cast<uintptr_t>(ref));
-						logger::debug(" |-IsInitiallyDisabled? {}; Disabled? {}", ref->IsInitiallyDisabled(), ref->IsDisabled());
-						logger::debug(" |-Base object: {:X} edid: <{}>", base->formID, base->GetFormEditorID());
-						logger::debug(" |-Cell: {:X} edid: <{}> address: {:X}", a_cell->formID, a_cell->GetFormEditorID(), reinterpret_cast<uintptr_t>(a_cell));
-						logger::debug(" |-|-Cell game flags: {:016b}", a_cell->cellGameFlags);
-						logger::debug(" |-|-Cell state: {:08b}", a_cell->cellState.underlying());
-						logger::debug(" |-|-Cell form flags {:032b}", a_cell->formFlags);
-						logger::debug(" |-|-Cell form flags {:016b}", a_cell->inGameFormFlags.underlying());
-						logger::debug(" |-|-Cell is initialized? {}", a_cell->IsInitialized());
-					}
-				#endif
+			RegisterCandidates(attachedCell.cell);
+			registeredCells.push_back(attachedCell.cell);
+			areCandidatesSorted = false;
+		}
+	}
 
+	void MarkerHandler::RegisterCandidates(const RE::TESObjectCELL* a_cell)
+	{
+		a_cell->ForEachReference([&](RE::TESObjectREFR* a_ref)
+		{
+			if (!a_ref || !IsCandidate(a_ref)) return RE::BSContainer::ForEachResult::kContinue;
 
-				bool shouldMarkerBeDrawnWhenFar = ShouldMarkerBeDrawnWhenFar(ref);
+			auto& list = ShouldMarkerBeDrawnWhenFar(a_ref) ? farCandidates : nearCandidates;
+			list.candidates.push_back(Candidate{ a_ref->GetHandle(), a_cell, a_ref->formID, a_ref->GetPosition() });
+			return RE::BSContainer::ForEachResult::kContinue;
+		});
+	}
 
-				float range = GetRange();
-				if (shouldMarkerBeDrawnWhenFar) range = drawWhenFarRange;
+	// checks every candidate, then sorts them by their distance to the center, which becomes the anchor
+	void MarkerHandler::SortCandidates(const RE::NiPoint3& a_center)
+	{
+		nearCandidates.range = GetRange();
+		farCandidates.range = drawWhenFarRange;
 
-				float dx = origin.x - ref->GetPositionX();
-				float dy = origin.y - ref->GetPositionY();
+		for (auto* list : { &nearCandidates, &farCandidates })
+		{
+			for (auto& candidate : list->candidates)
+			{
+				(void)UpdateCandidate(candidate, list->range, a_center);
 
-				if (dx * dx + dy * dy > range * range) return RE::BSContainer::ForEachResult::kContinue;
+				float dx = a_center.x - candidate.position.x;
+				float dy = a_center.y - candidate.position.y;
+				candidate.anchorDistance = std::sqrt(dx * dx + dy * dy);
+			}
 
-				#ifdef TRACEOBJECTS
-					if (ref->formID == debugFormID) logger::debug(" |-Object withing range");
-				#endif
+			std::ranges::sort(list->candidates, {}, &Candidate::anchorDistance);
 
-				uint32_t numberOfDrawnMarkers = visibleMarkers.size();
+			list->pending.clear();
+			for (uint32_t i = 0; i < list->candidates.size(); i++)
+			{
+				const auto& candidate = list->candidates[i];
+				if (candidate.isInRange && !visibleMarkerIndices.contains(candidate.formID)) list->pending.push_back(i);
+			}
+		}
 
-				ShowMarker(ref);
+		anchor = a_center;
+		anchorOffset = 0.0f;
+		areCandidatesSorted = true;
+	}
 
+	void MarkerHandler::UpdateCandidatesNearRange(CandidateList& a_list, const RE::NiPoint3& a_center, float a_offset)
+	{
+		auto& candidates = a_list.candidates;
+		auto first = std::ranges::lower_bound(candidates, a_list.range - a_offset, {}, &Candidate::anchorDistance);
+		auto last = std::ranges::upper_bound(candidates, a_list.range + a_offset, {}, &Candidate::anchorDistance);
 
-				if (shouldMarkerBeDrawnWhenFar && visibleMarkers.size() > numberOfDrawnMarkers)
-				{
-					visibleMarkers[numberOfDrawnMarkers]->drawWhenFar = true;
-				}
+		for (auto candidate = first; candidate != last; candidate++)
+		{
+			if (UpdateCandidate(*candidate, a_list.range, a_center))
+			{
+				a_list.pending.push_back(static_cast<uint32_t>(candidate - candidates.begin()));
+			}
+		}
+	}
 
-				return RE::BSContainer::ForEachResult::kContinue;
-			});
+	// the markers that could not be shown (eg. the 3D was not loaded yet) are tried again every update while in range
+	void MarkerHandler::RetryPendingCandidates(CandidateList& a_list)
+	{
+		std::erase_if(a_list.pending, [&](uint32_t a_index)
+		{
+			const auto& candidate = a_list.candidates[a_index];
+			if (!candidate.isInRange || visibleMarkerIndices.contains(candidate.formID)) return true;
+			return ShowCandidate(candidate);
 		});
 	}
 
+	// shows or hides the marker when the candidate has moved in or out of range, returns true if the marker could not be shown
+	bool MarkerHandler::UpdateCandidate(Candidate& a_candidate, float a_range, const RE::NiPoint3& a_center)
+	{
+		float dx = a_center.x - a_candidate.position.x;
+		float dy = a_center.y - a_candidate.position.y;
+		bool isInRange = dx * dx + dy * dy <= a_range * a_range;
+		if (isInRange == a_candidate.isInRange) return false;
+
+		a_candidate.isInRange = isInRange;
+		if (!isInRange)
+		{
+			HideCandidate(a_candidate);
+			return false;
+		}
+		return !ShowCandidate(a_candidate);
+	}
+
+	bool MarkerHandler::ShowCandidate(const Candidate& a_candidate)
+	{
+		auto ref = a_candidate.handle.get();
+		if (!ref) return false;
+
+		#ifdef TRACEOBJECTS
+			auto base = ref->GetBaseObject();
+			auto a_cell = a_candidate.cell;
+
+			if (ref->formID == debugFormID)
+			{
+				logger::debug("");
+				logger::debug("Tracing object {:X} edid: <{}> address: {:X}", ref->formID, ref->GetFormEditorID(), reinterpret_cast<uintptr_t>(ref.get()));
+				logger::debug(" |-IsInitiallyDisabled? {}; Disabled? {}", ref->IsInitiallyDisabled(), ref->IsDisabled());
+				logger::debug(" |-Base object: {:X} edid: <{}>", base->formID, base->GetFormEditorID());
+				logger::debug(" |-Cell: {:X} edid: <{}> address: {:X}", a_cell->formID, a_cell->GetFormEditorID(), reinterpret_cast<uintptr_t>(a_cell));
+				logger::debug(" |-|-Cell game flags: {:016b}", a_cell->cellGameFlags);
+				logger::debug(" |-|-Cell state: {:08b}", a_cell->cellState.underlying());
+				logger::debug(" |-|-Cell form flags {:032b}", a_cell->formFlags);
+				logger::debug(" |-|-Cell form flags {:016b}", a_cell->inGameFormFlags.underlying());
+				logger::debug(" |-|-Cell is initialized? {}", a_cell->IsInitialized());
+				logger::debug(" |-Object withing range");
+			}
+		#endif
+
+		showOperations++;
+		ShowMarker(ref.get());
+		return visibleMarkerIndices.contains(a_candidate.formID);
+	}
+
+	void MarkerHandler::HideCandidate(const Candidate& a_candidate)
+	{
+		auto visibleMarker = visibleMarkerIndices.find(a_candidate.formID);
+		if (visibleMarker == visibleMarkerIndices.end()) return;
+
+		hideOperations++;
+		HideMarker(visibleMarker->second);
+	}
+
 	void MarkerHandler::AddVisibleMarker(RE::TESObjectREFR* a_ref, RE::BSFixedString a_markerName, bool a_cullWhenHiding)
 	{
 		#ifdef TRACEOBJECTS
@@ -181,15 +346,20 @@ namespace DebugMenu
 			}
 		#endif
 
-		visibleMarkers.push_back(std::make_unique<Marker>(a_ref, a_markerName));
-		visibleMarkers.back().get()->cullWhenHiding = a_cullWhenHiding;
-		visibleMarkersIDs.insert(a_ref->formID);
+		visibleMarkerIndices[a_ref->formID] = visibleMarkers.size();
+		visibleMarkers.emplace_back(a_ref, a_markerName);
+		visibleMarkers.back().cullWhenHiding = a_cullWhenHiding;
 	}
 
 	void MarkerHandler::RemoveVisibleMarker(uint32_t a_markerIndex)
 	{
-		visibleMarkersIDs.erase(visibleMarkers[a_markerIndex]->formID);
-		visibleMarkers.erase(visibleMarkers.begin() + a_markerIndex);
+		visibleMarkerIndices.erase(visibleMarkers[a_markerIndex].formID);
+		if (a_markerIndex + 1 < visibleMarkers.size())
+		{
+			visibleMarkers[a_markerIndex] = std::move(visibleMarkers.back());
+			visibleMarkerIndices[visibleMarkers[a_markerIndex].formID] = a_markerIndex;
+		}
+		visibleMarkers.pop_back();
 	}
 
 	void MarkerHandler::HideAllMarkers()
@@ -198,26 +368,27 @@ namespace DebugMenu
 		{
 			HideMarker(i);
 		}
+
+		// the settings decide which refs are candidates, so they are registered again
+		nearCandidates = CandidateList{};
+		farCandidates = CandidateList{};
+		registeredCells.clear();
+		areCandidatesSorted = false;
 	}
 
 	void MarkerHandler::HideMarker(uint32_t a_markerIndex)
 	{
 		#ifdef TRACEOBJECTS
-			if (a_markerIndex == debugMarkerIndex)
+			if (a_markerIndex < visibleMarkers.size() && visibleMarkers[a_markerIndex].formID == debugFormID)
 			{
 				logger::debug(" |-Hiding Marker; MarkerIndex: {}; VisibleMarkersSize? {}", a_markerIndex, visibleMarkers.size());
-				if (a_markerIndex < visibleMarkers.size())
-				{
-					logger::debug(" |-|-IsMarkerLoaded? {}", IsMarkerLoaded(visibleMarkers[a_markerIndex]));
-				}
+				logger::debug(" |-|-IsMarkerLoaded? {}", IsMarkerLoaded(visibleMarkers[a_markerIndex]));
 			}
 		#endif
 
 		if (a_markerIndex >= visibleMarkers.size()) return;
 
-		std::unique_ptr<Marker>& marker = visibleMarkers[a_markerIndex];
-
-
+		Marker& marker = visibleMarkers[a_markerIndex];
 
 		if (!IsMarkerLoaded(marker))
 		{
@@ -225,13 +396,13 @@ namespace DebugMenu
 			return;
 		}
 
-		marker->SetDefaultState();
+		marker.SetDefaultState();
 
 		#ifdef TRACEOBJECTS
-			if (marker->ref->formID == debugFormID)
+			if (marker.ref->formID == debugFormID)
 			{
 				logger::debug(" |-Hiding Marker. Culltree after setting default:");
-				marker->PrintCullTree(" |-|-");
+				marker.PrintCullTree(" |-|-");
 			}
 		#endif
 
@@ -371,20 +542,11 @@ namespace DebugMenu
 
 	RE::NiNode* MarkerHandler::TrySet3DByName(RE::TESObjectREFR* a_ref, const char* a_modelName, const RE::BSFixedString a_markerName)
 	{
-		RE::NiPointer<RE::NiNode> markerModel_;
-		RE::BSModelDB::DBTraits::ArgsType args;
-		RE::BSResource::ErrorCode errorCode = RE::BSModelDB::Demand(a_modelName, markerModel_, args);
-
-		if (errorCode != RE::BSResource::ErrorCode::kNone || !markerModel_ || !markerModel_.get()) return nullptr;
-
-		auto clone = markerModel_->Clone();
+		RE::NiNode* node = modelCache.Clone(a_modelName);
+		if (!node) return nullptr;
 
-		RE::NiNode* node = clone->AsNode();
 		node->name = a_markerName;
 
-
-		if (!node) return nullptr;
-
 		a_ref->Set3D(node, true);
 		a_ref->Update3DPosition(true);
 		node->CullNode(true); // node must be culled by default, so the culltree will know that it should be hidden when deactivated
@@ -402,6 +564,19 @@ namespace DebugMenu
 
 	}
 
+	bool MarkerHandler::TryAttachMarkerModel(RE::NiNode* a_node, const char* a_modelName, const RE::BSFixedString a_markerName, RE::NiAVObject*& a_objectOut)
+	{
+		a_objectOut = modelCache.Clone(a_modelName);
+		if (!a_objectOut) return false;
+
+		a_objectOut->IncRefCount();
+		a_objectOut->name = a_markerName;
+		Utils::AttachChildNode(a_node, a_objectOut);
+		a_objectOut->DecRefCount();
+
+		return true;
+	}
+
 	RE::NiNode* MarkerHandler::GetNodeFromRef(RE::TESObjectREFR* a_ref)
 	{
 		if (auto obj = a_ref->Get3D())
@@ -431,9 +606,9 @@ namespace DebugMenu
 		return nullptr;
 	}
 
-	bool MarkerHandler::IsMarkerLoaded(const std::unique_ptr<Marker>& a_marker)
+	bool MarkerHandler::IsMarkerLoaded(const Marker& a_marker)
 	{
-		return a_marker->ref && a_marker->ref->parentCell && a_marker->ref->Is3DLoaded();
+		return a_marker.ref && a_marker.ref->parentCell && a_marker.ref->Is3DLoaded();
 	}
 
 	bool MarkerHandler::ShowNodeIfNeeded(RE::TESObjectREFR* a_ref)
@@ -506,7 +681,7 @@ namespace DebugMenu
 
 				auto pos = a_ref->GetPosition();
 
-				if (!Utils::TryAttachChildByName(node, markerModelPath.c_str(), furnitureMarkerName, markerModel)) continue;
+				if (!TryAttachMarkerModel(node, markerModelPath.c_str(), furnitureMarkerName, markerModel)) continue;
 
 				//RE::NiUpdateData updateData;
 				//updateData.flags = static_cast<RE::NiUpdateData::Flag>(0x2); // seems to be flagged 2 when run by the game
@@ -547,7 +722,7 @@ namespace DebugMenu
 			}
 		#endif
 
-		if (numberOfAttachedMarkers > 0 && !visibleMarkersIDs.contains(a_ref->formID))
+		if (numberOfAttachedMarkers > 0 && !visibleMarkerIndices.contains(a_ref->formID))
 		{
 			//bool isNodeShown = ShowNodeIfNeeded(a_ref); // check if marker should be drawn (such as wallLeanMarker)
 			bool cullNodeWhenHiding = false;
@@ -584,7 +759,7 @@ namespace DebugMenu
 		#endif
 
 
-		if (!visibleMarkersIDs.contains(a_ref->formID))
+		if (!visibleMarkerIndices.contains(a_ref->formID))
 		{
 			Utils::CullNode(node, false);
 			AddVisibleMarker(a_ref);
@@ -609,7 +784,7 @@ namespace DebugMenu
 			auto localRotation = teleportExtraData->teleportData->rotation;
 
 			RE::NiAVObject* markerModel = nullptr;
-			if (!Utils::TryAttachChildByName(node, "MarkerTeleport.nif", doorTeleportMarkerName, markerModel)) return;
+			if (!TryAttachMarkerModel(node, "MarkerTeleport.nif", doorTeleportMarkerName, markerModel)) return;
 
 			auto parentRotation = a_ref->Get3D()->world.rotate;
 
@@ -618,7 +793,7 @@ namespace DebugMenu
 			markerModel->local.rotate = parentRotation.Transpose() * RE::NiMatrix3(localRotation);
 		}
 
-		if (!visibleMarkersIDs.contains(a_ref->formID))
+		if (!visibleMarkerIndices.contains(a_ref->formID))
 		{
 			bool isNodeShown = ShowNodeIfNeeded(a_ref);
 			AddVisibleMarker(a_ref, doorTeleportMarkerName, isNodeShown);
@@ -663,27 +838,16 @@ namespace DebugMenu
 			}
 		}
 
-		if (MCM::settings::showInfoOnHover && MCM::settings::showMarkerInfo)
-		{
-			auto infoPosition = a_ref->GetPosition();
-			
-			DrawHandler::ShapeMetaData metaData;
-			metaData.cell = a_ref->parentCell;
-			metaData.ref = a_ref;
-			metaData.infoType = InfoType::kLightMarker;
-			GetDrawHandler()->DrawPoint(infoPosition, 20.0f, MCM::settings::lightBulbInfoColor, MCM::settings::markerInfoAlpha, metaData);
-		}
-
 		if (Utils::HasChildrenOfName(node, lightMarkerName)) return;
 
 		RE::NiAVObject* markerModel = nullptr;
-		if (!Utils::TryAttachChildByName(node, modelName, lightMarkerName, markerModel)) return;
+		if (!TryAttachMarkerModel(node, modelName, lightMarkerName, markerModel)) return;
 		a_ref->InitNonNPCAnimation(*markerModel->AsNode());
 
 		//some lights will not be visible without bounds
 		node->UpdateWorldBound();
 
-		if (!visibleMarkersIDs.contains(a_ref->formID))
+		if (!visibleMarkerIndices.contains(a_ref->formID))
 		{
 			AddVisibleMarker(a_ref, lightMarkerName, false);
 		}
@@ -716,26 +880,43 @@ namespace DebugMenu
 
 	void MarkerHandler::ShowSoundMarker(RE::TESObjectREFR* a_ref)
 	{
-		if (MCM::settings::showInfoOnHover && MCM::settings::showMarkerInfo)
-		{
-			auto pos = a_ref->GetPosition();
-
-			DrawHandler::ShapeMetaData metaData;
-			metaData.cell = a_ref->parentCell;
-			metaData.ref = a_ref;
-			metaData.infoType = InfoType::kSoundMarker;
-			GetDrawHandler()->DrawPoint(pos, 20.0f, MCM::settings::soundMarkerInfoColor, MCM::settings::markerInfoAlpha, metaData);
-		}
-
 		auto node = GetNodeFromRef(a_ref);
 
-		if (!Utils::IsNodeTreeVisible(node) && !visibleMarkersIDs.contains(a_ref->formID))
+		if (!Utils::IsNodeTreeVisible(node) && !visibleMarkerIndices.contains(a_ref->formID))
 		{
 			node->CullNode(false);
 			AddVisibleMarker(a_ref);
 		}
 	}
 
+	// the refs ShowMarker can show a marker for with the current settings
+	bool MarkerHandler::IsCandidate(RE::TESObjectREFR* a_ref)
+	{
+		auto baseObject = a_ref->GetBaseObject();
+		if (!baseObject) return false;
+
+		switch (baseObject->GetFormType())
+		{
+			case RE::FormType::Furniture:
+				return MCM::MSettings()->showFurnitureMarkers->IsEnabled();
+			case RE::FormType::Light:
+				return MCM::MSettings()->showLightMarkers->IsEnabled();
+			case RE::FormType::Sound:
+				return MCM::MSettings()->showSoundMarkers->IsEnabled();
+			case RE::FormType::Door:
+				return MCM::MSettings()->showDoorTeleportMarkers->IsEnabled() && a_ref->extraList.GetTeleportLinkedDoor().get();
+			case RE::FormType::MovableStatic:
+			case RE::FormType::IdleMarker:
+			case RE::FormType::Activator:
+			case RE::FormType::NPC:
+			case RE::FormType::Hazard:
+			case RE::FormType::TextureSet:
+			case RE::FormType::Static:
+				return ShouldMarkerBeDrawn(a_ref);
+		}
+		return false;
+	}
+
 	bool MarkerHandler::ShouldMarkerBeDrawnWhenFar(RE::TESObjectREFR* a_ref)
 	{
 		if (auto baseObject = a_ref->GetBaseObject())
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "DebugItem.h"
+#include "MarkerModelCache.h"
 
 namespace DebugMenu
 {
@@ -28,12 +29,9 @@ namespace DebugMenu
 
 			struct Marker
 			{
-				
-
 				RE::TESObjectREFRPtr ref;
 				RE::BSFixedString markerName = ""s;
 				RE::FormID formID = 0;
-				bool drawWhenFar = false;
 				bool cullWhenHiding = true;
 
 				Marker(RE::TESObjectREFR* a_ref, RE::BSFixedString a_markerName = "") :
@@ -45,6 +43,24 @@ namespace DebugMenu
 				void SetDefaultState();
 			};
 
+			// a ref that can have a marker, registered when its cell is attached and dropped when it is detached
+			struct Candidate
+			{
+				RE::ObjectRefHandle			handle;
+				const RE::TESObjectCELL*	cell;
+				RE::FormID					formID;
+				RE::NiPoint3				position;
+				float						anchorDistance = 0.0f;	// the candidates are sorted by it
+				bool						isInRange = false;
+			};
+
+			struct CandidateList
+			{
+				std::vector<Candidate>	candidates;
+				std::vector<uint32_t>	pending;		// in range, but the marker could not be shown yet
+				float					range = 0.0f;	// of the last update
+			};
+
 			struct MarkerInfo
 			{
 				std::string path = ""s;
@@ -53,8 +69,10 @@ namespace DebugMenu
 
 			const float	lightBulbAlphaMax = 2.25;
 			const float	drawWhenFarRange = 30000.0f;
+			const float	reanchorDistance = 512.0f; // the candidates are sorted again when the center has moved this far from the anchor
 
 			RE::BSEffectShaderMaterial* lightBulbMaterial = nullptr;
+			MarkerModelCache modelCache;
 
 			const RE::BSFixedString furnitureMarkerName = "FurnitureMarkerVis";
 			const RE::BSFixedString doorTeleportMarkerName = "TeleportMarkerVis";
@@ -62,12 +80,32 @@ namespace DebugMenu
 			const RE::BSFixedString locRefTypeName = "LocRefTypeMarkerVis";
 			const RE::BSFixedString skyMarkerBeamName = "SkyMarkerVis";
 
-			std::vector<std::unique_ptr<Marker>> visibleMarkers;
-			std::unordered_set<RE::FormID> visibleMarkersIDs;
+			// slot map, a hidden marker is replaced by the last one so the order is not kept
+			std::vector<Marker> visibleMarkers;
+			std::unordered_map<RE::FormID, uint32_t> visibleMarkerIndices;
+
+			CandidateList nearCandidates;	// drawn within markersRange
+			CandidateList farCandidates;	// drawn within drawWhenFarRange
+			std::vector<const RE::TESObjectCELL*> registeredCells;
+			RE::NiPoint3 anchor;
+			float anchorOffset = 0.0f;		// of the center in the last update
+			bool areCandidatesSorted = false;
+
+			uint32_t showOperations = 0;	// per update
+			uint32_t hideOperations = 0;
 
 			float GetRange() override;
 
 			void DrawMarkers();
+			void DrawMarkerInfo();
+			void UpdateCandidateCells();
+			void RegisterCandidates(const RE::TESObjectCELL* a_cell);
+			void SortCandidates(const RE::NiPoint3& a_center);
+			void UpdateCandidatesNearRange(CandidateList& a_list, const RE::NiPoint3& a_center, float a_offset);
+			void RetryPendingCandidates(CandidateList& a_list);
+			[[nodiscard]] bool UpdateCandidate(Candidate& a_candidate, float a_range, const RE::NiPoint3& a_center);
+			bool ShowCandidate(const Candidate& a_candidate);
+			void HideCandidate(const Candidate& a_candidate);
 			void AddVisibleMarker(RE::TESObjectREFR* a_ref, RE::BSFixedString a_markerName = "", bool a_cullWhenHiding = true);
 			void RemoveVisibleMarker(uint32_t a_markerIndex);
 			void CopyEffectShaderMaterial(const std::string& a_filepath, const std::string& a_shapeName, RE::BSEffectShaderMaterial*& a_materialOut);
@@ -83,13 +121,15 @@ namespace DebugMenu
 
 			[[nodiscard]] bool ShowNodeIfNeeded(RE::TESObjectREFR* a_ref);
 
-			bool IsMarkerLoaded(const std::unique_ptr<Marker>& a_marker);
+			bool IsMarkerLoaded(const Marker& a_marker);
+			bool IsCandidate(RE::TESObjectREFR* a_ref);
 			bool ShouldMarkerBeDrawnWhenFar(RE::TESObjectREFR* a_ref);
 			bool ShouldMarkerBeDrawn(RE::TESObjectREFR* a_ref);
 			bool ShouldMarkerBeDrawn(RE::TESObjectREFR* a_ref, bool& a_showWhenFar);
 
 			RE::NiNode* GetNodeFromRef(RE::TESObjectREFR* a_ref);
 			RE::NiNode* TrySet3DByName(RE::TESObjectREFR* a_ref, const char* a_modelName, const RE::BSFixedString a_markerName);
+			bool		TryAttachMarkerModel(RE::NiNode* a_node, const char* a_modelName, const RE::BSFixedString a_markerName, RE::NiAVObject*& a_objectOut);
 			MarkerInfo	GetMarkerInfo(RE::TESObjectREFR* a_ref);
 	};
 }
\ No newline at end of file
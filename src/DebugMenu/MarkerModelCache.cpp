@@ -0,0 +1,150 @@
+#include "MarkerModelCache.h"
+#include "Profiler.h"
+
+namespace DebugMenu
+{
+	MarkerModelCache::MarkerModelCache(uint32_t a_maxModels) :
+		maxModels(std::max(a_maxModels, 1u))
+	{
+		logger::debug("Initialized MarkerModelCache");
+	}
+
+	MarkerModelCache::~MarkerModelCache()
+	{
+		Wait();
+	}
+
+	void MarkerModelCache::Wait()
+	{
+		std::unique_lock<std::mutex> guard(lock);
+		preloadFinished.wait(guard, [&]() { return !isPreloading; });
+	}
+
+	void MarkerModelCache::FinishPreload()
+	{
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			isPreloading = false;
+		}
+		preloadFinished.notify_all();
+	}
+
+	std::string MarkerModelCache::GetKey(const char* a_path)
+	{
+		std::string key = a_path;
+		std::ranges::transform(key, key.begin(), [](unsigned char a_char) { return static_cast<char>(std::tolower(a_char)); });
+		return key;
+	}
+
+	RE::NiPointer<RE::NiNode> MarkerModelCache::Demand(const char* a_path)
+	{
+		PROFILE_SCOPE("MarkerModelCache::Demand");
+
+		RE::NiPointer<RE::NiNode> model;
+		RE::BSModelDB::DBTraits::ArgsType args;
+		RE::BSResource::ErrorCode errorCode = RE::BSModelDB::Demand(a_path, model, args);
+		if (errorCode != RE::BSResource::ErrorCode::kNone) return nullptr;
+		return model;
+	}
+
+	void MarkerModelCache::Insert(const std::string& a_key, RE::NiPointer<RE::NiNode> a_model)
+	{
+		if (prototypes.contains(a_key)) return;
+
+		if (prototypes.size() >= maxModels)
+		{
+			auto leastRecentlyUsed = std::ranges::min_element(prototypes, {}, [](const auto& a_prototype) { return a_prototype.second.lastUsed; });
+			prototypes.erase(leastRecentlyUsed);
+			stats.evicted++;
+		}
+		prototypes[a_key] = Prototype{ std::move(a_model), ++useCount };
+	}
+
+	void MarkerModelCache::InsertPreloaded()
+	{
+		for (auto& preloadedModel : preloadedModels.TakeAll())
+		{
+			if (prototypes.contains(preloadedModel.key)) continue; // demanded here in the meantime
+
+			Insert(preloadedModel.key, std::move(preloadedModel.model));
+			stats.preloaded++;
+		}
+	}
+
+	void MarkerModelCache::Preload(std::vector<std::string> a_paths)
+	{
+		Wait();
+		InsertPreloaded();
+
+		std::erase_if(a_paths, [&](const std::string& a_path) { return prototypes.contains(GetKey(a_path.c_str())); });
+		if (a_paths.empty()) return;
+
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			isPreloading = true;
+		}
+
+		// the preload is finished when the task is destroyed, so it is also finished if the pool discards the task without running it
+		std::shared_ptr<void> finish(nullptr, [this](void*) { FinishPreload(); });
+
+		GetWorkerPool().Submit([this, paths = std::move(a_paths), finish = std::move(finish)]()
+		{
+			auto start = std::chrono::high_resolution_clock::now();
+
+			uint32_t numberOfModels = 0;
+			for (const auto& path : paths)
+			{
+				auto model = Demand(path.c_str());
+				if (!model)
+				{
+					logger::warn("Could not preload marker model {}", path);
+					continue;
+				}
+
+				preloadedModels.Push(PreloadedModel{ GetKey(path.c_str()), std::move(model) });
+				numberOfModels++;
+			}
+
+			auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start);
+			logger::info("Preloaded {} marker models in {} ms", numberOfModels, duration.count());
+		});
+	}
+
+	RE::NiPointer<RE::NiNode> MarkerModelCache::GetPrototype(const char* a_path)
+	{
+		InsertPreloaded();
+
+		std::string key = GetKey(a_path);
+		if (auto prototype = prototypes.find(key); prototype != prototypes.end())
+		{
+			prototype->second.lastUsed = ++useCount;
+			stats.hits++;
+			return prototype->second.model;
+		}
+
+		// not preloaded (yet)
+		auto model = Demand(a_path);
+		stats.misses++;
+		if (model) Insert(key, model);
+		return model;
+	}
+
+	RE::NiNode* MarkerModelCache::Clone(const char* a_path)
+	{
+		auto prototype = GetPrototype(a_path);
+		if (!prototype) return nullptr;
+
+		PROFILE_SCOPE("MarkerModelCache::Clone");
+		auto clone = prototype->Clone();
+		return clone ? clone->AsNode() : nullptr;
+	}
+
+	MarkerModelCache::Stats MarkerModelCache::TakeStats()
+	{
+		InsertPreloaded();
+
+		Stats lastStats = stats;
+		stats = Stats{};
+		return lastStats;
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "WorkerPool.h"
+
+namespace DebugMenu
+{
+	// Marker models kept resident, so showing a marker clones a prototype instead of demanding the model each time.
+	// Preload demands the known marker models on a worker, and they are added to the cache on the main thread the next
+	// time it is used, so no model is released off the main thread. The models the worker did not get to yet are
+	// demanded on the calling thread and kept as well. At most maxModels are kept, the least recently used one is dropped first
+	class MarkerModelCache
+	{
+		public:
+			struct Stats
+			{
+				uint32_t	hits = 0;		// cloned from a resident prototype
+				uint32_t	misses = 0;		// demanded on the calling thread
+				uint32_t	preloaded = 0;
+				uint32_t	evicted = 0;
+			};
+
+			MarkerModelCache(uint32_t a_maxModels = 64);
+			~MarkerModelCache();
+			MarkerModelCache(const MarkerModelCache&) = delete;
+			MarkerModelCache& operator=(const MarkerModelCache&) = delete;
+
+			// demands the models that are not resident on a worker
+			void						Preload(std::vector<std::string> a_paths);
+			// the prototype itself, which must not be changed. Null if the model could not be loaded
+			RE::NiPointer<RE::NiNode>	GetPrototype(const char* a_path);
+			// a clone of the prototype, null if the model could not be loaded
+			RE::NiNode*					Clone(const char* a_path);
+			// Waits for the preload task to finish
+			void						Wait();
+
+			// since the last call
+			Stats						TakeStats();
+
+		private:
+			struct Prototype
+			{
+				RE::NiPointer<RE::NiNode>	model;
+				uint64_t					lastUsed = 0;
+			};
+
+			struct PreloadedModel
+			{
+				std::string					key;
+				RE::NiPointer<RE::NiNode>	model;
+			};
+
+			uint32_t									maxModels;
+			std::unordered_map<std::string, Prototype>	prototypes;	// by lowercase path, only used on the main thread
+			uint64_t									useCount = 0;
+			Stats										stats;
+
+			std::mutex									lock;
+			std::condition_variable						preloadFinished;
+			bool										isPreloading = false;
+			HandoffQueue<PreloadedModel>				preloadedModels; // demanded on the worker, inserted by the main thread
+
+			static std::string					GetKey(const char* a_path);
+			static RE::NiPointer<RE::NiNode>	Demand(const char* a_path);
+
+			void	Insert(const std::string& a_key, RE::NiPointer<RE::NiNode> a_model);
+			void	InsertPreloaded();
+			void	FinishPreload();
+	};
+}
@@ -0,0 +1,187 @@
+#include "NavmeshCacheFile.h"
+
+namespace DebugMenu::NavmeshCacheFile
+{
+	namespace
+	{
+		template <class T>
+		void Append(std::vector<uint8_t>& a_buffer, const T& a_value)
+		{
+			auto bytes = reinterpret_cast<const uint8_t*>(&a_value);
+			a_buffer.insert(a_buffer.end(), bytes, bytes + sizeof(T));
+		}
+
+		// reads from the file, and stops reading (and returns false) when the end of the block is reached
+		struct Reader
+		{
+			const uint8_t*	data;
+			size_t			size;
+			size_t			position = 0;
+
+			template <class T>
+			bool Read(T& a_value)
+			{
+				if (position + sizeof(T) > size) return false;
+				std::memcpy(&a_value, data + position, sizeof(T));
+				position += sizeof(T);
+				return true;
+			}
+
+			bool ReadString(std::string_view& a_string)
+			{
+				uint8_t length = 0;
+				if (!Read(length) || position + length > size) return false;
+				a_string = std::string_view(reinterpret_cast<const char*>(data + position), length);
+				position += length;
+				return true;
+			}
+		};
+	}
+
+	bool ReadCellIndex(std::span<const uint8_t> a_file, uint64_t a_loadOrderHash, std::vector<CellEntry>& a_cellIndex)
+	{
+		a_cellIndex.clear();
+		if (a_file.size() < sizeof(Header)) return false;
+
+		Header header;
+		std::memcpy(&header, a_file.data(), sizeof(Header));
+		if (header.magic != magic || header.version != version || header.loadOrderHash != a_loadOrderHash)
+		{
+			logger::debug("Navmesh disk cache is outdated, it will be rebuilt");
+			return false;
+		}
+
+		if (header.cellIndexOffset > a_file.size() || header.numberOfCells > (a_file.size() - header.cellIndexOffset) / sizeof(CellEntry))
+		{
+			logger::debug("Navmesh disk cache is corrupted, it will be rebuilt");
+			return false;
+		}
+
+		a_cellIndex.resize(header.numberOfCells);
+		std::memcpy(a_cellIndex.data(), a_file.data() + header.cellIndexOffset, header.numberOfCells * sizeof(CellEntry));
+		return true;
+	}
+
+	bool IsInFile(std::span<const uint8_t> a_file, const CellEntry& a_entry)
+	{
+		return a_entry.offset <= a_file.size() && a_entry.size <= a_file.size() - a_entry.offset;
+	}
+
+	bool ReadCell(std::span<const uint8_t> a_file, const CellEntry& a_entry, std::vector<Navmesh>& a_navmeshes)
+	{
+		a_navmeshes.clear();
+		if (!IsInFile(a_file, a_entry)) return false;
+
+		auto fail = [&]()
+		{
+			a_navmeshes.clear();
+			return false;
+		};
+
+		Reader reader{ a_file.data() + a_entry.offset, static_cast<size_t>(a_entry.size) };
+		for (uint32_t i = 0; i < a_entry.numberOfNavmeshes; i++)
+		{
+			NavmeshEntry navmeshEntry;
+			if (!reader.Read(navmeshEntry)) return fail();
+
+			uint64_t geometrySize = navmeshEntry.numberOfVertices * uint64_t{ packedVertexSize } + navmeshEntry.numberOfTriangles * uint64_t{ packedTriangleSize };
+			if (geometrySize > reader.size - reader.position) return fail();
+
+			auto& navmesh = a_navmeshes.emplace_back();
+			navmesh.formID = navmeshEntry.formID;
+			navmesh.origin = RE::NiPoint3(navmeshEntry.origin[0], navmeshEntry.origin[1], navmeshEntry.origin[2]);
+			navmesh.step = RE::NiPoint3(navmeshEntry.step[0], navmeshEntry.step[1], navmeshEntry.step[2]);
+
+			navmesh.vertices.resize(navmeshEntry.numberOfVertices);
+			for (auto& vertex : navmesh.vertices)
+			{
+				reader.Read(vertex.x);
+				reader.Read(vertex.y);
+				reader.Read(vertex.z);
+			}
+
+			navmesh.triangles.resize(navmeshEntry.numberOfTriangles);
+			for (auto& triangle : navmesh.triangles)
+			{
+				reader.Read(triangle.vertices);
+				reader.Read(triangle.triangleFlags);
+				reader.Read(triangle.traversalFlags);
+				reader.Read(triangle.edgeLinks);
+
+				for (uint16_t vertex : triangle.vertices)
+				{
+					if (vertex >= navmeshEntry.numberOfVertices) return fail();
+				}
+			}
+
+			if (navmeshEntry.numberOfSourceFiles > reader.size - reader.position) return fail(); // every name takes at least its length
+
+			navmesh.sourceFiles.resize(navmeshEntry.numberOfSourceFiles);
+			for (auto& fileName : navmesh.sourceFiles)
+			{
+				if (!reader.ReadString(fileName)) return fail();
+			}
+		}
+		return true;
+	}
+
+	void ReserveHeader(std::vector<uint8_t>& a_buffer)
+	{
+		a_buffer.resize(a_buffer.size() + sizeof(Header));
+	}
+
+	void WriteNavmesh(std::vector<uint8_t>& a_buffer, RE::FormID a_formID, const RE::NiPoint3& a_origin, const RE::NiPoint3& a_step,
+		std::span<const PackedVertex> a_vertices, std::span<const PackedTriangle> a_triangles, std::span<const std::string_view> a_sourceFiles)
+	{
+		NavmeshEntry navmeshEntry{};
+		navmeshEntry.formID = a_formID;
+		navmeshEntry.numberOfVertices = static_cast<uint32_t>(a_vertices.size());
+		navmeshEntry.numberOfTriangles = static_cast<uint32_t>(a_triangles.size());
+		navmeshEntry.numberOfSourceFiles = static_cast<uint32_t>(a_sourceFiles.size());
+		navmeshEntry.origin[0] = a_origin.x;
+		navmeshEntry.origin[1] = a_origin.y;
+		navmeshEntry.origin[2] = a_origin.z;
+		navmeshEntry.step[0] = a_step.x;
+		navmeshEntry.step[1] = a_step.y;
+		navmeshEntry.step[2] = a_step.z;
+		Append(a_buffer, navmeshEntry);
+
+		for (const auto& vertex : a_vertices)
+		{
+			Append(a_buffer, vertex.x);
+			Append(a_buffer, vertex.y);
+			Append(a_buffer, vertex.z);
+		}
+
+		for (const auto& triangle : a_triangles)
+		{
+			Append(a_buffer, triangle.vertices);
+			Append(a_buffer, triangle.triangleFlags);
+			Append(a_buffer, triangle.traversalFlags);
+			Append(a_buffer, triangle.edgeLinks);
+		}
+
+		for (const auto& fileName : a_sourceFiles)
+		{
+			uint8_t length = static_cast<uint8_t>(std::min<size_t>(fileName.size(), 0xFF));
+			Append(a_buffer, length);
+			a_buffer.insert(a_buffer.end(), fileName.begin(), fileName.begin() + length);
+		}
+	}
+
+	void WriteCellIndex(std::vector<uint8_t>& a_buffer, uint64_t a_loadOrderHash, std::span<const CellEntry> a_cellIndex)
+	{
+		Header header{};
+		header.magic = magic;
+		header.version = version;
+		header.loadOrderHash = a_loadOrderHash;
+		header.numberOfCells = static_cast<uint32_t>(a_cellIndex.size());
+		header.cellIndexOffset = a_buffer.size();
+		std::memcpy(a_buffer.data(), &header, sizeof(Header));
+
+		for (const auto& entry : a_cellIndex)
+		{
+			Append(a_buffer, entry);
+		}
+	}
+}
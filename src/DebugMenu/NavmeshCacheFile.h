@@ -0,0 +1,98 @@
+#pragma once
+
+namespace DebugMenu
+{
+	enum class EdgeLinkPosition
+	{
+		kAbove = 0,
+		kCenter,
+		kBelow
+	};
+
+	// vertex position quantized to 16 bits per axis within the bounds of its navmesh
+	struct PackedVertex
+	{
+		uint16_t x;
+		uint16_t y;
+		uint16_t z;
+	};
+
+	// BSNavmeshTriangle without the edge info indices. The only thing needed from the extra edge info is
+	// where the edge link is drawn, which is stored as 2 bits per edge (EdgeLinkPosition + 1, 0 = no link)
+	struct PackedTriangle
+	{
+		uint16_t vertices[3];
+		uint16_t triangleFlags;
+		uint16_t traversalFlags;
+		uint8_t	 edgeLinks;
+
+		bool				HasEdgeLink(uint8_t a_edge) const { return (edgeLinks >> (2 * a_edge)) & 0b11; }
+		EdgeLinkPosition	GetEdgeLinkPosition(uint8_t a_edge) const { return static_cast<EdgeLinkPosition>(((edgeLinks >> (2 * a_edge)) & 0b11) - 1); }
+	};
+
+	// Layout of the navmesh disk cache file, and the encoding of the cells in it. The file is written and read by the NavmeshDiskCache,
+	// apart from the NiPoint types this does not depend on the game, so it can be tested on its own
+	namespace NavmeshCacheFile
+	{
+		constexpr uint32_t magic = 0x434E4D44; // "DMNC"
+		constexpr uint32_t version = 1;
+
+		struct Header
+		{
+			uint32_t	magic;
+			uint32_t	version;
+			uint64_t	loadOrderHash;
+			uint32_t	numberOfCells;
+			uint32_t	pad = 0;
+			uint64_t	cellIndexOffset;
+		};
+
+		// the cell index is sorted by cell id, so a cell can be found without reading the other cells
+		struct CellEntry
+		{
+			RE::FormID	cellID;
+			uint32_t	numberOfNavmeshes;
+			uint64_t	offset;
+			uint64_t	size;
+		};
+
+		// followed by the vertices, the triangles and the source files (length prefixed names) of the navmesh
+		struct NavmeshEntry
+		{
+			RE::FormID	formID;
+			uint32_t	numberOfVertices;
+			uint32_t	numberOfTriangles;
+			uint32_t	numberOfSourceFiles;
+			float		origin[3];
+			float		step[3];
+		};
+
+		constexpr size_t packedVertexSize = 3 * sizeof(uint16_t);
+		constexpr size_t packedTriangleSize = 3 * sizeof(uint16_t) + 2 * sizeof(uint16_t) + sizeof(uint8_t);
+
+		// a navmesh read from a cell. The source file names point into the file
+		struct Navmesh
+		{
+			RE::FormID						formID = 0x0;
+			RE::NiPoint3					origin{ 0.0f, 0.0f, 0.0f };
+			RE::NiPoint3					step{ 0.0f, 0.0f, 0.0f };
+			std::vector<PackedVertex>		vertices;
+			std::vector<PackedTriangle>		triangles;
+			std::vector<std::string_view>	sourceFiles;
+		};
+
+		// Reads the index of the file. False if the file is not for this version and load order, or the index is not within the file
+		bool ReadCellIndex(std::span<const uint8_t> a_file, uint64_t a_loadOrderHash, std::vector<CellEntry>& a_cellIndex);
+		bool IsInFile(std::span<const uint8_t> a_file, const CellEntry& a_entry);
+
+		// Decodes the navmeshes of a cell. False if the cell is truncated or a triangle uses a vertex its navmesh doesn't have,
+		// in which case a_navmeshes is left empty, so a corrupted entry doesn't leave a half read cell behind
+		bool ReadCell(std::span<const uint8_t> a_file, const CellEntry& a_entry, std::vector<Navmesh>& a_navmeshes);
+
+		// The header is written over the space reserved at the start of a_buffer, once the cells and their index are known
+		void ReserveHeader(std::vector<uint8_t>& a_buffer);
+		void WriteNavmesh(std::vector<uint8_t>& a_buffer, RE::FormID a_formID, const RE::NiPoint3& a_origin, const RE::NiPoint3& a_step,
+			std::span<const PackedVertex> a_vertices, std::span<const PackedTriangle> a_triangles, std::span<const std::string_view> a_sourceFiles);
+		void WriteCellIndex(std::vector<uint8_t>& a_buffer, uint64_t a_loadOrderHash, std::span<const CellEntry> a_cellIndex);
+	}
+}
@@ -0,0 +1,259 @@
+#include "NavmeshDiskCache.h"
+
+namespace DebugMenu
+{
+	NavmeshDiskCache::NavmeshDiskCache(std::filesystem::path a_path) : path(a_path)
+	{
+	}
+
+	NavmeshDiskCache::~NavmeshDiskCache()
+	{
+		Close();
+	}
+
+	// FNV-1a of the names of the active plugins, in load order
+	uint64_t NavmeshDiskCache::GetLoadOrderHash()
+	{
+		uint64_t hash = 0xcbf29ce484222325;
+		auto hashByte = [&](uint8_t a_byte)
+		{
+			hash ^= a_byte;
+			hash *= 0x100000001b3;
+		};
+
+		auto dataHandler = RE::TESDataHandler::GetSingleton();
+		if (!dataHandler) return 0;
+
+		for (const auto file : dataHandler->files)
+		{
+			if (!file || file->compileIndex == 0xFF) continue; // not active
+
+			for (char c : file->GetFilename())
+			{
+				hashByte(static_cast<uint8_t>(std::tolower(static_cast<unsigned char>(c))));
+			}
+			hashByte(0); // separator
+		}
+		return hash;
+	}
+
+	bool NavmeshDiskCache::Open(uint64_t a_loadOrderHash)
+	{
+		Close();
+
+		file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) return false;
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < static_cast<LONGLONG>(sizeof(NavmeshCacheFile::Header)))
+		{
+			Close();
+			return false;
+		}
+
+		mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!mapping)
+		{
+			Close();
+			return false;
+		}
+
+		view = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+		viewSize = static_cast<size_t>(fileSize.QuadPart);
+		if (!view)
+		{
+			Close();
+			return false;
+		}
+
+		// only the index is read here, the cells are read when they are needed
+		if (!NavmeshCacheFile::ReadCellIndex(GetView(), a_loadOrderHash, cellIndex))
+		{
+			Close();
+			return false;
+		}
+
+		return true;
+	}
+
+	void NavmeshDiskCache::Close()
+	{
+		if (view) UnmapViewOfFile(view);
+		if (mapping) CloseHandle(mapping);
+		if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+
+		view = nullptr;
+		viewSize = 0;
+		mapping = nullptr;
+		file = INVALID_HANDLE_VALUE;
+		cellIndex.clear();
+	}
+
+	const NavmeshDiskCache::CellEntry* NavmeshDiskCache::FindCell(RE::FormID a_cellID) const
+	{
+		auto entry = std::lower_bound(cellIndex.begin(), cellIndex.end(), a_cellID, [](const CellEntry& a_entry, RE::FormID a_id) { return a_entry.cellID < a_id; });
+		if (entry == cellIndex.end() || entry->cellID != a_cellID) return nullptr;
+		return &*entry;
+	}
+
+	bool NavmeshDiskCache::HasCell(RE::FormID a_cellID) const
+	{
+		return IsOpen() && FindCell(a_cellID);
+	}
+
+	// The cell is decoded on its own, and only added to the handler when all of it could be read,
+	// so a corrupted entry doesn't leave a half read cell behind
+	bool NavmeshDiskCache::ReadCell(RE::FormID a_cellID, NavmeshHandler& a_handler) const
+	{
+		if (!IsOpen()) return false;
+
+		const CellEntry* entry = FindCell(a_cellID);
+		if (!entry) return false;
+
+		auto dataHandler = RE::TESDataHandler::GetSingleton();
+		if (!dataHandler) return false;
+
+		std::vector<NavmeshCacheFile::Navmesh> navmeshes;
+		if (!NavmeshCacheFile::ReadCell(GetView(), *entry, navmeshes)) return false;
+
+		NavmeshHandler::CachedCell& cell = a_handler.cachedNavmeshes[a_cellID];
+		auto isCached = [&](RE::FormID a_formID)
+		{
+			return std::any_of(cell.navmeshes.begin(), cell.navmeshes.end(), [&](const NavmeshHandler::NavmeshInfo& a_navmesh) { return a_navmesh.formID == a_formID; });
+		};
+
+		for (auto& navmesh : navmeshes)
+		{
+			// the names are resolved to the loaded files, so the string views outlive the mapped file
+			for (const auto fileName : navmesh.sourceFiles)
+			{
+				if (auto sourceFile = dataHandler->LookupModByName(fileName))
+				{
+					a_handler.AddNavmeshSourceFile(navmesh.formID, sourceFile->GetFilename());
+				}
+			}
+
+			if (isCached(navmesh.formID)) continue; // what is in memory is newer than what is on disk
+
+			auto& info = cell.navmeshes.emplace_back();
+			info.formID = navmesh.formID;
+			info.origin = navmesh.origin;
+			info.step = navmesh.step;
+			info.vertices = std::move(navmesh.vertices);
+			info.triangles = std::move(navmesh.triangles);
+		}
+		a_handler.UpdateCachedCellSize(cell);
+
+		return true;
+	}
+
+	void NavmeshDiskCache::WriteCell(std::vector<uint8_t>& a_buffer, const NavmeshHandler::CachedCell& a_cell, const NavmeshHandler& a_handler)
+	{
+		for (const auto& navmesh : a_cell.navmeshes)
+		{
+			std::span<const std::string_view> sourceFiles;
+			if (auto it = a_handler.sourceFilesOrdered.find(navmesh.formID); it != a_handler.sourceFilesOrdered.end())
+			{
+				sourceFiles = it->second;
+			}
+			NavmeshCacheFile::WriteNavmesh(a_buffer, navmesh.formID, navmesh.origin, navmesh.step, navmesh.vertices, navmesh.triangles, sourceFiles);
+		}
+	}
+
+	// Serializes the cells in memory, and copies the cells that are only on disk (eg. evicted or not visited this session)
+	std::vector<uint8_t> NavmeshDiskCache::Serialize(uint64_t a_loadOrderHash, const NavmeshHandler& a_handler) const
+	{
+		std::vector<RE::FormID> cellIDs;
+		cellIDs.reserve(a_handler.cachedNavmeshes.size() + cellIndex.size());
+		for (const auto& [cellID, cachedCell] : a_handler.cachedNavmeshes)
+		{
+			if (!cachedCell.navmeshes.empty()) cellIDs.push_back(cellID);
+		}
+		for (const auto& entry : cellIndex)
+		{
+			if (!a_handler.cachedNavmeshes.contains(entry.cellID)) cellIDs.push_back(entry.cellID);
+		}
+		std::sort(cellIDs.begin(), cellIDs.end());
+
+		std::vector<uint8_t> buffer;
+		std::vector<CellEntry> newCellIndex;
+		newCellIndex.reserve(cellIDs.size());
+
+		NavmeshCacheFile::ReserveHeader(buffer);
+
+		for (RE::FormID cellID : cellIDs)
+		{
+			CellEntry newEntry{};
+			newEntry.cellID = cellID;
+			newEntry.offset = buffer.size();
+
+			auto cachedCell = a_handler.cachedNavmeshes.find(cellID);
+			if (cachedCell != a_handler.cachedNavmeshes.end())
+			{
+				newEntry.numberOfNavmeshes = static_cast<uint32_t>(cachedCell->second.navmeshes.size());
+				WriteCell(buffer, cachedCell->second, a_handler);
+			}
+			else
+			{
+				const CellEntry* entry = FindCell(cellID);
+				if (!entry || !NavmeshCacheFile::IsInFile(GetView(), *entry)) continue;
+
+				newEntry.numberOfNavmeshes = entry->numberOfNavmeshes;
+				buffer.insert(buffer.end(), view + entry->offset, view + entry->offset + entry->size);
+			}
+
+			newEntry.size = buffer.size() - newEntry.offset;
+			newCellIndex.push_back(newEntry);
+		}
+
+		NavmeshCacheFile::WriteCellIndex(buffer, a_loadOrderHash, newCellIndex);
+
+		return buffer;
+	}
+
+	// does not touch the cache, so it can run on a worker while the old file is still mapped
+	bool NavmeshDiskCache::WriteFile(const std::filesystem::path& a_path, const std::vector<uint8_t>& a_buffer)
+	{
+		std::error_code error;
+		std::filesystem::create_directories(a_path.parent_path(), error);
+
+		std::ofstream stream(a_path, std::ios::binary | std::ios::trunc);
+		if (!stream)
+		{
+			logger::debug("Failed to write navmesh disk cache");
+			return false;
+		}
+		stream.write(reinterpret_cast<const char*>(a_buffer.data()), a_buffer.size());
+		stream.close(); // so a failed flush is noticed before the file replaces the old one
+		if (!stream)
+		{
+			logger::debug("Failed to write navmesh disk cache");
+			return false;
+		}
+		return true;
+	}
+
+	std::filesystem::path NavmeshDiskCache::GetTempPath() const
+	{
+		auto tempPath = path;
+		tempPath += L".tmp";
+		return tempPath;
+	}
+
+	// the old file is mapped, so it is closed before the written file is moved over it
+	bool NavmeshDiskCache::Replace(uint64_t a_loadOrderHash)
+	{
+		Close();
+		if (!MoveFileExW(GetTempPath().c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING))
+		{
+			logger::debug("Failed to replace navmesh disk cache");
+			Open(a_loadOrderHash);
+			return false;
+		}
+
+		if (!Open(a_loadOrderHash)) return false;
+
+		logger::debug("Wrote navmesh disk cache: {} cells, {:.3f} MB", GetNumberOfCells(), viewSize / 1000000.f);
+		return true;
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "NavmeshCacheFile.h"
+#include "NavmeshHandler.h"
+
+namespace DebugMenu
+{
+	// Binary file holding the navmeshes (and their source files) cached by the NavmeshHandler, so navmeshes that only exist
+	// in memory while being loaded are shown after a restart. The file is memory mapped, and a cell is only read when it is needed.
+	// The file is keyed by a hash of the load order, and is ignored when the load order or the version changes
+	class NavmeshDiskCache
+	{
+		public:
+			NavmeshDiskCache(std::filesystem::path a_path);
+			~NavmeshDiskCache();
+
+			bool		Open(uint64_t a_loadOrderHash); // false if there is no valid file for the load order
+			void		Close();
+			bool		IsOpen() const { return view != nullptr; }
+			bool		HasCell(RE::FormID a_cellID) const;
+			bool		ReadCell(RE::FormID a_cellID, NavmeshHandler& a_handler) const; // adds the navmeshes of the cell that are not cached yet
+			uint32_t	GetNumberOfCells() const { return static_cast<uint32_t>(cellIndex.size()); }
+
+			// Writing is split so the file can be written on a worker: the file is serialized and the old one replaced on the main thread
+			std::vector<uint8_t>	Serialize(uint64_t a_loadOrderHash, const NavmeshHandler& a_handler) const;
+			std::filesystem::path	GetTempPath() const; // where the serialized file is written before it replaces the old one
+			bool					Replace(uint64_t a_loadOrderHash);
+
+			static bool		WriteFile(const std::filesystem::path& a_path, const std::vector<uint8_t>& a_buffer);
+			static uint64_t GetLoadOrderHash();
+
+		private:
+			using CellEntry = NavmeshCacheFile::CellEntry;
+
+			std::filesystem::path	path;
+			HANDLE					file = INVALID_HANDLE_VALUE;
+			HANDLE					mapping = nullptr;
+			const uint8_t*			view = nullptr;
+			size_t					viewSize = 0;
+			std::vector<CellEntry>	cellIndex;
+
+			const CellEntry*			FindCell(RE::FormID a_cellID) const;
+			std::span<const uint8_t>	GetView() const { return { view, viewSize }; }
+			static void					WriteCell(std::vector<uint8_t>& a_buffer, const NavmeshHandler::CachedCell& a_cell, const NavmeshHandler& a_handler);
+	};
+}
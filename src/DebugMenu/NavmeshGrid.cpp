@@ -0,0 +1,60 @@
+#include "NavmeshGrid.h"
+
+namespace DebugMenu
+{
+	uint32_t NavmeshGrid::GetCellX(float a_x) const
+	{
+		float cell = std::floor((a_x - minX) / cellSize);
+		return static_cast<uint32_t>(std::clamp(cell, 0.0f, static_cast<float>(width - 1)));
+	}
+
+	uint32_t NavmeshGrid::GetCellY(float a_y) const
+	{
+		float cell = std::floor((a_y - minY) / cellSize);
+		return static_cast<uint32_t>(std::clamp(cell, 0.0f, static_cast<float>(height - 1)));
+	}
+
+	std::vector<uint32_t> NavmeshGrid::Build(std::span<const RE::NiPoint2> a_corners, float a_minCellSize, uint32_t a_maxWidth)
+	{
+		*this = NavmeshGrid();
+		if (a_corners.empty()) return {};
+
+		minX = minY = std::numeric_limits<float>::max();
+		maxX = maxY = std::numeric_limits<float>::lowest();
+		for (const auto& corner : a_corners)
+		{
+			minX = std::min(minX, corner.x);
+			minY = std::min(minY, corner.y);
+			maxX = std::max(maxX, corner.x);
+			maxY = std::max(maxY, corner.y);
+		}
+
+		float extent = std::max(maxX - minX, maxY - minY);
+		cellSize = std::max(a_minCellSize, extent / a_maxWidth);
+		width = static_cast<uint32_t>((maxX - minX) / cellSize) + 1;
+		height = static_cast<uint32_t>((maxY - minY) / cellSize) + 1;
+
+		std::vector<uint32_t> itemCells;
+		itemCells.reserve(a_corners.size());
+		cellStarts.assign(width * height + 1, 0);
+		for (const auto& corner : a_corners)
+		{
+			uint32_t gridCell = GetCellY(corner.y) * width + GetCellX(corner.x);
+			itemCells.push_back(gridCell);
+			cellStarts[gridCell + 1]++;
+		}
+
+		for (uint32_t i = 1; i < cellStarts.size(); i++)
+		{
+			cellStarts[i] += cellStarts[i - 1];
+		}
+
+		std::vector<uint32_t> nextIndex(cellStarts.begin(), cellStarts.end() - 1);
+		std::vector<uint32_t> order(a_corners.size());
+		for (uint32_t i = 0; i < a_corners.size(); i++)
+		{
+			order[nextIndex[itemCells[i]]++] = i;
+		}
+		return order;
+	}
+}
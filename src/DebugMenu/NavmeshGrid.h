@@ -0,0 +1,49 @@
+#pragma once
+
+namespace DebugMenu
+{
+	// Uniform grid over the draw list triangles of a navmesh. Each triangle is put in the grid cell containing the lower corner of its bounds,
+	// and since a triangle is only drawn if all of its vertices are in range, that corner has to be within the range square as well.
+	// Apart from the NiPoint types it does not depend on the game, so it can be tested on its own
+	struct NavmeshGrid
+	{
+		float					minX = 0.0f;
+		float					minY = 0.0f;
+		float					maxX = 0.0f;
+		float					maxY = 0.0f;
+		float					cellSize = 0.0f;
+		uint32_t				width = 0;
+		uint32_t				height = 0;
+		std::vector<uint32_t>	cellStarts; // items of grid cell i are items[cellStarts[i]] to items[cellStarts[i + 1]] once sorted
+
+		uint32_t GetCellX(float a_x) const;
+		uint32_t GetCellY(float a_y) const;
+
+		// Builds the grid over items with the given lower corners, and returns the order to sort them in (counting sort), so each grid
+		// cell is a continuous range of items: sorted[i] = items[order[i]]. Large areas get bigger grid cells rather than more of them
+		std::vector<uint32_t> Build(std::span<const RE::NiPoint2> a_corners, float a_minCellSize, uint32_t a_maxWidth);
+
+		// Calls a_func(begin, end) with the range of sorted items of every grid cell overlapping the square around a_origin
+		template <class Func>
+		void ForEachInRange(const RE::NiPoint2& a_origin, float a_range, Func&& a_func) const
+		{
+			if (width == 0 ||
+				a_origin.x + a_range < minX || a_origin.x - a_range > maxX ||
+				a_origin.y + a_range < minY || a_origin.y - a_range > maxY) return;
+
+			uint32_t startX = GetCellX(a_origin.x - a_range);
+			uint32_t endX	= GetCellX(a_origin.x + a_range);
+			uint32_t startY = GetCellY(a_origin.y - a_range);
+			uint32_t endY	= GetCellY(a_origin.y + a_range);
+
+			for (uint32_t y = startY; y <= endY; y++)
+			{
+				for (uint32_t x = startX; x <= endX; x++)
+				{
+					uint32_t gridCell = y * width + x;
+					if (cellStarts[gridCell] != cellStarts[gridCell + 1]) a_func(cellStarts[gridCell], cellStarts[gridCell + 1]);
+				}
+			}
+		}
+	};
+}
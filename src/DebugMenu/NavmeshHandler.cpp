@@ -1,6 +1,9 @@
 #include "NavmeshHandler.h"
+#include "NavmeshDiskCache.h"
 #include "DebugMenu.h"
 
+//#define NAVMESH_PROFILING
+
 
 namespace DebugMenu
 {
@@ -9,6 +12,96 @@ namespace DebugMenu
 		logger::debug("Initialized NavmeshHandler");
 	}
 
+	NavmeshHandler::~NavmeshHandler() = default;
+
+	void NavmeshHandler::InitPostDataLoaded()
+	{
+		if (!MCM::settings::useNavmeshDiskCache) return;
+
+		diskCache = std::make_unique<NavmeshDiskCache>(L"Data/SKSE/plugins/DebugMenu/NavmeshCache.bin");
+		loadOrderHash = NavmeshDiskCache::GetLoadOrderHash();
+
+		auto start = std::chrono::high_resolution_clock::now();
+
+		if (!diskCache->Open(loadOrderHash))
+		{
+			logger::debug("No navmesh disk cache for the current load order");
+			return;
+		}
+
+		// navmeshes cached while the game data was loading are newer, so only the missing ones are read from disk
+		std::vector<RE::FormID> cellIDs;
+		for (const auto& [cellID, cachedCell] : cachedNavmeshes)
+		{
+			cellIDs.push_back(cellID);
+		}
+		for (RE::FormID cellID : cellIDs)
+		{
+			PageInCell(cellID);
+		}
+
+		auto stop = std::chrono::high_resolution_clock::now();
+		logger::debug("Opened navmesh disk cache with {} cells in {} us", diskCache->GetNumberOfCells(), std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count());
+	}
+
+	// Called when the game is saved. Only the serialization runs here, writing the file is left to a worker
+	void NavmeshHandler::SaveDiskCache()
+	{
+		FinishDiskCacheWrite();
+		if (!diskCache || !isDiskCacheDirty || isDiskCacheWriting) return;
+
+		auto start = std::chrono::high_resolution_clock::now();
+
+		auto buffer = diskCache->Serialize(loadOrderHash, *this);
+		for (auto& [cellID, cachedCell] : cachedNavmeshes)
+		{
+			cachedCell.isBeingWritten = !cachedCell.navmeshes.empty();
+		}
+		isDiskCacheDirty = false;
+		isDiskCacheWriting = true;
+
+		GetWorkerPool().Submit([this, tempPath = diskCache->GetTempPath(), buffer = std::move(buffer)]()
+		{
+			diskCacheWrites.Push(NavmeshDiskCache::WriteFile(tempPath, buffer));
+		});
+
+		auto stop = std::chrono::high_resolution_clock::now();
+		logger::debug("Serializing navmesh disk cache took {} ms", std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count());
+	}
+
+	// the written file replaces the mapped one here, so it is never replaced while a cell is read
+	void NavmeshHandler::FinishDiskCacheWrite()
+	{
+		if (!isDiskCacheWriting) return;
+
+		auto writes = diskCacheWrites.TakeAll();
+		if (writes.empty()) return;
+
+		isDiskCacheWriting = false;
+		bool isWritten = writes.back() && diskCache->Replace(loadOrderHash);
+		if (!isWritten) isDiskCacheDirty = true;
+
+		for (auto& [cellID, cachedCell] : cachedNavmeshes)
+		{
+			if (cachedCell.isBeingWritten && isWritten) cachedCell.isOnDisk = true;
+			cachedCell.isBeingWritten = false;
+		}
+	}
+
+	void NavmeshHandler::PageInCell(RE::FormID a_cellID)
+	{
+		if (!diskCache || !diskCache->HasCell(a_cellID)) return;
+
+		bool wasCached = cachedNavmeshes.contains(a_cellID);
+		if (diskCache->ReadCell(a_cellID, *this))
+		{
+			CachedCell& cachedCell = cachedNavmeshes[a_cellID];
+			cachedCell.isOnDisk = !wasCached; // navmeshes already in memory are newer than the ones on disk
+			cachedCell.lastDrawn = drawCount;
+			UpdateCachedCellCenter(cachedCell);
+		}
+	}
+
 	float NavmeshHandler::GetRange()
 	{
 		return MCM::settings::navmeshRange;
@@ -25,17 +118,33 @@ namespace DebugMenu
 
 	void NavmeshHandler::Draw()
 	{
+		PROFILE_SCOPE("NavmeshHandler::Draw");
+
 		if (!MCM::settings::showNavmesh) return;
+
+		DrawHandler::ScopedBackend backend(GetDrawHandler().get(), MCM::settings::navmeshBackend);
 		
 		RE::NiPoint3 origin = GetCenter();
 		float range = GetRange();
 
+		float rangeSquared = range * range;
+
+		DrawListSettings settings = DrawListSettings::GetCurrent();
+
+		trianglesTested = 0;
+		trianglesInRange = 0;
+
 		Utils::ForEachCellInRange(origin, range, [&](const RE::TESObjectCELL* a_cell)
 		{
 			RE::FormID cellID = a_cell->GetFormID();
 
 			if (isCellsCacheFinalized[cellID] == false)
 			{
+				if (!cachedNavmeshes.contains(cellID))
+				{
+					PageInCell(cellID);
+				}
+
 				if (a_cell->GetRuntimeData().navMeshes);
 				{
 					CacheCellNavmeshes(a_cell);
@@ -43,143 +152,317 @@ namespace DebugMenu
 				isCellsCacheFinalized[cellID] = true;
 			}
 
-			if (!cachedNavmeshes.contains(cellID))
+			auto cachedCell = cachedNavmeshes.find(cellID);
+			if (cachedCell == cachedNavmeshes.end())
 			{
+				cacheMisses++;
 				return;
 			}
+			cacheHits++;
+			cachedCell->second.lastDrawn = drawCount;
 
-			for (auto& navmesh : cachedNavmeshes[cellID])
+			for (auto& navmesh : cachedCell->second.navmeshes)
 			{
-				DrawHandler::ShapeMetaData metaData;
-				metaData.formID = navmesh.formID;
-				metaData.cell = a_cell;
-				metaData.infoType = InfoType::kNavmesh;
-
-				auto& vertices = navmesh.vertices;
-				auto& triangles = navmesh.triangles;
-
-
-				for (const auto vertex : vertices)
+				NavmeshDrawList& drawList = navmesh.drawList;
+				if (!drawList.isBuilt || drawList.settings != settings)
 				{
-					break;
-					// dont draw vertices
-					/*auto dx = origin.x - vertex.location.x;
-					auto dy = origin.y - vertex.location.y;
-					if (dx * dx + dy * dy < range * range)
-						GetDrawHandler()->DrawPoint(vertex.location, 4, 0xFFFFFF, 90);*/
+					BuildDrawList(navmesh, a_cell, settings);
+					UpdateCachedCellSize(cachedCell->second);
+					drawListRebuilds++;
 				}
-
-				for (int i = 0; i < triangles.size(); i++)
+				else
 				{
-					const auto& triangle = triangles[i];
-					uint16_t triangleFlag = triangle.triangleFlags.underlying();
-
+					drawListReuses++;
+				}
 
-					if (MCM::settings::navmeshModeIndex == MCM::settings::NavmeshMode::creationKit && !(triangleFlag & inFileFlag))
+				drawList.grid.ForEachInRange(RE::NiPoint2(origin.x, origin.y), range, [&](uint32_t a_begin, uint32_t a_end)
+				{
+					for (uint32_t t = a_begin; t < a_end; t++)
 					{
-						if (i + 2 < triangles.size())
+						const auto& triangle = drawList.triangles[t];
+						trianglesTested++;
+
+						bool skip = false;
+						for (const auto& vertex : triangle.vertices)
 						{
-							bool isNextTriangleInFile = triangles[i + 1].triangleFlags.underlying() & inFileFlag;
-							bool isNextNextTriangleInFile = triangles[i + 2].triangleFlags.underlying() & inFileFlag;
-							if (!isNextTriangleInFile && !isNextNextTriangleInFile)
+							auto dx = origin.x - vertex.x;
+							auto dy = origin.y - vertex.y;
+							if (dx * dx + dy * dy > rangeSquared)
 							{
-								break; // sometimes (very rarely) a triangle in the middle of the array has no inFileFlag, so if the next two triangles are in file, don't break
+								skip = true;
+								break;
 							}
 						}
-					}
-
-					if (MCM::settings::navmeshModeIndex == MCM::settings::NavmeshMode::runtime && triangle.triangleFlags.all(RE::BSNavmeshTriangle::TriangleFlag::kOverlapping))
-					{
-						continue;
-					}
+						if (skip) continue;
+						trianglesInRange++;
 
-					bool skip = false;
-					for (const auto i : triangle.vertices)
-					{
-						auto dx = origin.x - vertices[i].location.x;
-						auto dy = origin.y - vertices[i].location.y;
-						if (sqrtf(dx * dx + dy * dy) > range)
+						for (uint32_t i = triangle.firstShape; i < triangle.firstShape + triangle.numberOfShapes; i++)
 						{
-							skip = true;
-							break;
+							DrawShape(drawList.shapes[i]);
 						}
 					}
-					if (skip) continue;
-					if (triangle.triangleFlags.any(RE::BSNavmeshTriangle::TriangleFlag::kDeleted))
+				});
+			}
+		});
+
+		EvictIfOverBudget();
+		drawCount++;
+
+		PROFILE_VALUE("Navmesh cache KB", cacheSizeInBytes / 1000);
+		PROFILE_VALUE("Navmesh cache budget KB", static_cast<size_t>(MCM::settings::navmeshCacheBudget) * 1000);
+		PROFILE_VALUE("Navmesh cache hits", cacheHits);
+		PROFILE_VALUE("Navmesh cache misses", cacheMisses);
+		PROFILE_VALUE("Navmesh cache evictions", cacheEvictions);
+
+		#ifdef NAVMESH_PROFILING
+			PrintDrawListStats();
+			PrintCacheStats();
+		#endif
+	}
+
+	NavmeshHandler::DrawListSettings NavmeshHandler::DrawListSettings::GetCurrent()
+	{
+		DrawListSettings settings;
+		settings.navmeshModeIndex			= MCM::settings::navmeshModeIndex;
+		settings.showNavmeshTriangles		= MCM::settings::showNavmeshTriangles;
+		settings.showNavmeshCover			= MCM::settings::showNavmeshCover;
+		settings.showCoverBeams				= MCM::settings::showCoverBeams;
+		settings.showNavmeshCoverLines		= MCM::settings::showNavmeshCoverLines;
+		settings.showNavmeshCoverInfo		= MCM::settings::showNavmeshCoverInfo;
+		settings.linesHeight				= MCM::settings::linesHeight;
+		settings.navmeshColor				= MCM::settings::navmeshColor;
+		settings.navmeshDoorColor			= MCM::settings::navmeshDoorColor;
+		settings.navmeshWaterColor			= MCM::settings::navmeshWaterColor;
+		settings.navmeshPrefferedColor		= MCM::settings::navmeshPrefferedColor;
+		settings.navmeshCellEdgeLinkColor	= MCM::settings::navmeshCellEdgeLinkColor;
+		settings.navmeshLedgeEdgeLinkColor	= MCM::settings::navmeshLedgeEdgeLinkColor;
+		settings.navmeshCoverColor			= MCM::settings::navmeshCoverColor;
+		settings.navmeshCoverBorderColor	= MCM::settings::navmeshCoverBorderColor;
+		settings.navmeshMaxCoverColor		= MCM::settings::navmeshMaxCoverColor;
+		settings.navmeshMaxCoverBorderColor	= MCM::settings::navmeshMaxCoverBorderColor;
+		settings.navmeshAlpha				= MCM::settings::navmeshAlpha;
+		settings.navmeshBorderAlpha			= MCM::settings::navmeshBorderAlpha;
+		settings.navmeshEdgeLinkAlpha		= MCM::settings::navmeshEdgeLinkAlpha;
+		settings.navmeshCoverAlpha			= MCM::settings::navmeshCoverAlpha;
+		settings.navmeshCoverBorderAlpha	= MCM::settings::navmeshCoverBorderAlpha;
+		settings.navmeshMaxCoverAlpha		= MCM::settings::navmeshMaxCoverAlpha;
+		settings.navmeshMaxCoverBorderAlpha	= MCM::settings::navmeshMaxCoverBorderAlpha;
+		return settings;
+	}
+
+	// Everything here only depends on the navmesh and the DrawListSettings, so it is done once and not every update
+	void NavmeshHandler::BuildDrawList(NavmeshInfo& a_navmesh, const RE::TESObjectCELL* a_cell, const DrawListSettings& a_settings)
+	{
+		NavmeshDrawList& drawList = a_navmesh.drawList;
+		drawList.triangles.clear();
+		drawList.shapes.clear();
+		drawList.settings = a_settings;
+		drawList.isBuilt = true;
+
+		DrawHandler::ShapeMetaData metaData;
+		metaData.formID = a_navmesh.formID;
+		metaData.cell = a_cell;
+		metaData.infoType = InfoType::kNavmesh;
+
+		auto& triangles = a_navmesh.triangles;
+
+		using TriangleFlag = RE::BSNavmeshTriangle::TriangleFlag;
+		auto hasFlag = [](uint16_t a_flags, TriangleFlag a_flag) { return (a_flags & static_cast<uint16_t>(a_flag)) != 0; };
+
+		for (int i = 0; i < triangles.size(); i++)
+		{
+			const auto& triangle = triangles[i];
+			uint16_t triangleFlag = triangle.triangleFlags;
+
+
+			if (a_settings.navmeshModeIndex == MCM::settings::NavmeshMode::creationKit && !(triangleFlag & inFileFlag))
+			{
+				if (i + 2 < triangles.size())
+				{
+					bool isNextTriangleInFile = triangles[i + 1].triangleFlags & inFileFlag;
+					bool isNextNextTriangleInFile = triangles[i + 2].triangleFlags & inFileFlag;
+					if (!isNextTriangleInFile && !isNextNextTriangleInFile)
 					{
-						continue;
+						break; // sometimes (very rarely) a triangle in the middle of the array has no inFileFlag, so if the next two triangles are in file, don't break
 					}
-					uint32_t triangleColor = MCM::settings::navmeshColor;
+				}
+			}
 
-					if (triangleFlag & doorFlag)
-						triangleColor = MCM::settings::navmeshDoorColor;
+			if (a_settings.navmeshModeIndex == MCM::settings::NavmeshMode::runtime && hasFlag(triangleFlag, TriangleFlag::kOverlapping))
+			{
+				continue;
+			}
 
-					else if (triangleFlag & waterFlag)
-						triangleColor = MCM::settings::navmeshWaterColor;
+			if (hasFlag(triangleFlag, TriangleFlag::kDeleted))
+			{
+				continue;
+			}
+			uint32_t triangleColor = a_settings.navmeshColor;
 
-					else if (triangle.triangleFlags.any(RE::BSNavmeshTriangle::TriangleFlag::kPreferred))
-						triangleColor = MCM::settings::navmeshPrefferedColor;
+			if (triangleFlag & doorFlag)
+				triangleColor = a_settings.navmeshDoorColor;
 
-					float borderThickness = triangleColor == MCM::settings::navmeshColor ? 4.0f : 5.0f;
+			else if (triangleFlag & waterFlag)
+				triangleColor = a_settings.navmeshWaterColor;
 
-					auto vertex0 = vertices[triangle.vertices[0]].location;
-					auto vertex1 = vertices[triangle.vertices[1]].location;
-					auto vertex2 = vertices[triangle.vertices[2]].location;
+			else if (hasFlag(triangleFlag, TriangleFlag::kPreferred))
+				triangleColor = a_settings.navmeshPrefferedColor;
 
-					if (MCM::settings::showNavmeshTriangles)
-					{
-						GetDrawHandler()->DrawPolygon({ vertex0, vertex1, vertex2 }, borderThickness, triangleColor, MCM::settings::navmeshAlpha, MCM::settings::navmeshBorderAlpha, triangleColor, false, metaData);
+			float borderThickness = triangleColor == a_settings.navmeshColor ? 4.0f : 5.0f;
 
-						for (int edge = 0; edge < 3; edge++)
-						{
-							uint16_t edgeFlag = 1 << edge;
-							if (triangleFlag & edgeFlag)
-							{
-								uint16_t edgeInfoIndex = triangle.triangles[edge];
-								if (edgeInfoIndex < navmesh.extraEdgeInfo.size())
-								{
-									uint32_t edgeLinkColor = MCM::settings::navmeshCellEdgeLinkColor;
-									uint32_t edgeLinkAlpha = MCM::settings::navmeshEdgeLinkAlpha;
-									EdgeLinkPosition edgeLinkPosition = EdgeLinkPosition::kCenter;
-									if (navmesh.extraEdgeInfo.data()[edgeInfoIndex].type.any(RE::EDGE_EXTRA_INFO_TYPE::kLedgeUp))
-									{
-										edgeLinkColor = MCM::settings::navmeshLedgeEdgeLinkColor;
-										edgeLinkAlpha = static_cast<uint32_t>(100 - (100 - edgeLinkAlpha) * (100 - edgeLinkAlpha) / 100.0f); // cell border edgelinks usually overlap almost entirely, so their combined opacity is probably (1-(1-opacity)^2), ie. if they are at 20% opcaity, combined they are probably at 7% opacity
-										edgeLinkPosition = EdgeLinkPosition::kAbove;
-									}
-									else if (navmesh.extraEdgeInfo.data()[edgeInfoIndex].type.any(RE::EDGE_EXTRA_INFO_TYPE::kLedgeDown))
-									{
-										edgeLinkColor = MCM::settings::navmeshLedgeEdgeLinkColor;
-										edgeLinkAlpha = static_cast<uint32_t>(100 - (100 - edgeLinkAlpha) * (100 - edgeLinkAlpha) / 100.0f);
-										edgeLinkPosition = EdgeLinkPosition::kBelow;
-									}
-
-									auto edgeLinkPolygon = GetEdgeLinkPolygon(vertices[triangle.vertices[edge]].location, vertices[triangle.vertices[edge == 2 ? 0 : edge + 1]].location, edgeLinkPosition);
-
-									GetDrawHandler()->DrawPolygon(edgeLinkPolygon, 0, edgeLinkColor, edgeLinkAlpha, 0);
-								}
-							}
-						}
-					}
+			RE::NiPoint3 triangleVertices[3]{ a_navmesh.GetVertex(triangle.vertices[0]), a_navmesh.GetVertex(triangle.vertices[1]), a_navmesh.GetVertex(triangle.vertices[2]) };
+			auto& vertex0 = triangleVertices[0];
+			auto& vertex1 = triangleVertices[1];
+			auto& vertex2 = triangleVertices[2];
+
+			NavmeshDrawTriangle drawTriangle;
+			drawTriangle.vertices[0] = vertex0;
+			drawTriangle.vertices[1] = vertex1;
+			drawTriangle.vertices[2] = vertex2;
+			drawTriangle.firstShape = drawList.shapes.size();
 
-					// quarter flag = height of 16 units,
-					// half flag = height of 32 units,
-					// tri flag = height of 64 units,
-					// full flag = height of 128 units
+			if (a_settings.showNavmeshTriangles)
+			{
+				drawList.shapes.push_back(MakePolygon({ vertex0, vertex1, vertex2 }, borderThickness, triangleColor, a_settings.navmeshAlpha, a_settings.navmeshBorderAlpha, triangleColor, false, metaData));
 
-					if (MCM::settings::showNavmeshCover)
+				for (uint8_t edge = 0; edge < 3; edge++)
+				{
+					if (triangle.HasEdgeLink(edge))
 					{
-						// first four bits describe the height
-						bool edge0HasCover = Utils::GetNavmeshCoverHeight(triangle.traversalFlags.underlying(), 0) != 0;
-						bool edge1HasCover = Utils::GetNavmeshCoverHeight(triangle.traversalFlags.underlying(), 1) != 0;
+						uint32_t edgeLinkColor = a_settings.navmeshCellEdgeLinkColor;
+						uint32_t edgeLinkAlpha = a_settings.navmeshEdgeLinkAlpha;
+						EdgeLinkPosition edgeLinkPosition = triangle.GetEdgeLinkPosition(edge);
+						if (edgeLinkPosition != EdgeLinkPosition::kCenter) // ledge up or down
+						{
+							edgeLinkColor = a_settings.navmeshLedgeEdgeLinkColor;
+							edgeLinkAlpha = static_cast<uint32_t>(100 - (100 - edgeLinkAlpha) * (100 - edgeLinkAlpha) / 100.0f); // cell border edgelinks usually overlap almost entirely, so their combined opacity is probably (1-(1-opacity)^2), ie. if they are at 20% opcaity, combined they are probably at 7% opacity
+						}
 
-						if (edge0HasCover) DrawCover(navmesh.formID, vertex0, vertex1, triangle.traversalFlags.underlying(), 0);
-						if (edge1HasCover) DrawCover(navmesh.formID, vertex1, vertex2, triangle.traversalFlags.underlying(), 1);
+						auto edgeLinkPolygon = GetEdgeLinkPolygon(triangleVertices[edge], triangleVertices[edge == 2 ? 0 : edge + 1], edgeLinkPosition);
 
+						drawList.shapes.push_back(MakePolygon(edgeLinkPolygon, 0, edgeLinkColor, edgeLinkAlpha, 0));
 					}
 				}
 			}
-		});
+
+			// quarter flag = height of 16 units,
+			// half flag = height of 32 units,
+			// tri flag = height of 64 units,
+			// full flag = height of 128 units
+
+			if (a_settings.showNavmeshCover)
+			{
+				// first four bits describe the height
+				bool edge0HasCover = Utils::GetNavmeshCoverHeight(triangle.traversalFlags, 0) != 0;
+				bool edge1HasCover = Utils::GetNavmeshCoverHeight(triangle.traversalFlags, 1) != 0;
+
+				if (edge0HasCover) AddCover(drawList.shapes, vertex0, vertex1, triangle.traversalFlags, 0, a_settings);
+				if (edge1HasCover) AddCover(drawList.shapes, vertex1, vertex2, triangle.traversalFlags, 1, a_settings);
+
+			}
+
+			drawTriangle.numberOfShapes = drawList.shapes.size() - drawTriangle.firstShape;
+			if (drawTriangle.numberOfShapes > 0) drawList.triangles.push_back(drawTriangle);
+		}
+
+		BuildGrid(drawList);
+	}
+
+	// Sorts the triangles by grid cell, so each grid cell is a continuous range of triangles
+	void NavmeshHandler::BuildGrid(NavmeshDrawList& a_drawList)
+	{
+		auto& triangles = a_drawList.triangles;
+
+		std::vector<RE::NiPoint2> corners;
+		corners.reserve(triangles.size());
+		for (const auto& triangle : triangles)
+		{
+			float x = std::min({ triangle.vertices[0].x, triangle.vertices[1].x, triangle.vertices[2].x });
+			float y = std::min({ triangle.vertices[0].y, triangle.vertices[1].y, triangle.vertices[2].y });
+			corners.emplace_back(x, y);
+		}
+
+		const auto order = a_drawList.grid.Build(corners, gridCellSize, maxGridWidth);
+
+		std::vector<NavmeshDrawTriangle> sortedTriangles;
+		sortedTriangles.reserve(triangles.size());
+		for (const uint32_t index : order)
+		{
+			sortedTriangles.push_back(triangles[index]);
+		}
+		triangles = std::move(sortedTriangles);
+	}
+
+	NavmeshHandler::NavmeshShape NavmeshHandler::MakePolygon(const std::vector<RE::NiPoint3>& a_positions, float a_borderThickness, uint32_t a_color, uint32_t a_baseAlpha, uint32_t a_borderAlpha, uint32_t a_borderColor, bool a_useCustomBorderColor, MetaData a_metaData)
+	{
+		NavmeshShape shape;
+		shape.type = NavmeshShape::Type::kPolygon;
+		shape.numberOfPoints = static_cast<uint8_t>(std::min<size_t>(a_positions.size(), std::size(shape.points)));
+		std::copy_n(a_positions.begin(), shape.numberOfPoints, shape.points);
+		shape.thickness = a_borderThickness;
+		shape.color = a_color;
+		shape.alpha = a_baseAlpha;
+		shape.borderAlpha = a_borderAlpha;
+		shape.borderColor = a_borderColor;
+		shape.useCustomBorderColor = a_useCustomBorderColor;
+		shape.metaData = a_metaData;
+		return shape;
+	}
+
+	NavmeshHandler::NavmeshShape NavmeshHandler::MakeLine(const RE::NiPoint3& a_start, const RE::NiPoint3& a_end, float a_thickness, uint32_t a_color, uint32_t a_alpha)
+	{
+		NavmeshShape shape;
+		shape.type = NavmeshShape::Type::kLine;
+		shape.numberOfPoints = 2;
+		shape.points[0] = a_start;
+		shape.points[1] = a_end;
+		shape.thickness = a_thickness;
+		shape.color = a_color;
+		shape.alpha = a_alpha;
+		return shape;
+	}
+
+	NavmeshHandler::NavmeshShape NavmeshHandler::MakePoint(const RE::NiPoint3& a_position, float a_radius, uint32_t a_color, uint32_t a_alpha, MetaData a_metaData)
+	{
+		NavmeshShape shape;
+		shape.type = NavmeshShape::Type::kPoint;
+		shape.numberOfPoints = 1;
+		shape.points[0] = a_position;
+		shape.thickness = a_radius;
+		shape.color = a_color;
+		shape.alpha = a_alpha;
+		shape.metaData = a_metaData;
+		return shape;
+	}
+
+	void NavmeshHandler::DrawShape(const NavmeshShape& a_shape)
+	{
+		switch (a_shape.type)
+		{
+			case NavmeshShape::Type::kPolygon:
+			{
+				GetDrawHandler()->DrawPolygon(std::span<const RE::NiPoint3>(a_shape.points, a_shape.numberOfPoints), a_shape.thickness, a_shape.color, a_shape.alpha, a_shape.borderAlpha, a_shape.borderColor, a_shape.useCustomBorderColor, a_shape.metaData);
+				break;
+			}
+			case NavmeshShape::Type::kLine:
+			{
+				GetDrawHandler()->DrawLine(a_shape.points[0], a_shape.points[1], a_shape.thickness, a_shape.color, a_shape.alpha);
+				break;
+			}
+			case NavmeshShape::Type::kPoint:
+			{
+				GetDrawHandler()->DrawPoint(a_shape.points[0], a_shape.thickness, a_shape.color, a_shape.alpha, a_shape.metaData);
+				break;
+			}
+		}
+	}
+
+	void NavmeshHandler::PrintDrawListStats()
+	{
+		uint32_t total = drawListRebuilds + drawListReuses;
+		float hitRate = total == 0 ? 0.0f : 100.0f * drawListReuses / total;
+		logger::debug("Navmesh draw lists: {} rebuilds, {} reuses ({:.1f}% reused)", drawListRebuilds, drawListReuses, hitRate);
+		logger::debug("Navmesh triangles last update: {} tested, {} in range", trianglesTested, trianglesInRange);
 	}
 
 	std::vector<RE::NiPoint3> NavmeshHandler::GetEdgeLinkPolygon(const RE::NiPoint3& a_point1, const RE::NiPoint3& a_point2, EdgeLinkPosition a_position)
@@ -224,7 +507,7 @@ namespace DebugMenu
 		return polygon;
 	}
 
-	void NavmeshHandler::DrawCover(RE::FormID a_formID, const RE::NiPoint3& a_rightPoint, const RE::NiPoint3& a_leftPoint, uint16_t a_traversalFlags, uint8_t a_edge)
+	void NavmeshHandler::AddCover(std::vector<NavmeshShape>& a_shapes, const RE::NiPoint3& a_rightPoint, const RE::NiPoint3& a_leftPoint, uint16_t a_traversalFlags, uint8_t a_edge, const DrawListSettings& a_settings)
 	{
 		bool left = false;
 		bool right = false;
@@ -233,25 +516,25 @@ namespace DebugMenu
 		int32_t iHeight = Utils::GetNavmeshCoverHeight(a_traversalFlags, a_edge);
 
 
-		if (MCM::settings::showCoverBeams)
+		if (a_settings.showCoverBeams)
 		{
 			left = Utils::GetNavmeshCoverLeft(a_traversalFlags, a_edge);
 			right = Utils::GetNavmeshCoverRight(a_traversalFlags, a_edge);
 		}
 		// maybe horizontal line every 16 or 32 height?
-		uint32_t color = MCM::settings::navmeshCoverColor;
-		uint32_t alpha = MCM::settings::navmeshCoverAlpha;
-		uint32_t borderColor = MCM::settings::navmeshCoverBorderColor;
-		uint32_t borderAlpha = MCM::settings::navmeshCoverBorderAlpha;
+		uint32_t color = a_settings.navmeshCoverColor;
+		uint32_t alpha = a_settings.navmeshCoverAlpha;
+		uint32_t borderColor = a_settings.navmeshCoverBorderColor;
+		uint32_t borderAlpha = a_settings.navmeshCoverBorderAlpha;
 
 		float height = static_cast<float>(iHeight);
 
 		if (iHeight == 240)
 		{
-			color = MCM::settings::navmeshMaxCoverColor;
-			alpha = MCM::settings::navmeshMaxCoverAlpha;
-			borderColor = MCM::settings::navmeshMaxCoverBorderColor;
-			borderAlpha = MCM::settings::navmeshMaxCoverBorderAlpha;
+			color = a_settings.navmeshMaxCoverColor;
+			alpha = a_settings.navmeshMaxCoverAlpha;
+			borderColor = a_settings.navmeshMaxCoverBorderColor;
+			borderAlpha = a_settings.navmeshMaxCoverBorderAlpha;
 		}
 		else if (iHeight < 64) // cover is ledge cover
 		{
@@ -280,25 +563,25 @@ namespace DebugMenu
 
 		std::vector<RE::NiPoint3> polygon{ corner1, corner2, corner3, corner4 };
 
-		GetDrawHandler()->DrawPolygon(polygon, borderThickness, color, alpha, borderAlpha, borderColor);
+		a_shapes.push_back(MakePolygon(polygon, borderThickness, color, alpha, borderAlpha, borderColor));
 
 		// Draw horizontal lines on cover to visualize height
-		if (MCM::settings::showNavmeshCoverLines)
+		if (a_settings.showNavmeshCoverLines)
 		{
-			uint32_t stepSize = MCM::settings::linesHeight;
+			uint32_t stepSize = a_settings.linesHeight;
 			for (int step = stepSize; step < iHeight; step += stepSize)
 			{
 				int8_t multiplier = iHeight < 64 ? -1 : 1;
 				RE::NiPoint3 point1 = corner1; point1.z += multiplier * step;
 				RE::NiPoint3 point2 = corner4; point2.z += multiplier * step;
-				GetDrawHandler()->DrawLine(point1, point2, borderThickness, borderColor, borderAlpha);
+				a_shapes.push_back(MakeLine(point1, point2, borderThickness, borderColor, borderAlpha));
 			}
 		}
 
 
 		// Draw dot in the middle of the triangle edge to contain info:
 
-		if (MCM::settings::showNavmeshCoverInfo)
+		if (a_settings.showNavmeshCoverInfo)
 		{
 			RE::NiPoint3 middle = a_leftPoint + directionAlongLine / 2;
 
@@ -306,7 +589,7 @@ namespace DebugMenu
 			metaData.navmeshTraversalFlags = a_traversalFlags;
 			metaData.coverEdge = a_edge;
 			metaData.infoType = InfoType::kNavmeshCover;
-			GetDrawHandler()->DrawPoint(middle, 10, borderColor, borderAlpha, metaData);
+			a_shapes.push_back(MakePoint(middle, 10, borderColor, borderAlpha, metaData));
 		}
 
 
@@ -320,7 +603,7 @@ namespace DebugMenu
 			corner4 = a_leftPoint + leftOffset;
 
 			std::vector<RE::NiPoint3> beamPolygon{ corner1, corner2, corner3, corner4 };
-			GetDrawHandler()->DrawPolygon(beamPolygon, 0.0f, 0x000000, alpha, 0);
+			a_shapes.push_back(MakePolygon(beamPolygon, 0.0f, 0x000000, alpha, 0));
 		}
 
 		if (right)
@@ -331,7 +614,7 @@ namespace DebugMenu
 			corner4 = a_rightPoint + rightOffset;
 
 			std::vector<RE::NiPoint3> beamPolygon{ corner1, corner2, corner3, corner4 };
-			GetDrawHandler()->DrawPolygon(beamPolygon, 0.0f, 0x000000, alpha, 0);
+			a_shapes.push_back(MakePolygon(beamPolygon, 0.0f, 0x000000, alpha, 0));
 		}
 	}
 
@@ -378,21 +661,22 @@ namespace DebugMenu
 
 			if (numberOfFiles == 0 || std::string(files[0]->GetFilename()) != "Skyrim.esm")
 			{
-				if (!sourceFiles[formID].contains("Skyrim.esm"))
-				{
-					sourceFiles[formID].insert("Skyrim.esm");
-					sourceFilesOrdered[formID].push_back("Skyrim.esm");
-				}
+				AddNavmeshSourceFile(formID, "Skyrim.esm");
 			}
 		}
 
 		for (int i = 0; i < numberOfFiles; i++)
 		{
-			if (!sourceFiles[formID].contains(files[i]->GetFilename()))
-			{
-				sourceFiles[formID].insert(files[i]->GetFilename());
-				sourceFilesOrdered[formID].push_back(files[i]->GetFilename());
-			}
+			AddNavmeshSourceFile(formID, files[i]->GetFilename());
+		}
+	}
+
+	void NavmeshHandler::AddNavmeshSourceFile(RE::FormID a_navmeshFormID, std::string_view a_fileName)
+	{
+		if (!sourceFiles[a_navmeshFormID].contains(a_fileName))
+		{
+			sourceFiles[a_navmeshFormID].insert(a_fileName);
+			sourceFilesOrdered[a_navmeshFormID].push_back(a_fileName);
 		}
 	}
 
@@ -416,98 +700,280 @@ namespace DebugMenu
 	void NavmeshHandler::CacheNavmesh(RE::NavMesh* a_navmesh, RE::FormID a_cellID)
 	{
 		auto formID = a_navmesh->GetFormID();
+
 		if (!cachedNavmeshes.contains(a_cellID))
 		{
-			std::vector<NavmeshInfo> navmeshes;
-			cachedNavmeshes[a_cellID] = navmeshes;
+			PageInCell(a_cellID); // so the navmeshes only on disk are kept when the cell is written again
 		}
+		CachedCell& cachedCell = cachedNavmeshes[a_cellID];
 
-		for (auto& navmeshInfo : cachedNavmeshes[a_cellID])
+		NavmeshInfo* navmeshInfo = nullptr;
+		for (auto& cachedNavmesh : cachedCell.navmeshes)
 		{
-			if (navmeshInfo.formID == formID) // if the navmesh exists, replace its information
+			if (cachedNavmesh.formID == formID) // if the navmesh exists, replace its information
 			{
-				navmeshInfo.triangles = a_navmesh->triangles;
-				navmeshInfo.vertices = a_navmesh->vertices;
-				navmeshInfo.extraEdgeInfo = a_navmesh->extraEdgeInfo;
-				return;
+				navmeshInfo = &cachedNavmesh;
+				break;
 			}
 		}
+		if (!navmeshInfo)
+		{
+			navmeshInfo = &cachedCell.navmeshes.emplace_back();
+			navmeshInfo->formID = formID;
+		}
 
-		NavmeshInfo newInfo;
-		newInfo.formID = formID;
-		newInfo.triangles = a_navmesh->triangles;
-		newInfo.vertices = a_navmesh->vertices;
-		newInfo.extraEdgeInfo = a_navmesh->extraEdgeInfo;
+		PackNavmesh(a_navmesh, *navmeshInfo);
+		navmeshInfo->drawList.isBuilt = false;
+		isDiskCacheDirty = true;
 
-		cachedNavmeshes[a_cellID].push_back(newInfo);
+		cachedCell.isOnDisk = false;
+		cachedCell.isBeingWritten = false;
+		cachedCell.lastDrawn = drawCount;
+		UpdateCachedCellCenter(cachedCell);
+		UpdateCachedCellSize(cachedCell);
+		EvictIfOverBudget();
 	}
 
-	void NavmeshHandler::CacheCellNavmeshes(const RE::TESObjectCELL* a_cell) // call on cell fully loaded
+	// the center is only used to find the cells furthest away when evicting, so the average of the navmesh centers will do
+	void NavmeshHandler::UpdateCachedCellCenter(CachedCell& a_cell)
 	{
-		auto cellID = a_cell->GetFormID();
+		if (a_cell.navmeshes.empty()) return;
 
-		if (!a_cell->GetRuntimeData().navMeshes)
+		RE::NiPoint3 center{ 0.0f, 0.0f, 0.0f };
+		for (const auto& cachedNavmesh : a_cell.navmeshes)
 		{
-			return;
+			center += cachedNavmesh.origin + cachedNavmesh.step * (std::numeric_limits<uint16_t>::max() / 2.0f);
+		}
+		a_cell.center = center / static_cast<float>(a_cell.navmeshes.size());
+	}
+
+	void NavmeshHandler::PackNavmesh(RE::NavMesh* a_navmesh, NavmeshInfo& a_info)
+	{
+		const auto& vertices = a_navmesh->vertices;
+		const auto& triangles = a_navmesh->triangles;
+		const auto& extraEdgeInfo = a_navmesh->extraEdgeInfo;
+
+		RE::NiPoint3 boundsMin{ 0.0f, 0.0f, 0.0f };
+		RE::NiPoint3 boundsMax{ 0.0f, 0.0f, 0.0f };
+		if (!vertices.empty())
+		{
+			boundsMin = boundsMax = vertices[0].location;
+		}
+		for (const auto& vertex : vertices)
+		{
+			boundsMin.x = std::min(boundsMin.x, vertex.location.x);
+			boundsMin.y = std::min(boundsMin.y, vertex.location.y);
+			boundsMin.z = std::min(boundsMin.z, vertex.location.z);
+			boundsMax.x = std::max(boundsMax.x, vertex.location.x);
+			boundsMax.y = std::max(boundsMax.y, vertex.location.y);
+			boundsMax.z = std::max(boundsMax.z, vertex.location.z);
 		}
 
-		for (const auto& navmesh : a_cell->GetRuntimeData().navMeshes->navMeshes)
+		// exterior navmeshes are ~4096 units wide, so one step is well below a unit
+		constexpr float maxValue = std::numeric_limits<uint16_t>::max();
+		a_info.origin = boundsMin;
+		a_info.step = (boundsMax - boundsMin) / maxValue;
+
+		auto quantize = [&](float a_value, float a_origin, float a_step) -> uint16_t
 		{
-			CacheNavmesh(navmesh.get(), cellID);
+			if (a_step <= 0.0f) return 0;
+			return static_cast<uint16_t>(std::clamp(std::round((a_value - a_origin) / a_step), 0.0f, maxValue));
+		};
+
+		a_info.vertices.clear();
+		a_info.vertices.reserve(vertices.size());
+		for (const auto& vertex : vertices)
+		{
+			a_info.vertices.push_back(PackedVertex{
+				quantize(vertex.location.x, a_info.origin.x, a_info.step.x),
+				quantize(vertex.location.y, a_info.origin.y, a_info.step.y),
+				quantize(vertex.location.z, a_info.origin.z, a_info.step.z) });
+		}
+
+		a_info.triangles.clear();
+		a_info.triangles.reserve(triangles.size());
+		for (const auto& triangle : triangles)
+		{
+			PackedTriangle packedTriangle;
+			packedTriangle.vertices[0] = triangle.vertices[0];
+			packedTriangle.vertices[1] = triangle.vertices[1];
+			packedTriangle.vertices[2] = triangle.vertices[2];
+			packedTriangle.triangleFlags = triangle.triangleFlags.underlying();
+			packedTriangle.traversalFlags = triangle.traversalFlags.underlying();
+			packedTriangle.edgeLinks = 0;
+
+			for (uint8_t edge = 0; edge < 3; edge++)
+			{
+				uint16_t edgeFlag = 1 << edge;
+				uint16_t edgeInfoIndex = triangle.triangles[edge];
+				if (!(packedTriangle.triangleFlags & edgeFlag) || edgeInfoIndex >= extraEdgeInfo.size()) continue;
+
+				EdgeLinkPosition edgeLinkPosition = EdgeLinkPosition::kCenter;
+				if (extraEdgeInfo.data()[edgeInfoIndex].type.any(RE::EDGE_EXTRA_INFO_TYPE::kLedgeUp))
+					edgeLinkPosition = EdgeLinkPosition::kAbove;
+				else if (extraEdgeInfo.data()[edgeInfoIndex].type.any(RE::EDGE_EXTRA_INFO_TYPE::kLedgeDown))
+					edgeLinkPosition = EdgeLinkPosition::kBelow;
+
+				packedTriangle.edgeLinks |= (static_cast<uint8_t>(edgeLinkPosition) + 1) << (2 * edge);
+			}
+
+			a_info.triangles.push_back(packedTriangle);
 		}
 	}
 
-	void NavmeshHandler::SizeofCache()
+	RE::NiPoint3 NavmeshHandler::NavmeshInfo::GetVertex(uint16_t a_index) const
 	{
-		unsigned long size = sizeof(cachedNavmeshes);
+		if (a_index >= vertices.size()) return origin;
 
-		int cellCount = 0;
-		int triangleCount = 0;
-		int vertexCount = 0;
-		int extraEdgeInfoCount = 0;
+		const PackedVertex& vertex = vertices[a_index];
+		return RE::NiPoint3(
+			origin.x + vertex.x * step.x,
+			origin.y + vertex.y * step.y,
+			origin.z + vertex.z * step.z);
+	}
 
-		int triangleCapacity = 0;
-		int vertexCapacity = 0;
-		int extraEdgeInfoCapacity = 0;
+	size_t NavmeshHandler::NavmeshInfo::GetSizeInBytes() const
+	{
+		size_t size = sizeof(NavmeshInfo);
+		size += vertices.capacity() * sizeof(PackedVertex);
+		size += triangles.capacity() * sizeof(PackedTriangle);
+		size += drawList.triangles.capacity() * sizeof(NavmeshDrawTriangle);
+		size += drawList.shapes.capacity() * sizeof(NavmeshShape);
+		size += drawList.grid.cellStarts.capacity() * sizeof(uint32_t);
+		return size;
+	}
 
-		std::map<RE::FormID, std::vector<NavmeshInfo>>::iterator it;
-		for (it = cachedNavmeshes.begin(); it != cachedNavmeshes.end(); it++)
+	void NavmeshHandler::UpdateCachedCellSize(CachedCell& a_cell)
+	{
+		size_t size = sizeof(RE::FormID) + sizeof(CachedCell);
+		for (const auto& navmesh : a_cell.navmeshes)
 		{
-			cellCount++;
+			size += navmesh.GetSizeInBytes();
+		}
 
-			size += sizeof(it->first);
-			for (const auto& item : it->second)
-			{
-				//size += sizeof(item);
+		cacheSizeInBytes -= a_cell.sizeInBytes;
+		cacheSizeInBytes += size;
+		a_cell.sizeInBytes = size;
+	}
+
+	// the draw list can be rebuilt from the packed navmesh, and is most of the size of a cell
+	void NavmeshHandler::ReleaseDrawLists(CachedCell& a_cell)
+	{
+		for (auto& navmesh : a_cell.navmeshes)
+		{
+			navmesh.drawList = NavmeshDrawList{};
+		}
+		UpdateCachedCellSize(a_cell);
+	}
 
-				triangleCount += item.triangles.size();
-				vertexCount += item.vertices.size();
-				extraEdgeInfoCount += item.extraEdgeInfo.size();
+	// Frees the cells that were drawn the longest time ago, and the ones furthest away first, until the cache is 10% below the budget
+	// (so it won't evict a single cell every time a navmesh is loaded). Cells drawn in the current update are never touched.
+	// First only the draw lists are dropped, since they are rebuilt when drawn. Then the navmeshes of cells that are not attached,
+	// which are cached again when their cell is loaded, and of attached cells the disk cache holds. The navmeshes of the other
+	// attached cells are kept, since a navmesh that only existed while its cell was loading can't be cached again until it reloads
+	void NavmeshHandler::EvictIfOverBudget()
+	{
+		size_t budget = static_cast<size_t>(MCM::settings::navmeshCacheBudget) * 1000000;
+		if (budget == 0 || cacheSizeInBytes <= budget) return;
 
-				triangleCapacity += item.triangles.capacity();
-				vertexCapacity += item.vertices.capacity();
-				extraEdgeInfoCapacity += item.extraEdgeInfo.capacity();
+		RE::NiPoint3 origin = GetCenter();
 
-			}
+		struct EvictionCandidate
+		{
+			RE::FormID	cellID;
+			uint32_t	lastDrawn;
+			float		squareDistance;
+		};
+
+		std::vector<EvictionCandidate> candidates;
+		for (const auto& [cellID, cachedCell] : cachedNavmeshes)
+		{
+			if (cachedCell.lastDrawn == drawCount) continue;
+
+			RE::NiPoint3 delta = cachedCell.center - origin;
+			candidates.push_back(EvictionCandidate{ cellID, cachedCell.lastDrawn, delta.x * delta.x + delta.y * delta.y });
+		}
+
+		std::sort(candidates.begin(), candidates.end(), [](const EvictionCandidate& a_lhs, const EvictionCandidate& a_rhs)
+		{
+			if (a_lhs.lastDrawn != a_rhs.lastDrawn) return a_lhs.lastDrawn < a_rhs.lastDrawn;
+			return a_lhs.squareDistance > a_rhs.squareDistance;
+		});
+
+		size_t target = budget / 10 * 9;
+		for (const auto& candidate : candidates)
+		{
+			if (cacheSizeInBytes <= target) return;
+
+			ReleaseDrawLists(cachedNavmeshes.find(candidate.cellID)->second);
+		}
+
+		const auto& attachedCells = Utils::GetAttachedCells();
+		for (const auto& candidate : candidates)
+		{
+			if (cacheSizeInBytes <= target) return;
+
+			auto cachedCell = cachedNavmeshes.find(candidate.cellID);
+			bool isAttached = std::ranges::any_of(attachedCells, [&](const Utils::AttachedCell& a_attachedCell) { return a_attachedCell.cell->GetFormID() == candidate.cellID; });
+			bool isOnDisk = cachedCell->second.isOnDisk && diskCache && diskCache->HasCell(candidate.cellID);
+			if (isAttached && !isOnDisk) continue;
+
+			cacheSizeInBytes -= cachedCell->second.sizeInBytes;
+			cachedNavmeshes.erase(cachedCell);
+			isCellsCacheFinalized[candidate.cellID] = false; // so the cell is paged in from the disk cache again when it is drawn
+			cacheEvictions++;
+		}
+	}
+
+	void NavmeshHandler::CacheCellNavmeshes(const RE::TESObjectCELL* a_cell) // call on cell fully loaded
+	{
+		auto cellID = a_cell->GetFormID();
+
+		if (!a_cell->GetRuntimeData().navMeshes)
+		{
+			return;
 		}
 
-		int allocSize = size;
+		for (const auto& navmesh : a_cell->GetRuntimeData().navMeshes->navMeshes)
+		{
+			CacheNavmesh(navmesh.get(), cellID);
+		}
+	}
 
-		size += triangleCount * sizeof(RE::BSNavmeshTriangle);
-		size += vertexCount * sizeof(RE::BSNavmeshVertex);
-		size += extraEdgeInfoCount * sizeof(RE::BSNavmeshEdgeExtraInfo);
+	NavmeshHandler::CacheStats NavmeshHandler::GetCacheStats()
+	{
+		CacheStats stats;
+		stats.sizeInBytes = cacheSizeInBytes;
+		stats.budgetInBytes = static_cast<size_t>(MCM::settings::navmeshCacheBudget) * 1000000;
+		stats.cells = cachedNavmeshes.size();
+		stats.hits = cacheHits;
+		stats.misses = cacheMisses;
+		stats.evictions = cacheEvictions;
+
+		for (const auto& [cellID, cachedCell] : cachedNavmeshes)
+		{
+			stats.navmeshes += cachedCell.navmeshes.size();
+			for (const auto& navmesh : cachedCell.navmeshes)
+			{
+				stats.triangles += navmesh.triangles.size();
+				stats.vertices += navmesh.vertices.size();
+			}
+		}
+		return stats;
+	}
 
-		allocSize += triangleCapacity * sizeof(RE::BSNavmeshTriangle);
-		allocSize += vertexCapacity * sizeof(RE::BSNavmeshVertex);
-		allocSize += extraEdgeInfoCapacity * sizeof(RE::BSNavmeshEdgeExtraInfo);
+	void NavmeshHandler::PrintCacheStats()
+	{
+		CacheStats stats = GetCacheStats();
 
 		logger::debug("Cache details:");
-		logger::debug("  Used Memory size (approximately):      {:>10.3f} MB ", size / 1000000.f);
-		logger::debug("  Allocated Memory size (approximately): {:>10.3f} MB", allocSize / 1000000.f);
-		logger::debug("  # of cells:      {:>10}", cellCount);
-		logger::debug("  # of trianlges:  {:>10}", triangleCount);
-		logger::debug("  # of vertices:   {:>10}", vertexCount);
-		logger::debug("  # of extra info: {:>10}", extraEdgeInfoCount);
+		logger::debug("  Allocated Memory size (approximately): {:>10.3f} MB / {:.0f} MB", stats.sizeInBytes / 1000000.f, stats.budgetInBytes / 1000000.f);
+		logger::debug("  # of cells:      {:>10}", stats.cells);
+		logger::debug("  # of navmeshes:  {:>10}", stats.navmeshes);
+		logger::debug("  # of trianlges:  {:>10}", stats.triangles);
+		logger::debug("  # of vertices:   {:>10}", stats.vertices);
+		logger::debug("  hits / misses:   {:>10} / {}", stats.hits, stats.misses);
+		logger::debug("  # of evictions:  {:>10}", stats.evictions);
 
 		/*
 		IN VANILLA:
@@ -1,15 +1,25 @@
 #pragma once
 
 #include "DebugItem.h"
+#include "NavmeshCacheFile.h"
+#include "NavmeshGrid.h"
+#include "WorkerPool.h"
 
 namespace DebugMenu
 {
+	class NavmeshDiskCache;
+
 	class NavmeshHandler : 
 		public DebugItem,
 		public RE::BSTEventSink<RE::TESCellFullyLoadedEvent>
 	{
 		public:
 			NavmeshHandler();
+			~NavmeshHandler();
+
+			void							InitPostDataLoaded();
+			void							SaveDiskCache(); // the file is written on a worker, and replaces the old one in FinishDiskCacheWrite
+			void							FinishDiskCacheWrite(); // call every frame
 
 			void							Draw() override;
 			void							OnCellFullyLoaded(RE::TESObjectCELL* a_cell);
@@ -17,18 +27,25 @@ namespace DebugMenu
 			void							OnCellLoad(RE::TESObjectCELL* const& a_cell);
 			std::vector<std::string_view>&	GetNavmeshSourceFiles(RE::FormID a_navmeshFormID); // not used
 
-			RE::BSEventNotifyControl ProcessEvent(const RE::TESCellFullyLoadedEvent* a_event, RE::BSTEventSource<RE::TESCellFullyLoadedEvent>*);
-
-		private:
-			struct NavmeshInfo
+			struct CacheStats
 			{
-				RE::FormID formID = 0x0;
-				bool hasTriangleInfo = false;
-				RE::BSTArray<RE::BSNavmeshVertex> vertices;
-				RE::BSTArray<RE::BSNavmeshTriangle> triangles;
-				RE::BSTArray<RE::BSNavmeshEdgeExtraInfo> extraEdgeInfo;
+				size_t		sizeInBytes = 0;
+				size_t		budgetInBytes = 0;
+				uint32_t	cells = 0;
+				uint32_t	navmeshes = 0;
+				uint32_t	triangles = 0;
+				uint32_t	vertices = 0;
+				uint64_t	hits = 0;
+				uint64_t	misses = 0;
+				uint64_t	evictions = 0;
 			};
 
+			CacheStats						GetCacheStats();
+			void							PrintCacheStats();
+
+			RE::BSEventNotifyControl ProcessEvent(const RE::TESCellFullyLoadedEvent* a_event, RE::BSTEventSource<RE::TESCellFullyLoadedEvent>*);
+
+		private:
 			enum TriangelFlag : uint32_t
 			{
 				waterFlag	= 1 << 9,
@@ -36,24 +53,148 @@ namespace DebugMenu
 				inFileFlag	= 1 << 11,
 			};
 
-			enum class EdgeLinkPosition
+			// a shape the navmesh draws, stored so it can be passed to the draw handler without being recomputed
+			struct NavmeshShape
+			{
+				enum class Type : uint8_t
+				{
+					kPolygon,
+					kLine,
+					kPoint
+				};
+
+				Type			type = Type::kPolygon;
+				uint8_t			numberOfPoints = 0;
+				RE::NiPoint3	points[4];
+				float			thickness = 0.0f; // radius for points
+				uint32_t		color = 0xFFFFFF;
+				uint32_t		alpha = 0;
+				uint32_t		borderAlpha = 0;
+				uint32_t		borderColor = 0xFFFFFF;
+				bool			useCustomBorderColor = false;
+				MetaData		metaData;
+			};
+
+			// all shapes belonging to one navmesh triangle (the triangle itself, edge links and cover)
+			struct NavmeshDrawTriangle
 			{
-				kAbove = 0,
-				kCenter,
-				kBelow
+				RE::NiPoint3	vertices[3]; // used for the range check
+				uint32_t		firstShape = 0;
+				uint32_t		numberOfShapes = 0;
+			};
+
+			// the settings a draw list depends on. if any of them change, the draw list is rebuilt
+			struct DrawListSettings
+			{
+				uint32_t navmeshModeIndex = 0;
+				bool	 showNavmeshTriangles = false;
+				bool	 showNavmeshCover = false;
+				bool	 showCoverBeams = false;
+				bool	 showNavmeshCoverLines = false;
+				bool	 showNavmeshCoverInfo = false;
+				uint32_t linesHeight = 0;
+				uint32_t navmeshColor = 0;
+				uint32_t navmeshDoorColor = 0;
+				uint32_t navmeshWaterColor = 0;
+				uint32_t navmeshPrefferedColor = 0;
+				uint32_t navmeshCellEdgeLinkColor = 0;
+				uint32_t navmeshLedgeEdgeLinkColor = 0;
+				uint32_t navmeshCoverColor = 0;
+				uint32_t navmeshCoverBorderColor = 0;
+				uint32_t navmeshMaxCoverColor = 0;
+				uint32_t navmeshMaxCoverBorderColor = 0;
+				uint32_t navmeshAlpha = 0;
+				uint32_t navmeshBorderAlpha = 0;
+				uint32_t navmeshEdgeLinkAlpha = 0;
+				uint32_t navmeshCoverAlpha = 0;
+				uint32_t navmeshCoverBorderAlpha = 0;
+				uint32_t navmeshMaxCoverAlpha = 0;
+				uint32_t navmeshMaxCoverBorderAlpha = 0;
+
+				static DrawListSettings GetCurrent();
+				bool operator==(const DrawListSettings& a_other) const = default;
+			};
+
+			struct NavmeshDrawList
+			{
+				bool								isBuilt = false; // sat to false whenever the navmesh is (re)cached
+				DrawListSettings					settings;
+				std::vector<NavmeshDrawTriangle>	triangles; // sorted by grid cell
+				std::vector<NavmeshShape>			shapes;
+				NavmeshGrid							grid;
+			};
+
+			struct NavmeshInfo
+			{
+				RE::FormID formID = 0x0;
+				bool hasTriangleInfo = false;
+				RE::NiPoint3 origin{ 0.0f, 0.0f, 0.0f }; // lower corner of the navmesh bounds
+				RE::NiPoint3 step{ 0.0f, 0.0f, 0.0f }; // size of one quantization step along each axis
+				std::vector<PackedVertex> vertices;
+				std::vector<PackedTriangle> triangles;
+				NavmeshDrawList drawList;
+
+				RE::NiPoint3	GetVertex(uint16_t a_index) const;
+				size_t			GetSizeInBytes() const;
+			};
+
+			struct CachedCell
+			{
+				std::vector<NavmeshInfo> navmeshes;
+				RE::NiPoint3	center{ 0.0f, 0.0f, 0.0f };
+				size_t			sizeInBytes = 0;
+				uint32_t		lastDrawn = 0; // update in which the cell was last drawn
+				bool			isOnDisk = false; // the disk cache holds the same navmeshes, so they can be paged in again after being evicted
+				bool			isBeingWritten = false; // in the disk cache file being written, and not changed since
 			};
 
 			std::map<RE::FormID, std::vector<std::string_view>> sourceFilesOrdered;
 			std::map<RE::FormID, std::set<std::string_view>>	sourceFiles;
-			std::map<RE::FormID, std::vector<NavmeshInfo>>		cachedNavmeshes;
+			std::map<RE::FormID, CachedCell>					cachedNavmeshes;
 			std::map<RE::FormID, bool>							isCellsCacheFinalized;
+
+			size_t		cacheSizeInBytes = 0;
+			uint32_t	drawCount = 0; // number of updates the navmesh has been drawn, used as the time for the lru eviction
+			uint64_t	cacheHits = 0;
+			uint64_t	cacheMisses = 0;
+			uint64_t	cacheEvictions = 0;
+
+			std::unique_ptr<NavmeshDiskCache>	diskCache = nullptr; // only created when the disk cache is enabled
+			uint64_t							loadOrderHash = 0;
+			bool								isDiskCacheDirty = false;
+			bool								isDiskCacheWriting = false;
+			HandoffQueue<bool>					diskCacheWrites; // whether the file written on the worker can replace the old one
+
+			uint32_t drawListRebuilds = 0;
+			uint32_t drawListReuses = 0;
+			uint32_t trianglesTested = 0; // per update
+			uint32_t trianglesInRange = 0;
+
+			const float		gridCellSize = 512.0f;
+			const uint32_t	maxGridWidth = 64;
 			
 			float						GetRange() override;
 			std::vector<RE::NiPoint3>	GetEdgeLinkPolygon(const RE::NiPoint3& a_point1, const RE::NiPoint3& a_point2, EdgeLinkPosition a_position);
-			void						DrawCover(RE::FormID a_formID, const RE::NiPoint3& a_rightPoint, const RE::NiPoint3& a_leftPoint, uint16_t a_traversalFlags, uint8_t a_edge);
+			void						BuildDrawList(NavmeshInfo& a_navmesh, const RE::TESObjectCELL* a_cell, const DrawListSettings& a_settings);
+			void						BuildGrid(NavmeshDrawList& a_drawList);
+			void						AddCover(std::vector<NavmeshShape>& a_shapes, const RE::NiPoint3& a_rightPoint, const RE::NiPoint3& a_leftPoint, uint16_t a_traversalFlags, uint8_t a_edge, const DrawListSettings& a_settings);
+			void						DrawShape(const NavmeshShape& a_shape);
+			void						PrintDrawListStats();
+
+			static NavmeshShape			MakePolygon(const std::vector<RE::NiPoint3>& a_positions, float a_borderThickness, uint32_t a_color, uint32_t a_baseAlpha, uint32_t a_borderAlpha, uint32_t a_borderColor = 0xFFFFFF, bool a_useCustomBorderColor = false, MetaData a_metaData = {});
+			static NavmeshShape			MakeLine(const RE::NiPoint3& a_start, const RE::NiPoint3& a_end, float a_thickness, uint32_t a_color, uint32_t a_alpha);
+			static NavmeshShape			MakePoint(const RE::NiPoint3& a_position, float a_radius, uint32_t a_color, uint32_t a_alpha, MetaData a_metaData);
 			void						CacheNavmesh(RE::NavMesh* a_navmesh, RE::FormID a_cellID); // caches a navmesh beloning to the cell with id a_cellID
 			void						CacheCellNavmeshes(const RE::TESObjectCELL* a_cell); // caches navmeshes of a cell
-			void						SizeofCache();
+			void						PackNavmesh(RE::NavMesh* a_navmesh, NavmeshInfo& a_info);
+			void						UpdateCachedCellSize(CachedCell& a_cell);
+			void						EvictIfOverBudget();
+			void						ReleaseDrawLists(CachedCell& a_cell);
+			void						UpdateCachedCellCenter(CachedCell& a_cell);
+			void						PageInCell(RE::FormID a_cellID); // reads the cell from the disk cache, if it is there
+			void						AddNavmeshSourceFile(RE::FormID a_navmeshFormID, std::string_view a_fileName);
+
+			friend class NavmeshDiskCache;
 
 			
 
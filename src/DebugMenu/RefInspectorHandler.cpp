@@ -8,25 +8,16 @@ DebugMenu::RefInspectorHandler::RefInspectorHandler()
 
 void DebugMenu::RefInspectorHandler::Draw()
 {
-	Utils::ForEachCellInRange(GetCenter(), GetRange(), [&](const RE::TESObjectCELL* a_cell)
-	{
-		a_cell->ForEachReference([&](RE::TESObjectREFR* a_ref)
-		{
-			if (!a_ref) return RE::BSContainer::ForEachResult::kContinue;
-
-			float dx = GetCenter().x - a_ref->GetPositionX();
-			float dy = GetCenter().y - a_ref->GetPositionY();
-			if (dx * dx + dy * dy > GetRange() * GetRange()) return RE::BSContainer::ForEachResult::kContinue;
-
-			DrawHandler::ShapeMetaData metaData;
-			metaData.ref = a_ref;
-			metaData.infoType = InfoType::kRef;
-			GetDrawHandler()->DrawPoint(a_ref->GetPosition(), 15.0f, 0xF0CA22 /* yellow */, 100, metaData);
+	PROFILE_SCOPE("RefInspectorHandler::Draw");
 
-
-
-		});
+	uint32_t visited = GetRefSnapshot()->ForEachRefInRange(RefSnapshot::kAll, GetCenter(), GetRange(), [&](RE::TESObjectREFR* a_ref, const RE::TESObjectCELL*)
+	{
+		DrawHandler::ShapeMetaData metaData;
+		metaData.ref = a_ref;
+		metaData.infoType = InfoType::kRef;
+		GetDrawHandler()->DrawPoint(a_ref->GetPosition(), 15.0f, 0xF0CA22 /* yellow */, 100, metaData);
 	});
+	PROFILE_VALUE("RefInspectorHandler refs visited", visited);
 }
 
 float DebugMenu::RefInspectorHandler::GetRange()
@@ -0,0 +1,93 @@
+#include "RefSnapshot.h"
+#include "Profiler.h"
+#include "Utils.h"
+
+namespace DebugMenu
+{
+	RefSnapshot::RefSnapshot()
+	{
+		logger::debug("Initialized RefSnapshot");
+	}
+
+	void RefSnapshot::Build()
+	{
+		PROFILE_SCOPE("RefSnapshot::Build");
+
+		isBuilt = true;
+		gathered.clear();
+		for (auto& cells : categoryCells)
+		{
+			for (auto& [key, range] : cells) range = CellRange{}; // kept, the refs mostly stay in the same grid cells
+		}
+
+		// every attached cell, the debug items that use the snapshot check the range themselves
+		auto origin = RE::PlayerCharacter::GetSingleton()->GetPosition();
+		Utils::ForEachCellInRange(origin, std::numeric_limits<float>::max(), [&](const RE::TESObjectCELL* a_cell)
+		{
+			a_cell->ForEachReference([&](RE::TESObjectREFR* a_ref)
+			{
+				if (!a_ref) return RE::BSContainer::ForEachResult::kContinue;
+
+				RE::NiPoint3 position = a_ref->GetPosition();
+				gathered.push_back(RefEntry{ a_ref, a_cell, position, GetCellKey(ToCell(position.x), ToCell(position.y)), GetCategoryIndex(a_ref) });
+				return RE::BSContainer::ForEachResult::kContinue;
+			});
+		});
+
+		// counted per grid cell, then each ref is moved to the range of its grid cell, a sort is not needed
+		for (const auto& entry : gathered) categoryCells[entry.category][entry.key].count++;
+
+		uint32_t offset = 0;
+		for (auto& cells : categoryCells)
+		{
+			std::erase_if(cells, [](const auto& a_cell) { return a_cell.second.count == 0; });
+			for (auto& [key, range] : cells)
+			{
+				range.offset = offset;
+				offset += range.count;
+				range.count = 0;
+			}
+		}
+
+		entries.resize(gathered.size());
+		for (const auto& entry : gathered)
+		{
+			auto& range = categoryCells[entry.category][entry.key];
+			entries[range.offset + range.count++] = entry;
+		}
+
+		PROFILE_VALUE("RefSnapshot refs", entries.size());
+	}
+
+	uint32_t RefSnapshot::GetCategoryIndex(const RE::TESObjectREFR* a_ref) const
+	{
+		auto baseObject = a_ref->GetBaseObject();
+		if (!baseObject) return std::countr_zero(static_cast<uint32_t>(kOther));
+
+		Category category = kOther;
+		switch (baseObject->formID)
+		{
+			case 0x17: category = kPlaneMarker; break;
+			case 0x21: category = kCollisionMarker; break;
+			default:
+			{
+				switch (baseObject->GetFormType())
+				{
+					case RE::FormType::Light:			category = kLight; break;
+					case RE::FormType::Sound:			category = kSound; break;
+					case RE::FormType::Furniture:		category = kFurniture; break;
+					case RE::FormType::Door:			category = kDoor; break;
+					case RE::FormType::NPC:				category = kActor; break;
+					case RE::FormType::MovableStatic:
+					case RE::FormType::IdleMarker:
+					case RE::FormType::Activator:
+					case RE::FormType::Hazard:
+					case RE::FormType::TextureSet:
+					case RE::FormType::Static:			category = kStatic; break;
+					default: break;
+				}
+			}
+		}
+		return std::countr_zero(static_cast<uint32_t>(category));
+	}
+}
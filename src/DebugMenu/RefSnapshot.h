@@ -0,0 +1,111 @@
+#pragma once
+
+namespace DebugMenu
+{
+	// The references of all attached cells, gathered once per update (on the first query after Invalidate) instead of once per
+	// debug item. They are bucketed by the category of their base object, and each bucket is indexed on a grid of game cells,
+	// so a query only walks the categories and grid cells it asks for
+	class RefSnapshot
+	{
+		public:
+			enum Category : uint32_t
+			{
+				kPlaneMarker		= 1 << 0,
+				kCollisionMarker	= 1 << 1,
+				kLight				= 1 << 2,
+				kSound				= 1 << 3,
+				kFurniture			= 1 << 4,
+				kDoor				= 1 << 5,
+				kActor				= 1 << 6,
+				kStatic				= 1 << 7,	// statics, and the other base forms that can be markers
+				kOther				= 1 << 8,
+				kAll				= (1 << 9) - 1
+			};
+
+			RefSnapshot();
+
+			void		Invalidate() { isBuilt = false; }
+
+			// Calls a_callback(RE::TESObjectREFR*, const RE::TESObjectCELL*) for the refs of a_categories that are within a_range
+			// of a_center in the xy plane. Returns the number of refs whose distance was checked
+			template <class Callback>
+			uint32_t	ForEachRefInRange(uint32_t a_categories, const RE::NiPoint3& a_center, float a_range, Callback&& a_callback)
+			{
+				if (!isBuilt) Build();
+
+				uint32_t visited = 0;
+				float rangeSquared = a_range*a_range;
+				int32_t minX = ToCell(a_center.x - a_range);
+				int32_t maxX = ToCell(a_center.x + a_range);
+				int32_t minY = ToCell(a_center.y - a_range);
+				int32_t maxY = ToCell(a_center.y + a_range);
+
+				auto visitRange = [&](const CellRange& a_range)
+				{
+					for (uint32_t i = a_range.offset; i < a_range.offset + a_range.count; i++)
+					{
+						const RefEntry& entry = entries[i];
+						visited++;
+
+						float dx = a_center.x - entry.position.x;
+						float dy = a_center.y - entry.position.y;
+						if (dx*dx + dy*dy > rangeSquared) continue;
+
+						a_callback(entry.ref, entry.cell);
+					}
+				};
+
+				for (uint32_t category = 0; category < numberOfCategories; category++)
+				{
+					if (!(a_categories & (1 << category))) continue;
+					const auto& cells = categoryCells[category];
+
+					// a large range covers more grid cells than the category has, then it is faster to check all of them
+					if (static_cast<uint64_t>(maxX - minX + 1)*(maxY - minY + 1) > cells.size())
+					{
+						for (const auto& [key, range] : cells) visitRange(range);
+						continue;
+					}
+
+					for (int32_t x = minX; x <= maxX; x++)
+					{
+						for (int32_t y = minY; y <= maxY; y++)
+						{
+							auto cell = cells.find(GetCellKey(x, y));
+							if (cell != cells.end()) visitRange(cell->second);
+						}
+					}
+				}
+				return visited;
+			}
+
+		private:
+			static constexpr uint32_t	numberOfCategories = 9;
+			static constexpr float		cellSize = 4096.0f; // the size of a game cell
+
+			struct RefEntry
+			{
+				RE::TESObjectREFR*			ref;
+				const RE::TESObjectCELL*	cell;
+				RE::NiPoint3				position;
+				uint64_t					key;		// grid cell
+				uint32_t					category;	// index, not flag
+			};
+
+			struct CellRange
+			{
+				uint32_t	offset = 0;
+				uint32_t	count = 0;
+			};
+
+			bool											isBuilt = false;
+			std::vector<RefEntry>							gathered;	// in the order of the cells
+			std::vector<RefEntry>							entries;	// grouped by category, then grid cell
+			std::unordered_map<uint64_t, CellRange>			categoryCells[numberOfCategories];
+
+			void		Build();
+			uint32_t	GetCategoryIndex(const RE::TESObjectREFR* a_ref) const;
+			int32_t		ToCell(float a_coordinate) const { return static_cast<int32_t>(std::floor(a_coordinate/cellSize)); }
+			uint64_t	GetCellKey(int32_t a_x, int32_t a_y) const { return static_cast<uint64_t>(static_cast<uint32_t>(a_x)) << 32 | static_cast<uint32_t>(a_y); }
+	};
+}
@@ -0,0 +1,108 @@
+#include "WorkerPool.h"
+#include "MCM.h"
+
+namespace DebugMenu
+{
+	WorkerPool& GetWorkerPool()
+	{
+		static WorkerPool workerPool(MCM::settings::workerThreads);
+		return workerPool;
+	}
+
+	WorkerPool::WorkerPool(uint32_t a_numberOfThreads)
+	{
+		Resize(a_numberOfThreads);
+	}
+
+	WorkerPool::~WorkerPool()
+	{
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			isStopping = true;
+			tasks.clear();
+		}
+		hasTasks.notify_all();
+
+		for (auto& worker : workers)
+		{
+			worker->thread.join();
+		}
+		for (auto& worker : retiredWorkers)
+		{
+			worker->thread.join();
+		}
+	}
+
+	void WorkerPool::Submit(std::function<void()> a_task)
+	{
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			tasks.push_back(std::move(a_task));
+		}
+		hasTasks.notify_one();
+	}
+
+	uint32_t WorkerPool::GetNumberOfQueuedTasks()
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		return static_cast<uint32_t>(tasks.size());
+	}
+
+	// Called on the main thread when the MCM closes, so it never waits for a running task (a shader compile or a disk
+	// cache write can take a while)
+	void WorkerPool::Resize(uint32_t a_numberOfThreads)
+	{
+		a_numberOfThreads = std::max(a_numberOfThreads, 1u);
+
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			while (workers.size() > a_numberOfThreads)
+			{
+				workers.back()->isRetired = true;
+				retiredWorkers.push_back(std::move(workers.back()));
+				workers.pop_back();
+			}
+		}
+		hasTasks.notify_all();
+
+		std::erase_if(retiredWorkers, [&](const std::unique_ptr<Worker>& a_worker)
+		{
+			bool hasExited = false;
+			{
+				std::lock_guard<std::mutex> guard(lock);
+				hasExited = a_worker->hasExited;
+			}
+			if (hasExited) a_worker->thread.join();
+			return hasExited;
+		});
+
+		while (workers.size() < a_numberOfThreads)
+		{
+			auto worker = std::make_unique<Worker>();
+			worker->thread = std::thread([this, worker = worker.get()]() { Run(worker); });
+			workers.push_back(std::move(worker));
+		}
+	}
+
+	void WorkerPool::Run(Worker* a_worker)
+	{
+		while (true)
+		{
+			std::function<void()> task;
+			{
+				std::unique_lock<std::mutex> guard(lock);
+				hasTasks.wait(guard, [&]() { return isStopping || a_worker->isRetired || !tasks.empty(); });
+				if (isStopping || a_worker->isRetired)
+				{
+					a_worker->hasExited = true;
+					if (!tasks.empty()) hasTasks.notify_one(); // the wake up could have been meant for a worker that is still running
+					return;
+				}
+
+				task = std::move(tasks.front());
+				tasks.pop_front();
+			}
+			task();
+		}
+	}
+}
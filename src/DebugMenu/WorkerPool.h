@@ -0,0 +1,85 @@
+#pragma once
+
+namespace DebugMenu
+{
+	// Lock free handoff of results from the workers to the main thread. Any thread can push, and a single thread
+	// takes everything pushed so far, in the order it was pushed
+	template <class T>
+	class HandoffQueue
+	{
+		public:
+			HandoffQueue() = default;
+			~HandoffQueue() { TakeAll(); }
+			HandoffQueue(const HandoffQueue&) = delete;
+			HandoffQueue& operator=(const HandoffQueue&) = delete;
+
+			void Push(T a_value)
+			{
+				auto node = new Node{ std::move(a_value), head.load(std::memory_order_relaxed) };
+				while (!head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {}
+			}
+
+			std::vector<T> TakeAll()
+			{
+				std::vector<T> values;
+				Node* node = head.exchange(nullptr, std::memory_order_acquire);
+				while (node)
+				{
+					values.push_back(std::move(node->value));
+					auto next = node->next;
+					delete node;
+					node = next;
+				}
+				std::reverse(values.begin(), values.end()); // the stack is newest first
+				return values;
+			}
+
+		private:
+			struct Node
+			{
+				T		value;
+				Node*	next;
+			};
+
+			std::atomic<Node*> head{ nullptr };
+	};
+
+	// A few threads running tasks in the order they were submitted. The tasks must not touch game objects
+	// without holding a reference or a lock, since the main thread keeps running
+	class WorkerPool
+	{
+		public:
+			WorkerPool(uint32_t a_numberOfThreads);
+			~WorkerPool(); // the tasks that did not start yet are discarded
+			WorkerPool(const WorkerPool&) = delete;
+			WorkerPool& operator=(const WorkerPool&) = delete;
+
+			void		Submit(std::function<void()> a_task);
+			uint32_t	GetNumberOfQueuedTasks();
+			uint32_t	GetNumberOfThreads() const { return static_cast<uint32_t>(workers.size()); }
+			// the queued tasks are kept. The threads that are stopped finish their current task on their own,
+			// so it does not wait for them. Call from a single thread
+			void		Resize(uint32_t a_numberOfThreads);
+
+		private:
+			struct Worker
+			{
+				std::thread	thread;
+				bool		isRetired = false;	// stops once its current task is done
+				bool		hasExited = false;	// can be joined without waiting
+			};
+
+			std::vector<std::unique_ptr<Worker>>	workers;
+			std::vector<std::unique_ptr<Worker>>	retiredWorkers; // joined by Resize once they have exited, or by the destructor
+			std::mutex								lock;
+			std::condition_variable					hasTasks;
+			std::deque<std::function<void()>>		tasks;
+			bool									isStopping = false;
+
+			void Run(Worker* a_worker);
+	};
+
+	// the pool everything running on workers shares, sized by MCM::settings::workerThreads. It is destroyed
+	// (and its threads joined) before the handlers, since it is created after them
+	WorkerPool& GetWorkerPool();
+}
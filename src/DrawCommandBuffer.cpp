@@ -0,0 +1,62 @@
+#include "DrawCommandBuffer.h"
+
+uint32_t DrawCommandBuffer::GetNumberOfArguments(Opcode a_opcode)
+{
+	switch (a_opcode)
+	{
+		case Opcode::kLineStyle:	return 3;
+		case Opcode::kBeginFill:	return 2;
+		case Opcode::kMoveTo:		return 2;
+		case Opcode::kLineTo:		return 2;
+		case Opcode::kCurveTo:		return 4;
+		default:					return 0;
+	}
+}
+
+void DrawCommandBuffer::Add(Opcode a_opcode, std::initializer_list<double> a_arguments)
+{
+	data.push_back(static_cast<double>(a_opcode));
+	data.insert(data.end(), a_arguments.begin(), a_arguments.end());
+	numberOfCommands++;
+}
+
+void DrawCommandBuffer::Clear()
+{
+	Add(Opcode::kClear, {});
+}
+
+void DrawCommandBuffer::LineStyle(double a_thickness, uint32_t a_color, uint32_t a_alpha)
+{
+	Add(Opcode::kLineStyle, { a_thickness, static_cast<double>(a_color), static_cast<double>(a_alpha) });
+}
+
+void DrawCommandBuffer::BeginFill(uint32_t a_color, uint32_t a_alpha)
+{
+	Add(Opcode::kBeginFill, { static_cast<double>(a_color), static_cast<double>(a_alpha) });
+}
+
+void DrawCommandBuffer::MoveTo(double a_x, double a_y)
+{
+	Add(Opcode::kMoveTo, { a_x, a_y });
+}
+
+void DrawCommandBuffer::LineTo(double a_x, double a_y)
+{
+	Add(Opcode::kLineTo, { a_x, a_y });
+}
+
+void DrawCommandBuffer::CurveTo(double a_controlX, double a_controlY, double a_anchorX, double a_anchorY)
+{
+	Add(Opcode::kCurveTo, { a_controlX, a_controlY, a_anchorX, a_anchorY });
+}
+
+void DrawCommandBuffer::EndFill()
+{
+	Add(Opcode::kEndFill, {});
+}
+
+void DrawCommandBuffer::Reset()
+{
+	data.clear();
+	numberOfCommands = 0;
+}
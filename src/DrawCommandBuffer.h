@@ -0,0 +1,62 @@
+#pragma once
+
+// The drawing API calls of a frame, packed into one array of numbers (opcode followed by its arguments), so the
+// DrawMenu movie can replay them in a single Invoke instead of one Invoke per call.
+// The opcodes and their arguments must match DrawCommands.as
+class DrawCommandBuffer
+{
+	public:
+		enum class Opcode : uint32_t
+		{
+			kClear = 0,		// no arguments
+			kLineStyle = 1,	// thickness, color, alpha
+			kBeginFill = 2,	// color, alpha
+			kMoveTo = 3,	// x, y
+			kLineTo = 4,	// x, y
+			kCurveTo = 5,	// control x, control y, anchor x, anchor y
+			kEndFill = 6	// no arguments
+		};
+
+		static uint32_t GetNumberOfArguments(Opcode a_opcode);
+
+		void Clear();
+		void LineStyle(double a_thickness, uint32_t a_color, uint32_t a_alpha);
+		void BeginFill(uint32_t a_color, uint32_t a_alpha);
+		void MoveTo(double a_x, double a_y);
+		void LineTo(double a_x, double a_y);
+		void CurveTo(double a_controlX, double a_controlY, double a_anchorX, double a_anchorY);
+		void EndFill();
+
+		// Forgets the recorded commands, but keeps the memory for the next frame
+		void Reset();
+
+		std::span<const double>	GetData() const { return data; }
+		uint32_t				GetNumberOfCommands() const { return numberOfCommands; }
+		bool					IsEmpty() const { return numberOfCommands == 0; }
+
+		// Calls a_function(opcode, arguments) for every command, in the order they were recorded. False if the data is malformed
+		template <class F>
+		static bool ForEachCommand(std::span<const double> a_data, F&& a_function)
+		{
+			size_t position = 0;
+			while (position < a_data.size())
+			{
+				double opcodeValue = a_data[position];
+				if (!(opcodeValue >= 0.0 && opcodeValue <= static_cast<double>(Opcode::kEndFill)) || opcodeValue != std::floor(opcodeValue)) return false;
+
+				auto opcode = static_cast<Opcode>(static_cast<uint32_t>(opcodeValue));
+				uint32_t numberOfArguments = GetNumberOfArguments(opcode);
+				if (a_data.size() - position - 1 < numberOfArguments) return false;
+
+				a_function(opcode, a_data.subspan(position + 1, numberOfArguments));
+				position += 1 + numberOfArguments;
+			}
+			return true;
+		}
+
+	private:
+		std::vector<double>	data;
+		uint32_t			numberOfCommands = 0;
+
+		void Add(Opcode a_opcode, std::initializer_list<double> a_arguments);
+};
@@ -1,6 +1,8 @@
 #include "DrawHandler.h"
 #include "Linalg.h"
 #include "MCM.h"
+#include "Profiler.h"
+#include "ScreenLOD.h"
 #include "Renderer/Renderer.h"
 #include "DebugMenu/DebugMenu.h"
 #include "Interface/UIHandler.h"
@@ -75,14 +77,29 @@ void DrawHandler::GetDrawMenu()
 
 void DrawHandler::ClearScaleform()
 {
-	pointsToDraw.clear();
-	linesToDraw.clear();
-	polygonsToDraw.clear();
+	shapesToDraw.Clear();
+
+	overlay.Clear();
+	haveOverlayFillsChanged = true;
+	havePolygonsChanged = true;
+	haveMergedPolygons = false;
+	polygonGeneration++; // merges still on a worker were made from the polygons that were just cleared
+
+	pickGrid.Clear();
+	pickMetaData.clear();
+	havePickShapesChanged = true;
 }
 void DrawHandler::ClearD3D11()
 {
 	Renderer::ClearLines();
 	Renderer::ClearMeshes();
+	Renderer::ClearMeshInstances();
+}
+void DrawHandler::ClearOverlay()
+{
+	overlay.Clear();
+	haveOverlayFillsChanged = true;
+	Renderer::ClearOverlay();
 }
 
 
@@ -103,57 +120,275 @@ void DrawHandler::UpdateProjectionMatrix()
 
 void DrawHandler::Update(float a_delta)
 {
+	PROFILE_SCOPE("DrawHandler::Update");
+
 	UpdateProjectionMatrix();
+	UpdateOverlay();
+	UpdateLODThresholds();
+	UpdateMergedNavmeshPolygons();
 	g_DrawMenu->clearCanvas();
-	//auto begin = std::chrono::high_resolution_clock::now();
 
 	DrawPolygons();
 	DrawLines();
 	DrawPoints();
+	PROFILE_VALUE("DrawHandler LOD culled", lodCulled);
 	HandleInfo(a_delta);
 	if (MCM::settings::showCrosshair) DrawCrosshair();
 	if (MCM::settings::showCanvasBorder) DrawCanvasBorders();
-	
 
-	//auto end = std::chrono::high_resolution_clock::now();
-	//auto dt = std::chrono::duration_cast<std::chrono::microseconds>(end-begin).count();
-	//logger::debug("time elapesed = {} s", dt);
+	g_DrawMenu->FlushCommands();
 }
 
-bool DrawHandler::IsShapeEligibleForInfo(const ShapeData* a_shape, const RE::NiPoint2& a_pointInShape, float a_depth)
+// The overlay is drawn by the gpu, only the strokes have to be turned towards the camera again
+void DrawHandler::UpdateOverlay()
 {
-	if (!a_shape->metaData || a_shape->metaData.infoType == DrawHandler::ShapeMetaData::InfoType::kNoInfo) return false;
-	if (!MCM::settings::showInfoOnHover || ScaleformUI::GetDebugMenuUI()->IsOpen()) return false;
-	if (a_depth > MCM::settings::infoRange) return false;
+	if (!MCM::settings::useD3D || !niCamera) return;
 
-	float centerX = canvasWidth / 2;
-	float centerY = canvasHeight / 2;
-	if (a_pointInShape.x < centerX - infoRadius || 
-		a_pointInShape.x > centerX + infoRadius || 
-		a_pointInShape.y < centerY - infoRadius ||
-		a_pointInShape.y > centerY + infoRadius) return false;
+	if (overlay.HasStrokes())
+	{
+		const auto& matrix = GetProjectionMatrix();
+		glm::vec3 right{ matrix(0, 0), matrix(0, 1), matrix(0, 2) };
+		glm::vec3 up{ matrix(1, 0), matrix(1, 1), matrix(1, 2) };
 
-	return true;
+		float widthScale = GetWorldWidthPerThickness();
+		if (widthScale <= 0.0f) return;
+
+		const auto& cameraPosition = niCamera->world.translate;
+		overlay.BuildStrokes(glm::vec3{ cameraPosition.x, cameraPosition.y, cameraPosition.z }, glm::normalize(right), glm::normalize(up), widthScale);
+	}
+
+	if (haveOverlayFillsChanged || overlay.HasStrokes())
+	{
+		Renderer::SetOverlay(overlay, haveOverlayFillsChanged);
+		haveOverlayFillsChanged = false;
+	}
+}
+
+void DrawHandler::UpdateLODThresholds()
+{
+	lodCulled = 0;
+	if (MCM::settings::enableScreenLOD)
+		lodThresholds = ScreenLOD::Thresholds{ MCM::settings::lodMinArea, MCM::settings::lodMinExtent, MCM::settings::lodFullCircleRadius };
+	else
+		lodThresholds = ScreenLOD::Thresholds{}; // nothing is culled and circles get all segments
 }
 
-void DrawHandler::AddEligibleInfoPoint(float a_pointDepth, const RE::NiPoint2& a_screenPoint, ShapeMetaData a_metaData)
+// Coplanar navmesh triangles of the same style far from the camera are merged into larger polygons on a worker, the main thread only
+// copies them. Only triangles beyond the merge distance plus a margin are merged, and the queued triangles are restored and merged again
+// once the camera moves further than the margin, so a merged polygon never gets within the merge distance (which is at least the info
+// range). Picking is done on pickGrid, which holds the unmerged triangles
+void DrawHandler::UpdateMergedNavmeshPolygons()
 {
-	eligibleInfoPoints.push_back(ShowInfoData{ a_pointDepth, a_screenPoint, a_metaData});
+	// before the results are taken, so those of the polygons queued before are dropped
+	if (havePolygonsChanged)
+	{
+		havePolygonsChanged = false;
+		unmergedPolygons.assign(shapesToDraw.polygons.begin(), shapesToDraw.polygons.end());
+		unmergedPositionCount = static_cast<uint32_t>(shapesToDraw.positions.size());
+		isMergeDone = false;
+		isMergeNeeded = true;
+	}
+
+	for (auto& result : mergeResults.TakeAll())
+	{
+		isMergeQueued = false;
+		if (result.generation == polygonGeneration) ApplyMerge(result);
+		mergeScratch = std::move(result.polygons);
+		mergeStyles = std::move(result.styles);
+	}
+
+	if (!MCM::settings::enableScreenLOD || MCM::settings::lodMergeDistance <= 0.0f || !niCamera)
+	{
+		RestoreUnmergedPolygons();
+		isMergeDone = false;
+		return;
+	}
+
+	float margin = GetMergeDistance()*mergeMarginScale;
+	if (isMergeDone && niCamera->world.translate.GetSquaredDistance(mergeCameraPosition) > margin*margin)
+	{
+		RestoreUnmergedPolygons(); // until the new merge is done, the triangles are drawn as they are
+		isMergeDone = false;
+		isMergeNeeded = true;
+	}
+
+	if (isMergeNeeded && !isMergeQueued) QueueMerge();
+}
+
+float DrawHandler::GetMergeDistance() const
+{
+	return std::max(MCM::settings::lodMergeDistance, MCM::settings::infoRange);
+}
+
+void DrawHandler::QueueMerge()
+{
+	isMergeNeeded = false;
+
+	MergeResult task;
+	task.generation = polygonGeneration;
+	task.cameraPosition = niCamera->world.translate;
+	task.polygons = std::move(mergeScratch);
+	task.styles = std::move(mergeStyles);
+	task.styles.clear();
+
+	float mergeDistance = GetMergeDistance()*(1.0f + mergeMarginScale);
+	float mergeDistanceSquared = mergeDistance*mergeDistance;
+	for (uint32_t polygonIndex = 0; polygonIndex < shapesToDraw.polygons.size(); polygonIndex++)
+	{
+		const auto& polygonData = shapesToDraw.polygons[polygonIndex];
+		if (polygonData.metaData.infoType != ShapeMetaData::InfoType::kNavmesh) continue;
+
+		auto positions = shapesToDraw.GetPositions(polygonData);
+		bool isDistant = std::ranges::all_of(positions, [&](const RE::NiPoint3& a_position) { return task.cameraPosition.GetSquaredDistance(a_position) > mergeDistanceSquared; });
+		if (!isDistant) continue;
+
+		// merged polygons get more points than they had room for in the arena, so the merge works on copies
+		if (task.polygons.size() <= task.indices.size()) task.polygons.emplace_back();
+		task.polygons[task.indices.size()].assign(positions.begin(), positions.end());
+		task.indices.push_back(polygonIndex);
+		task.styles.push_back(ScreenLOD::PolygonStyle{ polygonData.color, polygonData.baseAlpha, polygonData.borderColor, polygonData.borderAlpha, polygonData.borderThickness });
+	}
+
+	isMergeQueued = true;
+	DebugMenu::GetWorkerPool().Submit([this, task = std::move(task)]() mutable
+	{
+		std::vector<std::vector<RE::NiPoint3>*> polygons;
+		polygons.reserve(task.indices.size());
+		for (uint32_t i = 0; i < task.indices.size(); i++) polygons.push_back(&task.polygons[i]);
+
+		task.merged = ScreenLOD::MergeCoplanarPolygons(polygons, task.styles);
+		mergeResults.Push(std::move(task));
+	});
+}
+
+void DrawHandler::ApplyMerge(const MergeResult& a_result)
+{
+	PROFILE_VALUE("DrawHandler LOD merged", a_result.merged);
+
+	// the camera moved too far while the worker was merging
+	float margin = GetMergeDistance()*mergeMarginScale;
+	if (niCamera && niCamera->world.translate.GetSquaredDistance(a_result.cameraPosition) > margin*margin)
+	{
+		isMergeNeeded = true;
+		return;
+	}
+
+	// the generation should already have dropped a merge of other polygons
+	if (std::ranges::any_of(a_result.indices, [&](uint32_t a_index) { return a_index >= unmergedPolygons.size(); }) || shapesToDraw.polygons.size() != unmergedPolygons.size())
+	{
+		isMergeNeeded = true;
+		return;
+	}
+
+	mergeCameraPosition = a_result.cameraPosition;
+	isMergeDone = true;
+	if (a_result.merged == 0) return;
+
+	// a polygon only changes size if something was merged into it. The grown ones are appended to the arena, and they
+	// cover several triangles so they keep the info of none
+	for (uint32_t i = 0; i < a_result.indices.size(); i++)
+	{
+		auto& polygonData = shapesToDraw.polygons[a_result.indices[i]];
+		const auto& positions = a_result.polygons[i];
+		if (positions.size() == polygonData.positionCount) continue;
+
+		polygonData.positionOffset = shapesToDraw.positions.size();
+		polygonData.positionCount = positions.size();
+		polygonData.metaData = ShapeMetaData{};
+		shapesToDraw.positions.insert(shapesToDraw.positions.end(), positions.begin(), positions.end());
+	}
+	std::erase_if(shapesToDraw.polygons, [](const PolygonData& a_polygonData) { return a_polygonData.positionCount == 0; });
+	haveMergedPolygons = true;
+}
+
+void DrawHandler::RestoreUnmergedPolygons()
+{
+	if (!haveMergedPolygons) return;
+
+	shapesToDraw.polygons.assign(unmergedPolygons.begin(), unmergedPolygons.end());
+	shapesToDraw.positions.resize(unmergedPositionCount);
+	haveMergedPolygons = false;
+}
+
+bool DrawHandler::IsOverlayBackend() const
+{
+	return backend == Backend::kD3D11 && MCM::settings::useD3D;
+}
+
+// the Scaleform shapes are thickness*pointScaleMultiplier/depth pixels wide, which is a constant width in the world. 0 without a projection
+float DrawHandler::GetWorldWidthPerThickness()
+{
+	const auto& matrix = GetProjectionMatrix();
+	RE::NiPoint3 up{ matrix(1, 0), matrix(1, 1), matrix(1, 2) };
+
+	float pixelsPerUnitAtUnitDepth = up.Length()*canvasHeight/2;
+	return pixelsPerUnitAtUnitDepth > 0.0f ? pointScaleMultiplier/pixelsPerUnitAtUnitDepth : 0.0f;
+}
+
+uint32_t DrawHandler::AddPickMetaData(const ShapeMetaData& a_metaData)
+{
+	havePickShapesChanged = true;
+	pickMetaData.push_back(a_metaData);
+	return pickMetaData.size() - 1;
+}
+
+// The ray from the camera through a point on the canvas. Its direction is scaled so t along it is the depth (the clip space w),
+// the same depth the info range is compared against. The rows of the projection are the right, up and forward axes of the camera
+Picking::Ray DrawHandler::GetPickRay(const RE::NiPoint2& a_screenPoint)
+{
+	const auto& matrix = GetProjectionMatrix();
+	RE::NiPoint3 right{ matrix(0, 0), matrix(0, 1), matrix(0, 2) };
+	RE::NiPoint3 up{ matrix(1, 0), matrix(1, 1), matrix(1, 2) };
+	RE::NiPoint3 forward{ matrix(3, 0), matrix(3, 1), matrix(3, 2) };
+
+	float ndcX = a_screenPoint.x/canvasWidth*2 - 1;
+	float ndcY = 1 - a_screenPoint.y/canvasHeight*2;
+
+	Picking::Ray ray;
+	ray.origin = niCamera->world.translate;
+	ray.direction = right*(ndcX/right.SqrLength()) + up*(ndcY/up.SqrLength()) + forward/forward.SqrLength();
+	ray.length = MCM::settings::infoRange;
+	ray.slope = 2*infoRadius/(up.Length()*canvasHeight); // infoRadius pixels, in world units at a depth of 1
+	return ray;
+}
+
+// One pick per frame, along the crosshair or along the cursor while the debug menu is open
+bool DrawHandler::PickShape(ShowInfoData& a_shape)
+{
+	if (!MCM::settings::showInfoOnHover || pickMetaData.empty() || !niCamera) return false;
+
+	RE::NiPoint2 screenPoint{ canvasWidth/2, canvasHeight/2 };
+	if (ScaleformUI::GetDebugMenuUI()->IsOpen())
+	{
+		auto cursor = RE::MenuCursor::GetSingleton();
+		if (!cursor) return false;
+		screenPoint = RE::NiPoint2(cursor->GetRuntimeData().cursorPosX, cursor->GetRuntimeData().cursorPosY);
+	}
+
+	if (havePickShapesChanged)
+	{
+		pickGrid.Build();
+		havePickShapesChanged = false;
+	}
+
+	Picking::Hit hit = pickGrid.Pick(GetPickRay(screenPoint), GetWorldWidthPerThickness());
+	PROFILE_VALUE("DrawHandler pick tests", pickGrid.GetTestsOfLastPick());
+	if (!hit) return false;
+
+	Linalg::Vector4 clipPoint = worldToClipPoint(hit.position);
+	a_shape = ShowInfoData{ clipPoint.w, PointToScreenspace(clipPoint).point, pickMetaData[hit.id] };
+	return true;
 }
 
 void DrawHandler::HandleInfo(float a_delta)
 {
-	if (!eligibleInfoPoints.empty())
+	PROFILE_SCOPE("DrawHandler::HandleInfo");
+
+	ShowInfoData closestPoint;
+	if (PickShape(closestPoint))
 	{
 		if (timeHovering > infoDelay)
 		{
-			ShowInfoData closestPoint = eligibleInfoPoints.front();
-			for (const auto& point : eligibleInfoPoints)
-			{
-				if (point.depth < closestPoint.depth)
-					closestPoint = point;
-			}
-
 			g_DrawMenu->DrawPoint(closestPoint.screenPoint, 15 * pointScaleMultiplier / closestPoint.depth, 0xFFFFFF, 100);
 
 			if (!isInfoBoxVisible)
@@ -178,88 +413,96 @@ void DrawHandler::HandleInfo(float a_delta)
 		isInfoBoxVisible = false;
 		timeHovering = 0.0f;
 	}
-
-	eligibleInfoPoints.clear();
 }
 
 void DrawHandler::DrawPoints()
 {
-	for (const auto& pointData : pointsToDraw)
+	worldPointsToTransform.clear();
+	for (const auto& pointData : shapesToDraw.points)
 	{
-		Linalg::Vector4 clipPoint = worldToClipPoint(pointData->position);
+		worldPointsToTransform.push_back(pointData.position);
+	}
+	transformedClipPoints.resize(worldPointsToTransform.size());
+	Linalg::TransformPoints(GetProjectionMatrix(), worldPointsToTransform.data(), worldPointsToTransform.size(), transformedClipPoints.data());
+
+	for (uint32_t pointIndex = 0; pointIndex < shapesToDraw.points.size(); pointIndex++)
+	{
+		const auto& pointData = shapesToDraw.points[pointIndex];
+		Linalg::Vector4 clipPoint = transformedClipPoints[pointIndex];
 
 		if (isPointOnScreen(clipPoint))
 		{
 			auto screenspaceData = PointToScreenspace(clipPoint);
-			g_DrawMenu->DrawPoint(screenspaceData.point, pointData->radius*screenspaceData.scale, pointData->color, pointData->alpha);
-			
-			float depth = clipPoint.w;
-			auto& screenPoint = screenspaceData.point;
-			if (IsShapeEligibleForInfo(pointData.get(), screenPoint, depth))
-				AddEligibleInfoPoint(depth, screenPoint, pointData->metaData);
+			float radius = pointData.radius*screenspaceData.scale;
+			if (ScreenLOD::IsPointTooSmall(radius, lodThresholds))
+			{
+				lodCulled++;
+				continue;
+			}
+			g_DrawMenu->DrawPoint(screenspaceData.point, radius, pointData.color, pointData.alpha, ScreenLOD::GetCircleSegments(radius, lodThresholds));
 		}
 	}
 }
 
 void DrawHandler::DrawLines()
 {
-	for (const auto& lineData : linesToDraw)
+	worldPointsToTransform.clear();
+	for (const auto& lineData : shapesToDraw.lines)
 	{
-		Linalg::Vector4 clipPoint1 = worldToClipPoint(lineData->start);
-		Linalg::Vector4 clipPoint2 = worldToClipPoint(lineData->end);
+		worldPointsToTransform.push_back(lineData.start);
+		worldPointsToTransform.push_back(lineData.end);
+	}
+	transformedClipPoints.resize(worldPointsToTransform.size());
+	Linalg::TransformPoints(GetProjectionMatrix(), worldPointsToTransform.data(), worldPointsToTransform.size(), transformedClipPoints.data());
+
+	for (uint32_t lineIndex = 0; lineIndex < shapesToDraw.lines.size(); lineIndex++)
+	{
+		const auto& lineData = shapesToDraw.lines[lineIndex];
+		Linalg::Vector4 clipPoint1 = transformedClipPoints[2*lineIndex];
+		Linalg::Vector4 clipPoint2 = transformedClipPoints[2*lineIndex + 1];
 
 		if (ClipLine(clipPoint1, clipPoint2))
 		{
 			auto screenspaceData1 = PointToScreenspace(clipPoint1);
 			auto screenspaceData2 = PointToScreenspace(clipPoint2);
 
-			if(lineData->isSimpleLine)
-				g_DrawMenu->DrawSimpleLine(screenspaceData1.point, screenspaceData2.point, lineData->thickness*(screenspaceData1.scale + screenspaceData2.scale)/2, lineData->color, lineData->alpha);
+			float averageWidth = lineData.thickness*(screenspaceData1.scale + screenspaceData2.scale)/2;
+			if (!lineData.isSimpleLine) averageWidth *= 2; // the thickness is a radius
+			if (ScreenLOD::IsLineTooSmall(screenspaceData1.point, screenspaceData2.point, averageWidth, lodThresholds))
+			{
+				lodCulled++;
+				continue;
+			}
+
+			if(lineData.isSimpleLine)
+				g_DrawMenu->DrawSimpleLine(screenspaceData1.point, screenspaceData2.point, lineData.thickness*(screenspaceData1.scale + screenspaceData2.scale)/2, lineData.color, lineData.alpha);
 			else
-				g_DrawMenu->DrawLine(screenspaceData1.point, screenspaceData2.point, lineData->thickness*screenspaceData1.scale, lineData->thickness*screenspaceData2.scale, lineData->color, lineData->alpha);
-
-			
-				float depth = clipPoint1.w;
-				auto& screenPoint = screenspaceData1.point;
-				if (IsShapeEligibleForInfo(lineData.get(), screenPoint, depth))
-					AddEligibleInfoPoint(depth, screenPoint, lineData->metaData);
-
-				depth = clipPoint2.w;
-				screenPoint = screenspaceData2.point;
-				if (IsShapeEligibleForInfo(lineData.get(), screenPoint, depth))
-					AddEligibleInfoPoint(depth, screenPoint, lineData->metaData);
-			
+				g_DrawMenu->DrawLine(screenspaceData1.point, screenspaceData2.point, lineData.thickness*screenspaceData1.scale, lineData.thickness*screenspaceData2.scale, lineData.color, lineData.alpha);
 		}
 	}
 }
 
 void DrawHandler::DrawPolygons()
 {
-	for (const auto& polygonData : polygonsToDraw)
-	{
-		std::vector<Linalg::Vector4> clipPoints;
-		for (const auto& position : polygonData->positions)
-		{
-			clipPoints.push_back(worldToClipPoint(position));
-		}
-
-		// number of clip points is not guaranteed to be equal the number of world points
-		if (!ClipPolygon(clipPoints)) continue; // no clipping happens if the entire polygon is off screen
+	ClipPolygons();
 
-		ScreenspacePolygon polygon = PolygonToScreenspace(clipPoints);
-		if (polygon.points.size() < 2) continue; // the polygon can only be drawn if it contains at least 3 points
-			
-		g_DrawMenu->DrawPolygon(polygon.points, polygonData->borderThickness*polygon.avgScale, polygonData->color, polygonData->baseAlpha, polygonData->borderColor, polygonData->borderAlpha);
+	for (uint32_t polygonIndex = 0; polygonIndex < shapesToDraw.polygons.size(); polygonIndex++)
+	{
+		const auto& polygonData = shapesToDraw.polygons[polygonIndex];
+		const PolygonRange& range = polygonScreenRanges[polygonIndex];
+		if (range.count < 2) continue; // the polygon can only be drawn if it contains at least 3 points
 
+		const RE::NiPoint2* points = polygonScreenPoints.data() + range.offset;
 
-		for (int i = 0; i < polygon.points.size(); i++)
+		float borderWidth = polygonData.borderAlpha > 0 ? polygonData.borderThickness*range.avgScale : 0.0f;
+		if (ScreenLOD::IsPolygonTooSmall(points, range.count, borderWidth, lodThresholds))
 		{
-			float depth = clipPoints[i].w;
-			const auto& screenPoint = polygon.points[i];
-			if (IsShapeEligibleForInfo(polygonData.get(), screenPoint, depth))
-				AddEligibleInfoPoint(depth, screenPoint, polygonData->metaData);
+			lodCulled++;
+			continue;
 		}
 
+		g_DrawMenu->DrawPolygon(points, range.count, polygonData.borderThickness*range.avgScale, polygonData.color, polygonData.baseAlpha, polygonData.borderColor, polygonData.borderAlpha);
+
 		///////////// vvv - Show info - vvv /////////////////////////////////////////////////////
 		//if (!MCM::settings::showInfoOnHover || 
 		//	isPolygonHighlighted || 
@@ -336,29 +579,17 @@ void DrawHandler::DrawCanvasBorders()
 
 DrawHandler::ScreenspacePoint DrawHandler::PointToScreenspace(const Linalg::Vector4& a_point)
 {
-	
-	float scale = pointScaleMultiplier/a_point.w;
-	float x = a_point.x/a_point.w;
-	float y = a_point.y/a_point.w;
-	x = (x + 1)/2 * canvasWidth;
-	y = (1 - y)/2 * canvasHeight;
-	return ScreenspacePoint(RE::NiPoint2(x, y), scale);
+	return PointToScreenspace(a_point.x, a_point.y, a_point.w);
 }
 
-DrawHandler::ScreenspacePolygon DrawHandler::PolygonToScreenspace(const std::vector<Linalg::Vector4>& a_points)
+DrawHandler::ScreenspacePoint DrawHandler::PointToScreenspace(float a_x, float a_y, float a_w)
 {
-	std::vector<RE::NiPoint2> screenspacePoints;
-	std::vector<float> scales;
-	float avgScale = 0;
-	for (const auto& point : a_points)
-	{
-		ScreenspacePoint spPoint = PointToScreenspace(point);
-		screenspacePoints.push_back(spPoint.point);
-		scales.push_back(spPoint.scale);
-		avgScale += spPoint.scale;
-	}
-	int n = a_points.size();
-	return ScreenspacePolygon(screenspacePoints, scales, avgScale/(n == 0 ? 1 : n));
+	float scale = pointScaleMultiplier/a_w;
+	float x = a_x/a_w;
+	float y = a_y/a_w;
+	x = (x + 1)/2 * canvasWidth;
+	y = (1 - y)/2 * canvasHeight;
+	return ScreenspacePoint(RE::NiPoint2(x, y), scale);
 }
 
 bool DrawHandler::isPointOnScreen(const Linalg::Vector4& a_clipPoint)
@@ -372,131 +603,57 @@ bool DrawHandler::isPointOnScreen(const Linalg::Vector4& a_clipPoint)
 	return false;
 }
 
-// SutherlandHodgman https://en.wikipedia.org/wiki/Sutherland%E2%80%93Hodgman_algorithm
-bool DrawHandler::ClipPolygon(std::vector<Linalg::Vector4>& a_points)
+// Transforms all queued polygons to clip space in one stream, clips them and writes the screenspace
+// points of every polygon into one arena. polygonScreenRanges[i] then refers to shapesToDraw.polygons[i]
+void DrawHandler::ClipPolygons()
 {
+	polygonClipPoints.Clear();
+	polygonClipRanges.clear();
+	polygonScreenPoints.clear();
+	polygonScreenRanges.clear();
 
-	// first if all points are at one side of the frustum, so not visible
-	bool areAllPointsBehind = true;
-	bool areAllPointsInFront = true;
-	bool areAllPointsToTheLeft = true;
-	bool areAllPointsToTheRight = true;
-	bool areAllPointsAbove = true;
-	bool areAllPointsBelow = true;
-	for (const auto& point : a_points)
+	uint32_t numberOfPoints = 0;
+	for (const auto& polygonData : shapesToDraw.polygons)
 	{
-		areAllPointsBehind		*= point.z < -point.w;
-		areAllPointsInFront		*= point.z >  point.w;
-
-		areAllPointsToTheLeft	*= point.x < -point.w*MCM::settings::canvasScale;
-		areAllPointsToTheRight	*= point.x >  point.w*MCM::settings::canvasScale;
-		areAllPointsBelow		*= point.y < -point.w*MCM::settings::canvasScale;
-		areAllPointsAbove		*= point.y >  point.w*MCM::settings::canvasScale;
+		PolygonRange range;
+		range.offset = numberOfPoints;
+		range.count = polygonData.positionCount;
+		numberOfPoints += range.count;
+		polygonClipRanges.push_back(range);
 	}
-	if (areAllPointsBehind || areAllPointsInFront || areAllPointsToTheLeft || areAllPointsToTheRight || areAllPointsAbove || areAllPointsBelow)
+
+	polygonClipPoints.Resize(numberOfPoints);
+	for (uint32_t polygonIndex = 0; polygonIndex < shapesToDraw.polygons.size(); polygonIndex++)
 	{
-		return false;
+		auto positions = shapesToDraw.GetPositions(shapesToDraw.polygons[polygonIndex]);
+		uint32_t offset = polygonClipRanges[polygonIndex].offset;
+		Linalg::TransformPoints(GetProjectionMatrix(), positions.data(), positions.size(),
+			polygonClipPoints.x.data() + offset, polygonClipPoints.y.data() + offset,
+			polygonClipPoints.z.data() + offset, polygonClipPoints.w.data() + offset);
 	}
 
-	Linalg::Vector4   leftPlane{ -1,  0,  0,  1 };
-	Linalg::Vector4  rightPlane{  1,  0,  0,  1 };
-	Linalg::Vector4 bottomPlane{  0, -1,  0,  1 };
-	Linalg::Vector4    topPlane{  0,  1,  0,  1 };
-	Linalg::Vector4   nearPlane{  0,  0, -1,  1 };
-	Linalg::Vector4    farPlane{  0,  0,  1,  1 };
-
-	Linalg::Vector4* planes[6]{ &leftPlane, &rightPlane, &bottomPlane, &topPlane, &nearPlane, &farPlane };
-
-	int sgn = 1;
-	for (int plane = 0; plane < 6; plane++)
+	for (const auto& clipRange : polygonClipRanges)
 	{
-		sgn *= -1;
-		std::vector<Linalg::Vector4> input = a_points;
-		a_points.clear();
+		PolygonRange screenRange;
+		screenRange.offset = polygonScreenPoints.size();
 
-		int n = input.size();
-		for (int i = 0; i < n; i++) // loop over all points
+		// number of clip points is not guaranteed to be equal the number of world points
+		const Clipping::VertexStream* clipped = clipper.Clip(polygonClipPoints, clipRange.offset, clipRange.count, MCM::settings::canvasScale); // nullptr if the entire polygon is off screen
+		if (clipped)
 		{
-			Linalg::Vector4 currentPoint = input[i];
-			Linalg::Vector4 prevPoint = input[i == 0 ? n-1 : i-1];
-
-			float scale = plane < 4 ? MCM::settings::canvasScale : 1;
-
-			float prevCoord = prevPoint.x;
-			float currentCoord = currentPoint.x;
-			if (plane > 1)
-			{
-				prevCoord = prevPoint.y;
-				currentCoord = currentPoint.y;
-			}
-			if (plane > 3)
-			{
-				prevCoord = prevPoint.z;
-				currentCoord = currentPoint.z;
-			}
-			float delta_w = currentPoint.w - prevPoint.w;
-
-			float t = (sgn * prevPoint.w * scale - prevCoord) / (currentCoord - prevCoord - sgn * delta_w * scale);
-			/*// ---Definitions of t for the 6 planes borders (prev point (1) --> current point (2) ) --O
-			|  (-w1 * canvasScale - x1) / ( x2 - x1 + (w2 - w1)*cavasScale );	// left					|
-			|  (+w1 * canvasScale - x1) / ( x2 - x1 - (w2 - w1)*cavasScale );	// right				|
-			|  (-w1 * canvasScale - y1) / ( y2 - y1 + (w2 - w1)*cavasScale );	// bottom				|
-			|  (+w1 * canvasScale - y1) / ( y2 - y1 - (w2 - w1)*cavasScale );	// top					|
-			|  (-w1				  - z1)	/ ( z2 - z1 + (w2 - w1)			   );	// near					|
-			|  (+w1				  - z1) / ( z2 - z1 - (w2 - w1)			   );	// top					|
-			\*/// --------------------------------------------------------------------------------------O
-
-			// we know 0 < t < 1 because current point and prev point is to either side of the plane
-			Linalg::Vector4  intersectionPoint = prevPoint + (currentPoint - prevPoint)*t;
-
-			bool isCurrentPointInside;
-			bool isPrevPointOutside;
-			if (plane == 0) // left
-			{
-				isCurrentPointInside = currentPoint.x > -currentPoint.w*MCM::settings::canvasScale;
-				isPrevPointOutside = prevPoint.x < -prevPoint.w*MCM::settings::canvasScale;
-			}
-			else if (plane == 1) // right
-			{
-				isCurrentPointInside = currentPoint.x < currentPoint.w*MCM::settings::canvasScale;
-				isPrevPointOutside = prevPoint.x > prevPoint.w * MCM::settings::canvasScale;
-			}
-			else if (plane == 2) // bottom
-			{
-				isCurrentPointInside = currentPoint.y > -currentPoint.w*MCM::settings::canvasScale;
-				isPrevPointOutside = prevPoint.y < -prevPoint.w * MCM::settings::canvasScale;
-			}
-			else if (plane == 3) // top
-			{
-				isCurrentPointInside = currentPoint.y < currentPoint.w*MCM::settings::canvasScale;
-				isPrevPointOutside = prevPoint.y > prevPoint.w*MCM::settings::canvasScale;
-			}
-			else if (plane == 4) // near
-			{
-				isCurrentPointInside = currentPoint.z > -currentPoint.w;
-				isPrevPointOutside = prevPoint.z < -prevPoint.w;
-			}
-			else // far
-			{
-				isCurrentPointInside = currentPoint.z < currentPoint.w;
-				isPrevPointOutside = prevPoint.z > prevPoint.w;
-			}
-
-			if (isCurrentPointInside)
-			{
-				if (isPrevPointOutside)
-				{
-					a_points.push_back(intersectionPoint);
-				}
-				a_points.push_back(currentPoint);
-			}
-			else if (!isPrevPointOutside)
+			float avgScale = 0;
+			uint32_t n = clipped->Size();
+			for (uint32_t i = 0; i < n; i++)
 			{
-				a_points.push_back(intersectionPoint);
+				ScreenspacePoint spPoint = PointToScreenspace(clipped->x[i], clipped->y[i], clipped->w[i]);
+				polygonScreenPoints.push_back(spPoint.point);
+				avgScale += spPoint.scale;
 			}
+			screenRange.count = n;
+			screenRange.avgScale = avgScale/(n == 0 ? 1 : n);
 		}
+		polygonScreenRanges.push_back(screenRange);
 	}
-	return true;
 }
 
 bool DrawHandler::ClipLine(Linalg::Vector4& a_point1, Linalg::Vector4& a_point2)
@@ -643,17 +800,51 @@ Linalg::Vector4 DrawHandler::worldToClipPoint(const RE::NiPoint3& a_position)
 
 void DrawHandler::DrawPoint(RE::NiPoint3 a_position, float a_scale, uint32_t a_color, uint32_t a_alpha, ShapeMetaData a_metaData)
 {
-	pointsToDraw.push_back(std::make_unique<PointData>(a_position, a_scale, a_color, a_alpha*alphaMultiplier, a_metaData));
+	if (a_metaData) pickGrid.AddSphere(a_position, a_scale, AddPickMetaData(a_metaData));
+
+	if (IsOverlayBackend())
+	{
+		overlay.AddDisc(Utils::NiToGLMVec3(a_position), a_scale, Renderer::LineVertex::PackColor(a_color, a_alpha*alphaMultiplier));
+		return;
+	}
+	shapesToDraw.points.emplace_back(a_position, a_scale, a_color, a_alpha*alphaMultiplier, a_metaData);
 }
 
 void DrawHandler::DrawLine(RE::NiPoint3 a_start, RE::NiPoint3 a_end, float a_thickness, uint32_t a_color, uint32_t a_alpha, bool a_isSimpleLine, ShapeMetaData a_metaData)
 {
-	linesToDraw.push_back(std::make_unique<LineData>(a_start, a_end, a_thickness, a_color, a_alpha*alphaMultiplier, a_isSimpleLine, a_metaData));
+	float width = a_isSimpleLine ? a_thickness : 2*a_thickness; // the thickness of the other lines is a radius
+	if (a_metaData) pickGrid.AddSegment(a_start, a_end, width/2, AddPickMetaData(a_metaData));
+
+	if (IsOverlayBackend())
+	{
+		overlay.AddLine(Utils::NiToGLMVec3(a_start), Utils::NiToGLMVec3(a_end), width, width, Renderer::LineVertex::PackColor(a_color, a_alpha*alphaMultiplier));
+		return;
+	}
+	shapesToDraw.lines.emplace_back(a_start, a_end, a_thickness, a_color, a_alpha*alphaMultiplier, a_isSimpleLine, a_metaData);
 }
 
-void DrawHandler::DrawPolygon(std::vector<RE::NiPoint3> a_positions, float a_borderThickness, uint32_t a_color, uint32_t a_baseAlpha, uint32_t a_borderAlpha, uint32_t a_borderColor, bool a_useCustomBorderColor, ShapeMetaData a_metaData)
+void DrawHandler::DrawPolygon(std::span<const RE::NiPoint3> a_positions, float a_borderThickness, uint32_t a_color, uint32_t a_baseAlpha, uint32_t a_borderAlpha, uint32_t a_borderColor, bool a_useCustomBorderColor, ShapeMetaData a_metaData)
 {
-	polygonsToDraw.push_back(std::make_unique<PolygonData>(a_positions, a_borderThickness, a_color, a_baseAlpha*alphaMultiplier, a_useCustomBorderColor ? a_borderColor : a_color, a_borderAlpha*alphaMultiplier, a_metaData));
+	if (a_metaData) pickGrid.AddPolygon(a_positions, AddPickMetaData(a_metaData));
+
+	if (IsOverlayBackend())
+	{
+		overlayPolygonPoints.clear();
+		for (auto& position : a_positions)
+		{
+			overlayPolygonPoints.push_back(Utils::NiToGLMVec3(position));
+		}
+
+		overlay.AddPolygon(overlayPolygonPoints, Renderer::LineVertex::PackColor(a_color, a_baseAlpha*alphaMultiplier));
+		if (a_borderThickness > 0 && a_borderAlpha > 0)
+			overlay.AddPolygonBorder(overlayPolygonPoints, a_borderThickness, Renderer::LineVertex::PackColor(a_useCustomBorderColor ? a_borderColor : a_color, a_borderAlpha*alphaMultiplier));
+		return;
+	}
+	// a polygon queued after a merge is added to the unmerged ones, which are merged again
+	RestoreUnmergedPolygons();
+	havePolygonsChanged = true;
+	polygonGeneration++;
+	shapesToDraw.AddPolygon(a_positions, a_borderThickness, a_color, a_baseAlpha*alphaMultiplier, a_useCustomBorderColor ? a_borderColor : a_color, a_borderAlpha*alphaMultiplier, a_metaData);
 }
 
 // not used
@@ -1,7 +1,13 @@
 #pragma once
 
 #include "Linalg.h"
+#include "Clipping.h"
 #include "DrawMenu.h"
+#include "Picking.h"
+#include "Renderer/OverlayGeometry.h"
+#include "DebugMenu/WorkerPool.h"
+#include "ScreenLOD.h"
+#include "ShapeQueue.h"
 
 class DrawHandler
 {
@@ -14,13 +20,6 @@ class DrawHandler
 			float scale;
 		};
 
-		struct ScreenspacePolygon
-		{
-			std::vector<RE::NiPoint2> points;
-			std::vector<float> scales;
-			float avgScale;
-		};
-
 		struct ShapeMetaData
 		{
 			enum class InfoType
@@ -63,59 +62,33 @@ class DrawHandler
 			}
 		};
 
-		struct ShapeData
-		{
-			ShapeMetaData metaData{};
-			ShapeData(ShapeMetaData a_metaData) : metaData(a_metaData) {}
-			ShapeData() {}
-		};
+		using Shapes		= ShapeQueue<ShapeMetaData>;
+		using ShapeData		= Shapes::ShapeData;
+		using PointData		= Shapes::PointData;
+		using LineData		= Shapes::LineData;
+		using PolygonData	= Shapes::PolygonData;
 
-		struct PointData : ShapeData
+		enum class Backend : uint32_t
 		{
-			RE::NiPoint3 position;
-			float radius;
-			uint32_t color;
-			uint32_t alpha;
-			PointData(RE::NiPoint3 a_pos, float a_radius, uint32_t a_color, uint32_t a_alpha, ShapeMetaData a_metaData) :
-				ShapeData(a_metaData), position(a_pos), radius(a_radius), color(a_color), alpha(a_alpha)
-			{}
+			kScaleform = 0,
+			kD3D11 = 1 // the Renderer overlay, falls back to Scaleform when D3D is disabled
 		};
 
-		struct LineData : ShapeData
+		// The shapes drawn while it is alive go to the backend, eg. the one selected for a debug item in the MCM
+		class ScopedBackend
 		{
-			RE::NiPoint3 start;
-			RE::NiPoint3 end;
-			float thickness;
-			uint32_t color;
-			uint32_t alpha;
-			bool isSimpleLine;
-			LineData(RE::NiPoint3 a_start, RE::NiPoint3 a_end, float a_thickness, uint32_t a_color, uint32_t a_alpha, bool a_isSimpleLine, ShapeMetaData a_metaData) :
-				ShapeData(a_metaData),
-				start(a_start), 
-				end(a_end), 
-				thickness(a_thickness), 
-				color(a_color), 
-				alpha(a_alpha), 
-				isSimpleLine(a_isSimpleLine)
-			{}
-		};
-
-		struct PolygonData : ShapeData
-		{
-			std::vector<RE::NiPoint3> positions;
-			float borderThickness;
-			uint32_t color;
-			uint32_t baseAlpha;
-			uint32_t borderColor;
-			uint32_t borderAlpha;
-			PolygonData(std::vector<RE::NiPoint3> a_positions, float a_thickness, uint32_t a_color, uint32_t a_baseAlpha, uint32_t a_borderColor, uint32_t a_borderAlpha, ShapeMetaData a_metaData) :
-				ShapeData(a_metaData),
-				positions(a_positions), 
-				borderThickness(a_thickness), 
-				color(a_color), baseAlpha(a_baseAlpha), 
-				borderColor(a_borderColor), 
-				borderAlpha(a_borderAlpha)
-			{}
+			public:
+				ScopedBackend(DrawHandler* a_drawHandler, uint32_t a_backend) : drawHandler(a_drawHandler), previous(a_drawHandler->backend)
+				{
+					drawHandler->backend = static_cast<Backend>(a_backend);
+				}
+				~ScopedBackend() { drawHandler->backend = previous; }
+				ScopedBackend(const ScopedBackend&) = delete;
+				ScopedBackend& operator=(const ScopedBackend&) = delete;
+
+			private:
+				DrawHandler*	drawHandler;
+				Backend			previous;
 		};
 
 		bool isMenuOpen = false;
@@ -145,9 +118,7 @@ class DrawHandler
 		RE::NiPointer<RE::NiCamera> niCamera;
 		RE::PlayerCamera* playerCamera;
 
-		std::vector<std::unique_ptr<PointData>>		pointsToDraw;
-		std::vector<std::unique_ptr<LineData>>		linesToDraw;
-		std::vector<std::unique_ptr<PolygonData>>	polygonsToDraw;
+		Shapes shapesToDraw; // cleared by ClearScaleform
 
 		DrawHandler();
 		void Init();
@@ -155,13 +126,14 @@ class DrawHandler
 		void Update(float a_delta);
 		void ClearScaleform();
 		void ClearD3D11();
+		void ClearOverlay(); // the overlay the renderer draws, which is otherwise only replaced by the next update
 		void UpdateCanvasScale();
 		void UpdateProjectionMatrix();
 		Linalg::Matrix4& GetProjectionMatrix();
 
 		void DrawPoint(RE::NiPoint3 a_position, float a_scale, uint32_t a_color = 0xFFFFFF, uint32_t a_alpha = 100, ShapeMetaData a_metaData = {});
 		void DrawLine(RE::NiPoint3 a_start, RE::NiPoint3 a_end, float a_thickness, uint32_t a_color = 0xFFFFFF, uint32_t a_alpha = 100, bool a_isSimpleLine = true, ShapeMetaData a_metaData = {});
-		void DrawPolygon(std::vector<RE::NiPoint3> a_positions, float a_borderThickness = 2, uint32_t a_color = 0xFFFFFF, uint32_t a_baseAlpha = 50, uint32_t a_borderAlpha = 0, uint32_t a_borderColor = 0xFFFFFF, bool a_useCustomBorderColor = false, ShapeMetaData a_metaData = {});
+		void DrawPolygon(std::span<const RE::NiPoint3> a_positions, float a_borderThickness = 2, uint32_t a_color = 0xFFFFFF, uint32_t a_baseAlpha = 50, uint32_t a_borderAlpha = 0, uint32_t a_borderColor = 0xFFFFFF, bool a_useCustomBorderColor = false, ShapeMetaData a_metaData = {});
 		
 	private:
 		struct ShowInfoData
@@ -174,16 +146,70 @@ class DrawHandler
 			const bool operator!=(ShowInfoData& a_other) const { return shapeMetaData != a_other.shapeMetaData; }
 		};
 
-		std::vector<ShowInfoData>	eligibleInfoPoints;
+		struct PolygonRange
+		{
+			uint32_t	offset = 0;
+			uint32_t	count = 0;
+			float		avgScale = 0.0f;
+		};
+
+		// the polygon buffers are cleared every update but never shrunk, so the clipper stops allocating once it has warmed up
+		Clipping::VertexStream		polygonClipPoints;		// clip space vertices of every queued polygon
+		std::vector<PolygonRange>	polygonClipRanges;		// one range per entry in shapesToDraw.polygons
+		Clipping::PolygonClipper	clipper;
+		std::vector<RE::NiPoint2>	polygonScreenPoints;	// screenspace arena for all clipped polygons
+		std::vector<PolygonRange>	polygonScreenRanges;	// one range per entry in shapesToDraw.polygons, count = 0 if culled
+
+		std::vector<RE::NiPoint3>	worldPointsToTransform;	// gathered positions of the queued points and lines
+		std::vector<Linalg::Vector4> transformedClipPoints;
+
+		Backend							backend = Backend::kScaleform;
+		Renderer::OverlayGeometry		overlay;					// shapes of the D3D11 backend, cleared with the Scaleform shapes
+		bool							haveOverlayFillsChanged = false;
+		std::vector<glm::vec3>			overlayPolygonPoints;
+
+		ScreenLOD::Thresholds					lodThresholds;
+		uint32_t								lodCulled = 0; // per update
+
+		// distant navmesh triangles merged on a worker. The indices point into shapesToDraw.polygons as it was queued
+		struct MergeResult
+		{
+			uint32_t								generation = 0;
+			RE::NiPoint3							cameraPosition{ 0.0f, 0.0f, 0.0f };
+			std::vector<uint32_t>					indices;
+			std::vector<std::vector<RE::NiPoint3>>	polygons; // one per index, empty if it was merged into another. Can have unused extra entries
+			std::vector<ScreenLOD::PolygonStyle>	styles;
+			uint32_t								merged = 0;
+		};
+
+		bool									havePolygonsChanged = false; // the distant navmesh triangles are merged again
+		uint32_t								polygonGeneration = 0; // merges of polygons queued before the last change are dropped
+		std::vector<PolygonData>				unmergedPolygons; // shapesToDraw.polygons as it was queued
+		uint32_t								unmergedPositionCount = 0;
+		bool									haveMergedPolygons = false; // shapesToDraw.polygons differs from unmergedPolygons
+		bool									isMergeDone = false; // the polygons are merged for mergeCameraPosition
+		bool									isMergeNeeded = false;
+		bool									isMergeQueued = false;
+		RE::NiPoint3							mergeCameraPosition{ 0.0f, 0.0f, 0.0f };
+		const float								mergeMarginScale = 0.25f; // of the merge distance, the camera can move this far before merging again
+		std::vector<std::vector<RE::NiPoint3>>	mergeScratch; // copies of the distant polygons, handed to the worker and back
+		std::vector<ScreenLOD::PolygonStyle>	mergeStyles;
+		DebugMenu::HandoffQueue<MergeResult>	mergeResults;
+
+		Picking::ShapeGrid			pickGrid;					// the shapes that can show info, of both backends
+		std::vector<ShapeMetaData>	pickMetaData;				// indexed by the ids in pickGrid
+		bool						havePickShapesChanged = false;
 		bool						isInfoBoxVisible = false;
-		const float					infoRadius = 16.0f; // distance from the canvas center that a point can be and still be selected to show info
+		const float					infoRadius = 16.0f; // distance in pixels from the crosshair or cursor that a point or line can be and still be picked
 		const float					infoDelay = 0.25f; // time before the infobox opens
 		float						timeHovering = 0.0f; // in seconds
 		ShowInfoData				currentInfoData;
 
 
-		bool						IsShapeEligibleForInfo(const ShapeData* a_shape, const RE::NiPoint2& a_pointInShape, float a_depth);
-		void						AddEligibleInfoPoint(float a_pointDepth, const RE::NiPoint2& a_screenPoint, ShapeMetaData metaData);
+		uint32_t					AddPickMetaData(const ShapeMetaData& a_metaData);
+		Picking::Ray				GetPickRay(const RE::NiPoint2& a_screenPoint);
+		float						GetWorldWidthPerThickness();
+		bool						PickShape(ShowInfoData& a_shape);
 		void						HandleInfo(float a_delta);
 
 
@@ -193,14 +219,22 @@ class DrawHandler
 		void							DrawPolygons();
 		void							DrawCrosshair();
 		void							DrawCanvasBorders();
+		bool							IsOverlayBackend() const;
+		void							UpdateOverlay();
+		void							UpdateLODThresholds();
+		void							UpdateMergedNavmeshPolygons();
+		float							GetMergeDistance() const;
+		void							QueueMerge();
+		void							ApplyMerge(const MergeResult& a_result);
+		void							RestoreUnmergedPolygons();
 		void							BuildProjectionMatrix();
 		Linalg::Vector4					worldToClipPoint(const RE::NiPoint3& a_position);
 		bool							isPointOnScreen(const Linalg::Vector4& a_clipPoint);
 		bool							ClipLine(Linalg::Vector4& a_point1, Linalg::Vector4& a_point2);
-		bool							ClipPolygon(std::vector<Linalg::Vector4>& a_points);
+		void							ClipPolygons();
 
 		ScreenspacePoint				PointToScreenspace(const Linalg::Vector4& a_point);
-		ScreenspacePolygon				PolygonToScreenspace(const std::vector<Linalg::Vector4>& a_points);
+		ScreenspacePoint				PointToScreenspace(float a_x, float a_y, float a_w);
 
 
 };
\ No newline at end of file
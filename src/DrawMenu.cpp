@@ -2,6 +2,7 @@
 #include "Linalg.h"
 #include "DebugMenu/DebugMenu.h"
 #include "DrawHandler.h"
+#include "Profiler.h"
 
 void DrawMenu::Register()
 {
@@ -41,15 +42,74 @@ void DrawMenu::CloseMenu()
 		UIMessageQueue->AddMessage(MENU_NAME, RE::UI_MESSAGE_TYPE::kHide, nullptr);
 }
 
+// the canvas is cleared when the commands of the frame are flushed
 void DrawMenu::clearCanvas()
 {
-	if (movie)
-	{ 
-		movie->Invoke("clear", nullptr, nullptr, 0);
+	commands.Reset();
+	commands.Clear();
+}
+
+// The frame is drawn by the replay function of the movie (DrawCommands.as) in one Invoke. Movies published
+// before it was added only have the drawing API itself, so then every command is invoked on its own
+void DrawMenu::FlushCommands()
+{
+	if (!movie || commands.IsEmpty()) return;
+
+	uint32_t numberOfInvokes = 0;
+
+	if (hasReplayFunction)
+	{
+		auto data = commands.GetData();
+
+		if (!commandArray.IsArray()) movie->CreateArray(&commandArray);
+		commandArray.SetArraySize(static_cast<uint32_t>(data.size()));
+		for (uint32_t i = 0; i < data.size(); i++)
+		{
+			commandArray.SetElement(i, RE::GFxValue(data[i]));
+		}
+
+		hasReplayFunction = movie->Invoke("replay", nullptr, &commandArray, 1);
+		numberOfInvokes++;
+		if (!hasReplayFunction)
+		{
+			logger::debug("Draw menu has no replay function, the drawing commands are invoked one by one");
+			commandArray.SetUndefined();
+		}
+	}
+
+	if (!hasReplayFunction)
+	{
+		DrawCommandBuffer::ForEachCommand(commands.GetData(), [&](DrawCommandBuffer::Opcode a_opcode, std::span<const double> a_arguments)
+		{
+			RE::GFxValue arguments[4];
+			for (size_t i = 0; i < a_arguments.size(); i++) arguments[i] = a_arguments[i];
+
+			movie->Invoke(GetDrawingFunctionName(a_opcode), nullptr, arguments, static_cast<uint32_t>(a_arguments.size()));
+			numberOfInvokes++;
+		});
+	}
+
+	PROFILE_VALUE("DrawMenu commands", commands.GetNumberOfCommands()); // the number of invokes without the replay function
+	PROFILE_VALUE("DrawMenu invokes", numberOfInvokes);
+
+	commands.Reset();
+}
+
+const char* DrawMenu::GetDrawingFunctionName(DrawCommandBuffer::Opcode a_opcode)
+{
+	switch (a_opcode)
+	{
+		case DrawCommandBuffer::Opcode::kClear:		return "clear";
+		case DrawCommandBuffer::Opcode::kLineStyle:	return "lineStyle";
+		case DrawCommandBuffer::Opcode::kBeginFill:	return "beginFill";
+		case DrawCommandBuffer::Opcode::kMoveTo:	return "moveTo";
+		case DrawCommandBuffer::Opcode::kLineTo:	return "lineTo";
+		case DrawCommandBuffer::Opcode::kCurveTo:	return "curveTo";
+		default:									return "endFill";
 	}
 }
 
-void DrawMenu::DrawPoint(RE::NiPoint2 a_position, float a_radius, uint32_t a_color, uint32_t a_alpha)
+void DrawMenu::DrawPoint(RE::NiPoint2 a_position, float a_radius, uint32_t a_color, uint32_t a_alpha, uint32_t a_segments)
 {
 	if (!movie) 
 	{
@@ -57,9 +117,10 @@ void DrawMenu::DrawPoint(RE::NiPoint2 a_position, float a_radius, uint32_t a_col
 		return;
 	}
 
-	// The angle of each of the eight segments is 45 degrees (360 divided by 8), which
-	// equals π/4 radians.
-	constexpr float angleDelta = 3.14159265359 / 4;
+	if (a_segments < 3) a_segments = 3;
+
+	// The angle of each segment is 360 degrees divided by the number of segments, eg. 45 degrees (π/4 radians) for 8.
+	const float angleDelta = 2 * 3.14159265359 / a_segments;
 
 	// Find the distance from the circle's center to the control points for the curves.
 	float ctrlDist = a_radius / cosf(angleDelta / 2.f);
@@ -67,20 +128,16 @@ void DrawMenu::DrawPoint(RE::NiPoint2 a_position, float a_radius, uint32_t a_col
 	// Initialize the angle
 	float angle = 0.f;
 
-	RE::GFxValue argsLineStyle[3]{ 0, 0, 0 };
-	movie->Invoke("lineStyle", nullptr, argsLineStyle, 3);
-
-	RE::GFxValue argsFill[2]{ a_color, a_alpha };
-	movie->Invoke("beginFill", nullptr, argsFill, 2);
+	commands.LineStyle(0, 0, 0);
+	commands.BeginFill(a_color, a_alpha);
 
 
 	// Move to the starting point, one radius to the right of the circle's center.
-	RE::GFxValue argsStartPos[2]{a_position.x + a_radius, a_position.y };
-	movie->Invoke("moveTo", nullptr, argsStartPos, 2);
+	commands.MoveTo(a_position.x + a_radius, a_position.y);
 
-	// Repeat eight times to create eight segments.
-	for (int i = 0; i < 8; ++i) {
-		// Increment the angle by angleDelta (π/4) to create the whole circle (2π).
+	// One curve per segment.
+	for (uint32_t i = 0; i < a_segments; ++i) {
+		// Increment the angle by angleDelta to create the whole circle (2π).
 		angle += angleDelta;
 
 		// The control points are derived using sine and cosine.
@@ -93,26 +150,20 @@ void DrawMenu::DrawPoint(RE::NiPoint2 a_position, float a_radius, uint32_t a_col
 		float ay = a_position.y + sinf(angle) * a_radius;
 
 		// Draw the segment.
-		RE::GFxValue argsCurveTo[4]{ rx, ry, ax, ay };
-		movie->Invoke("curveTo", nullptr, argsCurveTo, 4);
+		commands.CurveTo(rx, ry, ax, ay);
 	}
 
-	movie->Invoke("endFill", nullptr, nullptr, 0);
+	commands.EndFill();
 }
 void DrawMenu::DrawSimpleLine(RE::NiPoint2 a_start, RE::NiPoint2 a_end, float a_thickness, uint32_t a_color, uint32_t a_alpha) 
 {
 	if (!movie) return;
 
-	RE::GFxValue argsLineStyle[3]{a_thickness, a_color, a_alpha};
-	movie->Invoke("lineStyle", nullptr, argsLineStyle, 3);
-
-	RE::GFxValue argsStartPos[2]{ a_start.x, a_start.y };
-	movie->Invoke("moveTo", nullptr, argsStartPos, 2);
-
-	RE::GFxValue argsEndPos[2]{ a_end.x, a_end.y };
-	movie->Invoke("lineTo", nullptr, argsEndPos, 2);
+	commands.LineStyle(a_thickness, a_color, a_alpha);
+	commands.MoveTo(a_start.x, a_start.y);
 
-	movie->Invoke("endFill", nullptr, nullptr, 0);
+	commands.LineTo(a_end.x, a_end.y);
+	commands.EndFill();
 }
 
 
@@ -127,11 +178,8 @@ void DrawMenu::DrawLine(RE::NiPoint2 a_start, RE::NiPoint2 a_end, float a_startR
 	endDirection *=  a_endRadius/endDirection.Length();
 
 
-	RE::GFxValue argsLineStyle[3]{ 0, 0, 0 };
-	movie->Invoke("lineStyle", nullptr, argsLineStyle, 3);
-
-	RE::GFxValue argsFill[2]{ a_color, a_alpha };
-	movie->Invoke("beginFill", nullptr, argsFill, 2);
+	commands.LineStyle(0, 0, 0);
+	commands.BeginFill(a_color, a_alpha);
 
 	float ax = a_end.x + endDirection.x;
 	float ay = a_end.y + endDirection.y;
@@ -143,9 +191,7 @@ void DrawMenu::DrawLine(RE::NiPoint2 a_start, RE::NiPoint2 a_end, float a_startR
 	float sn2 = sinf(theta/2);
 
 	// Move to the starting point, one radius to the right of the circle's center.
-	RE::GFxValue argsStartPos[2]{ ax, ay };
-
-	movie->Invoke("moveTo", nullptr, argsStartPos, 2);
+	commands.MoveTo(ax, ay);
 	for (int i = 0; i < 4; ++i) {
 		float rx = a_end.x + (endDirection.x*cs2 - endDirection.y*sn2)/cs2;
 		float ry = a_end.y + (endDirection.x*sn2 + endDirection.y*cs2)/cs2;
@@ -160,8 +206,7 @@ void DrawMenu::DrawLine(RE::NiPoint2 a_start, RE::NiPoint2 a_end, float a_startR
 		ay += a_end.y;
 
 
-		RE::GFxValue argsCurveTo[4]{ rx, ry, ax, ay };
-		movie->Invoke("curveTo", nullptr, argsCurveTo, 4);
+		commands.CurveTo(rx, ry, ax, ay);
 	}
 
 	endDirection.x *= a_startRadius/a_endRadius;
@@ -170,8 +215,7 @@ void DrawMenu::DrawLine(RE::NiPoint2 a_start, RE::NiPoint2 a_end, float a_startR
 	ax = a_start.x + endDirection.x;
 	ay = a_start.y + endDirection.y;
 
-	RE::GFxValue argsNextPos[2]{ ax, ay };
-	movie->Invoke("lineTo", nullptr, argsNextPos, 2);
+	commands.LineTo(ax, ay);
 	
 	for (int i = 0; i < 4; ++i) {
 		float rx = a_start.x + (endDirection.x*cs2 - endDirection.y*sn2)/cs2;
@@ -186,55 +230,49 @@ void DrawMenu::DrawLine(RE::NiPoint2 a_start, RE::NiPoint2 a_end, float a_startR
 		ax += a_start.x;
 		ay += a_start.y;
 
-		RE::GFxValue argsCurveTo[4]{ rx, ry, ax, ay };
-		movie->Invoke("curveTo", nullptr, argsCurveTo, 4);
+		commands.CurveTo(rx, ry, ax, ay);
 	}
 
-	movie->Invoke("endFill", nullptr, nullptr, 0);
+	commands.EndFill();
 }
 
 
 void DrawMenu::DrawPolygon(const std::vector<RE::NiPoint2>& a_positions, float a_borderThickness, uint32_t a_color, uint32_t a_baseAlpha, uint32_t a_borderColor, uint32_t a_borderAlpha)
 {
-	if (!movie) return;
-	
+	DrawPolygon(a_positions.data(), a_positions.size(), a_borderThickness, a_color, a_baseAlpha, a_borderColor, a_borderAlpha);
+}
 
-	RE::GFxValue argsLineStyle[3]{ a_borderThickness, a_borderColor, a_borderAlpha};
-	movie->Invoke("lineStyle", nullptr, argsLineStyle, 3);
+void DrawMenu::DrawPolygon(const RE::NiPoint2* a_positions, size_t a_count, float a_borderThickness, uint32_t a_color, uint32_t a_baseAlpha, uint32_t a_borderColor, uint32_t a_borderAlpha)
+{
+	if (!movie || a_count == 0) return;
+	
 
-	RE::GFxValue argsFill[2]{ a_color, a_baseAlpha };
-	movie->Invoke("beginFill", nullptr, argsFill, 2);
+	commands.LineStyle(a_borderThickness, a_borderColor, a_borderAlpha);
+	commands.BeginFill(a_color, a_baseAlpha);
 
-	RE::GFxValue argsStartPos[2]{ a_positions[0].x, a_positions[0].y};
-	movie->Invoke("moveTo", nullptr, argsStartPos, 2);
+	commands.MoveTo(a_positions[0].x, a_positions[0].y);
 	
-	for (int i = 1; i < a_positions.size(); i++)
+	for (size_t i = 1; i < a_count; i++)
 	{
-		RE::GFxValue argsNextPos[2]{ a_positions[i].x, a_positions[i].y};
-		movie->Invoke("lineTo", nullptr, argsNextPos, 2);
+		commands.LineTo(a_positions[i].x, a_positions[i].y);
 	}
-	movie->Invoke("endFill", nullptr, nullptr, 0);
+	commands.EndFill();
 }
 
 void DrawMenu::DrawTriangle(RE::NiPoint2 a_positions[3], uint32_t a_color, uint32_t a_baseAlpha, uint32_t a_borderAlpha)
 {
 	if (!movie) return;
 
-	RE::GFxValue argsLineStyle[3]{ 2, a_color, a_borderAlpha};
-	movie->Invoke("lineStyle", nullptr, argsLineStyle, 3);
-
-	RE::GFxValue argsFill[2]{ a_color, a_baseAlpha };
-	movie->Invoke("beginFill", nullptr, argsFill, 2);
+	commands.LineStyle(2, a_color, a_borderAlpha);
+	commands.BeginFill(a_color, a_baseAlpha);
 
-	RE::GFxValue argsStartPos[2]{ a_positions[0].x, a_positions[0].y};
-	movie->Invoke("moveTo", nullptr, argsStartPos, 2);
+	commands.MoveTo(a_positions[0].x, a_positions[0].y);
 
 	for (uint16_t i = 1; i < 3; i++)
 	{
-		RE::GFxValue argsNextPos[2]{ a_positions[i].x, a_positions[i].y};
-		movie->Invoke("lineTo", nullptr, argsNextPos, 2);
+		commands.LineTo(a_positions[i].x, a_positions[i].y);
 	}
-	movie->Invoke("endFill", nullptr, nullptr, 0);
+	commands.EndFill();
 }
 
 
@@ -242,27 +280,18 @@ void DrawMenu::DrawSquare(RE::NiPoint2 a_leftLowerCorner, RE::NiPoint2 a_leftUpp
 {
 	if (!movie) return;
 
-	RE::GFxValue argsLineStyle[3]{ 2, a_color, a_borderAlpha};
-	movie->Invoke("lineStyle", nullptr, argsLineStyle, 3);
-
-	RE::GFxValue argsFill[2]{ a_color, a_alpha };
-	movie->Invoke("beginFill", nullptr, argsFill, 2);
-
-
-	RE::GFxValue argsStartPos[2]{ a_leftLowerCorner.x, a_leftLowerCorner.y };
-	movie->Invoke("moveTo", nullptr, argsStartPos, 2);
+	commands.LineStyle(2, a_color, a_borderAlpha);
+	commands.BeginFill(a_color, a_alpha);
 
-	RE::GFxValue argsNextPos1[2]{ a_leftUpperCorner.x, a_leftUpperCorner.y };
-	movie->Invoke("lineTo", nullptr, argsNextPos1, 2);
 
-	RE::GFxValue argsNextPos2[2]{ a_rightUpperCorner.x, a_rightUpperCorner.y };
-	movie->Invoke("lineTo", nullptr, argsNextPos2, 2);
+	commands.MoveTo(a_leftLowerCorner.x, a_leftLowerCorner.y);
+	commands.LineTo(a_leftUpperCorner.x, a_leftUpperCorner.y);
 
-	RE::GFxValue argsNextPos3[2]{ a_rightLowerCorner.x, a_rightLowerCorner.y };
-	movie->Invoke("lineTo", nullptr, argsNextPos3, 2);
+	commands.LineTo(a_rightUpperCorner.x, a_rightUpperCorner.y);
+	commands.LineTo(a_rightLowerCorner.x, a_rightLowerCorner.y);
 
 
 
 
-	movie->Invoke("endFill", nullptr, nullptr, 0);
+	commands.EndFill();
 }
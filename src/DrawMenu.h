@@ -1,17 +1,20 @@
 ﻿#pragma once
 
+#include "DrawCommandBuffer.h"
+
 class DrawMenu : public RE::IMenu
 {
 	public:
 		constexpr static const char* MENU_PATH = "DrawMenu";
 		constexpr static const char* MENU_NAME = "DrawMenu";
 
-		void DrawPoint(RE::NiPoint2 a_position, float a_radius, uint32_t a_color, uint32_t a_alpha);
+		void DrawPoint(RE::NiPoint2 a_position, float a_radius, uint32_t a_color, uint32_t a_alpha, uint32_t a_segments = 8); // fewer segments for small circles
 		void DrawSimpleLine(RE::NiPoint2 a_start, RE::NiPoint2 a_end, float a_thickness, uint32_t a_color, uint32_t a_alpha);
 		void DrawLine(RE::NiPoint2 a_start, RE::NiPoint2 a_end, float a_startRadius, float a_endRadius, uint32_t a_color, uint32_t a_alpha);
 		void DrawTriangle(RE::NiPoint2 a_positions[3], uint32_t a_color, uint32_t a_baseAlpha, uint32_t a_borderAlpha);
 		void DrawSquare(RE::NiPoint2 a_leftLowerCorner, RE::NiPoint2 a_leftUpperCorner, RE::NiPoint2 a_rightUpperCorner, RE::NiPoint2 a_rightLowerCorner, uint32_t a_color, uint32_t a_baseAlpha, uint32_t a_borderAlpha);
 		void DrawPolygon(const std::vector<RE::NiPoint2>& a_positions, float a_borderThickness, uint32_t a_color, uint32_t a_baseAlpha, uint32_t a_borderColor, uint32_t a_borderAlpha);
+		void DrawPolygon(const RE::NiPoint2* a_positions, size_t a_count, float a_borderThickness, uint32_t a_color, uint32_t a_baseAlpha, uint32_t a_borderColor, uint32_t a_borderAlpha);
 
 		float canvasWidth;
 		float canvasHeight;
@@ -50,8 +53,16 @@ class DrawMenu : public RE::IMenu
 
 
 		void clearCanvas();
+		// Replays the drawing commands of the frame in the movie
+		void FlushCommands();
 
 	private:
+		DrawCommandBuffer	commands;
+		RE::GFxValue		commandArray;				// passed to the replay function, made once and resized every frame
+		bool				hasReplayFunction = true;	// until the movie is found to not have it
+
+		static const char*	GetDrawingFunctionName(DrawCommandBuffer::Opcode a_opcode);
+
 		class Logger : public RE::GFxLog
 		{
 		public:
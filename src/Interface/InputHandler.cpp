@@ -1,5 +1,6 @@
 #include "InputHandler.h"
 #include "MCM.h"
+#include "Profiler.h"
 
 void ScaleformUI::InputHandler::Init()
 {
@@ -136,6 +137,8 @@ ScaleformUI::Size ScaleformUI::InputHandler::GetScrollDistance()
 
 void ScaleformUI::InputHandler::ProcessInputs()
 {
+	PROFILE_SCOPE("InputHandler::ProcessInputs");
+
 	auto cursor = RE::MenuCursor::GetSingleton();
 	float cursorX = cursor->cursorPosX;
 	float cursorY = cursor->cursorPosY;
@@ -1,5 +1,14 @@
 #include "Linalg.h"
 
+#include <immintrin.h>
+#ifdef _MSC_VER
+#	include <intrin.h>
+#	define TARGET_AVX2
+#else
+#	include <cpuid.h> // gcc and clang, which the host tests are built with
+#	define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
 namespace Linalg
 {
 	float& Vector4::operator[](std::size_t a_idx)
@@ -162,6 +171,208 @@ namespace Linalg
 	}
 
 
+	namespace
+	{
+		static_assert(sizeof(RE::NiPoint3) == 3*sizeof(float));
+
+		// The sums are done in the same order as Matrix4::operator*, and no fma is used, so the results match the scalar path.
+		// Both start at a_begin and return the index of the first point they didn't transform, the rest is left for the scalar loop
+		size_t TransformPointsSSE(const Matrix4& a_matrix, const float* a_points, size_t a_begin, size_t a_count, float* a_out[4])
+		{
+			__m128 m[4][4];
+			for (int row = 0; row < 4; row++)
+				for (int col = 0; col < 4; col++)
+					m[row][col] = _mm_set1_ps(a_matrix.entry[row][col]);
+
+			size_t i = a_begin;
+			for (; i + 4 <= a_count; i += 4)
+			{
+				// a = x0 y0 z0 x1, b = y1 z1 x2 y2, c = z2 x3 y3 z3
+				const float* p = a_points + 3*i;
+				__m128 a = _mm_loadu_ps(p);
+				__m128 b = _mm_loadu_ps(p + 4);
+				__m128 c = _mm_loadu_ps(p + 8);
+
+				__m128 x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+				__m128 y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+				__m128 z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), c, _MM_SHUFFLE(3, 0, 2, 0));
+
+				for (int row = 0; row < 4; row++)
+				{
+					__m128 result = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m[row][0]), _mm_mul_ps(y, m[row][1])), _mm_mul_ps(z, m[row][2])), m[row][3]);
+					_mm_storeu_ps(a_out[row] + i, result);
+				}
+			}
+			return i;
+		}
+
+		TARGET_AVX2 size_t TransformPointsAVX2(const Matrix4& a_matrix, const float* a_points, size_t a_begin, size_t a_count, float* a_out[4])
+		{
+			__m256 m[4][4];
+			for (int row = 0; row < 4; row++)
+				for (int col = 0; col < 4; col++)
+					m[row][col] = _mm256_set1_ps(a_matrix.entry[row][col]);
+
+			const __m256i stride = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+
+			size_t i = a_begin;
+			for (; i + 8 <= a_count; i += 8)
+			{
+				const float* p = a_points + 3*i;
+				__m256 x = _mm256_i32gather_ps(p,	  stride, 4);
+				__m256 y = _mm256_i32gather_ps(p + 1, stride, 4);
+				__m256 z = _mm256_i32gather_ps(p + 2, stride, 4);
+
+				for (int row = 0; row < 4; row++)
+				{
+					__m256 result = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, m[row][0]), _mm256_mul_ps(y, m[row][1])), _mm256_mul_ps(z, m[row][2])), m[row][3]);
+					_mm256_storeu_ps(a_out[row] + i, result);
+				}
+			}
+			return i;
+		}
+
+		void CPUID(int a_info[4], int a_leaf, int a_subleaf = 0)
+		{
+#ifdef _MSC_VER
+			__cpuidex(a_info, a_leaf, a_subleaf);
+#else
+			__cpuid_count(a_leaf, a_subleaf, a_info[0], a_info[1], a_info[2], a_info[3]);
+#endif
+		}
+
+		uint64_t GetXCR0()
+		{
+#ifdef _MSC_VER
+			return _xgetbv(0);
+#else
+			uint32_t low, high;
+			__asm__("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+			return (static_cast<uint64_t>(high) << 32) | low;
+#endif
+		}
+	}
+
+	bool HasAVX2()
+	{
+		static const bool hasAVX2 = []()
+		{
+			int info[4];
+			CPUID(info, 0);
+			if (info[0] < 7) return false;
+
+			CPUID(info, 1);
+			bool hasOSXSave = info[2] & (1 << 27);
+			bool hasAVX = info[2] & (1 << 28);
+			if (!hasOSXSave || !hasAVX) return false;
+			if ((GetXCR0() & 0x6) != 0x6) return false; // the os has to save the ymm registers
+
+			CPUID(info, 7);
+			return (info[1] & (1 << 5)) != 0;
+		}();
+		return hasAVX2;
+	}
+
+	void TransformPoints(const Matrix4& a_matrix, const RE::NiPoint3* a_points, size_t a_count, float* a_outX, float* a_outY, float* a_outZ, float* a_outW)
+	{
+		const float* points = reinterpret_cast<const float*>(a_points);
+		float* out[4]{ a_outX, a_outY, a_outZ, a_outW };
+
+		size_t i = HasAVX2() ? TransformPointsAVX2(a_matrix, points, 0, a_count, out) : 0;
+		i = TransformPointsSSE(a_matrix, points, i, a_count, out);
+
+		for (; i < a_count; i++)
+		{
+			Vector4 result = a_matrix*Vector4(a_points[i]);
+			a_outX[i] = result.x;
+			a_outY[i] = result.y;
+			a_outZ[i] = result.z;
+			a_outW[i] = result.w;
+		}
+	}
+
+	void TransformPoints(const Matrix4& a_matrix, const RE::NiPoint3* a_points, size_t a_count, Vector4* a_out)
+	{
+		constexpr size_t blockSize = 64;
+		float x[blockSize];
+		float y[blockSize];
+		float z[blockSize];
+		float w[blockSize];
+
+		for (size_t begin = 0; begin < a_count; begin += blockSize)
+		{
+			size_t n = std::min(blockSize, a_count - begin);
+			TransformPoints(a_matrix, a_points + begin, n, x, y, z, w);
+			for (size_t i = 0; i < n; i++)
+			{
+				a_out[begin + i] = Vector4(x[i], y[i], z[i], w[i]);
+			}
+		}
+	}
+
+	void DequantizePoints(const uint16_t* a_quantized, size_t a_count, float a_scale, const float a_offset[3], float* a_out, float a_min[3], float a_max[3])
+	{
+		// 4 points are 12 values, which fill 3 registers as [x0 y0 z0 x1] [y1 z1 x2 y2] [z2 x3 y3 z3], so no shuffles are needed
+		// as long as the offsets and the bounds follow the same pattern
+		constexpr int axes[3][4]{ { 0, 1, 2, 0 }, { 1, 2, 0, 1 }, { 2, 0, 1, 2 } };
+
+		const __m128i zero = _mm_setzero_si128();
+		const __m128 scale = _mm_set1_ps(a_scale);
+		__m128 offset[3];
+		__m128 min[3];
+		__m128 max[3];
+		for (int r = 0; r < 3; r++)
+		{
+			offset[r] = _mm_setr_ps(a_offset[axes[r][0]], a_offset[axes[r][1]], a_offset[axes[r][2]], a_offset[axes[r][3]]);
+			min[r] = _mm_setr_ps(a_min[axes[r][0]], a_min[axes[r][1]], a_min[axes[r][2]], a_min[axes[r][3]]);
+			max[r] = _mm_setr_ps(a_max[axes[r][0]], a_max[axes[r][1]], a_max[axes[r][2]], a_max[axes[r][3]]);
+		}
+
+		size_t i = 0;
+		for (; i + 4 <= a_count; i += 4)
+		{
+			const uint16_t* q = a_quantized + 3 * i;
+			__m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(q));
+			__m128i high = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(q + 8));
+
+			__m128 v[3]
+			{
+				_mm_cvtepi32_ps(_mm_unpacklo_epi16(low, zero)),
+				_mm_cvtepi32_ps(_mm_unpackhi_epi16(low, zero)),
+				_mm_cvtepi32_ps(_mm_unpacklo_epi16(high, zero))
+			};
+
+			float* out = a_out + 3 * i;
+			for (int r = 0; r < 3; r++)
+			{
+				v[r] = _mm_add_ps(_mm_mul_ps(v[r], scale), offset[r]);
+				_mm_storeu_ps(out + 4 * r, v[r]);
+				min[r] = _mm_min_ps(min[r], v[r]);
+				max[r] = _mm_max_ps(max[r], v[r]);
+			}
+		}
+
+		float lanes[4];
+		for (int r = 0; r < 3; r++)
+		{
+			_mm_storeu_ps(lanes, min[r]);
+			for (int l = 0; l < 4; l++) a_min[axes[r][l]] = std::min(a_min[axes[r][l]], lanes[l]);
+			_mm_storeu_ps(lanes, max[r]);
+			for (int l = 0; l < 4; l++) a_max[axes[r][l]] = std::max(a_max[axes[r][l]], lanes[l]);
+		}
+
+		for (; i < a_count; i++)
+		{
+			for (int axis = 0; axis < 3; axis++)
+			{
+				float value = a_quantized[3 * i + axis] * a_scale + a_offset[axis];
+				a_out[3 * i + axis] = value;
+				a_min[axis] = std::min(a_min[axis], value);
+				a_max[axis] = std::max(a_max[axis], value);
+			}
+		}
+	}
+
 	void PrintMatrix(const char* a_title, RE::NiMatrix3 a_matrix, int a_indent)
 	{
 		std::string indent(a_indent, ' ');
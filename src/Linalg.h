@@ -107,6 +107,16 @@ namespace Linalg
 
 	};
 
+	// Transforms a_count points (with w = 1) by a_matrix. Uses AVX2 or SSE depending on the cpu, and every
+	// point ends up bit-for-bit the same as a_matrix*Vector4(point)
+	void TransformPoints(const Matrix4& a_matrix, const RE::NiPoint3* a_points, size_t a_count, Vector4* a_out);
+	void TransformPoints(const Matrix4& a_matrix, const RE::NiPoint3* a_points, size_t a_count, float* a_outX, float* a_outY, float* a_outZ, float* a_outW);
+	bool HasAVX2();
+
+	// Dequantizes a_count interleaved xyz uint16 points into a_out as a_quantized * a_scale + a_offset, and grows
+	// a_min and a_max to include them. Uses SSE2, with the same result as the scalar expression
+	void DequantizePoints(const uint16_t* a_quantized, size_t a_count, float a_scale, const float a_offset[3], float* a_out, float a_min[3], float a_max[3]);
+
 	void PrintMatrix(const char* a_title, RE::NiMatrix3 a_matrix, int a_indent = 0);
 	void PrintMatrix(const char* a_title, float a_Matrix4[4][4], int a_indent = 0);
 	void PrintMatrix(const char* a_title, glm::mat4 a_Matrix4, int a_indent = 0);
@@ -3,6 +3,7 @@
 #include "DrawHandler.h"
 #include "DebugMenu/DebugMenu.h"
 #include "Interface/UIHandler.h"
+#include "Profiler.h"
 
 namespace MCM
 {
@@ -12,6 +13,7 @@ namespace MCM
 		DebugMenu::GetDrawHandler()->UpdateCanvasScale();
 		DebugMenu::GetMarkerHandler()->HideAllMarkers();
 		DebugMenu::GetCollisionHandler()->HideAllCollisions();
+		DebugMenu::GetWorkerPool().Resize(settings::workerThreads);
 		ScaleformUI::GetDebugMenuUI()->SetMenuOpenKeyCode(settings::openMenuHotkey);
 		UpdateCollisionColor();
 		if (!settings::modActive)
@@ -24,6 +26,15 @@ namespace MCM
 		}
 	}
 
+	// called by a button in the MCM
+	void DebugMenuMCM::DumpProfile(RE::TESQuest*)
+	{
+		constexpr auto profilePath = L"Data/SKSE/plugins/DebugMenu";
+
+		if (Profiler::Dump(profilePath)) logger::debug("Wrote Profile.csv and Profile.json");
+		else logger::debug("Failed to write the profile");
+	}
+
 	void DebugMenuMCM::UpdateCollisionColor()
 	{
 		float red = (MCM::settings::collisionColorInt >> 16) / 255.0f;
@@ -163,6 +174,20 @@ namespace MCM
 		ReadUInt32Setting(ini, "Advanced", "uLinesHeight",				settings::linesHeight);
 		ReadUInt32Setting(ini, "Advanced", "uCapsuleCylinderSegments",	settings::capsuleCylinderSegments);
 		ReadUInt32Setting(ini, "Advanced", "uCapsuleSphereSegments",	settings::capsuleSphereSegments);
+		ReadUInt32Setting(ini, "Advanced", "uNavmeshCacheBudget",		settings::navmeshCacheBudget);
+		ReadBoolSetting(ini, "Advanced", "bUseNavmeshDiskCache",		settings::useNavmeshDiskCache);
+		ReadUInt32Setting(ini, "Advanced", "uCollisionExtractionBudget",	settings::collisionExtractionBudget);
+		ReadUInt32Setting(ini, "Advanced", "uWorkerThreads",			settings::workerThreads);
+		ReadBoolSetting(ini, "Advanced", "bEnableProfiler",				settings::enableProfiler);
+		ReadUInt32Setting(ini, "Advanced", "uNavmeshBackend",			settings::navmeshBackend);
+		ReadUInt32Setting(ini, "Advanced", "uOcclusionBackend",			settings::occlusionBackend);
+		ReadUInt32Setting(ini, "Advanced", "uCellBorderBackend",		settings::cellBorderBackend);
+		ReadBoolSetting(ini, "Advanced", "bOverlayOcclude",				settings::overlayOcclude);
+		ReadBoolSetting(ini, "Advanced", "bEnableScreenLOD",			settings::enableScreenLOD);
+		ReadFloatSetting(ini, "Advanced", "fLodMinArea",				settings::lodMinArea);
+		ReadFloatSetting(ini, "Advanced", "fLodMinExtent",				settings::lodMinExtent);
+		ReadFloatSetting(ini, "Advanced", "fLodFullCircleRadius",		settings::lodFullCircleRadius);
+		ReadFloatSetting(ini, "Advanced", "fLodMergeDistance",			settings::lodMergeDistance);
 
 	}
 
@@ -175,6 +200,8 @@ namespace MCM
 
 		ReadSettingsFromPath(defaultSettingsPath, a_firstRead);
 		ReadSettingsFromPath(mcmPath, a_firstRead);
+
+		Profiler::SetEnabled(settings::enableProfiler);
 	}
 
 	void DebugMenuMCM::ReadBoolSetting(CSimpleIniA& a_ini, const char* a_sectionName, const char* a_varName, bool& a_var) 
@@ -210,6 +237,7 @@ namespace MCM
 	bool DebugMenuMCM::Register(RE::BSScript::IVirtualMachine* a_vm)
 	{
 		a_vm->RegisterFunction("OnConfigClose", "DebugMenuMCM", OnConfigClose);
+		a_vm->RegisterFunction("DumpProfile", "DebugMenuMCM", DumpProfile);
 
 		logger::debug("Registered DebugMenuMCM class");
 		return true;
@@ -9,6 +9,7 @@ namespace MCM
 		public:
 			static bool Register(RE::BSScript::IVirtualMachine* a_vm);
 			static void OnConfigClose(RE::TESQuest*);
+			static void DumpProfile(RE::TESQuest*);
 
 			static void ReadSettingsFromPath(std::filesystem::path a_path, bool a_firstRead);
 			static void ReadSettings(bool a_firstRead = false);
@@ -162,6 +163,20 @@ namespace MCM
 		static inline uint32_t linesHeight;
 		static inline uint32_t capsuleCylinderSegments;
 		static inline uint32_t capsuleSphereSegments;
+		static inline uint32_t navmeshCacheBudget = 64; // MB, 0 = no limit
+		static inline bool useNavmeshDiskCache = false;
+		static inline uint32_t collisionExtractionBudget = 2000; // us per update, 0 = no limit
+		static inline uint32_t workerThreads = 2; // of the shared worker pool, it is resized when the MCM is closed
+		static inline bool enableProfiler = false;
+		static inline uint32_t navmeshBackend = 0; // DrawHandler::Backend, 0 = Scaleform, 1 = D3D11 overlay
+		static inline uint32_t occlusionBackend = 0;
+		static inline uint32_t cellBorderBackend = 0;
+		static inline bool overlayOcclude = true; // D3D11 overlay shapes are hidden behind the world
+		static inline bool enableScreenLOD = true;
+		static inline float lodMinArea = 1.0f; // px^2, smaller Scaleform shapes are culled
+		static inline float lodMinExtent = 1.0f; // px
+		static inline float lodFullCircleRadius = 8.0f; // px, smaller circles get fewer segments
+		static inline float lodMergeDistance = 0.0f; // navmesh triangles further away are merged, 0 = off
 
 		// Non MCM settings
 		static inline float minRange;
@@ -0,0 +1,262 @@
+#include "Picking.h"
+
+namespace Picking
+{
+	namespace
+	{
+		RE::NiPoint3 GetPointOnRay(const Ray& a_ray, float a_t)
+		{
+			return a_ray.origin + a_ray.direction*a_t;
+		}
+	}
+
+	// Moller-Trumbore, both sides of the triangle can be hit
+	bool IntersectTriangle(const Ray& a_ray, const RE::NiPoint3& a_point1, const RE::NiPoint3& a_point2, const RE::NiPoint3& a_point3, float& a_t)
+	{
+		RE::NiPoint3 edge1 = a_point2 - a_point1;
+		RE::NiPoint3 edge2 = a_point3 - a_point1;
+		RE::NiPoint3 p = a_ray.direction.Cross(edge2);
+
+		float determinant = edge1.Dot(p);
+		if (std::abs(determinant) < 1e-12f) return false; // parallel to the triangle, or the triangle has no area
+
+		float inverseDeterminant = 1.0f/determinant;
+		RE::NiPoint3 s = a_ray.origin - a_point1;
+		float u = s.Dot(p)*inverseDeterminant;
+		if (u < 0.0f || u > 1.0f) return false;
+
+		RE::NiPoint3 q = s.Cross(edge1);
+		float v = a_ray.direction.Dot(q)*inverseDeterminant;
+		if (v < 0.0f || u + v > 1.0f) return false;
+
+		a_t = edge2.Dot(q)*inverseDeterminant;
+		return a_t > 0.0f && a_t <= a_ray.length;
+	}
+
+	// closest points of the ray and the segment, the ray clamped to its length and the segment to its ends
+	bool IntersectSegment(const Ray& a_ray, const RE::NiPoint3& a_start, const RE::NiPoint3& a_end, float a_radius, float& a_t)
+	{
+		RE::NiPoint3 segment = a_end - a_start;
+		RE::NiPoint3 offset = a_ray.origin - a_start;
+
+		float a = a_ray.direction.Dot(a_ray.direction);
+		float b = a_ray.direction.Dot(segment);
+		float c = segment.Dot(segment);
+		float d = a_ray.direction.Dot(offset);
+		float e = segment.Dot(offset);
+		if (a <= 0.0f) return false;
+		if (c <= 0.0f) return IntersectSphere(a_ray, a_start, a_radius, a_t);
+
+		float denominator = a*c - b*b;
+		float s = denominator > 1e-6f*a*c ? std::clamp((a*e - b*d)/denominator, 0.0f, 1.0f) : 0.0f; // parallel lines, any s is as close
+		float t = std::clamp((b*s - d)/a, 0.0f, a_ray.length);
+		s = std::clamp((e + b*t)/c, 0.0f, 1.0f);
+		if (t <= 0.0f) return false;
+
+		float tolerance = a_radius + a_ray.slope*t;
+		RE::NiPoint3 between = offset + a_ray.direction*t - segment*s;
+		if (between.SqrLength() > tolerance*tolerance) return false;
+
+		a_t = t;
+		return true;
+	}
+
+	bool IntersectSphere(const Ray& a_ray, const RE::NiPoint3& a_center, float a_radius, float& a_t)
+	{
+		float a = a_ray.direction.Dot(a_ray.direction);
+		if (a <= 0.0f) return false;
+
+		RE::NiPoint3 offset = a_ray.origin - a_center;
+		float t = std::clamp(-a_ray.direction.Dot(offset)/a, 0.0f, a_ray.length);
+		if (t <= 0.0f) return false;
+
+		float tolerance = a_radius + a_ray.slope*t;
+		RE::NiPoint3 between = offset + a_ray.direction*t;
+		if (between.SqrLength() > tolerance*tolerance) return false;
+
+		a_t = t;
+		return true;
+	}
+
+	void ShapeGrid::AddTriangle(const RE::NiPoint3& a_point1, const RE::NiPoint3& a_point2, const RE::NiPoint3& a_point3, uint32_t a_id)
+	{
+		Primitive primitive;
+		primitive.points[0] = a_point1;
+		primitive.points[1] = a_point2;
+		primitive.points[2] = a_point3;
+		primitive.id = a_id;
+		primitive.type = Primitive::Type::kTriangle;
+		AddPrimitive(primitive);
+	}
+
+	void ShapeGrid::AddPolygon(std::span<const RE::NiPoint3> a_points, uint32_t a_id)
+	{
+		for (size_t i = 1; i + 1 < a_points.size(); i++)
+		{
+			AddTriangle(a_points[0], a_points[i], a_points[i + 1], a_id);
+		}
+	}
+
+	void ShapeGrid::AddSegment(const RE::NiPoint3& a_start, const RE::NiPoint3& a_end, float a_radius, uint32_t a_id)
+	{
+		Primitive primitive;
+		primitive.points[0] = a_start;
+		primitive.points[1] = a_end;
+		primitive.radius = a_radius;
+		primitive.id = a_id;
+		primitive.type = Primitive::Type::kSegment;
+		AddPrimitive(primitive);
+	}
+
+	void ShapeGrid::AddSphere(const RE::NiPoint3& a_center, float a_radius, uint32_t a_id)
+	{
+		Primitive primitive;
+		primitive.points[0] = a_center;
+		primitive.radius = a_radius;
+		primitive.id = a_id;
+		primitive.type = Primitive::Type::kSphere;
+		AddPrimitive(primitive);
+	}
+
+	void ShapeGrid::Clear()
+	{
+		primitives.clear();
+		cellEntries.clear();
+		cellPrimitives.clear();
+		cells.clear();
+		lastPicked.clear();
+		maxRadius = 0.0f;
+	}
+
+	int32_t ShapeGrid::ToCell(float a_coordinate) const
+	{
+		return static_cast<int32_t>(std::floor(a_coordinate/cellSize));
+	}
+
+	uint64_t ShapeGrid::GetCellKey(int32_t a_x, int32_t a_y) const
+	{
+		return static_cast<uint64_t>(static_cast<uint32_t>(a_x)) << 32 | static_cast<uint32_t>(a_y);
+	}
+
+	// the primitive goes in every cell its bounds overlap. The radius is left out, Pick looks further around the ray instead
+	void ShapeGrid::AddPrimitive(const Primitive& a_primitive)
+	{
+		uint32_t numberOfPoints = a_primitive.type == Primitive::Type::kTriangle ? 3 : (a_primitive.type == Primitive::Type::kSegment ? 2 : 1);
+
+		float minX = a_primitive.points[0].x;
+		float maxX = a_primitive.points[0].x;
+		float minY = a_primitive.points[0].y;
+		float maxY = a_primitive.points[0].y;
+		for (uint32_t i = 1; i < numberOfPoints; i++)
+		{
+			minX = std::min(minX, a_primitive.points[i].x);
+			maxX = std::max(maxX, a_primitive.points[i].x);
+			minY = std::min(minY, a_primitive.points[i].y);
+			maxY = std::max(maxY, a_primitive.points[i].y);
+		}
+
+		uint32_t index = primitives.size();
+		for (int32_t x = ToCell(minX); x <= ToCell(maxX); x++)
+		{
+			for (int32_t y = ToCell(minY); y <= ToCell(maxY); y++)
+			{
+				cellEntries.emplace_back(GetCellKey(x, y), index);
+			}
+		}
+		maxRadius = std::max(maxRadius, a_primitive.radius);
+		primitives.push_back(a_primitive);
+	}
+
+	void ShapeGrid::Build()
+	{
+		std::ranges::sort(cellEntries);
+
+		cells.clear();
+		cellPrimitives.clear();
+		cellPrimitives.reserve(cellEntries.size());
+		for (const auto& [key, primitive] : cellEntries)
+		{
+			auto& range = cells[key];
+			if (range.count == 0) range.offset = cellPrimitives.size();
+			range.count++;
+			cellPrimitives.push_back(primitive);
+		}
+
+		lastPicked.assign(primitives.size(), 0);
+		pickCount = 0;
+	}
+
+	bool ShapeGrid::Intersect(const Primitive& a_primitive, const Ray& a_ray, float a_radiusScale, float& a_t) const
+	{
+		switch (a_primitive.type)
+		{
+		case Primitive::Type::kTriangle:
+			return IntersectTriangle(a_ray, a_primitive.points[0], a_primitive.points[1], a_primitive.points[2], a_t);
+		case Primitive::Type::kSegment:
+			return IntersectSegment(a_ray, a_primitive.points[0], a_primitive.points[1], a_primitive.radius*a_radiusScale, a_t);
+		default:
+			return IntersectSphere(a_ray, a_primitive.points[0], a_primitive.radius*a_radiusScale, a_t);
+		}
+	}
+
+	// The ray is walked one cell length at a time, and each step tests the cells around that part of the ray, widened by
+	// how far from the ray a shape can be hit. A shape is hit in the step its t is in, so the walk stops at the first step
+	// that starts beyond the closest hit so far. Shapes in several cells are only tested once per pick
+	Hit ShapeGrid::Pick(const Ray& a_ray, float a_radiusScale)
+	{
+		Hit hit;
+		testsOfLastPick = 0;
+		if (cells.empty() || a_ray.length <= 0.0f) return hit;
+
+		if (++pickCount == 0)
+		{
+			std::ranges::fill(lastPicked, 0);
+			pickCount = 1;
+		}
+
+		float horizontalLength = std::sqrt(a_ray.direction.x*a_ray.direction.x + a_ray.direction.y*a_ray.direction.y)*a_ray.length;
+		uint32_t steps = std::max(1u, static_cast<uint32_t>(std::ceil(horizontalLength/cellSize)));
+		float stepLength = a_ray.length/steps;
+
+		for (uint32_t step = 0; step < steps; step++)
+		{
+			float stepStart = stepLength*step;
+			float stepEnd = step + 1 == steps ? a_ray.length : stepLength*(step + 1);
+			if (hit.t <= stepStart) break;
+
+			RE::NiPoint3 start = GetPointOnRay(a_ray, stepStart);
+			RE::NiPoint3 end = GetPointOnRay(a_ray, stepEnd);
+			float padding = maxRadius*a_radiusScale + a_ray.slope*stepEnd;
+
+			int32_t maxX = ToCell(std::max(start.x, end.x) + padding);
+			int32_t maxY = ToCell(std::max(start.y, end.y) + padding);
+			for (int32_t x = ToCell(std::min(start.x, end.x) - padding); x <= maxX; x++)
+			{
+				for (int32_t y = ToCell(std::min(start.y, end.y) - padding); y <= maxY; y++)
+				{
+					auto cell = cells.find(GetCellKey(x, y));
+					if (cell == cells.end()) continue;
+
+					for (uint32_t i = 0; i < cell->second.count; i++)
+					{
+						uint32_t index = cellPrimitives[cell->second.offset + i];
+						if (lastPicked[index] == pickCount) continue;
+						lastPicked[index] = pickCount;
+						testsOfLastPick++;
+
+						const auto& primitive = primitives[index];
+						float t;
+						if (Intersect(primitive, a_ray, a_radiusScale, t) && t < hit.t)
+						{
+							hit.t = t;
+							hit.id = primitive.id;
+						}
+					}
+				}
+			}
+		}
+
+		if (hit) hit.position = GetPointOnRay(a_ray, hit.t);
+		return hit;
+	}
+}
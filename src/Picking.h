@@ -0,0 +1,87 @@
+#pragma once
+
+// Picking of the shapes that can show info. The shapes are bucketed in a grid over the xy plane when they are queued,
+// and a ray through the crosshair (or the cursor) only tests the shapes in the buckets it passes, nearest first.
+// Apart from the NiPoint types it does not depend on the game, so it can be tested on its own
+namespace Picking
+{
+	struct Ray
+	{
+		RE::NiPoint3	origin;
+		RE::NiPoint3	direction;		// not normalized, a point at t along the ray is at depth t
+		float			length = 0.0f;	// largest t that can be hit
+		float			slope = 0.0f;	// how far from the ray a point or line can be and still be hit, per t
+	};
+
+	struct Hit
+	{
+		float			t = std::numeric_limits<float>::max();
+		uint32_t		id = UINT32_MAX;
+		RE::NiPoint3	position;		// on the ray
+
+		explicit operator bool() const { return id != UINT32_MAX; }
+	};
+
+	// Each returns the t of the hit, or of the closest approach for lines and points. Nothing is hit behind the origin or beyond the length
+	bool	IntersectTriangle(const Ray& a_ray, const RE::NiPoint3& a_point1, const RE::NiPoint3& a_point2, const RE::NiPoint3& a_point3, float& a_t);
+	bool	IntersectSegment(const Ray& a_ray, const RE::NiPoint3& a_start, const RE::NiPoint3& a_end, float a_radius, float& a_t);
+	bool	IntersectSphere(const Ray& a_ray, const RE::NiPoint3& a_center, float a_radius, float& a_t);
+
+	class ShapeGrid
+	{
+		public:
+			explicit ShapeGrid(float a_cellSize = 512.0f) : cellSize(a_cellSize) {}
+
+			// a_id is returned in the hit, radii are multiplied by the radius scale of Pick
+			void		AddTriangle(const RE::NiPoint3& a_point1, const RE::NiPoint3& a_point2, const RE::NiPoint3& a_point3, uint32_t a_id);
+			void		AddPolygon(std::span<const RE::NiPoint3> a_points, uint32_t a_id); // convex, fanned into triangles
+			void		AddSegment(const RE::NiPoint3& a_start, const RE::NiPoint3& a_end, float a_radius, uint32_t a_id);
+			void		AddSphere(const RE::NiPoint3& a_center, float a_radius, uint32_t a_id);
+			void		Clear();
+
+			// buckets the shapes added since the last Clear, has to be called before Pick
+			void		Build();
+			// the closest shape along the ray
+			Hit			Pick(const Ray& a_ray, float a_radiusScale);
+
+			bool		IsEmpty() const { return primitives.empty(); }
+			uint32_t	GetTestsOfLastPick() const { return testsOfLastPick; }
+
+		private:
+			struct Primitive
+			{
+				enum class Type : uint8_t
+				{
+					kTriangle,
+					kSegment,
+					kSphere
+				};
+
+				RE::NiPoint3	points[3];
+				float			radius = 0.0f;
+				uint32_t		id = 0;
+				Type			type = Type::kTriangle;
+			};
+
+			struct CellRange
+			{
+				uint32_t	offset = 0;
+				uint32_t	count = 0;
+			};
+
+			float									cellSize;
+			float									maxRadius = 0.0f;
+			std::vector<Primitive>					primitives;
+			std::vector<std::pair<uint64_t, uint32_t>>	cellEntries;	// cell key and primitive, sorted by Build
+			std::vector<uint32_t>					cellPrimitives;
+			std::unordered_map<uint64_t, CellRange>	cells;
+			std::vector<uint32_t>					lastPicked;		// per primitive, the pick that last tested it
+			uint32_t								pickCount = 0;
+			uint32_t								testsOfLastPick = 0;
+
+			int32_t		ToCell(float a_coordinate) const;
+			uint64_t	GetCellKey(int32_t a_x, int32_t a_y) const;
+			void		AddPrimitive(const Primitive& a_primitive);
+			bool		Intersect(const Primitive& a_primitive, const Ray& a_ray, float a_radiusScale, float& a_t) const;
+	};
+}
@@ -0,0 +1,314 @@
+#include "Profiler.h"
+
+namespace Profiler
+{
+	namespace
+	{
+		const auto epoch = std::chrono::steady_clock::now();
+
+		// zones are never removed, so the references handed out stay valid
+		std::mutex							zonesLock;
+		std::deque<Zone>					zones;
+		std::unordered_map<std::string, Zone*>	zonesByName;
+
+		std::string EscapeJSON(std::string_view a_string)
+		{
+			std::string escaped;
+			escaped.reserve(a_string.size());
+			for (char character : a_string)
+			{
+				if (character == '"' || character == '\\') escaped.push_back('\\');
+				if (static_cast<unsigned char>(character) < 0x20) continue;
+				escaped.push_back(character);
+			}
+			return escaped;
+		}
+
+		bool WriteFile(const std::filesystem::path& a_path, const std::string& a_contents)
+		{
+			std::ofstream stream(a_path, std::ios::binary | std::ios::trunc);
+			stream.write(a_contents.data(), a_contents.size());
+			return static_cast<bool>(stream);
+		}
+	}
+
+	QuantileEstimator::QuantileEstimator(double a_quantile) :
+		quantile(a_quantile)
+	{
+		desiredPositions = { 1.0, 1.0 + 2.0 * quantile, 1.0 + 4.0 * quantile, 3.0 + 2.0 * quantile, 5.0 };
+		increments = { 0.0, quantile / 2.0, quantile, (1.0 + quantile) / 2.0, 1.0 };
+	}
+
+	void QuantileEstimator::Add(double a_value)
+	{
+		// the first 5 values are the initial markers
+		if (count < 5)
+		{
+			heights[count++] = a_value;
+			if (count == 5)
+			{
+				std::sort(heights.begin(), heights.end());
+				positions = { 1.0, 2.0, 3.0, 4.0, 5.0 };
+			}
+			return;
+		}
+		count++;
+
+		int cell = 0;
+		if (a_value < heights[0])
+		{
+			heights[0] = a_value;
+			cell = 0;
+		}
+		else if (a_value >= heights[4])
+		{
+			heights[4] = a_value;
+			cell = 3;
+		}
+		else
+		{
+			while (cell < 3 && a_value >= heights[cell + 1]) cell++;
+		}
+
+		for (int i = cell + 1; i < 5; i++) positions[i] += 1.0;
+		for (int i = 0; i < 5; i++) desiredPositions[i] += increments[i];
+
+		// move the middle markers towards their desired positions, when they can move without passing a neighbour
+		for (int i = 1; i < 4; i++)
+		{
+			double offset = desiredPositions[i] - positions[i];
+			if ((offset >= 1.0 && positions[i + 1] - positions[i] > 1.0) || (offset <= -1.0 && positions[i - 1] - positions[i] < -1.0))
+			{
+				int direction = offset > 0.0 ? 1 : -1;
+				double height = Parabolic(i, direction);
+				if (heights[i - 1] < height && height < heights[i + 1]) heights[i] = height;
+				else heights[i] = Linear(i, direction);
+				positions[i] += direction;
+			}
+		}
+	}
+
+	double QuantileEstimator::Parabolic(int a_index, double a_direction) const
+	{
+		const auto& n = positions;
+		const auto& q = heights;
+		int i = a_index;
+		return q[i] + a_direction / (n[i + 1] - n[i - 1]) *
+			((n[i] - n[i - 1] + a_direction) * (q[i + 1] - q[i]) / (n[i + 1] - n[i]) +
+			 (n[i + 1] - n[i] - a_direction) * (q[i] - q[i - 1]) / (n[i] - n[i - 1]));
+	}
+
+	double QuantileEstimator::Linear(int a_index, int a_direction) const
+	{
+		return heights[a_index] + a_direction * (heights[a_index + a_direction] - heights[a_index]) / (positions[a_index + a_direction] - positions[a_index]);
+	}
+
+	double QuantileEstimator::Get() const
+	{
+		if (count == 0) return 0.0;
+		if (count >= 5) return heights[2];
+
+		// too few values for the markers, so the quantile is taken directly
+		std::array<double, 5> sorted = heights;
+		std::sort(sorted.begin(), sorted.begin() + count);
+		return sorted[static_cast<size_t>(std::round(quantile * (count - 1)))];
+	}
+
+	void SampleRing::Record(const Sample& a_sample)
+	{
+		uint64_t position = writePosition.fetch_add(1, std::memory_order_relaxed);
+		auto& slot = slots[position % capacity];
+
+		slot.sequence.store(writing, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		slot.start.store(a_sample.start, std::memory_order_relaxed);
+		slot.value.store(a_sample.value, std::memory_order_relaxed);
+		slot.threadID.store(a_sample.threadID, std::memory_order_relaxed);
+		slot.sequence.store(position + 1, std::memory_order_release);
+	}
+
+	uint64_t SampleRing::Read(uint64_t a_position, std::vector<Sample>& a_output, uint64_t& a_dropped) const
+	{
+		uint64_t end = writePosition.load(std::memory_order_acquire);
+		if (end - a_position > capacity)
+		{
+			a_dropped += end - a_position - capacity;
+			a_position = end - capacity;
+		}
+
+		for (; a_position < end; a_position++)
+		{
+			const auto& slot = slots[a_position % capacity];
+
+			uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+			if (sequence == writing || sequence < a_position + 1) break; // not written yet, continue from here next time
+			if (sequence > a_position + 1)
+			{
+				a_dropped++;
+				continue;
+			}
+
+			Sample sample{ slot.start.load(std::memory_order_relaxed), slot.value.load(std::memory_order_relaxed), slot.threadID.load(std::memory_order_relaxed) };
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (slot.sequence.load(std::memory_order_relaxed) != sequence)
+			{
+				a_dropped++;
+				continue;
+			}
+			a_output.push_back(sample);
+		}
+		return a_position;
+	}
+
+	Zone::Zone(std::string a_name, ZoneType a_type) :
+		name(std::move(a_name)), type(a_type)
+	{
+	}
+
+	uint32_t Zone::GetThreadID()
+	{
+		thread_local const uint32_t threadID = static_cast<uint32_t>(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+		return threadID;
+	}
+
+	ZoneStats Zone::GetStats() const
+	{
+		ZoneStats result = stats;
+		result.p50 = p50.Get();
+		result.p95 = p95.Get();
+		result.p99 = p99.Get();
+		return result;
+	}
+
+	void Zone::Collect()
+	{
+		std::vector<Sample> samples;
+		readPosition = ring.Read(readPosition, samples, stats.dropped);
+
+		for (const auto& sample : samples)
+		{
+			if (stats.count == 0 || sample.value < stats.min) stats.min = sample.value;
+			if (stats.count == 0 || sample.value > stats.max) stats.max = sample.value;
+			stats.count++;
+			stats.sum += static_cast<double>(sample.value);
+
+			p50.Add(static_cast<double>(sample.value));
+			p95.Add(static_cast<double>(sample.value));
+			p99.Add(static_cast<double>(sample.value));
+		}
+	}
+
+	std::vector<Sample> Zone::GetRecentSamples() const
+	{
+		std::vector<Sample> samples;
+		uint64_t dropped = 0;
+		uint64_t end = ring.GetWritePosition();
+		ring.Read(end > SampleRing::capacity ? end - SampleRing::capacity : 0, samples, dropped);
+		return samples;
+	}
+
+	void Zone::Reset()
+	{
+		readPosition = ring.GetWritePosition();
+		stats = {};
+		p50 = QuantileEstimator(0.50);
+		p95 = QuantileEstimator(0.95);
+		p99 = QuantileEstimator(0.99);
+	}
+
+	void SetEnabled(bool a_enable)
+	{
+		if (a_enable && !IsEnabled()) Reset();
+		isEnabled.store(a_enable, std::memory_order_relaxed);
+	}
+
+	Zone& GetZone(std::string_view a_name, ZoneType a_type)
+	{
+		std::lock_guard<std::mutex> guard(zonesLock);
+		auto it = zonesByName.find(std::string(a_name));
+		if (it != zonesByName.end()) return *it->second;
+
+		auto& zone = zones.emplace_back(std::string(a_name), a_type);
+		zonesByName.emplace(zone.GetName(), &zone);
+		return zone;
+	}
+
+	int64_t Now()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+	}
+
+	void Collect()
+	{
+		if (!IsEnabled()) return;
+
+		std::lock_guard<std::mutex> guard(zonesLock);
+		for (auto& zone : zones) zone.Collect();
+	}
+
+	void Reset()
+	{
+		std::lock_guard<std::mutex> guard(zonesLock);
+		for (auto& zone : zones) zone.Reset();
+	}
+
+	std::string ToCSV()
+	{
+		std::string csv = "zone,type,count,dropped,min,mean,p50,p95,p99,max\n";
+
+		std::lock_guard<std::mutex> guard(zonesLock);
+		for (const auto& zone : zones)
+		{
+			auto stats = zone.GetStats();
+			if (stats.count == 0) continue;
+
+			bool isTimer = zone.GetType() == ZoneType::kTimer;
+			double scale = isTimer ? 1e-3 : 1.0; // ns to us
+			csv += fmt::format("\"{}\",{},{},{},{:.3f},{:.3f},{:.3f},{:.3f},{:.3f},{:.3f}\n", zone.GetName(), isTimer ? "us" : "value", stats.count, stats.dropped,
+				stats.min * scale, stats.Mean() * scale, stats.p50 * scale, stats.p95 * scale, stats.p99 * scale, stats.max * scale);
+		}
+		return csv;
+	}
+
+	std::string ToChromeTrace()
+	{
+		std::string json = "{\"traceEvents\":[";
+		bool isFirstEvent = true;
+
+		std::lock_guard<std::mutex> guard(zonesLock);
+		for (const auto& zone : zones)
+		{
+			auto name = EscapeJSON(zone.GetName());
+			for (const auto& sample : zone.GetRecentSamples())
+			{
+				if (!isFirstEvent) json += ",";
+				isFirstEvent = false;
+
+				// the timestamps of the format are in us
+				if (zone.GetType() == ZoneType::kTimer)
+				{
+					json += fmt::format("\n{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}", name, sample.threadID, sample.start * 1e-3, sample.value * 1e-3);
+				}
+				else
+				{
+					json += fmt::format("\n{{\"name\":\"{}\",\"ph\":\"C\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"args\":{{\"value\":{}}}}}", name, sample.threadID, sample.start * 1e-3, sample.value);
+				}
+			}
+		}
+
+		json += "\n],\"displayTimeUnit\":\"ms\"}\n";
+		return json;
+	}
+
+	bool Dump(const std::filesystem::path& a_directory)
+	{
+		Collect();
+
+		std::error_code error;
+		std::filesystem::create_directories(a_directory, error);
+
+		bool hasWrittenCSV = WriteFile(a_directory / L"Profile.csv", ToCSV());
+		bool hasWrittenTrace = WriteFile(a_directory / L"Profile.json", ToChromeTrace());
+		return hasWrittenCSV && hasWrittenTrace;
+	}
+}
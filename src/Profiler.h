@@ -0,0 +1,169 @@
+#pragma once
+
+// Always compiled profiler. While it is disabled a zone only costs a relaxed load, while it is enabled a sample is
+// a few stores into the ring buffer of the zone, from any thread. The samples are folded into the statistics by
+// Collect, which runs once per frame on the main thread, so recording never takes a lock.
+// The core does not depend on the game, so it can be used and tested on its own
+namespace Profiler
+{
+	// Streaming estimate of a single quantile in constant memory, with the P-square algorithm (Jain & Chlamtac, 1985)
+	class QuantileEstimator
+	{
+		public:
+			QuantileEstimator(double a_quantile);
+
+			void		Add(double a_value);
+			double		Get() const; // 0 if nothing was added
+			uint64_t	GetCount() const { return count; }
+
+		private:
+			double					quantile;
+			uint64_t				count = 0;
+			std::array<double, 5>	heights{};
+			std::array<double, 5>	positions{};
+			std::array<double, 5>	desiredPositions{};
+			std::array<double, 5>	increments{};
+
+			double Parabolic(int a_index, double a_direction) const;
+			double Linear(int a_index, int a_direction) const;
+	};
+
+	struct Sample
+	{
+		int64_t		start = 0;	// ns since the profiler started
+		int64_t		value = 0;	// duration in ns for timers, the recorded value for counters
+		uint32_t	threadID = 0;
+	};
+
+	// Fixed size buffer of the latest samples. Any number of threads can record, a single thread reads.
+	// Every slot is guarded by a sequence number, so the reader skips slots that are overwritten while it reads them
+	class SampleRing
+	{
+		public:
+			static constexpr uint32_t capacity = 2048;
+
+			void		Record(const Sample& a_sample);
+			// Reads the samples from a_position up to the last complete one, and returns the position to continue from.
+			// Samples that were already overwritten are counted in a_dropped
+			uint64_t	Read(uint64_t a_position, std::vector<Sample>& a_output, uint64_t& a_dropped) const;
+			uint64_t	GetWritePosition() const { return writePosition.load(std::memory_order_acquire); }
+
+		private:
+			static constexpr uint64_t writing = UINT64_MAX;
+
+			struct Slot
+			{
+				std::atomic<uint64_t>	sequence = 0; // position + 1 once written
+				std::atomic<int64_t>	start = 0;
+				std::atomic<int64_t>	value = 0;
+				std::atomic<uint32_t>	threadID = 0;
+			};
+
+			std::atomic<uint64_t>				writePosition = 0;
+			std::unique_ptr<Slot[]>				slots = std::make_unique<Slot[]>(capacity);
+	};
+
+	enum class ZoneType
+	{
+		kTimer,
+		kCounter
+	};
+
+	struct ZoneStats
+	{
+		uint64_t	count = 0;
+		uint64_t	dropped = 0; // recorded faster than they were collected
+		int64_t		min = 0;
+		int64_t		max = 0;
+		double		sum = 0.0;
+		double		p50 = 0.0;
+		double		p95 = 0.0;
+		double		p99 = 0.0;
+
+		double Mean() const { return count > 0 ? sum / count : 0.0; }
+	};
+
+	class Zone
+	{
+		public:
+			Zone(std::string a_name, ZoneType a_type);
+
+			const std::string&	GetName() const { return name; }
+			ZoneType			GetType() const { return type; }
+			ZoneStats			GetStats() const;
+
+			void				Record(int64_t a_start, int64_t a_value) { ring.Record(Sample{ a_start, a_value, GetThreadID() }); }
+			// Folds the samples recorded since the last call into the statistics. Main thread only
+			void				Collect();
+			// The samples still in the ring buffer, oldest first
+			std::vector<Sample>	GetRecentSamples() const;
+			void				Reset();
+
+			static uint32_t		GetThreadID();
+
+		private:
+			std::string			name;
+			ZoneType			type;
+			SampleRing			ring;
+			uint64_t			readPosition = 0;
+
+			ZoneStats			stats;
+			QuantileEstimator	p50{ 0.50 };
+			QuantileEstimator	p95{ 0.95 };
+			QuantileEstimator	p99{ 0.99 };
+	};
+
+	inline std::atomic<bool> isEnabled = false;
+
+	inline bool	IsEnabled() { return isEnabled.load(std::memory_order_relaxed); }
+	void		SetEnabled(bool a_enable); // the statistics are reset when it is enabled
+
+	// The zone with the name, created on first use. The reference stays valid until the plugin unloads
+	Zone&		GetZone(std::string_view a_name, ZoneType a_type = ZoneType::kTimer);
+	int64_t		Now(); // ns since the profiler started
+
+	// Once per frame, from the main thread
+	void		Collect();
+	void		Reset();
+
+	// One row per zone; timers are in us
+	std::string	ToCSV();
+	// The recent samples in the Chrome trace event format, for chrome://tracing or Perfetto
+	std::string	ToChromeTrace();
+	// Collects, then writes Profile.csv and Profile.json to the directory. False if a file could not be written
+	bool		Dump(const std::filesystem::path& a_directory);
+
+	class ScopedTimer
+	{
+		public:
+			ScopedTimer(Zone& a_zone) : zone(IsEnabled() ? &a_zone : nullptr), start(zone ? Now() : 0) {}
+			~ScopedTimer() { if (zone) zone->Record(start, Now() - start); }
+			ScopedTimer(const ScopedTimer&) = delete;
+			ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+		private:
+			Zone*	zone;
+			int64_t	start;
+	};
+
+	inline void RecordValue(Zone& a_zone, int64_t a_value)
+	{
+		if (IsEnabled()) a_zone.Record(Now(), a_value);
+	}
+}
+
+#define PROFILER_CONCAT_INNER(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_INNER(a, b)
+
+// Times the rest of the scope. The zone is looked up once, the first time the line runs
+#define PROFILE_SCOPE(name)																						\
+	static Profiler::Zone& PROFILER_CONCAT(profilerZone, __LINE__) = Profiler::GetZone(name);					\
+	Profiler::ScopedTimer PROFILER_CONCAT(profilerTimer, __LINE__)(PROFILER_CONCAT(profilerZone, __LINE__))
+
+// Records a value (eg. a count per frame) in a counter zone
+#define PROFILE_VALUE(name, value)																				\
+	do																											\
+	{																											\
+		static Profiler::Zone& profilerCounter = Profiler::GetZone(name, Profiler::ZoneType::kCounter);			\
+		Profiler::RecordValue(profilerCounter, static_cast<int64_t>(value));									\
+	} while (false)
@@ -0,0 +1,332 @@
+#include "QuickHull.h"
+
+namespace Utils
+{
+	QuickHull::QuickHull(const std::vector<glm::dvec3>& a_points) : points(a_points)
+	{
+		// the vertices are floats, so anything within float precision of a plane is treated as being on it
+		glm::dvec3 maxAbs{ 0.0 };
+		for (const auto& point : points)
+		{
+			maxAbs = glm::max(maxAbs, glm::abs(point));
+		}
+		epsilon = 3.0 * std::numeric_limits<float>::epsilon() * (maxAbs.x + maxAbs.y + maxAbs.z);
+		mergeEpsilon = 10.0 * epsilon;
+	}
+
+	uint32_t QuickHull::AddFace(uint16_t a_vertex1, uint16_t a_vertex2, uint16_t a_vertex3)
+	{
+		Face face{ { a_vertex1, a_vertex2, a_vertex3 } };
+
+		auto cross = glm::cross(points[a_vertex2] - points[a_vertex1], points[a_vertex3] - points[a_vertex1]);
+		auto length = glm::length(cross);
+		face.area = length / 2.0;
+		face.normal = length > 0.0 ? cross / length : glm::dvec3{ 0.0 };
+		face.offset = glm::dot(face.normal, points[a_vertex1]);
+
+		uint32_t index = static_cast<uint32_t>(faces.size());
+		for (int i = 0; i < 3; i++)
+		{
+			// an edge used twice in the same direction means the visible faces were not a disc
+			if (!edges.emplace(EdgeKey(face.vertices[i], face.vertices[(i + 1) % 3]), index).second) isValid = false;
+		}
+		faces.push_back(std::move(face));
+		return index;
+	}
+
+	void QuickHull::RemoveFace(uint32_t a_face)
+	{
+		auto& face = faces[a_face];
+		face.isRemoved = true;
+		for (int i = 0; i < 3; i++)
+		{
+			auto edge = edges.find(EdgeKey(face.vertices[i], face.vertices[(i + 1) % 3]));
+			if (edge != edges.end() && edge->second == a_face) edges.erase(edge);
+		}
+	}
+
+	uint32_t QuickHull::GetNeighbour(uint32_t a_face, int a_edge) const
+	{
+		const auto& face = faces[a_face];
+		auto twin = edges.find(EdgeKey(face.vertices[(a_edge + 1) % 3], face.vertices[a_edge]));
+		return twin != edges.end() ? twin->second : UINT32_MAX;
+	}
+
+	void QuickHull::AssignPoints(const std::vector<uint16_t>& a_points, const std::vector<uint32_t>& a_faces)
+	{
+		for (auto point : a_points)
+		{
+			double maxDistance = epsilon;
+			uint32_t bestFace = UINT32_MAX;
+			for (auto face : a_faces)
+			{
+				double distance = faces[face].Distance(points[point]);
+				if (distance > maxDistance)
+				{
+					maxDistance = distance;
+					bestFace = face;
+				}
+			}
+			// points below all faces are inside the hull and are dropped
+			if (bestFace != UINT32_MAX) faces[bestFace].outside.push_back(point);
+		}
+	}
+
+	bool QuickHull::BuildInitialSimplex()
+	{
+		if (points.size() < 4) return false;
+
+		// the two points furthest apart among the extreme points of each axis
+		std::array<uint16_t, 6> extremes{};
+		for (uint16_t i = 0; i < points.size(); i++)
+		{
+			for (int axis = 0; axis < 3; axis++)
+			{
+				if (points[i][axis] < points[extremes[2 * axis]][axis]) extremes[2 * axis] = i;
+				if (points[i][axis] > points[extremes[2 * axis + 1]][axis]) extremes[2 * axis + 1] = i;
+			}
+		}
+
+		uint16_t v1 = 0;
+		uint16_t v2 = 0;
+		double maxDistance = 0.0;
+		for (auto a : extremes)
+		{
+			for (auto b : extremes)
+			{
+				double distance = glm::distance(points[a], points[b]);
+				if (distance > maxDistance)
+				{
+					maxDistance = distance;
+					v1 = a;
+					v2 = b;
+				}
+			}
+		}
+		if (maxDistance <= epsilon) return false;
+
+		// the point furthest from the line through v1 and v2
+		uint16_t v3 = 0;
+		auto direction = glm::normalize(points[v2] - points[v1]);
+		maxDistance = 0.0;
+		for (uint16_t i = 0; i < points.size(); i++)
+		{
+			double distance = glm::length(glm::cross(points[i] - points[v1], direction));
+			if (distance > maxDistance)
+			{
+				maxDistance = distance;
+				v3 = i;
+			}
+		}
+		if (maxDistance <= epsilon) return false;
+
+		// the point furthest from the plane through v1, v2 and v3
+		uint16_t v4 = 0;
+		auto normal = glm::normalize(glm::cross(points[v2] - points[v1], points[v3] - points[v1]));
+		double signedDistance = 0.0;
+		for (uint16_t i = 0; i < points.size(); i++)
+		{
+			double distance = glm::dot(normal, points[i] - points[v1]);
+			if (std::abs(distance) > std::abs(signedDistance))
+			{
+				signedDistance = distance;
+				v4 = i;
+			}
+		}
+		if (std::abs(signedDistance) <= epsilon) return false;
+
+		// v4 has to be below the first face for all faces to point outwards
+		if (signedDistance > 0.0) std::swap(v2, v3);
+
+		AddFace(v1, v2, v3);
+		AddFace(v1, v4, v2);
+		AddFace(v2, v4, v3);
+		AddFace(v3, v4, v1);
+
+		std::vector<uint16_t> remainingPoints;
+		for (uint16_t i = 0; i < points.size(); i++)
+		{
+			if (i != v1 && i != v2 && i != v3 && i != v4) remainingPoints.push_back(i);
+		}
+		AssignPoints(remainingPoints, { 0, 1, 2, 3 });
+		return true;
+	}
+
+	void QuickHull::AddPoint(uint32_t a_face, uint16_t a_eyePoint)
+	{
+		const auto& eye = points[a_eyePoint];
+
+		// walk from the face the point was assigned to over all faces that can see it. The edges between
+		// visible and hidden faces form the horizon, which is connected to the point
+		std::vector<uint32_t> visibleFaces{ a_face };
+		std::vector<std::pair<uint16_t, uint16_t>> horizon;
+		faces[a_face].isRemoved = true;
+
+		for (size_t i = 0; i < visibleFaces.size(); i++)
+		{
+			for (int edge = 0; edge < 3; edge++)
+			{
+				auto neighbour = GetNeighbour(visibleFaces[i], edge);
+				if (neighbour == UINT32_MAX)
+				{
+					isValid = false;
+					return;
+				}
+				if (faces[neighbour].isRemoved) continue;
+
+				if (faces[neighbour].Distance(eye) > epsilon)
+				{
+					faces[neighbour].isRemoved = true;
+					visibleFaces.push_back(neighbour);
+				}
+				else
+				{
+					const auto& face = faces[visibleFaces[i]];
+					horizon.emplace_back(face.vertices[edge], face.vertices[(edge + 1) % 3]);
+				}
+			}
+		}
+
+		std::vector<uint16_t> orphanedPoints;
+		for (auto face : visibleFaces)
+		{
+			for (auto point : faces[face].outside)
+			{
+				if (point != a_eyePoint) orphanedPoints.push_back(point);
+			}
+			faces[face].outside.clear();
+			RemoveFace(face);
+		}
+
+		std::vector<uint32_t> newFaces;
+		newFaces.reserve(horizon.size());
+		for (const auto& [from, to] : horizon)
+		{
+			newFaces.push_back(AddFace(from, to, a_eyePoint));
+		}
+		AssignPoints(orphanedPoints, newFaces);
+	}
+
+	bool QuickHull::Build()
+	{
+		if (!BuildInitialSimplex()) return false;
+
+		// new faces are appended, so a single pass visits every face that gets points assigned
+		for (uint32_t i = 0; i < faces.size() && isValid; i++)
+		{
+			if (faces[i].isRemoved || faces[i].outside.empty()) continue;
+
+			uint16_t eyePoint = faces[i].outside[0];
+			double maxDistance = 0.0;
+			for (auto point : faces[i].outside)
+			{
+				double distance = faces[i].Distance(points[point]);
+				if (distance > maxDistance)
+				{
+					maxDistance = distance;
+					eyePoint = point;
+				}
+			}
+			AddPoint(i, eyePoint);
+		}
+		return isValid;
+	}
+
+	std::vector<std::vector<uint16_t>> QuickHull::GetFaces() const
+	{
+		std::vector<std::vector<uint16_t>> hullFaces;
+
+		// grow each polygon from its largest triangle, so slivers are absorbed by a large face instead of joining two faces
+		std::vector<uint32_t> seeds;
+		for (uint32_t i = 0; i < faces.size(); i++)
+		{
+			if (!faces[i].isRemoved) seeds.push_back(i);
+		}
+		std::sort(seeds.begin(), seeds.end(), [&](uint32_t a, uint32_t b) { return faces[a].area > faces[b].area; });
+
+		std::vector<int32_t> groups(faces.size(), -1);
+		int32_t groupCount = 0;
+		for (auto seed : seeds)
+		{
+			if (groups[seed] != -1) continue;
+
+			const auto& plane = faces[seed];
+			int32_t group = groupCount++;
+			groups[seed] = group;
+			std::vector<uint32_t> members{ seed };
+			for (size_t i = 0; i < members.size(); i++)
+			{
+				for (int edge = 0; edge < 3; edge++)
+				{
+					auto neighbour = GetNeighbour(members[i], edge);
+					if (neighbour == UINT32_MAX || groups[neighbour] != -1) continue;
+
+					bool isCoplanar = true;
+					for (auto vertex : faces[neighbour].vertices)
+					{
+						if (std::abs(plane.Distance(points[vertex])) > mergeEpsilon) isCoplanar = false;
+					}
+					if (isCoplanar)
+					{
+						groups[neighbour] = group;
+						members.push_back(neighbour);
+					}
+				}
+			}
+
+			// only slivers are left, their edges are already part of the neighbouring polygons
+			if (plane.area <= mergeEpsilon * mergeEpsilon) continue;
+
+			// the boundary of the group, chained into a single loop
+			std::unordered_map<uint16_t, uint16_t> nextVertex;
+			bool isSimple = true;
+			for (auto member : members)
+			{
+				for (int edge = 0; edge < 3; edge++)
+				{
+					auto neighbour = GetNeighbour(member, edge);
+					if (neighbour != UINT32_MAX && groups[neighbour] == group) continue;
+
+					const auto& face = faces[member];
+					if (!nextVertex.emplace(face.vertices[edge], face.vertices[(edge + 1) % 3]).second) isSimple = false;
+				}
+			}
+
+			std::vector<uint16_t> loop;
+			if (isSimple && !nextVertex.empty())
+			{
+				uint16_t vertex = nextVertex.begin()->first;
+				do
+				{
+					loop.push_back(vertex);
+					vertex = nextVertex[vertex];
+				} while (vertex != loop[0] && loop.size() <= nextVertex.size());
+				isSimple = vertex == loop[0] && loop.size() == nextVertex.size();
+			}
+
+			// drop vertices in the middle of a straight edge
+			std::vector<uint16_t> polygon;
+			for (size_t i = 0; isSimple && i < loop.size(); i++)
+			{
+				const auto& previous = points[loop[(i + loop.size() - 1) % loop.size()]];
+				const auto& current = points[loop[i]];
+				const auto& next = points[loop[(i + 1) % loop.size()]];
+				if (glm::length(glm::cross(current - previous, next - current)) > mergeEpsilon * glm::distance(previous, next)) polygon.push_back(loop[i]);
+			}
+
+			if (isSimple && polygon.size() >= 3 && polygon.size() <= UINT8_MAX)
+			{
+				hullFaces.push_back(std::move(polygon));
+			}
+			else
+			{
+				for (auto member : members)
+				{
+					const auto& face = faces[member];
+					hullFaces.push_back({ face.vertices[0], face.vertices[1], face.vertices[2] });
+				}
+			}
+		}
+		return hullFaces;
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+namespace Utils
+{
+	// Quickhull (Barber, Dobkin & Huhdanpaa) over the vertices of a convex shape. The hull is built from triangles, which are
+	// merged into polygons afterwards, so planes that are only almost coplanar (the case ensureConnectivity fails on) become one face.
+	// It only depends on glm, so it can be tested on its own
+	class QuickHull
+	{
+		public:
+			QuickHull(const std::vector<glm::dvec3>& a_points);
+
+			bool Build(); // false if the points are (almost) coplanar or the hull became inconsistent
+			std::vector<std::vector<uint16_t>> GetFaces() const;
+
+		private:
+			struct Face
+			{
+				uint16_t				vertices[3];
+				glm::dvec3				normal{ 0.0 };
+				double					offset = 0.0;
+				double					area = 0.0;
+				std::vector<uint16_t>	outside{}; // the points above the face, each point is assigned to a single face
+				bool					isRemoved = false;
+
+				double Distance(const glm::dvec3& a_point) const { return glm::dot(normal, a_point) - offset; }
+			};
+
+			const std::vector<glm::dvec3>&			points;
+			std::vector<Face>						faces;
+			std::unordered_map<uint32_t, uint32_t>	edges;					// directed edge -> face, the twin of an edge is in the neighbouring face
+			double									epsilon = 0.0;			// points closer than this to a face are not above it
+			double									mergeEpsilon = 0.0;		// triangles with all vertices this close to a plane are merged
+			bool									isValid = true;
+
+			static uint32_t EdgeKey(uint16_t a_from, uint16_t a_to) { return static_cast<uint32_t>(a_from) << 16 | a_to; }
+
+			bool		BuildInitialSimplex();
+			uint32_t	AddFace(uint16_t a_vertex1, uint16_t a_vertex2, uint16_t a_vertex3);
+			void		RemoveFace(uint32_t a_face);
+			void		AssignPoints(const std::vector<uint16_t>& a_points, const std::vector<uint32_t>& a_faces);
+			void		AddPoint(uint32_t a_face, uint16_t a_eyePoint);
+			uint32_t	GetNeighbour(uint32_t a_face, int a_edge) const;
+	};
+}
@@ -50,9 +50,9 @@ namespace Renderer
         DSState(Renderer::D3DContext& ctx, DSStateKey& info) 
 		{
             D3D11_DEPTH_STENCIL_DESC dsDesc;
-            dsDesc.DepthEnable = info.write;
-            dsDesc.DepthWriteMask = info.test ? D3D11_DEPTH_WRITE_MASK::D3D11_DEPTH_WRITE_MASK_ALL
-                                              : D3D11_DEPTH_WRITE_MASK::D3D11_DEPTH_WRITE_MASK_ZERO;
+            dsDesc.DepthEnable = info.test;
+            dsDesc.DepthWriteMask = info.write ? D3D11_DEPTH_WRITE_MASK::D3D11_DEPTH_WRITE_MASK_ALL
+                                               : D3D11_DEPTH_WRITE_MASK::D3D11_DEPTH_WRITE_MASK_ZERO;
             dsDesc.DepthFunc = info.mode;
             dsDesc.StencilEnable = false;
             ctx.device->CreateDepthStencilState(&dsDesc, state.put());
@@ -8,14 +8,14 @@
 
 namespace Renderer 
 {
-    LineDrawer::LineDrawer(D3DContext& ctx) 
+    LineDrawer::LineDrawer(D3DContext& ctx, D3D11_PRIMITIVE_TOPOLOGY topology) : context(ctx), topology(topology)
 	{ 
 		CreateObjects(ctx); 
 	}
 
     LineDrawer::~LineDrawer() 
 	{
-        for (auto i = 0; i < NumBuffers; i++) vbo[i].reset();
+        vbo.reset();
 
         vs.reset();
         ps.reset();
@@ -29,61 +29,56 @@ namespace Renderer
         ShaderCreateInfo psCreateInfo(Shaders::VertexColorScreenPS, PipelineStage::Fragment);
         ps = ShaderCache::Get().Load(psCreateInfo, ctx);
 
+        CreateBuffer(ring.Capacity());
+    }
+
+    void LineDrawer::CreateBuffer(uint32_t capacity)
+    {
         VertexBufferCreateInfo vbInfo;
-        vbInfo.elementSize = sizeof(Point);
-        vbInfo.numElements = LineDrawPointBatchSize * 2;
-        vbInfo.topology = D3D11_PRIMITIVE_TOPOLOGY::D3D11_PRIMITIVE_TOPOLOGY_LINELIST;
+        vbInfo.elementSize = sizeof(LineVertex);
+        vbInfo.numElements = capacity;
+        vbInfo.topology = topology;
         vbInfo.bufferUsage = D3D11_USAGE::D3D11_USAGE_DYNAMIC;
         vbInfo.cpuAccessFlags = D3D11_CPU_ACCESS_FLAG::D3D11_CPU_ACCESS_WRITE;
         vbInfo.vertexProgram = vs;
+        // the shader still reads float4s, the missing w of the position is filled in as 1 and the color is unpacked to [0, 1]
         vbInfo.iaLayout.emplace_back(
-            D3D11_INPUT_ELEMENT_DESC{"POS", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0});
+            D3D11_INPUT_ELEMENT_DESC{"POS", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0});
         vbInfo.iaLayout.emplace_back(D3D11_INPUT_ELEMENT_DESC{
-            "COL", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0});
+            "COL", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0});
 
-        for (auto i = 0; i < NumBuffers; i++) vbo[i] = std::move(std::make_unique<VertexBuffer>(vbInfo, ctx));
+        vbo = std::make_unique<VertexBuffer>(vbInfo, context);
     }
 
-    void LineDrawer::Submit(const LineList& lines) noexcept {
-        if (lines.size() > 0)
+    void LineDrawer::Submit(const LineList& lines, bool hasChanged) noexcept 
+    {
+        if (hasChanged)
         {
-            vs->Use();
-            ps->Use();
-        }
+            drawCount = static_cast<uint32_t>(lines.size());
+            if (drawCount == 0) return;
 
+            const auto allocation = ring.Allocate(drawCount);
+            if (allocation.grow) CreateBuffer(ring.Capacity());
 
-        auto begin = lines.cbegin();
-        auto end = lines.cend();
-        uint32_t batchCount = 0;
+            // appending with NO_OVERWRITE leaves the lines drawn in previous frames alone, so the map does not wait on the gpu
+            const auto mode = allocation.discard ? D3D11_MAP::D3D11_MAP_WRITE_DISCARD : D3D11_MAP::D3D11_MAP_WRITE_NO_OVERWRITE;
+            auto buf = reinterpret_cast<LineVertex*>(vbo->Map(mode).pData);
+            std::memcpy(buf + allocation.offset, lines.data(), drawCount * sizeof(LineVertex));
+            vbo->Unmap();
 
-        while (begin != end) {
-            DrawBatch(
-                // Flip flop buffers to avoid pipeline stalls, if possible
-                batchCount % static_cast<uint32_t>(NumBuffers), begin, end);
-            batchCount++;
+            drawOffset = allocation.offset;
+            CountDrawCall(drawCount * sizeof(LineVertex));
         }
-    }
-
-    void LineDrawer::DrawBatch(uint32_t bufferIndex, LineList::const_iterator& begin, LineList::const_iterator& end) {
-        uint32_t batchSize = 0;
-        uint32_t index = 0;
-        auto buf = reinterpret_cast<glm::vec4*>(vbo[bufferIndex]->Map(D3D11_MAP::D3D11_MAP_WRITE_DISCARD).pData);
-
-        while (begin != end) {
-            buf[index] = begin->start.pos;
-            buf[index + 1] = begin->start.col;
-            buf[index + 2] = begin->end.pos;
-            buf[index + 3] = begin->end.col;
-
-            begin++;
-            batchSize++;
-            index += 4;
-
-            if (batchSize >= LineDrawPointBatchSize) break;
+        else
+        {
+            if (drawCount == 0) return;
+            CountDrawCall(0);
         }
-        vbo[bufferIndex]->Unmap();
-        vbo[bufferIndex]->Bind();
-        vbo[bufferIndex]->DrawCount(batchSize * 2);
+
+        vs->Use();
+        ps->Use();
+        vbo->Bind();
+        vbo->DrawCount(drawCount, drawOffset);
     }
 
 	static std::mutex renderLock;
@@ -93,13 +88,41 @@ namespace Renderer
 
 	static std::unique_ptr<LineDrawer> lineDrawer;
 	static LineList lineList;
+	static bool areLinesDirty = false; // the lines are only uploaded when they changed
 	static MeshList meshList;
 
+	// the overlay is drawn with triangles, the fills only change when the shapes are queued again, the strokes face the camera every frame
+	static std::unique_ptr<LineDrawer> overlayFillDrawer;
+	static std::unique_ptr<LineDrawer> overlayStrokeDrawer;
+	static LineList overlayFills;
+	static LineList overlayStrokes;
+	static bool areOverlayFillsDirty = false;
+	static bool areOverlayStrokesDirty = false;
+
 	static VSPerObjectCBuffer cbufPerObjectStaging = {};
 	static std::shared_ptr<CBuffer> cbufPerObject;
 
 	static std::shared_ptr<Shader> meshVertexShader;
 	static std::shared_ptr<Shader> meshPixelShader;
+	static std::shared_ptr<Shader> instancedMeshVertexShader;
+	static std::shared_ptr<Shader> positionMeshVertexShader;
+	static std::shared_ptr<Shader> instancedPositionMeshVertexShader;
+
+	struct InstanceRange
+	{
+		InstancedMeshDrawer* meshDrawer;
+		uint32_t start;
+		uint32_t count;
+	};
+
+	// the instances of all meshes share one buffer, which is only written when the instances have changed
+	static InstanceList instanceList;
+	static std::vector<InstanceRange> instanceRanges;
+	static std::unique_ptr<VertexBuffer> instanceBuffer;
+	static bool areInstancesDirty = false;
+
+	static DrawStats frameStats;
+	static DrawStats lastFrameStats;
 
 	std::shared_ptr<Shader> GetMeshVS()
 	{
@@ -110,16 +133,100 @@ namespace Renderer
 		return meshPixelShader;
 	}
 
+	std::shared_ptr<Shader> GetInstancedMeshVS()
+	{
+		return instancedMeshVertexShader;
+	}
+
+	std::shared_ptr<Shader> GetPositionMeshVS()
+	{
+		return positionMeshVertexShader;
+	}
+
+	std::shared_ptr<Shader> GetInstancedPositionMeshVS()
+	{
+		return instancedPositionMeshVertexShader;
+	}
+
 	std::shared_ptr<CBuffer> GetPerObjectCBuffer()
 	{
 		return cbufPerObject;
 	}
 
+	void CountDrawCall(size_t a_uploadBytes)
+	{
+		frameStats.drawCalls++;
+		frameStats.uploadBytes += a_uploadBytes;
+	}
+
+	DrawStats GetDrawStats()
+	{
+		std::lock_guard<std::mutex> lock(renderLock);
+		return lastFrameStats;
+	}
+
+	static void UploadInstances(D3DContext& a_ctx)
+	{
+		instanceRanges.clear();
+		areInstancesDirty = false;
+
+		uint32_t numberOfInstances = 0;
+		for (const auto& [meshDrawer, instances] : instanceList)
+		{
+			numberOfInstances += static_cast<uint32_t>(instances.size());
+		}
+		if (numberOfInstances == 0) return;
+
+		if (!instanceBuffer || instanceBuffer->Count() < numberOfInstances)
+		{
+			VertexBufferCreateInfo vbInfo;
+			vbInfo.elementSize = sizeof(MeshInstance);
+			vbInfo.numElements = std::bit_ceil(std::max(numberOfInstances, 256u));
+			vbInfo.bufferUsage = D3D11_USAGE::D3D11_USAGE_DYNAMIC;
+			vbInfo.cpuAccessFlags = D3D11_CPU_ACCESS_FLAG::D3D11_CPU_ACCESS_WRITE;
+			vbInfo.vertexProgram = instancedMeshVertexShader;
+			vbInfo.iaLayout = InstancedMeshDrawer::GetIALayout(VertexLayout::PositionUVNormalColor);
+
+			instanceBuffer = std::make_unique<VertexBuffer>(vbInfo, a_ctx);
+		}
+
+		auto buf = reinterpret_cast<MeshInstance*>(instanceBuffer->Map(D3D11_MAP::D3D11_MAP_WRITE_DISCARD).pData);
+		uint32_t start = 0;
+		for (const auto& [meshDrawer, instances] : instanceList)
+		{
+			uint32_t count = static_cast<uint32_t>(instances.size());
+			if (count == 0) continue;
+
+			std::memcpy(buf + start, instances.data(), count * sizeof(MeshInstance));
+			instanceRanges.push_back(InstanceRange{ meshDrawer.get(), start, count });
+			start += count;
+		}
+		instanceBuffer->Unmap();
+
+		frameStats.uploadBytes += numberOfInstances * sizeof(MeshInstance);
+	}
+
+    void PrefetchShaders() 
+	{
+		std::vector<ShaderCreateInfo> infos;
+		infos.emplace_back(Shaders::VertexColorScreenVS, PipelineStage::Vertex);
+		infos.emplace_back(Shaders::VertexColorScreenPS, PipelineStage::Fragment);
+		infos.emplace_back(Shaders::VertexColorWorldVS, PipelineStage::Vertex);
+		infos.emplace_back(Shaders::VertexColorWorldPS, PipelineStage::Fragment);
+		infos.emplace_back(Shaders::VertexColorWorldInstancedVS, PipelineStage::Vertex);
+		infos.emplace_back(Shaders::PositionWorldVS, PipelineStage::Vertex);
+		infos.emplace_back(Shaders::PositionWorldInstancedVS, PipelineStage::Vertex);
+
+		ShaderCache::Get().Prefetch(infos);
+	}
+
     void InitDrawer() 
 	{
         auto& ctx = GetContext();
 
         lineDrawer = std::make_unique<LineDrawer>(ctx);
+        overlayFillDrawer = std::make_unique<LineDrawer>(ctx, D3D11_PRIMITIVE_TOPOLOGY::D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        overlayStrokeDrawer = std::make_unique<LineDrawer>(ctx, D3D11_PRIMITIVE_TOPOLOGY::D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
 		// Vertex and fragment programs
 		Renderer::ShaderCreateInfo vsCreateInfo(Renderer::Shaders::VertexColorWorldVS, Renderer::PipelineStage::Vertex);
@@ -128,6 +235,15 @@ namespace Renderer
 		meshVertexShader = Renderer::ShaderCache::Get().Load(vsCreateInfo, ctx);
 		meshPixelShader = Renderer::ShaderCache::Get().Load(psCreateInfo, ctx);
 
+		Renderer::ShaderCreateInfo instancedVSCreateInfo(Renderer::Shaders::VertexColorWorldInstancedVS, Renderer::PipelineStage::Vertex);
+		instancedMeshVertexShader = Renderer::ShaderCache::Get().Load(instancedVSCreateInfo, ctx);
+
+		Renderer::ShaderCreateInfo positionVSCreateInfo(Renderer::Shaders::PositionWorldVS, Renderer::PipelineStage::Vertex);
+		positionMeshVertexShader = Renderer::ShaderCache::Get().Load(positionVSCreateInfo, ctx);
+
+		Renderer::ShaderCreateInfo instancedPositionVSCreateInfo(Renderer::Shaders::PositionWorldInstancedVS, Renderer::PipelineStage::Vertex);
+		instancedPositionMeshVertexShader = Renderer::ShaderCache::Get().Load(instancedPositionVSCreateInfo, ctx);
+
 		Renderer::CBufferCreateInfo perObj;
 		perObj.bufferUsage = D3D11_USAGE::D3D11_USAGE_DYNAMIC;
 		perObj.cpuAccessFlags = D3D11_CPU_ACCESS_FLAG::D3D11_CPU_ACCESS_WRITE;
@@ -149,6 +265,8 @@ namespace Renderer
 
             auto& drawHandler = DebugMenu::GetDrawHandler();
 			if (!drawHandler->isMenuOpen) return;
+
+			frameStats = {};
            
             for (int i = 0; i < 4; i++)
                 for (int j = 0; j < 4; j++)
@@ -159,6 +277,7 @@ namespace Renderer
 					
 
             cbufPerFrame->Update(&cbufPerFrameStaging, 0, sizeof(decltype(cbufPerFrameStaging)), a_ctx);
+			frameStats.uploadBytes += sizeof(decltype(cbufPerFrameStaging));
 
             cbufPerFrame->Bind(PipelineStage::Vertex, 1, a_ctx);
             cbufPerFrame->Bind(PipelineStage::Fragment, 1, a_ctx);
@@ -175,30 +294,93 @@ namespace Renderer
 				Renderer::SetDepthState(a_ctx, true, true, D3D11_COMPARISON_FUNC::D3D11_COMPARISON_LESS_EQUAL);
 			
 			// linelist and meshlist are cleared in drawhandler ClearAll() called in DebubMenu.cpp
-            lineDrawer->Submit(lineList);
-			for (auto& mesh : meshList)
+            lineDrawer->Submit(lineList, areLinesDirty);
+			areLinesDirty = false;
+			for (auto& [mesh, color] : meshList)
+			{
+				mesh->Submit(glm::identity<glm::mat4>(), color);
+			}
+
+			if (areInstancesDirty) UploadInstances(a_ctx);
+			for (const auto& range : instanceRanges)
 			{
-				mesh->Submit(glm::identity<glm::mat4>());
+				range.meshDrawer->Submit(*instanceBuffer, range.start, range.count);
+				frameStats.drawCalls++;
+				frameStats.instances += range.count;
 			}
+
+			if (!overlayFills.empty() || !overlayStrokes.empty())
+			{
+				// filled and alpha blended, unlike the wireframe collisions
+				Renderer::SetRasterState(a_ctx, D3D11_FILL_MODE::D3D11_FILL_SOLID,
+										D3D11_CULL_MODE::D3D11_CULL_NONE, true, -2000, 0.0f, 0.0f, true,
+										false, false, false);
+				Renderer::SetBlendState(a_ctx, true);
+
+				// transparent shapes are tested against the depth of the game, but don't write to it
+				if (MCM::settings::overlayOcclude)
+					Renderer::SetDepthState(a_ctx, false, true, D3D11_COMPARISON_FUNC::D3D11_COMPARISON_LESS_EQUAL);
+				else
+					Renderer::SetDepthState(a_ctx, false, false, D3D11_COMPARISON_FUNC::D3D11_COMPARISON_ALWAYS);
+			}
+			overlayFillDrawer->Submit(overlayFills, areOverlayFillsDirty);
+			overlayStrokeDrawer->Submit(overlayStrokes, areOverlayStrokesDirty);
+			areOverlayFillsDirty = false;
+			areOverlayStrokesDirty = false;
+
+			lastFrameStats = frameStats;
         });
     }
 
     void DrawLine(const vec3u& a_point1, const vec3u& a_point2, vec4u& a_color)
     {
         std::lock_guard<std::mutex> lock(renderLock);
-        lineList.emplace_back(Renderer::Point(a_point1, a_color),
-                              Renderer::Point(a_point2, a_color));
+        lineList.emplace_back(a_point1, a_color);
+        lineList.emplace_back(a_point2, a_color);
+		areLinesDirty = true;
     }
 
-	void DrawMesh(std::shared_ptr<Renderer::MeshDrawer>& meshDrawer)
+	void DrawMesh(std::shared_ptr<Renderer::MeshDrawer>& meshDrawer, const vec4u& a_color)
 	{
 		std::lock_guard<std::mutex> lock(renderLock);
-		meshList.emplace_back(meshDrawer);
+		meshList.emplace_back(meshDrawer, a_color);
 	}
 
 	void ClearLines()
 	{
 		lineList.clear();
+		areLinesDirty = true;
+	}
+
+	void DrawMeshInstance(const std::shared_ptr<InstancedMeshDrawer>& a_meshDrawer, const glm::mat4& a_model, const vec4u& a_color)
+	{
+		std::lock_guard<std::mutex> lock(renderLock);
+		instanceList[a_meshDrawer].emplace_back(a_model, a_color);
+		areInstancesDirty = true;
+	}
+
+	void SetOverlay(const OverlayGeometry& a_overlay, bool a_haveFillsChanged)
+	{
+		std::lock_guard<std::mutex> lock(renderLock);
+		if (a_haveFillsChanged)
+		{
+			overlayFills.assign(a_overlay.GetFills().begin(), a_overlay.GetFills().end());
+			areOverlayFillsDirty = true;
+		}
+		if (a_overlay.HasStrokes() || !overlayStrokes.empty())
+		{
+			overlayStrokes.assign(a_overlay.GetStrokes().begin(), a_overlay.GetStrokes().end());
+			areOverlayStrokesDirty = true;
+		}
+	}
+
+	void ClearOverlay()
+	{
+		std::lock_guard<std::mutex> lock(renderLock);
+		overlayFills.clear();
+		overlayStrokes.clear();
+		areOverlayFillsDirty = true;
+		areOverlayStrokesDirty = true;
 	}
 
 	void ClearMeshes()
@@ -206,4 +388,17 @@ namespace Renderer
 		meshList.clear();
 	}
 
+	void ClearMeshInstances()
+	{
+		std::lock_guard<std::mutex> lock(renderLock);
+		// the vectors are kept so they don't have to grow again next update, but meshes without instances are released
+		std::erase_if(instanceList, [](const auto& a_entry) { return a_entry.second.empty(); });
+		for (auto& [meshDrawer, instances] : instanceList)
+		{
+			instances.clear();
+		}
+		instanceRanges.clear();
+		areInstancesDirty = true;
+	}
+
 }
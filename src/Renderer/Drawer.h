@@ -2,7 +2,10 @@
 
 #include "VertexBuffer.h"
 #include "MeshDrawer.h"
+#include "InstancedMeshDrawer.h"
 #include "CBuffer.h"
+#include "OverlayGeometry.h"
+#include "RingBufferAllocator.h"
 
 namespace Renderer
 {
@@ -19,67 +22,79 @@ namespace Renderer
 	struct VSPerObjectCBuffer 
 	{
 		glm::mat4 model = glm::identity<glm::mat4>();
+		glm::vec4 color{ 1.0f }; // used by meshes without vertex colors
 	};
 	static_assert(sizeof(VSPerObjectCBuffer) % 16 == 0);
 
-    typedef struct Point 
-    {
-        glm::vec4 pos;
-        glm::vec4 col;
-
-        Point(glm::vec3 position, glm::vec4 color) : col(color) { pos = {position.x, position.y, position.z, 1.0f}; }
-    } Point;
-
-    typedef struct Line 
-    {
-        Point start;
-        Point end;
-        Line(Point&& start, Point&& end) : start(start), end(end) {};
-    } Line;
+    using LineList = std::vector<LineVertex>; // 2 vertices per line
+	using MeshList = std::vector<std::pair<std::shared_ptr<MeshDrawer>, glm::vec4>>;
+	using InstanceList = std::unordered_map<std::shared_ptr<InstancedMeshDrawer>, std::vector<MeshInstance>>;
 
-    using LineList = std::vector<Line>;
-	using MeshList = std::vector<std::shared_ptr<MeshDrawer>>;
+	// counted per frame, to compare the cost of the different mesh paths
+	struct DrawStats
+	{
+		uint32_t drawCalls = 0;
+		uint32_t instances = 0;
+		size_t uploadBytes = 0; // vertices, instances and constant buffers written to the gpu
+	};
 
-    // Number of points we can submit in a single draw call
-    constexpr size_t LineDrawPointBatchSize = 256;
-    // Number of buffers to use
-    constexpr size_t NumBuffers = 2;
+    // Number of line vertices the ring buffer starts with, it grows when a frame needs more
+    constexpr uint32_t LineRingBufferSize = 1 << 16;
 
     class LineDrawer 
     {
         public:
-            explicit LineDrawer(D3DContext& ctx);
+            // the overlay draws its triangles through it as well, with a triangle list
+            explicit LineDrawer(D3DContext& ctx, D3D11_PRIMITIVE_TOPOLOGY topology = D3D11_PRIMITIVE_TOPOLOGY::D3D11_PRIMITIVE_TOPOLOGY_LINELIST);
             ~LineDrawer();
             LineDrawer(const LineDrawer&) = delete;
             LineDrawer(LineDrawer&&) noexcept = delete;
             LineDrawer& operator=(const LineDrawer&) = delete;
             LineDrawer& operator=(LineDrawer&&) noexcept = delete;
 
-            // Submit a list of lines for drawing
-            void Submit(const LineList& lines) noexcept;
+            // Submit a list of lines for drawing in a single draw call. If the list has not changed since the last
+            // submit, the lines already in the buffer are drawn again
+            void Submit(const LineList& lines, bool hasChanged) noexcept;
 
         protected:
             std::shared_ptr<Shader> vs;
             std::shared_ptr<Shader> ps;
 
         private:
-            std::array<std::unique_ptr<VertexBuffer>, NumBuffers> vbo;
+            D3DContext context;
+            D3D11_PRIMITIVE_TOPOLOGY topology;
+            std::unique_ptr<VertexBuffer> vbo;
+            RingBufferAllocator ring{ LineRingBufferSize };
+            uint32_t drawOffset = 0;
+            uint32_t drawCount = 0;
 
             void CreateObjects(D3DContext& ctx);
-            void DrawBatch(uint32_t bufferIndex, LineList::const_iterator& begin, LineList::const_iterator& end);
+            void CreateBuffer(uint32_t capacity);
     };
 
     static constexpr float RenderScale = 1.0f;//0.0142875f;
 
+    void PrefetchShaders(); // starts reading or compiling the shaders of InitDrawer on a worker thread, before the renderer starts
     void InitDrawer();
     void DrawLine(const vec3u& a_point1, const vec3u& a_point2, vec4u& a_color);
-	void DrawMesh(std::shared_ptr<MeshDrawer>& meshDrawer);
+	void DrawMesh(std::shared_ptr<MeshDrawer>& meshDrawer, const vec4u& a_color = vec4u{ 1.0f });
+	void DrawMeshInstance(const std::shared_ptr<InstancedMeshDrawer>& a_meshDrawer, const glm::mat4& a_model, const vec4u& a_color);
+	// Copies the triangles of the overlay, the fills only when they changed since the last call
+	void SetOverlay(const OverlayGeometry& a_overlay, bool a_haveFillsChanged);
     
 	void ClearLines();
 	void ClearMeshes();
+	void ClearMeshInstances();
+	void ClearOverlay();
+
+	void CountDrawCall(size_t a_uploadBytes);
+	DrawStats GetDrawStats(); // stats of the last frame
 
 	std::shared_ptr<Shader> GetMeshVS();
 	std::shared_ptr<Shader> GetMeshPS();
+	std::shared_ptr<Shader> GetInstancedMeshVS();
+	std::shared_ptr<Shader> GetPositionMeshVS();			// for VertexLayout::Position, colored by the per object color
+	std::shared_ptr<Shader> GetInstancedPositionMeshVS();	// for VertexLayout::Position, colored by the instance color
 	std::shared_ptr<CBuffer> GetPerObjectCBuffer();
 
     __forceinline glm::vec3 ToRenderScale(const glm::vec3& position) noexcept { return position * RenderScale; }
@@ -0,0 +1,49 @@
+#include "InstancedMeshDrawer.h"
+
+namespace Renderer
+{
+	InstancedMeshDrawer::InstancedMeshDrawer(MeshCreateInfo& info, D3DContext& ctx) noexcept :
+		vs(info.vs), ps(info.ps)
+	{
+		CreateObjects(info, ctx);
+	}
+
+	InstancedMeshDrawer::~InstancedMeshDrawer() 
+	{
+		vbo.reset();
+		vs.reset();
+		ps.reset();
+	}
+
+	IALayout InstancedMeshDrawer::GetIALayout(VertexLayout layout)
+	{
+		IALayout iaLayout = GetMeshIALayout(layout);
+
+		iaLayout.emplace_back(D3D11_INPUT_ELEMENT_DESC{ "MODEL", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 0, D3D11_INPUT_PER_INSTANCE_DATA, 1 });
+		iaLayout.emplace_back(D3D11_INPUT_ELEMENT_DESC{ "MODEL", 1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 });
+		iaLayout.emplace_back(D3D11_INPUT_ELEMENT_DESC{ "MODEL", 2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 });
+		iaLayout.emplace_back(D3D11_INPUT_ELEMENT_DESC{ "MODEL", 3, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 });
+		iaLayout.emplace_back(D3D11_INPUT_ELEMENT_DESC{ "INSTANCECOLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 });
+		return iaLayout;
+	}
+
+	void InstancedMeshDrawer::CreateObjects(const MeshCreateInfo& info, D3DContext& ctx) 
+	{
+		MeshBufferData bufferData{ info };
+		bufferData.vbInfo.iaLayout = GetIALayout(bufferData.layout);
+
+		vbo = std::make_unique<Renderer::VertexBuffer>(bufferData.vbInfo, ctx);
+		context = ctx;
+	}
+
+	void InstancedMeshDrawer::Submit(VertexBuffer& instanceBuffer, uint32_t startInstance, uint32_t count) noexcept 
+	{
+		vs->Use();
+		ps->Use();
+		vbo->Bind();
+		instanceBuffer.BindToSlot(1);
+		vbo->DrawInstanced(count, startInstance);
+	}
+
+	size_t InstancedMeshDrawer::Size() const noexcept { return vbo->Size(); }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "VertexBuffer.h"
+#include "MeshDrawer.h"
+
+namespace Renderer 
+{
+	// Per instance data of an instanced mesh, the model matrix is passed as its columns
+	typedef struct MeshInstance 
+	{
+		glm::vec4 model[4];
+		glm::vec4 color;
+
+		MeshInstance(const glm::mat4& a_model, const glm::vec4& a_color) : model{ a_model[0], a_model[1], a_model[2], a_model[3] }, color(a_color) {}
+	} MeshInstance;
+
+	// A mesh in its local space, which is uploaded once and drawn for every instance in a single draw call
+	class InstancedMeshDrawer 
+	{
+		public:
+			InstancedMeshDrawer(MeshCreateInfo& info, D3DContext& ctx) noexcept;
+			~InstancedMeshDrawer();
+			InstancedMeshDrawer(const InstancedMeshDrawer&) = delete;
+			InstancedMeshDrawer(InstancedMeshDrawer&&) noexcept = delete;
+			InstancedMeshDrawer& operator=(const InstancedMeshDrawer&) = delete;
+			InstancedMeshDrawer& operator=(InstancedMeshDrawer&&) noexcept = delete;
+
+			// Draw a_count instances starting at a_startInstance in the instance buffer
+			void Submit(VertexBuffer& instanceBuffer, uint32_t startInstance, uint32_t count) noexcept;
+
+			// Size of the vertex and index buffers in bytes
+			size_t Size() const noexcept;
+
+			// Layout of the mesh vertices (slot 0) and the instances (slot 1)
+			static IALayout GetIALayout(VertexLayout layout);
+
+		private:
+			D3DContext context;
+			std::unique_ptr<VertexBuffer> vbo;
+			std::shared_ptr<Shader> vs;
+			std::shared_ptr<Shader> ps;
+
+			void CreateObjects(const MeshCreateInfo& info, D3DContext& ctx);
+	};
+
+}
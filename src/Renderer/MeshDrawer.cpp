@@ -1,15 +1,16 @@
 #include "MeshDrawer.h"
+#include "Drawer.h"
 
 namespace Renderer
 {
 	MeshDrawer::MeshDrawer(MeshCreateInfo& info, const std::shared_ptr<Renderer::CBuffer>& perObjectBuffer, D3DContext& ctx) noexcept :
 		vs(info.vs), ps(info.ps)
 	{
-		assert(perObjectBuffer->Size() == sizeof(glm::mat4));
+		assert(perObjectBuffer->Size() == sizeof(VSPerObjectCBuffer));
 		assert(perObjectBuffer->Usage() == D3D11_USAGE_DYNAMIC);
 		cbufPerObject = perObjectBuffer;
 
-		CreateObjects(info.mesh->vertices, ctx);
+		CreateObjects(info, ctx);
 	}
 
 	MeshDrawer::~MeshDrawer() 
@@ -20,49 +21,84 @@ namespace Renderer
 		cbufPerObject.reset();
 	}
 
-	void MeshDrawer::CreateObjects(std::vector<Model::Vertex>& vertices, D3DContext& ctx) 
+	IALayout GetMeshIALayout(VertexLayout layout)
 	{
-		D3D11_SUBRESOURCE_DATA data;
-		data.pSysMem = vertices.data();
-		data.SysMemPitch = 0;
-		data.SysMemSlicePitch = 0;
+		IALayout iaLayout;
+		iaLayout.emplace_back(D3D11_INPUT_ELEMENT_DESC{ "POS", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 });
+		if (layout == VertexLayout::PositionUVNormalColor)
+		{
+			iaLayout.emplace_back(D3D11_INPUT_ELEMENT_DESC{ "UV", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 });
+			iaLayout.emplace_back(D3D11_INPUT_ELEMENT_DESC{ "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 });
+			iaLayout.emplace_back(D3D11_INPUT_ELEMENT_DESC{ "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 });
+		}
+		return iaLayout;
+	}
+
+	MeshBufferData::MeshBufferData(const MeshCreateInfo& info)
+	{
+		assert(info.mesh || info.positionMesh);
 
-		Renderer::VertexBufferCreateInfo vbInfo;
-		vbInfo.elementSize = sizeof(Model::Vertex);
-		vbInfo.numElements = static_cast<uint32_t>(vertices.size());
-		vbInfo.elementData = &data;
 		vbInfo.topology = D3D11_PRIMITIVE_TOPOLOGY::D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
 		vbInfo.bufferUsage = D3D11_USAGE::D3D11_USAGE_IMMUTABLE;
 		vbInfo.cpuAccessFlags = 0;
-		vbInfo.vertexProgram = vs;
+		vbInfo.vertexProgram = info.vs;
+		vbInfo.elementData = &vertexData;
 
-		vbInfo.iaLayout.emplace_back(D3D11_INPUT_ELEMENT_DESC{ "POS", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 });
-		vbInfo.iaLayout.emplace_back(D3D11_INPUT_ELEMENT_DESC{ "UV", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 });
-		vbInfo.iaLayout.emplace_back(D3D11_INPUT_ELEMENT_DESC{ "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 });
-		vbInfo.iaLayout.emplace_back(D3D11_INPUT_ELEMENT_DESC{ "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 });
+		if (info.mesh)
+		{
+			layout = VertexLayout::PositionUVNormalColor;
+			vertexData.pSysMem = info.mesh->vertices.data();
+			vbInfo.elementSize = sizeof(Model::Vertex);
+			vbInfo.numElements = static_cast<uint32_t>(info.mesh->vertices.size());
+		}
+		else
+		{
+			const auto& mesh = *info.positionMesh;
+			layout = VertexLayout::Position;
+			vertexData.pSysMem = mesh.positions.data();
+			vbInfo.elementSize = sizeof(vec3u);
+			vbInfo.numElements = static_cast<uint32_t>(mesh.positions.size());
+			vbInfo.numIndices = static_cast<uint32_t>(mesh.indices.size());
 
-		vbo = std::make_unique<Renderer::VertexBuffer>(vbInfo, ctx);
+			if (mesh.UsesShortIndices())
+			{
+				shortIndices.assign(mesh.indices.begin(), mesh.indices.end());
+				vbInfo.indexData = shortIndices.data();
+				vbInfo.indexFormat = DXGI_FORMAT_R16_UINT;
+			}
+			else
+			{
+				vbInfo.indexData = mesh.indices.data();
+				vbInfo.indexFormat = DXGI_FORMAT_R32_UINT;
+			}
+		}
+		vbInfo.iaLayout = GetMeshIALayout(layout);
+	}
+
+	void MeshDrawer::CreateObjects(const MeshCreateInfo& info, D3DContext& ctx) 
+	{
+		MeshBufferData bufferData{ info };
+		layout = bufferData.layout;
+
+		vbo = std::make_unique<Renderer::VertexBuffer>(bufferData.vbInfo, ctx);
 		context = ctx;
 	}
 
-	void Renderer::MeshDrawer::Submit(const glm::mat4& modelMatrix) noexcept 
+	void Renderer::MeshDrawer::Submit(const glm::mat4& modelMatrix, const glm::vec4& color) noexcept 
 	{
-		cbufPerObject->Update(&modelMatrix, 0, sizeof(modelMatrix), context);
+		VSPerObjectCBuffer perObject{ modelMatrix, color };
+		cbufPerObject->Update(&perObject, 0, sizeof(perObject), context);
 		cbufPerObject->Bind(PipelineStage::Vertex, 0, context);
 		vs->Use();
 		ps->Use();
 		vbo->Bind();
 		vbo->Draw();
+		CountDrawCall(sizeof(perObject));
 	}
 
 	void Renderer::MeshDrawer::SetShaders(std::shared_ptr<Shader>& nvs, std::shared_ptr<Shader>& nps) 
 	{
-		IALayout iaLayout;
-		iaLayout.emplace_back(D3D11_INPUT_ELEMENT_DESC{ "POS", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 });
-		iaLayout.emplace_back(D3D11_INPUT_ELEMENT_DESC{ "UV", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 });
-		iaLayout.emplace_back(D3D11_INPUT_ELEMENT_DESC{ "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 });
-		iaLayout.emplace_back(D3D11_INPUT_ELEMENT_DESC{ "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 });
-		vbo->CreateIALayout(iaLayout, nvs.get());
+		vbo->CreateIALayout(GetMeshIALayout(layout), nvs.get());
 		vs = nvs;
 		ps = nps;
 	}
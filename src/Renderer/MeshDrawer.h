@@ -8,11 +8,28 @@ namespace Renderer
 {
 	typedef struct MeshCreateInfo 
 	{
-		Model::Mesh* mesh = nullptr;
+		Model::Mesh* mesh = nullptr;					// uploaded with VertexLayout::PositionUVNormalColor
+		Model::PositionMesh* positionMesh = nullptr;	// uploaded with VertexLayout::Position and an index buffer, if mesh is not set
 		std::shared_ptr<Shader> vs;
 		std::shared_ptr<Shader> ps;
 	} MeshCreateInfo;
 
+	// Input layout of the mesh vertices in slot 0
+	IALayout GetMeshIALayout(VertexLayout layout);
+
+	// The vertex and index data of a mesh in the layout it is uploaded with, shared by the mesh drawers
+	struct MeshBufferData 
+	{
+		VertexLayout layout;
+		VertexBufferCreateInfo vbInfo;
+		D3D11_SUBRESOURCE_DATA vertexData = {};
+		std::vector<uint16_t> shortIndices = {};
+
+		MeshBufferData(const MeshCreateInfo& info);
+		MeshBufferData(const MeshBufferData&) = delete;
+		MeshBufferData& operator=(const MeshBufferData&) = delete;
+	};
+
 	class MeshDrawer 
 	{
 		public:
@@ -24,8 +41,8 @@ namespace Renderer
 			MeshDrawer& operator=(const MeshDrawer&) = delete;
 			MeshDrawer& operator=(MeshDrawer&&) noexcept = delete;
 
-			// Draw the mesh using the given model matrix
-			void Submit(const glm::mat4& modelMatrix) noexcept;
+			// Draw the mesh using the given model matrix. The color is only used by meshes without vertex colors
+			void Submit(const glm::mat4& modelMatrix, const glm::vec4& color = glm::vec4{ 1.0f }) noexcept;
 
 			// Set the shaders used by the mesh for rendering
 			void SetShaders(std::shared_ptr<Shader>& vs, std::shared_ptr<Shader>& ps);
@@ -36,8 +53,9 @@ namespace Renderer
 			std::shared_ptr<CBuffer> cbufPerObject;
 			std::shared_ptr<Shader> vs;
 			std::shared_ptr<Shader> ps;
+			VertexLayout layout = VertexLayout::PositionUVNormalColor;
 
-			void CreateObjects(std::vector<Model::Vertex>& vertices, D3DContext& ctx);
+			void CreateObjects(const MeshCreateInfo& info, D3DContext& ctx);
 	};
 
 }
\ No newline at end of file
@@ -1,37 +1,220 @@
 #include "Model.h"
 
-bool Renderer::Model::Load(const uint8_t* location, Model& output) {
-	output.header = *reinterpret_cast<const ModelHeader*>(location);
-	if (output.header.tag != 0xF00590DA) return false;
-	if (output.header.version != 1) return false;
-
-	constexpr auto headerSize = sizeof(ModelHeader);
-	constexpr auto meshHeaderSize = sizeof(MeshHeader);
-	constexpr auto vertexSize = sizeof(Vertex);
-
-	size_t offset = headerSize;
-	for (uint32_t i = 0; i < output.header.numMeshes; i++) {
-		const auto base = reinterpret_cast<intptr_t>(location);
-		const auto h = reinterpret_cast<const MeshHeader*>(base + offset);
-		offset += meshHeaderSize;
-
-		Mesh mesh = {};
-		memcpy(&mesh.header, h, meshHeaderSize);
-		mesh.vertices.reserve(mesh.header.numVertices);
-
-		for (uint32_t j = 0; j < mesh.header.numVertices; j++) {
-			mesh.vertices.push_back(*reinterpret_cast<const Vertex*>(base + offset));
-			offset += vertexSize;
+namespace {
+	size_t Align(size_t offset) {
+		return (offset + Renderer::Model::sectionAlignment - 1) & ~static_cast<size_t>(Renderer::Model::sectionAlignment - 1);
+	}
+
+	// true if count elements of elementSize fit in data at offset, without overflowing
+	bool FitsIn(std::span<const uint8_t> data, uint64_t offset, uint64_t count, uint64_t elementSize) {
+		if (offset > data.size()) return false;
+		return count <= (data.size() - offset) / elementSize;
+	}
+
+	template <class T>
+	T Read(std::span<const uint8_t> data, size_t offset) {
+		T value;
+		std::memcpy(&value, data.data() + offset, sizeof(T));
+		return value;
+	}
+
+	template <class Index>
+	bool AreIndicesValid(std::span<const Index> indices, uint32_t numVertices) {
+		return std::all_of(indices.begin(), indices.end(), [&](Index index) { return index < numVertices; });
+	}
+
+	// v1: every mesh header is directly followed by its vertices
+	bool LoadV1(std::span<const uint8_t> data, Renderer::Model::ModelView& output) {
+		using namespace Renderer::Model;
+
+		size_t offset = sizeof(ModelHeader);
+		for (uint32_t i = 0; i < output.header.numMeshes; i++) {
+			if (!FitsIn(data, offset, 1, sizeof(MeshHeader))) return false;
+			const auto name = reinterpret_cast<const char*>(data.data() + offset);
+			const auto numVertices = Read<uint32_t>(data, offset + offsetof(MeshHeader, numVertices));
+			offset += sizeof(MeshHeader);
+
+			if (!FitsIn(data, offset, numVertices, sizeof(Vertex))) return false;
+			MeshView& mesh = output.meshes.emplace_back();
+			mesh.name = std::string_view(name, strnlen(name, sizeof(MeshHeader::name)));
+			mesh.vertices = { reinterpret_cast<const Vertex*>(data.data() + offset), numVertices };
+			offset += numVertices * sizeof(Vertex);
 		}
+		return true;
+	}
+
+	bool LoadV2(std::span<const uint8_t> data, Renderer::Model::ModelView& output) {
+		using namespace Renderer::Model;
+
+		constexpr size_t entriesOffset = sizeof(ModelHeader) + sizeof(ModelInfo);
+		if (reinterpret_cast<uintptr_t>(data.data()) % sectionAlignment != 0) return false;
+		if (!FitsIn(data, sizeof(ModelHeader), 1, sizeof(ModelInfo))) return false;
+
+		const auto info = Read<ModelInfo>(data, sizeof(ModelHeader));
+		if (info.alignment != sectionAlignment || info.size != data.size()) return false;
+		if (!FitsIn(data, entriesOffset, output.header.numMeshes, sizeof(MeshEntry))) return false;
+		if (GetChecksum(data.subspan(entriesOffset)) != info.checksum) return false;
+
+		for (uint32_t i = 0; i < output.header.numMeshes; i++) {
+			const auto entry = Read<MeshEntry>(data, entriesOffset + i * sizeof(MeshEntry));
+			if (entry.vertexOffset % sectionAlignment != 0 || entry.indexOffset % sectionAlignment != 0) return false;
+			if (!FitsIn(data, entry.vertexOffset, entry.numVertices, sizeof(Vertex))) return false;
+
+			MeshView& mesh = output.meshes.emplace_back();
+			const auto name = reinterpret_cast<const char*>(data.data() + entriesOffset + i * sizeof(MeshEntry));
+			mesh.name = std::string_view(name, strnlen(name, sizeof(MeshEntry::name)));
+			mesh.vertices = { reinterpret_cast<const Vertex*>(data.data() + entry.vertexOffset), entry.numVertices };
+
+			if (entry.indexSize == 0) {
+				if (entry.numIndices != 0) return false;
+				continue;
+			}
+			if (entry.indexSize != sizeof(uint16_t) && entry.indexSize != sizeof(uint32_t)) return false;
+			if (entry.numIndices % 3 != 0 || !FitsIn(data, entry.indexOffset, entry.numIndices, entry.indexSize)) return false;
+
+			const auto indices = data.data() + entry.indexOffset;
+			if (entry.indexSize == sizeof(uint16_t)) {
+				mesh.shortIndices = { reinterpret_cast<const uint16_t*>(indices), entry.numIndices };
+				if (!AreIndicesValid(mesh.shortIndices, entry.numVertices)) return false;
+			}
+			else {
+				mesh.indices = { reinterpret_cast<const uint32_t*>(indices), entry.numIndices };
+				if (!AreIndicesValid(mesh.indices, entry.numVertices)) return false;
+			}
+		}
+		return true;
+	}
+}
+
+// FNV-1a over 8 byte words rather than bytes, in 4 interleaved lanes so the multiplies don't wait on each other. Changing
+// any one word still changes the hash, as xor and the multiply by an odd prime can't map two words to the same value
+uint64_t Renderer::Model::GetChecksum(std::span<const uint8_t> data) {
+	constexpr uint64_t prime = 0x100000001b3;
+	uint64_t lanes[4] = { 0xcbf29ce484222325, 0xcbf29ce484222325 ^ 1, 0xcbf29ce484222325 ^ 2, 0xcbf29ce484222325 ^ 3 };
+	size_t i = 0;
+	for (; i + sizeof(lanes) <= data.size(); i += sizeof(lanes)) {
+		for (size_t lane = 0; lane < 4; lane++) {
+			lanes[lane] ^= Read<uint64_t>(data, i + lane * sizeof(uint64_t));
+			lanes[lane] *= prime;
+		}
+	}
 
-		output.meshes.push_back(mesh);
+	uint64_t hash = lanes[0];
+	for (size_t lane = 1; lane < 4; lane++) {
+		hash ^= lanes[lane];
+		hash *= prime;
+	}
+	for (; i < data.size(); i++) {
+		hash ^= data[i];
+		hash *= prime;
+	}
+	return hash;
+}
+
+bool Renderer::Model::Load(std::span<const uint8_t> data, ModelView& output) {
+	output = {};
+	if (data.size() < sizeof(ModelHeader)) return false;
+
+	output.header = Read<ModelHeader>(data, 0);
+	if (output.header.tag != modelTag) return false;
+
+	bool isLoaded = false;
+	if (output.header.version == 1) isLoaded = LoadV1(data, output);
+	else if (output.header.version == 2) isLoaded = LoadV2(data, output);
+
+	if (!isLoaded) output = {};
+	return isLoaded;
+}
+
+bool Renderer::Model::Load(std::span<const uint8_t> data, Model& output) {
+	ModelView view;
+	if (!Load(data, view)) return false;
+
+	output.header = view.header;
+	output.meshes.clear();
+	output.meshes.reserve(view.meshes.size());
+	for (const auto& meshView : view.meshes) {
+		auto& mesh = output.meshes.emplace_back();
+		std::memcpy(mesh.header.name, meshView.name.data(), std::min(meshView.name.size(), sizeof(mesh.header.name) - 1));
+		mesh.header.numVertices = static_cast<uint32_t>(meshView.vertices.size());
+		mesh.vertices.assign(meshView.vertices.begin(), meshView.vertices.end());
 	}
 
 	return true;
 };
 
+std::vector<uint8_t> Renderer::Model::Serialize(const std::vector<MeshView>& meshes) {
+	const ModelHeader header{ modelTag, 2, static_cast<uint32_t>(meshes.size()) };
+	const size_t entriesOffset = sizeof(ModelHeader) + sizeof(ModelInfo);
+
+	// the sections follow the mesh entries in the same order, vertices first
+	std::vector<MeshEntry> entries(meshes.size());
+	size_t offset = entriesOffset + meshes.size() * sizeof(MeshEntry);
+	for (size_t i = 0; i < meshes.size(); i++) {
+		const auto& mesh = meshes[i];
+		auto& entry = entries[i];
+		std::memcpy(entry.name, mesh.name.data(), std::min(mesh.name.size(), sizeof(entry.name) - 1));
+		entry.numVertices = static_cast<uint32_t>(mesh.vertices.size());
+		entry.vertexOffset = Align(offset);
+		offset = entry.vertexOffset + mesh.vertices.size_bytes();
+
+		if (!mesh.shortIndices.empty() || !mesh.indices.empty()) {
+			entry.indexSize = mesh.shortIndices.empty() ? sizeof(uint32_t) : sizeof(uint16_t);
+			entry.numIndices = static_cast<uint32_t>(mesh.shortIndices.empty() ? mesh.indices.size() : mesh.shortIndices.size());
+			entry.indexOffset = Align(offset);
+			offset = entry.indexOffset + entry.numIndices * entry.indexSize;
+		}
+	}
+
+	std::vector<uint8_t> data(Align(offset), 0);
+	std::memcpy(data.data(), &header, sizeof(ModelHeader));
+	std::memcpy(data.data() + entriesOffset, entries.data(), entries.size() * sizeof(MeshEntry));
+	for (size_t i = 0; i < meshes.size(); i++) {
+		const auto& mesh = meshes[i];
+		std::memcpy(data.data() + entries[i].vertexOffset, mesh.vertices.data(), mesh.vertices.size_bytes());
+		if (!mesh.shortIndices.empty()) std::memcpy(data.data() + entries[i].indexOffset, mesh.shortIndices.data(), mesh.shortIndices.size_bytes());
+		else if (!mesh.indices.empty()) std::memcpy(data.data() + entries[i].indexOffset, mesh.indices.data(), mesh.indices.size_bytes());
+	}
+
+	const ModelInfo info{ sectionAlignment, data.size(), GetChecksum(std::span<const uint8_t>(data).subspan(entriesOffset)) };
+	std::memcpy(data.data() + sizeof(ModelHeader), &info, sizeof(ModelInfo));
+	return data;
+}
+
 void Renderer::Model::Release(Model& mdl) {
 	mdl.header.numMeshes = 0;
 	mdl.meshes.clear();
 	mdl.meshes.shrink_to_fit();
-}
\ No newline at end of file
+}
+
+Renderer::Model::PositionMesh Renderer::Model::WeldVertices(const std::vector<vec3u>& vertices, const std::vector<uint32_t>& indices) {
+	PositionMesh mesh = {};
+	const size_t numIndices = indices.empty() ? vertices.size() - vertices.size() % 3 : indices.size();
+	mesh.indices.reserve(numIndices);
+
+	// welded index per input vertex, so a vertex that is used many times is only hashed once
+	constexpr uint32_t unassigned = UINT32_MAX;
+	std::vector<uint32_t> remap(vertices.size(), unassigned);
+	std::unordered_map<vec3u, uint32_t> positionToIndex;
+	positionToIndex.reserve(vertices.size());
+
+	for (size_t i = 0; i + 3 <= numIndices; i += 3) {
+		uint32_t triangle[3];
+		for (size_t j = 0; j < 3; j++) triangle[j] = indices.empty() ? static_cast<uint32_t>(i + j) : indices[i + j];
+		if (triangle[0] >= vertices.size() || triangle[1] >= vertices.size() || triangle[2] >= vertices.size()) continue;
+
+		for (const uint32_t vertex : triangle) {
+			auto& welded = remap[vertex];
+			if (welded == unassigned) {
+				// adding 0 turns -0 into +0, which otherwise hashes differently
+				const vec3u position = vertices[vertex] + 0.0f;
+				const auto [it, isNew] = positionToIndex.try_emplace(position, static_cast<uint32_t>(mesh.positions.size()));
+				if (isNew) mesh.positions.push_back(position);
+				welded = it->second;
+			}
+			mesh.indices.push_back(welded);
+		}
+	}
+
+	return mesh;
+}
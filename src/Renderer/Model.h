@@ -15,7 +15,7 @@ namespace Renderer
 
 		typedef struct MeshHeader 
 		{
-			const char name[128];
+			char name[128] = {};
 			uint32_t numVertices = 0;
 		} MeshHeader;
 
@@ -25,8 +25,31 @@ namespace Renderer
 			uint32_t version = 0;
 			uint32_t numMeshes = 0;
 		} ModelHeader;
+
+		// v2 only, follows the ModelHeader. The checksum is GetChecksum of every byte after this struct
+		typedef struct ModelInfo 
+		{
+			uint32_t alignment = 0;
+			uint64_t size = 0;
+			uint64_t checksum = 0;
+		} ModelInfo;
+
+		// v2 only, one per mesh after the ModelInfo. The offsets are from the start of the file, and aligned to ModelInfo::alignment
+		typedef struct MeshEntry 
+		{
+			char name[128] = {};
+			uint32_t numVertices = 0;
+			uint32_t numIndices = 0;
+			uint32_t indexSize = 0; // 2 or 4, 0 if the mesh has no indices
+			uint32_t reserved = 0;
+			uint64_t vertexOffset = 0;
+			uint64_t indexOffset = 0;
+		} MeshEntry;
 	#pragma pack(pop)
 
+		constexpr uint32_t modelTag = 0xF00590DA;
+		constexpr uint32_t sectionAlignment = 16;
+
 		typedef struct Mesh 
 		{
 			MeshHeader header = {};
@@ -39,7 +62,46 @@ namespace Renderer
 			std::vector<Mesh> meshes = {};
 		} Model;
 
-		bool Load(const uint8_t* location, Model& output);
+		// A mesh with only positions, for meshes drawn in a single color. Every 3 indices are a triangle
+		typedef struct PositionMesh 
+		{
+			std::vector<vec3u> positions = {};
+			std::vector<uint32_t> indices = {};
+
+			// 16 bit indices are used when they can address every position
+			bool UsesShortIndices() const { return positions.size() <= UINT16_MAX + 1; }
+		} PositionMesh;
+
+		// A mesh inside a loaded model file, without copying it. At most one of the index views is set
+		typedef struct MeshView 
+		{
+			std::string_view name = {};
+			std::span<const Vertex> vertices = {};
+			std::span<const uint16_t> shortIndices = {};
+			std::span<const uint32_t> indices = {};
+		} MeshView;
+
+		typedef struct ModelView 
+		{
+			ModelHeader header = {};
+			std::vector<MeshView> meshes = {};
+		} ModelView;
+
+		// Validates a v1 or v2 model and points the views into data, which has to outlive output. v2 data has to be
+		// aligned to sectionAlignment, which a resource blob or a buffer from operator new is.
+		// No model files are loaded by the plugin yet, so nothing uploads the views without a copy
+		bool Load(std::span<const uint8_t> data, ModelView& output);
+		// Same as above, but copies the vertices so data can be released
+		bool Load(std::span<const uint8_t> data, Model& output);
 		void Release(Model& mdl);
+
+		// Writes the meshes as a v2 model
+		std::vector<uint8_t> Serialize(const std::vector<MeshView>& meshes);
+		// FNV-1a over the 8 byte words of data in 4 lanes, for ModelInfo::checksum
+		uint64_t GetChecksum(std::span<const uint8_t> data);
+
+		// Merges vertices at exactly the same position and drops unused ones. If indices is empty, every 3 vertices are a triangle.
+		// Triangles with an index past the end of vertices are dropped
+		PositionMesh WeldVertices(const std::vector<vec3u>& vertices, const std::vector<uint32_t>& indices = {});
 	}
 }
\ No newline at end of file
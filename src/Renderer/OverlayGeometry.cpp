@@ -0,0 +1,125 @@
+#include "OverlayGeometry.h"
+
+namespace Renderer
+{
+	uint32_t LineVertex::PackColor(const glm::vec4& color) noexcept
+	{
+		const auto c = glm::round(glm::clamp(color, 0.0f, 1.0f) * 255.0f);
+		return  static_cast<uint32_t>(c.r) |
+				static_cast<uint32_t>(c.g) << 8 |
+				static_cast<uint32_t>(c.b) << 16 |
+				static_cast<uint32_t>(c.a) << 24;
+	}
+
+	uint32_t LineVertex::PackColor(uint32_t rgb, uint32_t alpha) noexcept
+	{
+		uint32_t a = (std::min(alpha, 100u) * 255 + 50) / 100;
+		return	(rgb >> 16 & 0xFF) |
+				(rgb >> 8 & 0xFF) << 8 |
+				(rgb & 0xFF) << 16 |
+				a << 24;
+	}
+
+	void OverlayGeometry::AddPolygon(std::span<const glm::vec3> points, uint32_t color)
+	{
+		TriangulateFan(points, color, fills);
+	}
+
+	void OverlayGeometry::AddPolygonBorder(std::span<const glm::vec3> points, float width, uint32_t color)
+	{
+		if (points.size() < 2) return;
+
+		for (size_t i = 0; i < points.size(); i++)
+		{
+			const auto& next = points[i + 1 == points.size() ? 0 : i + 1];
+			AddLine(points[i], next, width, width, color);
+		}
+	}
+
+	void OverlayGeometry::AddLine(const glm::vec3& start, const glm::vec3& end, float startWidth, float endWidth, uint32_t color)
+	{
+		lines.push_back(Line{ start, end, startWidth, endWidth, color });
+	}
+
+	void OverlayGeometry::AddDisc(const glm::vec3& center, float radius, uint32_t color)
+	{
+		discs.push_back(Disc{ center, radius, color });
+	}
+
+	void OverlayGeometry::BuildStrokes(const glm::vec3& cameraPosition, const glm::vec3& cameraRight, const glm::vec3& cameraUp, float widthScale)
+	{
+		strokes.clear();
+		for (const auto& line : lines)
+		{
+			ExpandLine(line.start, line.end, line.startWidth * widthScale, line.endWidth * widthScale, line.color, cameraPosition, strokes);
+		}
+		for (const auto& disc : discs)
+		{
+			ExpandDisc(disc.center, disc.radius * widthScale, disc.color, cameraRight, cameraUp, strokes);
+		}
+	}
+
+	void OverlayGeometry::Clear()
+	{
+		fills.clear();
+		lines.clear();
+		discs.clear();
+		strokes.clear();
+	}
+
+	void OverlayGeometry::TriangulateFan(std::span<const glm::vec3> points, uint32_t color, std::vector<LineVertex>& output)
+	{
+		if (points.size() < 3) return;
+
+		for (size_t i = 1; i + 1 < points.size(); i++)
+		{
+			output.emplace_back(points[0], color);
+			output.emplace_back(points[i], color);
+			output.emplace_back(points[i + 1], color);
+		}
+	}
+
+	void OverlayGeometry::ExpandLine(const glm::vec3& start, const glm::vec3& end, float startWidth, float endWidth, uint32_t color, const glm::vec3& cameraPosition, std::vector<LineVertex>& output)
+	{
+		glm::vec3 direction = end - start;
+		if (glm::dot(direction, direction) < 1e-8f) return;
+
+		glm::vec3 side = glm::cross(direction, (start + end) * 0.5f - cameraPosition);
+		float sideLength = glm::length(side);
+		if (sideLength < 1e-6f) return; // looking straight along the line, it covers no area
+
+		side /= sideLength;
+		glm::vec3 startOffset = side * (startWidth * 0.5f);
+		glm::vec3 endOffset = side * (endWidth * 0.5f);
+
+		LineVertex startLeft{ start - startOffset, color };
+		LineVertex startRight{ start + startOffset, color };
+		LineVertex endLeft{ end - endOffset, color };
+		LineVertex endRight{ end + endOffset, color };
+
+		output.push_back(startLeft);
+		output.push_back(startRight);
+		output.push_back(endRight);
+
+		output.push_back(startLeft);
+		output.push_back(endRight);
+		output.push_back(endLeft);
+	}
+
+	void OverlayGeometry::ExpandDisc(const glm::vec3& center, float radius, uint32_t color, const glm::vec3& right, const glm::vec3& up, std::vector<LineVertex>& output)
+	{
+		constexpr float angleDelta = glm::two_pi<float>() / discSegments;
+
+		glm::vec3 previous = center + right * radius;
+		for (uint32_t i = 1; i <= discSegments; i++)
+		{
+			float angle = angleDelta * i;
+			glm::vec3 current = i == discSegments ? center + right * radius : center + (right * std::cos(angle) + up * std::sin(angle)) * radius;
+
+			output.emplace_back(center, color);
+			output.emplace_back(previous, color);
+			output.emplace_back(current, color);
+			previous = current;
+		}
+	}
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+namespace Renderer
+{
+	// Line vertex with the color packed as RGBA8, half the size of a vec4 position and a vec4 color
+	struct LineVertex
+	{
+		glm::vec3 pos;
+		uint32_t col;
+
+		LineVertex(const glm::vec3& position, const glm::vec4& color) : pos(position), col(PackColor(color)) {}
+		LineVertex(const glm::vec3& position, uint32_t packedColor) : pos(position), col(packedColor) {}
+
+		// R in the lowest byte, which is read as DXGI_FORMAT_R8G8B8A8_UNORM
+		static uint32_t PackColor(const glm::vec4& color) noexcept;
+		// 0xRRGGBB and an alpha of 0 - 100, the colors used by DrawHandler
+		static uint32_t PackColor(uint32_t rgb, uint32_t alpha) noexcept;
+	};
+	static_assert(sizeof(LineVertex) == 16);
+
+	// Triangles of the screen overlay, the D3D11 backend of DrawHandler, as a triangle list in world space, so the gpu
+	// projects and clips them. Polygons are fanned into triangles when they are added. Lines and points face the camera,
+	// so they are kept and expanded into quads and discs by BuildStrokes whenever the camera moves.
+	// It does not touch D3D or the game, so it can be used on its own
+	class OverlayGeometry
+	{
+		public:
+			static constexpr uint32_t discSegments = 12;
+
+			// Convex polygon, 3 or more points. Colors are packed with LineVertex::PackColor
+			void		AddPolygon(std::span<const glm::vec3> points, uint32_t color);
+			// The closed outline of a polygon
+			void		AddPolygonBorder(std::span<const glm::vec3> points, float width, uint32_t color);
+			// Widths and radii are scaled by the widthScale of BuildStrokes
+			void		AddLine(const glm::vec3& start, const glm::vec3& end, float startWidth, float endWidth, uint32_t color);
+			void		AddDisc(const glm::vec3& center, float radius, uint32_t color);
+
+			// Expands the lines and discs, facing a camera at the position with the right and up vectors of the screen
+			void		BuildStrokes(const glm::vec3& cameraPosition, const glm::vec3& cameraRight, const glm::vec3& cameraUp, float widthScale);
+			void		Clear();
+
+			const std::vector<LineVertex>&	GetFills() const { return fills; }
+			const std::vector<LineVertex>&	GetStrokes() const { return strokes; }
+			bool							HasStrokes() const { return !lines.empty() || !discs.empty(); }
+
+			// fan from the first point: (0, 1, 2), (0, 2, 3), ...
+			static void	TriangulateFan(std::span<const glm::vec3> points, uint32_t color, std::vector<LineVertex>& output);
+			// two triangles spanning the line, widened perpendicular to the line and the direction to the camera. Nothing if the line has no length
+			static void	ExpandLine(const glm::vec3& start, const glm::vec3& end, float startWidth, float endWidth, uint32_t color, const glm::vec3& cameraPosition, std::vector<LineVertex>& output);
+			// discSegments triangles around the center, in the plane of the right and up vectors
+			static void	ExpandDisc(const glm::vec3& center, float radius, uint32_t color, const glm::vec3& right, const glm::vec3& up, std::vector<LineVertex>& output);
+
+		private:
+			struct Line
+			{
+				glm::vec3	start;
+				glm::vec3	end;
+				float		startWidth;
+				float		endWidth;
+				uint32_t	color;
+			};
+
+			struct Disc
+			{
+				glm::vec3	center;
+				float		radius;
+				uint32_t	color;
+			};
+
+			std::vector<LineVertex>	fills;
+			std::vector<Line>		lines;
+			std::vector<Disc>		discs;
+			std::vector<LineVertex>	strokes;	// rebuilt from lines and discs
+	};
+}
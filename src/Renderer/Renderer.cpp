@@ -1,4 +1,5 @@
 #include "Renderer.h"
+#include "Profiler.h"
 
 namespace Renderer
 {
@@ -17,6 +18,31 @@ namespace Renderer
         d3dObjects.loadedDepthStates.emplace(key, std::move(state));
     }
 
+    void SetBlendState(D3DContext& ctx, bool alphaBlend) noexcept
+    {
+        BlendStateKey key;
+        auto& target = key.desc.RenderTarget[0];
+        target.BlendEnable = alphaBlend;
+        target.SrcBlend = alphaBlend ? D3D11_BLEND::D3D11_BLEND_SRC_ALPHA : D3D11_BLEND::D3D11_BLEND_ONE;
+        target.DestBlend = alphaBlend ? D3D11_BLEND::D3D11_BLEND_INV_SRC_ALPHA : D3D11_BLEND::D3D11_BLEND_ZERO;
+        target.BlendOp = D3D11_BLEND_OP::D3D11_BLEND_OP_ADD;
+        target.SrcBlendAlpha = D3D11_BLEND::D3D11_BLEND_ONE;
+        target.DestBlendAlpha = alphaBlend ? D3D11_BLEND::D3D11_BLEND_INV_SRC_ALPHA : D3D11_BLEND::D3D11_BLEND_ZERO;
+        target.BlendOpAlpha = D3D11_BLEND_OP::D3D11_BLEND_OP_ADD;
+        target.RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
+
+        auto it = d3dObjects.loadedBlendStates.find(key);
+        if (it != d3dObjects.loadedBlendStates.end()) 
+        {
+            ctx.context->OMSetBlendState(it->second.state.get(), key.factors, 0xFFFFFFFF);
+            return;
+        }
+
+        auto state = BlendState{ctx, key};
+        ctx.context->OMSetBlendState(state.state.get(), key.factors, 0xFFFFFFFF);
+        d3dObjects.loadedBlendStates.emplace(key, std::move(state));
+    }
+
     void OnPresent(DrawFunc&& callback) noexcept 
     { 
         presentCallbacks.emplace_back(callback);
@@ -163,6 +189,7 @@ namespace Renderer
             gameContext.context->OMGetRenderTargets(1, d3dObjects.gameRTV.put(), d3dObjects.depthStencilView.put());
 
             {
+                PROFILE_SCOPE("Renderer::Present callbacks");
                 for (auto& callback : presentCallbacks) 
 				{
                     callback(gameContext);
@@ -21,6 +21,7 @@ namespace Renderer
 
 
     void        SetDepthState(D3DContext& ctx, bool writeEnable, bool testEnable, D3D11_COMPARISON_FUNC testFunc) noexcept;
+    void        SetBlendState(D3DContext& ctx, bool alphaBlend) noexcept; // straight alpha over the render target, or no blending
     void        OnPresent(DrawFunc&& callback) noexcept;
     HRESULT     Present(IDXGISwapChain* swapChain, UINT syncInterval, UINT flags);
     void        InstallHooks();
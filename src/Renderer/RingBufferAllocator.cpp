@@ -0,0 +1,22 @@
+#include "RingBufferAllocator.h"
+
+namespace Renderer
+{
+    RingBufferAllocator::Allocation RingBufferAllocator::Allocate(uint32_t count) noexcept
+    {
+        if (count > capacity)
+        {
+            capacity = std::bit_ceil(count);
+            writeOffset = count;
+            return { 0, true, true };
+        }
+        if (count > capacity - writeOffset)
+        {
+            writeOffset = count;
+            return { 0, true, false };
+        }
+        Allocation allocation{ writeOffset, false, false };
+        writeOffset += count;
+        return allocation;
+    }
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+namespace Renderer
+{
+    // Bookkeeping of a ring buffer that is appended to with MAP_WRITE_NO_OVERWRITE. When the buffer is full it wraps around
+    // with MAP_WRITE_DISCARD, which makes the driver hand out new memory, so the gpu never reads memory that is being overwritten.
+    // Only one allocation is made per frame. It does not touch D3D, so it can be used without a device
+    class RingBufferAllocator 
+    {
+        public:
+            struct Allocation 
+            {
+                uint32_t offset = 0;	// in elements
+                bool discard = false;	// the buffer must be mapped with MAP_WRITE_DISCARD
+                bool grow = false;		// the buffer must be recreated with Capacity() elements first
+            };
+
+            explicit RingBufferAllocator(uint32_t capacity) noexcept : capacity(capacity), writeOffset(capacity) {}
+
+            Allocation Allocate(uint32_t count) noexcept;
+            uint32_t Capacity() const noexcept { return capacity; }
+
+        private:
+            uint32_t capacity;
+            uint32_t writeOffset; // starts full, so the first allocation discards
+    };
+}
@@ -0,0 +1,268 @@
+#include "ShaderDiskCache.h"
+#include "DebugMenu/WorkerPool.h"
+
+namespace Renderer
+{
+	namespace
+	{
+		uint64_t HashBytes(std::span<const uint8_t> a_data, uint64_t a_hash = 0xcbf29ce484222325)
+		{
+			for (const uint8_t byte : a_data)
+			{
+				a_hash ^= byte;
+				a_hash *= 0x100000001b3;
+			}
+			return a_hash;
+		}
+
+		// the length is hashed as well, so moving characters from one string to the next changes the hash
+		uint64_t HashString(std::string_view a_string, uint64_t a_hash = 0xcbf29ce484222325)
+		{
+			a_hash = HashBytes({ reinterpret_cast<const uint8_t*>(a_string.data()), a_string.size() }, a_hash);
+			const uint64_t size = a_string.size();
+			return HashBytes({ reinterpret_cast<const uint8_t*>(&size), sizeof(size) }, a_hash);
+		}
+
+		template <class T>
+		void Append(std::vector<uint8_t>& a_buffer, const T& a_value)
+		{
+			auto bytes = reinterpret_cast<const uint8_t*>(&a_value);
+			a_buffer.insert(a_buffer.end(), bytes, bytes + sizeof(T));
+		}
+	}
+
+	ShaderDiskCache::ShaderDiskCache(std::filesystem::path a_path, std::unique_ptr<ShaderCompiler> a_compiler) :
+		path(std::move(a_path)), compiler(std::move(a_compiler))
+	{
+	}
+
+	ShaderDiskCache::~ShaderDiskCache()
+	{
+		Wait();
+	}
+
+	// the source is hashed with FNV-1a instead of std::hash, since the key has to be the same in every session
+	uint64_t ShaderDiskCache::GetKey(const ShaderCompileJob& a_job, uint64_t a_compilerVersion)
+	{
+		uint64_t hash = HashString(a_job.source);
+		hash = HashString(a_job.entryName, hash);
+		hash = HashString(a_job.target, hash);
+		hash ^= static_cast<uint64_t>(a_job.infoHash) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		hash ^= a_compilerVersion + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		return hash;
+	}
+
+	void ShaderDiskCache::Prefetch(std::vector<ShaderCompileJob> a_jobs)
+	{
+		Wait();
+
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			for (const auto& job : a_jobs)
+			{
+				const uint64_t key = GetKey(job, compiler->GetVersion());
+				usedKeys.insert(key);
+				if (!entries.contains(key)) pendingKeys.insert(key);
+			}
+			isPrefetching = true;
+		}
+
+		// the prefetch is finished when the task is destroyed, so it is also finished if the pool discards the task without running it
+		std::shared_ptr<void> finish(nullptr, [this](void*) { FinishPrefetch(); });
+
+		DebugMenu::GetWorkerPool().Submit([this, jobs = std::move(a_jobs), finish = std::move(finish)]()
+		{
+			auto start = std::chrono::high_resolution_clock::now();
+
+			Read();
+
+			uint32_t numberOfCompiledShaders = 0;
+			for (const auto& job : jobs)
+			{
+				const uint64_t key = GetKey(job, compiler->GetVersion());
+				{
+					std::lock_guard<std::mutex> guard(lock);
+					if (!pendingKeys.contains(key)) continue;
+				}
+
+				auto bytecode = compiler->Compile(job);
+
+				{
+					std::lock_guard<std::mutex> guard(lock);
+					if (!bytecode.empty())
+					{
+						entries[key] = std::move(bytecode);
+						numberOfCompiledShaders++;
+					}
+					pendingKeys.erase(key);
+				}
+				compiled.notify_all();
+			}
+
+			if (numberOfCompiledShaders > 0) Write();
+
+			auto stop = std::chrono::high_resolution_clock::now();
+			logger::debug("Prefetched {} shaders, {} were not cached, in {} us", jobs.size(), numberOfCompiledShaders, std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count());
+		});
+	}
+
+	std::vector<uint8_t> ShaderDiskCache::GetBytecode(const ShaderCompileJob& a_job)
+	{
+		const uint64_t key = GetKey(a_job, compiler->GetVersion());
+
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			compiled.wait(guard, [&]() { return !pendingKeys.contains(key); });
+
+			usedKeys.insert(key);
+			auto it = entries.find(key);
+			if (it != entries.end()) return it->second;
+		}
+
+		// not prefetched, or the worker failed to compile it (in which case the errors are logged again here)
+		auto bytecode = compiler->Compile(a_job);
+		if (bytecode.empty()) return bytecode;
+
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			entries[key] = bytecode;
+		}
+
+		// the worker writes the file itself, and could miss this entry if it is still running
+		Wait();
+		Write();
+		return bytecode;
+	}
+
+	void ShaderDiskCache::Wait()
+	{
+		std::unique_lock<std::mutex> guard(lock);
+		compiled.wait(guard, [&]() { return !isPrefetching; });
+	}
+
+	// the jobs that are still pending were not run, they are compiled by GetBytecode instead. Notified while locked,
+	// since the cache can be destroyed as soon as Wait sees the prefetch finish
+	void ShaderDiskCache::FinishPrefetch()
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		pendingKeys.clear();
+		isPrefetching = false;
+		compiled.notify_all();
+	}
+
+	// the entries read from the file are only added if they are not compiled yet
+	void ShaderDiskCache::Read()
+	{
+		std::ifstream stream(path, std::ios::binary);
+		if (!stream) return;
+
+		std::vector<uint8_t> data{ std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>() };
+
+		Entries fileEntries;
+		if (!Deserialize(data, compiler->GetVersion(), fileEntries))
+		{
+			logger::debug("Shader disk cache is outdated or corrupted, it will be rebuilt");
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			for (auto& [key, bytecode] : fileEntries)
+			{
+				if (!pendingKeys.contains(key)) continue;
+				entries.try_emplace(key, std::move(bytecode));
+				pendingKeys.erase(key);
+			}
+		}
+		compiled.notify_all();
+	}
+
+	// Written next to the old file and then moved, so a crash while writing does not leave a broken file
+	void ShaderDiskCache::Write()
+	{
+		std::vector<uint8_t> buffer;
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			Entries usedEntries;
+			for (const auto& [key, bytecode] : entries)
+			{
+				if (usedKeys.contains(key)) usedEntries.emplace(key, bytecode);
+			}
+			buffer = Serialize(usedEntries, compiler->GetVersion());
+		}
+
+		std::error_code error;
+		std::filesystem::create_directories(path.parent_path(), error);
+
+		auto tempPath = path;
+		tempPath += L".tmp";
+		{
+			std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+			stream.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+			if (!stream)
+			{
+				logger::debug("Failed to write shader disk cache");
+				return;
+			}
+		}
+
+		std::filesystem::rename(tempPath, path, error);
+		if (error) logger::debug("Failed to replace shader disk cache; {}", error.message());
+	}
+
+	// sorted by key, so the same shaders always give the same file
+	std::vector<uint8_t> ShaderDiskCache::Serialize(const Entries& a_entries, uint64_t a_compilerVersion)
+	{
+		std::vector<uint64_t> keys;
+		keys.reserve(a_entries.size());
+		for (const auto& [key, bytecode] : a_entries) keys.push_back(key);
+		std::sort(keys.begin(), keys.end());
+
+		std::vector<uint8_t> buffer(sizeof(Header));
+		for (uint64_t key : keys)
+		{
+			const auto& bytecode = a_entries.at(key);
+			Append(buffer, EntryHeader{ key, bytecode.size() });
+			buffer.insert(buffer.end(), bytecode.begin(), bytecode.end());
+		}
+
+		Header header{};
+		header.magic = magic;
+		header.version = version;
+		header.compilerVersion = a_compilerVersion;
+		header.checksum = HashBytes(std::span<const uint8_t>(buffer).subspan(sizeof(Header)));
+		header.numberOfEntries = static_cast<uint32_t>(keys.size());
+		std::memcpy(buffer.data(), &header, sizeof(Header));
+		return buffer;
+	}
+
+	bool ShaderDiskCache::Deserialize(std::span<const uint8_t> a_data, uint64_t a_compilerVersion, Entries& a_output)
+	{
+		a_output.clear();
+		if (a_data.size() < sizeof(Header)) return false;
+
+		Header header;
+		std::memcpy(&header, a_data.data(), sizeof(Header));
+		if (header.magic != magic || header.version != version || header.compilerVersion != a_compilerVersion) return false;
+		if (HashBytes(a_data.subspan(sizeof(Header))) != header.checksum) return false;
+
+		Entries entries;
+		size_t position = sizeof(Header);
+		for (uint32_t i = 0; i < header.numberOfEntries; i++)
+		{
+			EntryHeader entry;
+			if (a_data.size() - position < sizeof(EntryHeader)) return false;
+			std::memcpy(&entry, a_data.data() + position, sizeof(EntryHeader));
+			position += sizeof(EntryHeader);
+
+			if (entry.size == 0 || a_data.size() - position < entry.size) return false;
+			entries[entry.key].assign(a_data.begin() + position, a_data.begin() + position + entry.size);
+			position += entry.size;
+		}
+
+		if (position != a_data.size()) return false;
+
+		a_output = std::move(entries);
+		return true;
+	}
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+namespace Renderer
+{
+	// Everything needed to compile a shader, without depending on D3D
+	struct ShaderCompileJob
+	{
+		size_t		infoHash = 0;	// ShaderCreateInfo::Hash
+		std::string	source;
+		std::string	entryName;
+		std::string	target;			// eg. vs_5_0
+	};
+
+	class ShaderCompiler
+	{
+		public:
+			virtual ~ShaderCompiler() = default;
+
+			// Changes when the compiler can produce different bytecode, which invalidates the cache file
+			virtual uint64_t				GetVersion() const = 0;
+			// Empty if the shader failed to compile. Called from a worker
+			virtual std::vector<uint8_t>	Compile(const ShaderCompileJob& job) = 0;
+	};
+
+	// Compiled shader bytecode kept on disk between sessions. The file is read, and the shaders missing from it compiled,
+	// in a task Prefetch submits to the worker pool, so the bytecode is usually ready when the renderer starts.
+	// Entries are keyed by the create info hash, a hash of the source text and the compiler version
+	class ShaderDiskCache
+	{
+		public:
+			using Entries = std::unordered_map<uint64_t, std::vector<uint8_t>>;
+
+			ShaderDiskCache(std::filesystem::path path, std::unique_ptr<ShaderCompiler> compiler);
+			~ShaderDiskCache();
+			ShaderDiskCache(const ShaderDiskCache&) = delete;
+			ShaderDiskCache& operator=(const ShaderDiskCache&) = delete;
+
+			// Reads the file and compiles the jobs that are not in it on a worker, then writes the file if anything was compiled
+			void					Prefetch(std::vector<ShaderCompileJob> jobs);
+			// Waits for the job if it was prefetched, and compiles it on the calling thread if it was not. Empty if it failed to compile
+			std::vector<uint8_t>	GetBytecode(const ShaderCompileJob& job);
+			// Waits for the prefetch task to finish
+			void					Wait();
+
+			static uint64_t				GetKey(const ShaderCompileJob& job, uint64_t compilerVersion);
+			static std::vector<uint8_t>	Serialize(const Entries& entries, uint64_t compilerVersion);
+			// False if the data is not a valid cache file for the compiler version
+			static bool					Deserialize(std::span<const uint8_t> data, uint64_t compilerVersion, Entries& output);
+
+		private:
+			static constexpr uint32_t magic = 0x43534D44; // "DMSC"
+			static constexpr uint32_t version = 1;
+
+			struct Header
+			{
+				uint32_t	magic;
+				uint32_t	version;
+				uint64_t	compilerVersion;
+				uint64_t	checksum; // FNV-1a of everything after the header
+				uint32_t	numberOfEntries;
+				uint32_t	pad = 0;
+			};
+
+			// followed by size bytes of bytecode
+			struct EntryHeader
+			{
+				uint64_t	key;
+				uint64_t	size;
+			};
+
+			std::filesystem::path				path;
+			std::unique_ptr<ShaderCompiler>		compiler;
+			std::mutex							lock;
+			std::condition_variable				compiled;
+			bool								isPrefetching = false;
+			Entries								entries;
+			std::unordered_set<uint64_t>		pendingKeys;	// prefetched, but not read or compiled yet
+			std::unordered_set<uint64_t>		usedKeys;		// only these are written, so entries of changed shaders are dropped
+
+			void	Read();
+			void	Write();
+			void	FinishPrefetch();
+	};
+}
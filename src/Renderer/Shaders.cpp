@@ -4,16 +4,74 @@
 
 namespace Renderer
 {
-    ShaderCache::ShaderCache() noexcept {};
+    namespace
+    {
+        class D3DShaderCompiler : public ShaderCompiler
+        {
+            public:
+                static constexpr UINT compileFlags = D3DCOMPILE_ENABLE_STRICTNESS | D3DCOMPILE_PACK_MATRIX_COLUMN_MAJOR;
+
+                uint64_t GetVersion() const override 
+                {
+                    return (static_cast<uint64_t>(D3D_COMPILER_VERSION) << 32) | compileFlags;
+                }
+
+                std::vector<uint8_t> Compile(const ShaderCompileJob& job) override 
+                {
+                    winrt::com_ptr<ID3DBlob> binary;
+                    winrt::com_ptr<ID3DBlob> errorBlob;
+
+                    const auto result = D3DCompile(job.source.c_str(), job.source.length(), nullptr, nullptr, nullptr, job.entryName.c_str(),
+                                                   job.target.c_str(), compileFlags, 0, binary.put(), errorBlob.put());
+
+                    if (!SUCCEEDED(result)) {
+                        if (errorBlob) {
+                            logger::debug("Shader compilation failed; {}", static_cast<const char*>(errorBlob->GetBufferPointer()));
+                        }
+                        return {};
+                    }
+
+                    const auto bytes = static_cast<const uint8_t*>(binary->GetBufferPointer());
+                    return std::vector<uint8_t>(bytes, bytes + binary->GetBufferSize());
+                }
+        };
+    }
+
+    ShaderCache::ShaderCache() noexcept :
+        diskCache(std::make_unique<ShaderDiskCache>(L"Data/SKSE/plugins/DebugMenu/ShaderCache.bin", std::make_unique<D3DShaderCompiler>())) 
+    {};
 
     
 void ShaderCache::Release() noexcept { shaders.clear(); }
 
+    ShaderCompileJob ShaderCache::GetCompileJob(const ShaderCreateInfo& info) 
+    {
+        const auto target = info.stage == PipelineStage::Vertex ? std::string("vs_").append(info.version) : std::string("ps_").append(info.version);
+        return ShaderCompileJob{ info.Hash(), info.source.source, info.entryName, target };
+    }
+
+    void ShaderCache::Prefetch(const std::vector<ShaderCreateInfo>& infos) noexcept 
+    {
+        std::vector<ShaderCompileJob> jobs;
+        jobs.reserve(infos.size());
+        for (const auto& info : infos) jobs.push_back(GetCompileJob(info));
+
+        diskCache->Prefetch(std::move(jobs));
+    }
+
+    std::vector<uint8_t> ShaderCache::GetBytecode(const ShaderCreateInfo& info) noexcept 
+    {
+        return diskCache->GetBytecode(GetCompileJob(info));
+    }
+
     Shader::Shader(const ShaderCreateInfo& createInfo, D3DContext& ctx) noexcept
         : stage(createInfo.stage), context(ctx) 
 	{
-        validBinary = Compile(createInfo.source.source, createInfo.entryName, createInfo.version);
+        const auto bytecode = ShaderCache::Get().GetBytecode(createInfo);
+        validBinary = !bytecode.empty() && SUCCEEDED(D3DCreateBlob(bytecode.size(), binary.put()));
         if (!validBinary) return;
+        std::memcpy(binary->GetBufferPointer(), bytecode.data(), bytecode.size());
+
         if (stage == PipelineStage::Vertex) 
 		{
             const auto result = context.device->CreateVertexShader(binary->GetBufferPointer(), binary->GetBufferSize(), nullptr, &program.vertex);
@@ -52,26 +110,6 @@ void ShaderCache::Release() noexcept { shaders.clear(); }
         }
     }
 
-    bool Shader::Compile(const std::string& source, const std::string& entryName,
-                                 const std::string& version) noexcept {
-        constexpr UINT compileFlags = D3DCOMPILE_ENABLE_STRICTNESS | D3DCOMPILE_PACK_MATRIX_COLUMN_MAJOR;
-        winrt::com_ptr<ID3DBlob> errorBlob;
-
-        auto versionStr =
-            stage == PipelineStage::Vertex ? std::string("vs_").append(version) : std::string("ps_").append(version);
-
-        const auto result = D3DCompile(source.c_str(), source.length(), nullptr, nullptr, nullptr, entryName.c_str(),
-                                       versionStr.c_str(), compileFlags, 0, binary.put(), errorBlob.put());
-
-        if (!SUCCEEDED(result)) {
-            if (errorBlob) {
-                logger::debug("Shader compilation failed; {}", static_cast<const char*>(errorBlob->GetBufferPointer()));
-            }
-            return false;
-        }
-        return true;
-    }
-
     bool Shader::IsValid() const noexcept { return validProgram && validBinary; }
 
     std::shared_ptr<Shader> ShaderCache::Load(const ShaderCreateInfo& info, D3DContext& ctx) noexcept 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "D3DContext.h"
+#include "ShaderDiskCache.h"
 #include <winrt/base.h>
 
 
@@ -88,6 +89,7 @@ struct VS_OUTPUT {
 
 cbuffer PerObject : register(b0) {
 	float4x4 matModel;
+	float4 color;
 };
 
 cbuffer PerFrame : register(b1) {
@@ -134,6 +136,126 @@ PS_OUTPUT main(PS_INPUT input) {
 	PS_OUTPUT output;
 	// scale tint.rgb by color.xyz so that black colors remain unchanged
 	output.color = float4(lerp(input.color.xyz, tint.xyz * input.color.xyz, 0.5f), input.color.w);
+	return output;
+}
+		)" };
+
+		// same as VertexColorWorldVS, but the model matrix and color are per instance
+		constexpr ShaderDecl VertexColorWorldInstancedVS = {
+			6,
+			R"(
+struct VS_INPUT {
+	float3 vPos     : POS;
+	float2 vUV      : UV;
+	float3 vNormal  : NORMAL;
+	float4 vColor   : COLOR;
+	float4 vModel0  : MODEL0;
+	float4 vModel1  : MODEL1;
+	float4 vModel2  : MODEL2;
+	float4 vModel3  : MODEL3;
+	float4 vInstanceColor : INSTANCECOLOR;
+};
+
+struct VS_OUTPUT {
+	float4 vPos     : SV_POSITION;
+	float2 vUV      : COLOR0;
+	float3 vNormal  : COLOR1;
+	float4 vColor   : COLOR2;
+};
+
+cbuffer PerFrame : register(b1) {
+	float4x4 matProjView;
+};
+
+VS_OUTPUT main(VS_INPUT input) {
+	// the model matrix is passed as columns
+	float4 pos = input.vModel0 * input.vPos.x + input.vModel1 * input.vPos.y + input.vModel2 * input.vPos.z + input.vModel3;
+	pos = mul(matProjView, pos);
+
+	VS_OUTPUT output;
+	output.vPos = pos;
+	output.vUV = input.vUV;
+	output.vNormal = input.vNormal;
+	output.vColor = input.vInstanceColor;
+
+	return output;
+}
+		)" };
+
+		// for meshes with only positions, colored by the per object color
+		constexpr ShaderDecl PositionWorldVS = {
+			7,
+			R"(
+struct VS_INPUT {
+	float3 vPos     : POS;
+};
+
+struct VS_OUTPUT {
+	float4 vPos     : SV_POSITION;
+	float2 vUV      : COLOR0;
+	float3 vNormal  : COLOR1;
+	float4 vColor   : COLOR2;
+};
+
+cbuffer PerObject : register(b0) {
+	float4x4 matModel;
+	float4 color;
+};
+
+cbuffer PerFrame : register(b1) {
+	float4x4 matProjView;
+};
+
+VS_OUTPUT main(VS_INPUT input) {
+	float4 pos = float4(input.vPos, 1.0f);
+	pos = mul(matModel, pos);
+	pos = mul(matProjView, pos);
+
+	VS_OUTPUT output;
+	output.vPos = pos;
+	output.vUV = float2(0.0f, 0.0f);
+	output.vNormal = float3(0.0f, 0.0f, 0.0f);
+	output.vColor = color;
+
+	return output;
+}
+		)" };
+
+		// for meshes with only positions, the model matrix and color are per instance
+		constexpr ShaderDecl PositionWorldInstancedVS = {
+			8,
+			R"(
+struct VS_INPUT {
+	float3 vPos     : POS;
+	float4 vModel0  : MODEL0;
+	float4 vModel1  : MODEL1;
+	float4 vModel2  : MODEL2;
+	float4 vModel3  : MODEL3;
+	float4 vInstanceColor : INSTANCECOLOR;
+};
+
+struct VS_OUTPUT {
+	float4 vPos     : SV_POSITION;
+	float2 vUV      : COLOR0;
+	float3 vNormal  : COLOR1;
+	float4 vColor   : COLOR2;
+};
+
+cbuffer PerFrame : register(b1) {
+	float4x4 matProjView;
+};
+
+VS_OUTPUT main(VS_INPUT input) {
+	// the model matrix is passed as columns
+	float4 pos = input.vModel0 * input.vPos.x + input.vModel1 * input.vPos.y + input.vModel2 * input.vPos.z + input.vModel3;
+	pos = mul(matProjView, pos);
+
+	VS_OUTPUT output;
+	output.vPos = pos;
+	output.vUV = float2(0.0f, 0.0f);
+	output.vNormal = float3(0.0f, 0.0f, 0.0f);
+	output.vColor = input.vInstanceColor;
+
 	return output;
 }
 		)" };
@@ -200,8 +322,6 @@ PS_OUTPUT main(PS_INPUT input) {
             ID3D11PixelShader* fragment;
         } program;
 
-        bool Compile(const std::string& source, const std::string& entryName, const std::string& version) noexcept;
-
         friend class VertexBuffer;
     };
 
@@ -222,6 +342,13 @@ PS_OUTPUT main(PS_INPUT input) {
 
             std::shared_ptr<Shader> Load(const ShaderCreateInfo& info, Renderer::D3DContext& ctx) noexcept;
 
+            // Reads the compiled shaders from disk and compiles the missing ones on a worker thread, so Load does not have to
+            // compile them. Can be called before the D3D device exists
+            void Prefetch(const std::vector<ShaderCreateInfo>& infos) noexcept;
+
+            // Bytecode of the shader from the disk cache, compiled if it is not cached. Empty if it failed to compile
+            std::vector<uint8_t> GetBytecode(const ShaderCreateInfo& info) noexcept;
+
             struct SCIHasher 
             {
                 size_t operator()(const ShaderCreateInfo& key) const { return key.Hash(); }
@@ -237,6 +364,9 @@ PS_OUTPUT main(PS_INPUT input) {
 
         private:
             std::unordered_map<ShaderCreateInfo, std::weak_ptr<Renderer::Shader>, SCIHasher, SCICompare> shaders;
+            std::unique_ptr<ShaderDiskCache> diskCache;
+
+            static ShaderCompileJob GetCompileJob(const ShaderCreateInfo& info);
     };
 
 }
\ No newline at end of file
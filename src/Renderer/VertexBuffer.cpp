@@ -10,11 +10,14 @@ namespace Renderer
         CreateBuffer(createInfo.elementSize * createInfo.numElements, createInfo.bufferUsage, createInfo.cpuAccessFlags,
                      createInfo.elementData);
         CreateIALayout(createInfo.iaLayout, createInfo.vertexProgram.get());
+        if (createInfo.numIndices > 0) CreateIndexBuffer(createInfo.indexData, createInfo.numIndices, createInfo.indexFormat);
     }
 
     VertexBuffer::~VertexBuffer() noexcept {
         if (buffer) buffer = nullptr;
 
+        if (indexBuffer) indexBuffer = nullptr;
+
         if (inputLayout) inputLayout = nullptr;
     }
 
@@ -45,18 +48,57 @@ namespace Renderer
 			FatalError(L"DebugMenu: Failed to create D3D vertex buffer.");
     }
 
+    void VertexBuffer::CreateIndexBuffer(const void* indexData, uint32_t numIndices, DXGI_FORMAT format) noexcept 
+	{
+        assert(format == DXGI_FORMAT_R16_UINT || format == DXGI_FORMAT_R32_UINT);
+        indexCount = numIndices;
+        indexFormat = format;
+
+        D3D11_BUFFER_DESC desc = {};
+        desc.ByteWidth = numIndices * (format == DXGI_FORMAT_R16_UINT ? sizeof(uint16_t) : sizeof(uint32_t));
+        desc.BindFlags = D3D11_BIND_FLAG::D3D11_BIND_INDEX_BUFFER;
+        desc.Usage = D3D11_USAGE::D3D11_USAGE_IMMUTABLE;
+
+        D3D11_SUBRESOURCE_DATA data = {};
+        data.pSysMem = indexData;
+
+        const auto code = context.device->CreateBuffer(&desc, &data, indexBuffer.put());
+
+        if (!SUCCEEDED(code)) 
+			FatalError(L"DebugMenu: Failed to create D3D index buffer.");
+    }
+
     void VertexBuffer::Bind(uint32_t offset) noexcept {
         const auto buf = buffer.get();
         context.context->IASetInputLayout(inputLayout.get());
         context.context->IASetVertexBuffers(0, 1, &buf, &stride, &offset);
         context.context->IASetPrimitiveTopology(topology);
+        if (indexBuffer) context.context->IASetIndexBuffer(indexBuffer.get(), indexFormat, 0);
     }
 
-    void VertexBuffer::Draw() noexcept { context.context->Draw(vertexCount, 0); }
+    void VertexBuffer::BindToSlot(uint32_t slot, uint32_t offset) noexcept {
+        const auto buf = buffer.get();
+        context.context->IASetVertexBuffers(slot, 1, &buf, &stride, &offset);
+    }
+
+    void VertexBuffer::Draw() noexcept {
+        if (indexBuffer) context.context->DrawIndexed(indexCount, 0, 0);
+        else context.context->Draw(vertexCount, 0);
+    }
+
+    void VertexBuffer::DrawInstanced(uint32_t instanceCount, uint32_t startInstance) noexcept {
+        if (indexBuffer) context.context->DrawIndexedInstanced(indexCount, instanceCount, 0, 0, startInstance);
+        else context.context->DrawInstanced(vertexCount, instanceCount, 0, startInstance);
+    }
+
+    size_t VertexBuffer::Size() const noexcept {
+        size_t indexSize = indexFormat == DXGI_FORMAT_R16_UINT ? sizeof(uint16_t) : sizeof(uint32_t);
+        return static_cast<size_t>(stride) * vertexCount + indexSize * indexCount;
+    }
 
-    void VertexBuffer::DrawCount(uint32_t num) noexcept {
-        assert(num <= vertexCount);
-        context.context->Draw(num, 0);
+    void VertexBuffer::DrawCount(uint32_t num, uint32_t start) noexcept {
+        assert(start + num <= vertexCount);
+        context.context->Draw(num, start);
     }
 
     D3D11_MAPPED_SUBRESOURCE& VertexBuffer::Map(D3D11_MAP mode) noexcept {
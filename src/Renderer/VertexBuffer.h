@@ -5,6 +5,13 @@
 namespace Renderer
 {
     using IALayout = std::vector<D3D11_INPUT_ELEMENT_DESC>;
+
+    // Layouts the vertices of a mesh can be uploaded with
+    enum class VertexLayout {
+        PositionUVNormalColor,  // Model::Vertex, 48 bytes
+        Position,               // only the position, 12 bytes. The color comes from the per object or per instance data
+    };
+
     struct VertexBufferCreateInfo {
         uint32_t elementSize = 0;
         uint32_t numElements = 0;
@@ -14,6 +21,10 @@ namespace Renderer
         uint32_t cpuAccessFlags = 0;
         std::shared_ptr<Shader> vertexProgram;
         IALayout iaLayout = {};
+        // Optional index buffer, the elements are then drawn by index
+        const void* indexData = nullptr;
+        uint32_t numIndices = 0;
+        DXGI_FORMAT indexFormat = DXGI_FORMAT_R16_UINT;
     };
 
     class VertexBuffer {
@@ -27,10 +38,18 @@ namespace Renderer
 
         // Bind the vertex buffer for drawing
         void Bind(uint32_t offset = 0) noexcept;
-        // Draw the full contents of the buffer
+        // Bind only the buffer to the given input slot, eg. as the instance buffer of another vertex buffer
+        void BindToSlot(uint32_t slot, uint32_t offset = 0) noexcept;
+        // Draw the full contents of the buffer, by index if it has an index buffer
         void Draw() noexcept;
-        // Draw the given number of elements from the buffer
-        void DrawCount(uint32_t num) noexcept;
+        // Draw the given number of elements from the buffer, starting at the given element
+        void DrawCount(uint32_t num, uint32_t start = 0) noexcept;
+        // Draw the full contents of the buffer once per instance
+        void DrawInstanced(uint32_t instanceCount, uint32_t startInstance) noexcept;
+        // Number of elements the buffer was created with
+        uint32_t Count() const noexcept { return vertexCount; }
+        // Size of the vertex and index buffers in bytes
+        size_t Size() const noexcept;
         // Map the buffer to CPU memory
         D3D11_MAPPED_SUBRESOURCE& Map(D3D11_MAP mode) noexcept;
         // Unmap the buffer
@@ -44,10 +63,14 @@ namespace Renderer
         D3D11_PRIMITIVE_TOPOLOGY topology;
         D3DContext context;
         winrt::com_ptr<ID3D11Buffer> buffer;
+        winrt::com_ptr<ID3D11Buffer> indexBuffer;
+        uint32_t indexCount = 0;
+        DXGI_FORMAT indexFormat = DXGI_FORMAT_R16_UINT;
         winrt::com_ptr<ID3D11InputLayout> inputLayout;
         D3D11_MAPPED_SUBRESOURCE mappedBuffer;
 
         void CreateBuffer(size_t size, D3D11_USAGE usage, uint32_t cpuAccessFlags,
                           const D3D11_SUBRESOURCE_DATA* initialData) noexcept;
+        void CreateIndexBuffer(const void* indexData, uint32_t numIndices, DXGI_FORMAT format) noexcept;
     };
 }
\ No newline at end of file
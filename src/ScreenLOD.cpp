@@ -0,0 +1,250 @@
+#include "ScreenLOD.h"
+
+namespace ScreenLOD
+{
+	namespace
+	{
+		// directed edge, by the bits of its points, since the merged polygons share the exact same points
+		struct EdgeKey
+		{
+			std::array<uint32_t, 6> bits;
+
+			bool operator==(const EdgeKey& a_other) const = default;
+		};
+
+		struct EdgeKeyHasher
+		{
+			size_t operator()(const EdgeKey& a_key) const
+			{
+				size_t seed = 0;
+				for (uint32_t bits : a_key.bits)
+				{
+					seed ^= std::hash<uint32_t>{}(bits) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+				}
+				return seed;
+			}
+		};
+
+		EdgeKey MakeEdgeKey(const RE::NiPoint3& a_from, const RE::NiPoint3& a_to)
+		{
+			return EdgeKey{ {
+				std::bit_cast<uint32_t>(a_from.x), std::bit_cast<uint32_t>(a_from.y), std::bit_cast<uint32_t>(a_from.z),
+				std::bit_cast<uint32_t>(a_to.x), std::bit_cast<uint32_t>(a_to.y), std::bit_cast<uint32_t>(a_to.z) } };
+		}
+
+		bool IsSamePoint(const RE::NiPoint3& a_point1, const RE::NiPoint3& a_point2)
+		{
+			return a_point1.x == a_point2.x && a_point1.y == a_point2.y && a_point1.z == a_point2.z;
+		}
+
+		RE::NiPoint3 Subtract(const RE::NiPoint3& a_point1, const RE::NiPoint3& a_point2)
+		{
+			return RE::NiPoint3(a_point1.x - a_point2.x, a_point1.y - a_point2.y, a_point1.z - a_point2.z);
+		}
+
+		RE::NiPoint3 Cross(const RE::NiPoint3& a_vector1, const RE::NiPoint3& a_vector2)
+		{
+			return RE::NiPoint3(
+				a_vector1.y*a_vector2.z - a_vector1.z*a_vector2.y,
+				a_vector1.z*a_vector2.x - a_vector1.x*a_vector2.z,
+				a_vector1.x*a_vector2.y - a_vector1.y*a_vector2.x);
+		}
+
+		float Dot(const RE::NiPoint3& a_vector1, const RE::NiPoint3& a_vector2)
+		{
+			return a_vector1.x*a_vector2.x + a_vector1.y*a_vector2.y + a_vector1.z*a_vector2.z;
+		}
+
+		// Newell's method, false if the polygon has no area
+		bool GetNormal(const std::vector<RE::NiPoint3>& a_polygon, RE::NiPoint3& a_normal)
+		{
+			RE::NiPoint3 normal(0.0f, 0.0f, 0.0f);
+			for (size_t i = 0; i < a_polygon.size(); i++)
+			{
+				const auto& current = a_polygon[i];
+				const auto& next = a_polygon[(i + 1) % a_polygon.size()];
+				normal.x += (current.y - next.y)*(current.z + next.z);
+				normal.y += (current.z - next.z)*(current.x + next.x);
+				normal.z += (current.x - next.x)*(current.y + next.y);
+			}
+
+			float length = std::sqrt(Dot(normal, normal));
+			if (length < 1e-6f) return false;
+
+			a_normal = RE::NiPoint3(normal.x/length, normal.y/length, normal.z/length);
+			return true;
+		}
+
+		// collinear points are allowed, the merged polygons keep the points of the edges they were merged along
+		bool IsConvex(const std::vector<RE::NiPoint3>& a_polygon, const RE::NiPoint3& a_normal)
+		{
+			size_t n = a_polygon.size();
+			for (size_t i = 0; i < n; i++)
+			{
+				RE::NiPoint3 edge1 = Subtract(a_polygon[(i + 1) % n], a_polygon[i]);
+				RE::NiPoint3 edge2 = Subtract(a_polygon[(i + 2) % n], a_polygon[(i + 1) % n]);
+				float tolerance = 1e-4f*std::sqrt(Dot(edge1, edge1)*Dot(edge2, edge2));
+				if (Dot(Cross(edge1, edge2), a_normal) < -tolerance) return false;
+			}
+			return true;
+		}
+	}
+
+	float GetPolygonArea(const RE::NiPoint2* a_points, uint32_t a_count)
+	{
+		if (a_count < 3) return 0.0f;
+
+		float doubleArea = 0.0f;
+		for (uint32_t i = 0; i < a_count; i++)
+		{
+			const auto& current = a_points[i];
+			const auto& next = a_points[i + 1 == a_count ? 0 : i + 1];
+			doubleArea += current.x*next.y - next.x*current.y;
+		}
+		return std::abs(doubleArea)/2;
+	}
+
+	float GetPolygonPerimeter(const RE::NiPoint2* a_points, uint32_t a_count)
+	{
+		if (a_count < 2) return 0.0f;
+
+		float perimeter = 0.0f;
+		for (uint32_t i = 0; i < a_count; i++)
+		{
+			const auto& next = a_points[i + 1 == a_count ? 0 : i + 1];
+			perimeter += (next - a_points[i]).Length();
+		}
+		return perimeter;
+	}
+
+	float GetExtent(const RE::NiPoint2* a_points, uint32_t a_count)
+	{
+		if (a_count == 0) return 0.0f;
+
+		float minX = a_points[0].x;
+		float maxX = a_points[0].x;
+		float minY = a_points[0].y;
+		float maxY = a_points[0].y;
+		for (uint32_t i = 1; i < a_count; i++)
+		{
+			minX = std::min(minX, a_points[i].x);
+			maxX = std::max(maxX, a_points[i].x);
+			minY = std::min(minY, a_points[i].y);
+			maxY = std::max(maxY, a_points[i].y);
+		}
+		return std::max(maxX - minX, maxY - minY);
+	}
+
+	bool IsPolygonTooSmall(const RE::NiPoint2* a_points, uint32_t a_count, float a_borderWidth, const Thresholds& a_thresholds)
+	{
+		float extent = GetExtent(a_points, a_count) + a_borderWidth;
+		if (extent < a_thresholds.minExtent) return true;
+
+		float area = GetPolygonArea(a_points, a_count);
+		if (a_borderWidth > 0.0f) area += GetPolygonPerimeter(a_points, a_count)*a_borderWidth/2;
+		return area < a_thresholds.minArea;
+	}
+
+	bool IsLineTooSmall(const RE::NiPoint2& a_start, const RE::NiPoint2& a_end, float a_width, const Thresholds& a_thresholds)
+	{
+		float length = (a_end - a_start).Length();
+		if (length + a_width < a_thresholds.minExtent) return true;
+		return length*a_width < a_thresholds.minArea;
+	}
+
+	bool IsPointTooSmall(float a_radius, const Thresholds& a_thresholds)
+	{
+		if (2*a_radius < a_thresholds.minExtent) return true;
+		return glm::pi<float>()*a_radius*a_radius < a_thresholds.minArea;
+	}
+
+	uint32_t GetCircleSegments(float a_radius, const Thresholds& a_thresholds)
+	{
+		if (a_thresholds.fullCircleRadius <= 0.0f || a_radius >= a_thresholds.fullCircleRadius) return maxCircleSegments;
+
+		uint32_t extraSegments = static_cast<uint32_t>((maxCircleSegments - minCircleSegments)*std::max(a_radius, 0.0f)/a_thresholds.fullCircleRadius);
+		return minCircleSegments + extraSegments;
+	}
+
+	uint32_t MergeCoplanarPolygons(std::span<std::vector<RE::NiPoint3>*> a_polygons, std::span<const PolygonStyle> a_styles, uint32_t a_maxPoints)
+	{
+		constexpr float minNormalDot = 0.9999f; // about 0.8 degrees
+		constexpr uint32_t noPolygon = UINT32_MAX;
+
+		std::vector<RE::NiPoint3> normals(a_polygons.size());
+		std::vector<bool> canMerge(a_polygons.size());
+		std::unordered_map<EdgeKey, uint32_t, EdgeKeyHasher> edgeOwners;
+
+		for (uint32_t i = 0; i < a_polygons.size(); i++)
+		{
+			const auto& polygon = *a_polygons[i];
+			canMerge[i] = polygon.size() >= 3 && polygon.size() < a_maxPoints && GetNormal(polygon, normals[i]);
+			if (!canMerge[i]) continue;
+
+			for (size_t point = 0; point < polygon.size(); point++)
+			{
+				edgeOwners[MakeEdgeKey(polygon[point], polygon[(point + 1) % polygon.size()])] = i;
+			}
+		}
+
+		uint32_t numberOfMerged = 0;
+		std::vector<RE::NiPoint3> merged;
+
+		for (uint32_t i = 0; i < a_polygons.size(); i++)
+		{
+			if (!canMerge[i]) continue;
+			auto& polygon = *a_polygons[i];
+
+			bool hasMerged = true;
+			while (hasMerged && polygon.size() < a_maxPoints)
+			{
+				hasMerged = false;
+				for (size_t edge = 0; edge < polygon.size(); edge++)
+				{
+					const RE::NiPoint3 a = polygon[edge];
+					const RE::NiPoint3 b = polygon[(edge + 1) % polygon.size()];
+
+					auto owner = edgeOwners.find(MakeEdgeKey(b, a));
+					uint32_t j = owner == edgeOwners.end() ? noPolygon : owner->second;
+					if (j == noPolygon || j == i || !canMerge[j]) continue;
+					if (!(a_styles[i] == a_styles[j]) || Dot(normals[i], normals[j]) < minNormalDot) continue;
+
+					auto& other = *a_polygons[j];
+					if (polygon.size() + other.size() - 2 > a_maxPoints) continue;
+
+					size_t otherEdge = 0;
+					while (otherEdge < other.size() && !(IsSamePoint(other[otherEdge], b) && IsSamePoint(other[(otherEdge + 1) % other.size()], a))) otherEdge++;
+					if (otherEdge == other.size()) continue;
+
+					// the points of this polygon up to a, then the other polygon's points from after a until before b, then b and the rest
+					merged.clear();
+					merged.insert(merged.end(), polygon.begin(), polygon.begin() + edge + 1);
+					for (size_t k = 2; k < other.size(); k++)
+					{
+						merged.push_back(other[(otherEdge + k) % other.size()]);
+					}
+					merged.insert(merged.end(), polygon.begin() + edge + 1, polygon.end());
+
+					if (!IsConvex(merged, normals[i])) continue;
+
+					edgeOwners.erase(MakeEdgeKey(a, b));
+					edgeOwners.erase(MakeEdgeKey(b, a));
+					for (size_t k = 0; k < other.size(); k++)
+					{
+						auto key = MakeEdgeKey(other[k], other[(k + 1) % other.size()]);
+						auto otherOwner = edgeOwners.find(key);
+						if (otherOwner != edgeOwners.end() && otherOwner->second == j) otherOwner->second = i;
+					}
+
+					polygon.swap(merged);
+					other.clear();
+					canMerge[j] = false;
+					numberOfMerged++;
+					hasMerged = true;
+					break;
+				}
+			}
+		}
+		return numberOfMerged;
+	}
+}
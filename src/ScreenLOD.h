@@ -0,0 +1,43 @@
+#pragma once
+
+// Level of detail of the Scaleform shapes, decided by their size on the canvas (in pixels) after clipping.
+// Apart from the NiPoint types it does not depend on the game, so it can be benchmarked on its own
+namespace ScreenLOD
+{
+	struct Thresholds
+	{
+		float minArea = 0.0f;			// px^2, shapes covering less are culled
+		float minExtent = 0.0f;			// px, shapes whose largest side is shorter are culled
+		float fullCircleRadius = 0.0f;	// px, circles this large get all segments, smaller ones fewer
+	};
+
+	constexpr uint32_t maxCircleSegments = 8;
+	constexpr uint32_t minCircleSegments = 4;
+
+	float		GetPolygonArea(const RE::NiPoint2* a_points, uint32_t a_count);
+	float		GetPolygonPerimeter(const RE::NiPoint2* a_points, uint32_t a_count);
+	float		GetExtent(const RE::NiPoint2* a_points, uint32_t a_count); // largest side of the bounding box
+
+	// the border counts with the half of it that is outside the polygon
+	bool		IsPolygonTooSmall(const RE::NiPoint2* a_points, uint32_t a_count, float a_borderWidth, const Thresholds& a_thresholds);
+	bool		IsLineTooSmall(const RE::NiPoint2& a_start, const RE::NiPoint2& a_end, float a_width, const Thresholds& a_thresholds);
+	bool		IsPointTooSmall(float a_radius, const Thresholds& a_thresholds);
+	uint32_t	GetCircleSegments(float a_radius, const Thresholds& a_thresholds);
+
+	// polygons are only merged if everything they are drawn with is equal
+	struct PolygonStyle
+	{
+		uint32_t	color = 0;
+		uint32_t	alpha = 0;
+		uint32_t	borderColor = 0;
+		uint32_t	borderAlpha = 0;
+		float		borderThickness = 0.0f;
+
+		bool operator==(const PolygonStyle& a_other) const = default;
+	};
+
+	// Merges polygons that share an edge (the same two points, in opposite order), lie in the same plane and have the same
+	// style into larger convex polygons of at most a_maxPoints points. Polygons that are merged into another one are emptied.
+	// Returns the number of polygons that were emptied
+	uint32_t	MergeCoplanarPolygons(std::span<std::vector<RE::NiPoint3>*> a_polygons, std::span<const PolygonStyle> a_styles, uint32_t a_maxPoints = 8);
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+// The shapes queued for the Scaleform backend of DrawHandler during an update. They are stored by value, and the points of
+// all polygons share one arena. Clear keeps the memory, so queueing shapes stops allocating once the buffers have grown.
+// The meta data is a template parameter, so apart from the NiPoint types it does not depend on the game and can be tested on its own
+template <class MetaData>
+class ShapeQueue
+{
+	public:
+		struct ShapeData
+		{
+			MetaData metaData{};
+			ShapeData(MetaData a_metaData) : metaData(a_metaData) {}
+			ShapeData() {}
+		};
+
+		struct PointData : ShapeData
+		{
+			RE::NiPoint3 position;
+			float radius;
+			uint32_t color;
+			uint32_t alpha;
+			PointData(RE::NiPoint3 a_pos, float a_radius, uint32_t a_color, uint32_t a_alpha, MetaData a_metaData) :
+				ShapeData(a_metaData), position(a_pos), radius(a_radius), color(a_color), alpha(a_alpha)
+			{}
+		};
+
+		struct LineData : ShapeData
+		{
+			RE::NiPoint3 start;
+			RE::NiPoint3 end;
+			float thickness;
+			uint32_t color;
+			uint32_t alpha;
+			bool isSimpleLine;
+			LineData(RE::NiPoint3 a_start, RE::NiPoint3 a_end, float a_thickness, uint32_t a_color, uint32_t a_alpha, bool a_isSimpleLine, MetaData a_metaData) :
+				ShapeData(a_metaData),
+				start(a_start),
+				end(a_end),
+				thickness(a_thickness),
+				color(a_color),
+				alpha(a_alpha),
+				isSimpleLine(a_isSimpleLine)
+			{}
+		};
+
+		struct PolygonData : ShapeData
+		{
+			uint32_t positionOffset; // the points are in positions
+			uint32_t positionCount;
+			float borderThickness;
+			uint32_t color;
+			uint32_t baseAlpha;
+			uint32_t borderColor;
+			uint32_t borderAlpha;
+			PolygonData(uint32_t a_positionOffset, uint32_t a_positionCount, float a_thickness, uint32_t a_color, uint32_t a_baseAlpha, uint32_t a_borderColor, uint32_t a_borderAlpha, MetaData a_metaData) :
+				ShapeData(a_metaData),
+				positionOffset(a_positionOffset),
+				positionCount(a_positionCount),
+				borderThickness(a_thickness),
+				color(a_color), baseAlpha(a_baseAlpha),
+				borderColor(a_borderColor),
+				borderAlpha(a_borderAlpha)
+			{}
+		};
+
+		std::vector<PointData>		points;
+		std::vector<LineData>		lines;
+		std::vector<PolygonData>	polygons;
+		std::vector<RE::NiPoint3>	positions; // of all polygons
+
+		void AddPolygon(std::span<const RE::NiPoint3> a_positions, float a_borderThickness, uint32_t a_color, uint32_t a_baseAlpha, uint32_t a_borderColor, uint32_t a_borderAlpha, MetaData a_metaData)
+		{
+			polygons.emplace_back(static_cast<uint32_t>(positions.size()), static_cast<uint32_t>(a_positions.size()), a_borderThickness, a_color, a_baseAlpha, a_borderColor, a_borderAlpha, a_metaData);
+			positions.insert(positions.end(), a_positions.begin(), a_positions.end());
+		}
+
+		std::span<const RE::NiPoint3> GetPositions(const PolygonData& a_polygonData) const
+		{
+			return std::span<const RE::NiPoint3>(positions.data() + a_polygonData.positionOffset, a_polygonData.positionCount);
+		}
+
+		void Clear()
+		{
+			points.clear();
+			lines.clear();
+			polygons.clear();
+			positions.clear();
+		}
+};
@@ -1,49 +1,86 @@
 #include "Utils.h"
+#include "QuickHull.h"
 #include "math.h"
 
 namespace Utils
 {
-	void ForEachCellInRange(RE::NiPoint3 a_origin, float a_range, std::function<void(const RE::TESObjectCELL* a_cell)> a_callback)
+	namespace
 	{
-		if (const auto* TES = RE::TES::GetSingleton(); TES)
+		// the interior cell, the grid cells (nullptr if not attached) and the sky cell, in that order
+		template <class Visitor>
+		void VisitGridCells(const RE::TES* a_TES, Visitor&& a_visitor)
 		{
-			if (TES->interiorCell)
+			a_visitor(a_TES->interiorCell);
+			if (!a_TES->interiorCell)
 			{
-				a_callback(TES->interiorCell);
-			}
-			else if (const auto gridLength = TES->gridCells ? TES->gridCells->length : 0; gridLength > 0)
-			{
-				const float yPlus = a_origin.y + a_range;
-				const float yMinus = a_origin.y - a_range;
-				const float xPlus = a_origin.x + a_range;
-				const float xMinus = a_origin.x - a_range;
-
+				const auto gridLength = a_TES->gridCells ? a_TES->gridCells->length : 0;
 				for (uint32_t x = 0; x < gridLength; x++)
 				{
 					for (uint32_t y = 0; y < gridLength; y++)
 					{
-						if (const auto cell = TES->gridCells->GetCell(x, y); cell && cell->IsAttached())
-						{
-							if (const auto cellCoords = cell->GetCoordinates(); cellCoords)
-							{
-								const RE::NiPoint2 worldPos{ cellCoords->worldX, cellCoords->worldY };
-								if (worldPos.x < xPlus && (worldPos.x + 4096.0f) > xMinus && worldPos.y < yPlus && (worldPos.y + 4096.0f) > yMinus) // if some of the cell is in range
-								{
-									a_callback(cell);
-								}
-							}
-						}
+						const auto cell = a_TES->gridCells->GetCell(x, y);
+						a_visitor(cell && cell->IsAttached() ? cell : nullptr);
 					}
 				}
 			}
-			if (const auto ws = TES->GetRuntimeData2().worldSpace)
+			const auto ws = a_TES->GetRuntimeData2().worldSpace;
+			a_visitor(ws ? ws->GetSkyCell() : nullptr);
+		}
+
+		std::vector<AttachedCell>		attachedCells;
+		std::vector<RE::TESObjectCELL*>	cellsOfList;	// what attachedCells was made from
+		bool							isListChecked = false;
+	}
+
+	void InvalidateAttachedCells()
+	{
+		isListChecked = false;
+	}
+
+	const std::vector<AttachedCell>& GetAttachedCells()
+	{
+		if (isListChecked) return attachedCells;
+		isListChecked = true;
+
+		const auto* TES = RE::TES::GetSingleton();
+		if (!TES)
+		{
+			attachedCells.clear();
+			cellsOfList.clear();
+			return attachedCells;
+		}
+
+		// the coordinates and bounds are only looked up again when a cell of the grid has changed
+		size_t index = 0;
+		bool hasChanged = false;
+		VisitGridCells(TES, [&](RE::TESObjectCELL* a_cell)
+		{
+			hasChanged = hasChanged || index >= cellsOfList.size() || cellsOfList[index] != a_cell;
+			index++;
+		});
+		if (!hasChanged && index == cellsOfList.size()) return attachedCells;
+
+		cellsOfList.clear();
+		VisitGridCells(TES, [&](RE::TESObjectCELL* a_cell) { cellsOfList.push_back(a_cell); });
+
+		constexpr float infinity = std::numeric_limits<float>::infinity();
+		attachedCells.clear();
+		for (size_t i = 0; i < cellsOfList.size(); i++)
+		{
+			const auto cell = cellsOfList[i];
+			if (!cell) continue;
+
+			// the first is the interior cell and the last the sky cell
+			if (i == 0 || i + 1 == cellsOfList.size())
 			{
-				if (const auto skyCell = ws ? ws->GetSkyCell() : nullptr; skyCell)
-				{
-					a_callback(skyCell);
-				}
+				attachedCells.push_back(AttachedCell{ cell, -infinity, -infinity, infinity, infinity });
+			}
+			else if (const auto cellCoords = cell->GetCoordinates(); cellCoords)
+			{
+				attachedCells.push_back(AttachedCell{ cell, cellCoords->worldX, cellCoords->worldY, cellCoords->worldX + 4096.0f, cellCoords->worldY + 4096.0f });
 			}
 		}
+		return attachedCells;
 	}
 
 	bool IsPlayerLoaded()
@@ -106,28 +143,6 @@ namespace Utils
 		}
 	}
 
-	bool TryAttachChildByName(RE::NiNode* a_node, const char* a_modelName, const RE::BSFixedString a_markerName, RE::NiAVObject*& a_objectOut)
-	{
-		RE::NiPointer<RE::NiNode> markerModel;
-		RE::BSModelDB::DBTraits::ArgsType args;
-		RE::BSResource::ErrorCode errorCode = RE::BSModelDB::Demand(a_modelName, markerModel, args);
-
-		if (errorCode != RE::BSResource::ErrorCode::kNone) return false;
-
-		if (!markerModel) return false;
-
-		a_objectOut = markerModel->Clone()->AsNode();
-
-		if (!a_objectOut) return false;
-
-		a_objectOut->IncRefCount();
-		a_objectOut->name = a_markerName;
-		AttachChildNode(a_node, a_objectOut);
-		a_objectOut->DecRefCount();
-
-		return true;
-	}
-
 	bool IsNodeTreeVisible(RE::NiAVObject* a_obj, uint32_t a_depth) // returns true if all children are visible, else false
 	{
 		if (a_obj->GetAppCulled()) return false;
@@ -301,7 +316,12 @@ namespace Utils
 
 	std::string GethkpShapeTypeName(const RE::hkpShape* a_shape)
 	{
-		switch (a_shape->type)
+		return GethkpShapeTypeName(a_shape->type);
+	}
+
+	std::string GethkpShapeTypeName(RE::hkpShapeType a_type)
+	{
+		switch (a_type)
 		{
 			case RE::hkpShapeType::kInvalid:
 				return "kInvalid"s;
@@ -447,78 +467,32 @@ namespace Utils
 		return vec3u{ a_point.x, a_point.y, a_point.z };
 	}
 
+	// a_planeEquations are not used, the planes of the shape are what ensureConnectivity failed on
 	ConnectivityData Utils::FindConvexHull(RE::hkArray<RE::hkVector4> a_vertices, RE::hkArray<RE::hkVector4>& a_planeEquations)
 	{
 		RE::hkArray<uint16_t> vertexIndices = GetEmptyHkArray<uint16_t>();
 		RE::hkArray<uint8_t> verticesPerFace = GetEmptyHkArray<uint8_t>();
 
-		auto numberOfPoints = a_vertices.size();
+		if (a_vertices.size() > UINT16_MAX) return ConnectivityData{ vertexIndices, verticesPerFace };
 
-		for (int i = 0; i < numberOfPoints - 2; i++)
+		std::vector<glm::dvec3> points;
+		points.reserve(a_vertices.size());
+		for (const auto& vertex : a_vertices)
 		{
-			auto& pt1 = a_vertices[i];
-			for (int j = i + 1; j < numberOfPoints - 1; j++)
-			{
-				auto& pt2 = a_vertices[j];
-				auto vec21 = pt2 - pt1;
-				for (int k = j + 1; k < numberOfPoints; k++)
-				{
-					auto& pt3 = a_vertices[k];
-					auto vec31 = pt3 - pt1;
-					auto normal = vec21.Cross(vec31);
-
-					int8_t prev = 0;
-					bool keep = true;
-
-					for (int l = 0; l < numberOfPoints; l++)
-					{
-						if (l == i || l == j || l == k) continue;
-
-						auto& otherPoint = a_vertices[l];
-						auto direction = normal.Dot3(otherPoint - pt1);
-
-						if (direction == 0) continue;
-
-						int8_t eps = direction > 0 ? 1 : -1;
+			points.emplace_back(vertex.quad.m128_f32[0], vertex.quad.m128_f32[1], vertex.quad.m128_f32[2]);
+		}
 
-						// True whenever a set of points have been found where one is above and one is below the triangle surface
-						if (eps + prev == 0)
-						{
-							keep = false;
-							break;
-						}
+		QuickHull hull{ points };
+		if (!hull.Build()) return ConnectivityData{ vertexIndices, verticesPerFace };
 
-						prev = eps;
-					}
-					if (keep)
-					{
-						vertexIndices.push_back(i);
-						vertexIndices.push_back(j);
-						vertexIndices.push_back(k);
-						verticesPerFace.push_back(3);
-					}
-				}
+		for (const auto& face : hull.GetFaces())
+		{
+			for (auto index : face)
+			{
+				vertexIndices.push_back(index);
 			}
+			verticesPerFace.push_back(static_cast<uint8_t>(face.size()));
 		}
-
-		//for (const auto& planeEquation : a_planeEquations)
-		//{
-		//	uint8_t numVertices = 0;
-		//	for (int i = 0; i < a_vertices.size(); i++)
-		//	{
-		//		if (numVertices == 255) break;
-		//		// plane equation ax + by + cz - d = 0
-		//		// lhs is planeEquation.Dot3(vertex)
-		//		float result = std::abs(planeEquation.Dot3(a_vertices[i]) + planeEquation.quad.m128_f32[3]);
-		//		float eps = 1e-3f;
-		//		if (result < eps)
-		//		{
-		//			vertexIndices.push_back(i);
-		//			numVertices++;
-		//		}
-		//	}
-		//	verticesPerFace.push_back(numVertices);
-		//}
 		return ConnectivityData{ vertexIndices, verticesPerFace };
 	}
 
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "CellsInRange.h"
+
 namespace Utils
 {
 
@@ -14,7 +16,18 @@ namespace Utils
 	const uint32_t defaultCullFlag = 1 << 31;
 	const RE::hkVector4 identityQuat{ 0.0f, 0.0f, 0.0f, 1.0f };
 
-	void			ForEachCellInRange(RE::NiPoint3 a_origin, float a_range, std::function<void(const RE::TESObjectCELL*)> a_callback);
+	// the attached cells of TES::gridCells, the interior cell and the sky cell. Only made again when those change, which is
+	// checked once after each InvalidateAttachedCells
+	void			InvalidateAttachedCells();
+	const std::vector<AttachedCell>& GetAttachedCells();
+
+	// ForEachCellInRange over GetAttachedCells()
+	template <class Callback>
+	inline bool		ForEachCellInRange(const RE::NiPoint3& a_origin, float a_range, Callback&& a_callback)
+	{
+		return ForEachCellInRange(GetAttachedCells(), a_origin, a_range, std::forward<Callback>(a_callback));
+	}
+
 	bool			IsPlayerLoaded();
 	bool			IsRefInLoadedCell(const RE::TESObjectREFR* a_ref);
 
@@ -25,7 +38,6 @@ namespace Utils
 	void			AttachChildNode(RE::NiNode* a_parent, RE::NiAVObject* a_child);
 	void			DetachChildrenByName(RE::NiNode* a_node, const RE::BSFixedString a_childName);
 
-	bool			TryAttachChildByName(RE::NiNode* a_node, const char* a_modelName, const RE::BSFixedString a_markerName, RE::NiAVObject*& a_objectOut);
 	bool			IsNodeTreeVisible(RE::NiAVObject* a_obj, uint32_t a_depth = 0);
 	bool			IsMarkerVisible(RE::NiAVObject* a_obj);
 	bool			HasChildrenOfName(RE::NiNode* a_node, const RE::BSFixedString a_childName);
@@ -41,6 +53,7 @@ namespace Utils
 	
 
 	std::string		GethkpShapeTypeName(const RE::hkpShape* a_shape);
+	std::string		GethkpShapeTypeName(RE::hkpShapeType a_type);
 	RE::NiPoint3	RotateNiPoint3(const RE::NiPoint3& a_vector, const RE::hkQuaternion& a_quaternion);
 	RE::NiMatrix3	GetRotationMatrixFromAxis(const RE::NiPoint3& a_axis, float a_angle);
 	RE::NiMatrix3	GetRotationMatrixZ(float a_angle);
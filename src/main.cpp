@@ -45,6 +45,7 @@ void MessageHandler(SKSE::MessagingInterface::Message* a_message) {
 			RE::UI::GetSingleton()->AddEventSink<RE::MenuOpenCloseEvent>(DebugMenu::GetDebugMenuHandler().get());
 
 			DebugMenu::GetMarkerHandler()->InitPostDataLoaded();
+			DebugMenu::GetNavmeshHandler()->InitPostDataLoaded();
 			FreeCamHandler::GetSingleton()->Init();
 
 			ScaleformUI::UIHandler::GetSingleton()->Init();
@@ -73,6 +74,11 @@ void MessageHandler(SKSE::MessagingInterface::Message* a_message) {
 			}
 			break;
         }
+		case SKSE::MessagingInterface::kSaveGame:
+		{
+			DebugMenu::GetNavmeshHandler()->SaveDiskCache();
+			break;
+		}
     }
 }
 
@@ -120,6 +126,10 @@ extern "C" __declspec( dllexport ) bool SKSEAPI SKSEPlugin_Load(const SKSE::Load
 			WarningPopup(L"DebugMenu: AttachD3D failed. D3D11 rendering will be disabled");
 			MCM::settings::useD3D = false;
 		}
+		else
+		{
+			Renderer::PrefetchShaders();
+		}
 	}
 	
     return true;
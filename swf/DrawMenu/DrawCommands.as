@@ -0,0 +1,57 @@
+// Replays the drawing commands recorded by DrawCommandBuffer (src/DrawCommandBuffer.h), so a frame is drawn with a
+// single call from the plugin. The first frame of DrawMenu.fla forwards to it with
+//
+//	function replay(a_commands:Array):Void { DrawCommands.Replay(this, a_commands); }
+//
+class DrawCommands
+{
+	static var CLEAR:Number = 0;
+	static var LINE_STYLE:Number = 1;
+	static var BEGIN_FILL:Number = 2;
+	static var MOVE_TO:Number = 3;
+	static var LINE_TO:Number = 4;
+	static var CURVE_TO:Number = 5;
+	static var END_FILL:Number = 6;
+
+	public static function Replay(a_target:MovieClip, a_commands:Array):Void
+	{
+		var i:Number = 0;
+		var length:Number = a_commands.length;
+		while (i < length)
+		{
+			switch (a_commands[i])
+			{
+				case CLEAR:
+					a_target.clear();
+					i += 1;
+					break;
+				case LINE_STYLE:
+					a_target.lineStyle(a_commands[i + 1], a_commands[i + 2], a_commands[i + 3]);
+					i += 4;
+					break;
+				case BEGIN_FILL:
+					a_target.beginFill(a_commands[i + 1], a_commands[i + 2]);
+					i += 3;
+					break;
+				case MOVE_TO:
+					a_target.moveTo(a_commands[i + 1], a_commands[i + 2]);
+					i += 3;
+					break;
+				case LINE_TO:
+					a_target.lineTo(a_commands[i + 1], a_commands[i + 2]);
+					i += 3;
+					break;
+				case CURVE_TO:
+					a_target.curveTo(a_commands[i + 1], a_commands[i + 2], a_commands[i + 3], a_commands[i + 4]);
+					i += 5;
+					break;
+				case END_FILL:
+					a_target.endFill();
+					i += 1;
+					break;
+				default:
+					return; // malformed, the rest cannot be decoded
+			}
+		}
+	}
+}
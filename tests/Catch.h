@@ -0,0 +1,8 @@
+#pragma once
+
+#if __has_include(<catch2/catch_all.hpp>)
+#	include <catch2/catch_all.hpp>
+using Catch::Approx;
+#else
+#	include <catch2/catch.hpp>
+#endif
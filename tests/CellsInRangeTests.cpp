@@ -0,0 +1,217 @@
+#include "Catch.h"
+#include "CellsInRange.h"
+
+namespace
+{
+	constexpr float cellSize = 4096.0f;
+	constexpr float infinity = std::numeric_limits<float>::infinity();
+
+	// a stand-in for a cell of TES::gridCells: the test only needs its address, its coordinates and if it is attached
+	struct FakeCell
+	{
+		float	worldX;
+		float	worldY;
+		bool	isAttached;
+	};
+
+	// a uGridsToLoad x uGridsToLoad grid centered on cell (0, 0), and the sky cell
+	struct Grid
+	{
+		uint32_t				length;
+		std::vector<FakeCell>	cells;
+		FakeCell				skyCell{ 0.0f, 0.0f, true };
+
+		const FakeCell* GetCell(uint32_t a_x, uint32_t a_y) const { return &cells[a_x * length + a_y]; }
+	};
+
+	const RE::TESObjectCELL* AsCell(const FakeCell* a_cell)
+	{
+		return reinterpret_cast<const RE::TESObjectCELL*>(a_cell);
+	}
+
+	Grid MakeGrid(uint32_t a_length, float a_detachedShare = 0.0f, uint32_t a_seed = 0)
+	{
+		std::mt19937 rng(a_seed);
+		std::bernoulli_distribution isDetached(a_detachedShare);
+
+		Grid grid{ a_length, {} };
+		const int32_t half = static_cast<int32_t>(a_length / 2);
+		for (uint32_t x = 0; x < a_length; x++)
+		{
+			for (uint32_t y = 0; y < a_length; y++)
+			{
+				grid.cells.push_back(FakeCell{ (static_cast<int32_t>(x) - half) * cellSize, (static_cast<int32_t>(y) - half) * cellSize, !isDetached(rng) });
+			}
+		}
+		return grid;
+	}
+
+	// what Utils::GetAttachedCells makes of the grid
+	std::vector<Utils::AttachedCell> ListAttachedCells(const Grid& a_grid)
+	{
+		std::vector<Utils::AttachedCell> attachedCells;
+		for (uint32_t x = 0; x < a_grid.length; x++)
+		{
+			for (uint32_t y = 0; y < a_grid.length; y++)
+			{
+				const auto cell = a_grid.GetCell(x, y);
+				if (cell->isAttached) attachedCells.push_back(Utils::AttachedCell{ AsCell(cell), cell->worldX, cell->worldY, cell->worldX + cellSize, cell->worldY + cellSize });
+			}
+		}
+		attachedCells.push_back(Utils::AttachedCell{ AsCell(&a_grid.skyCell), -infinity, -infinity, infinity, infinity });
+		return attachedCells;
+	}
+
+	// Utils::ForEachCellInRange as it was before the cell list: a std::function, and a walk over the whole grid that looks up
+	// the coordinates of each attached cell on every call
+	void ForEachCellInRangeOfGrid(const Grid& a_grid, RE::NiPoint3 a_origin, float a_range, std::function<void(const RE::TESObjectCELL* a_cell)> a_callback)
+	{
+		const float yPlus = a_origin.y + a_range;
+		const float yMinus = a_origin.y - a_range;
+		const float xPlus = a_origin.x + a_range;
+		const float xMinus = a_origin.x - a_range;
+
+		for (uint32_t x = 0; x < a_grid.length; x++)
+		{
+			for (uint32_t y = 0; y < a_grid.length; y++)
+			{
+				if (const auto cell = a_grid.GetCell(x, y); cell && cell->isAttached)
+				{
+					const RE::NiPoint2 worldPos{ cell->worldX, cell->worldY };
+					if (worldPos.x < xPlus && (worldPos.x + cellSize) > xMinus && worldPos.y < yPlus && (worldPos.y + cellSize) > yMinus)
+					{
+						a_callback(AsCell(cell));
+					}
+				}
+			}
+		}
+		a_callback(AsCell(&a_grid.skyCell));
+	}
+
+	std::vector<const RE::TESObjectCELL*> CellsInRange(std::span<const Utils::AttachedCell> a_cells, const RE::NiPoint3& a_origin, float a_range)
+	{
+		std::vector<const RE::TESObjectCELL*> cells;
+		Utils::ForEachCellInRange(a_cells, a_origin, a_range, [&](const RE::TESObjectCELL* a_cell) { cells.push_back(a_cell); });
+		return cells;
+	}
+
+	std::vector<const RE::TESObjectCELL*> CellsInRangeOfGrid(const Grid& a_grid, const RE::NiPoint3& a_origin, float a_range)
+	{
+		std::vector<const RE::TESObjectCELL*> cells;
+		ForEachCellInRangeOfGrid(a_grid, a_origin, a_range, [&](const RE::TESObjectCELL* a_cell) { cells.push_back(a_cell); });
+		return cells;
+	}
+}
+
+TEST_CASE("ForEachCellInRange visits the cells the range reaches into", "[cells]")
+{
+	const auto grid = MakeGrid(5);
+	const auto attachedCells = ListAttachedCells(grid);
+	REQUIRE(attachedCells.size() == 26);
+
+	// the middle of cell (0, 0), reaching half a cell into each neighbour
+	const RE::NiPoint3 center(cellSize / 2, cellSize / 2, 0.0f);
+	CHECK(CellsInRange(attachedCells, center, cellSize).size() == 9 + 1);
+	CHECK(CellsInRange(attachedCells, center, cellSize / 4).size() == 1 + 1);
+	CHECK(CellsInRange(attachedCells, center, 10 * cellSize).size() == 25 + 1);
+
+	// far from the grid only the sky cell is left
+	const auto farAway = CellsInRange(attachedCells, RE::NiPoint3(100 * cellSize, 0.0f, 0.0f), cellSize);
+	REQUIRE(farAway.size() == 1);
+	CHECK(farAway[0] == AsCell(&grid.skyCell));
+
+	// a range that ends on the border of a cell does not reach into it
+	CHECK(CellsInRange(attachedCells, RE::NiPoint3(0.0f, cellSize / 2, 0.0f), cellSize).size() == 2 * 3 + 1);
+	CHECK(CellsInRange(attachedCells, center, cellSize / 2).size() == 1 + 1);
+}
+
+TEST_CASE("ForEachCellInRange skips detached cells", "[cells]")
+{
+	auto grid = MakeGrid(3);
+	grid.cells[4].isAttached = false; // the middle one
+	const auto attachedCells = ListAttachedCells(grid);
+
+	const auto cells = CellsInRange(attachedCells, RE::NiPoint3(cellSize / 2, cellSize / 2, 0.0f), cellSize / 4);
+	REQUIRE(cells.size() == 1);
+	CHECK(cells[0] == AsCell(&grid.skyCell));
+}
+
+TEST_CASE("ForEachCellInRange stops when the callback returns false", "[cells]")
+{
+	const auto grid = MakeGrid(5);
+	const auto attachedCells = ListAttachedCells(grid);
+	const RE::NiPoint3 center(cellSize / 2, cellSize / 2, 0.0f);
+
+	uint32_t visits = 0;
+	CHECK_FALSE(Utils::ForEachCellInRange(attachedCells, center, cellSize, [&](const RE::TESObjectCELL*) { return ++visits < 3; }));
+	CHECK(visits == 3);
+
+	visits = 0;
+	CHECK(Utils::ForEachCellInRange(attachedCells, center, cellSize, [&](const RE::TESObjectCELL*) { visits++; return true; }));
+	CHECK(visits == 10);
+
+	// a callback that returns nothing always goes through all of them
+	visits = 0;
+	CHECK(Utils::ForEachCellInRange(attachedCells, center, cellSize, [&](const RE::TESObjectCELL*) { visits++; }));
+	CHECK(visits == 10);
+
+	CHECK(Utils::ForEachCellInRange(std::span<const Utils::AttachedCell>(), center, cellSize, [](const RE::TESObjectCELL*) { return false; }));
+}
+
+TEST_CASE("ForEachCellInRange fuzz against walking the grid", "[cells][fuzz]")
+{
+	std::mt19937 rng(23);
+	std::uniform_real_distribution<float> coordinate(-5 * cellSize, 5 * cellSize);
+	std::uniform_real_distribution<float> range(0.0f, 3 * cellSize);
+
+	for (uint32_t length : { 1u, 3u, 5u, 7u, 9u })
+	{
+		for (uint32_t seed = 0; seed < 20; seed++)
+		{
+			const auto grid = MakeGrid(length, 0.2f, seed);
+			const auto attachedCells = ListAttachedCells(grid);
+			for (int i = 0; i < 100; i++)
+			{
+				const RE::NiPoint3 origin(coordinate(rng), coordinate(rng), 0.0f);
+				const float radius = range(rng);
+				// the same cells in the same order
+				REQUIRE(CellsInRange(attachedCells, origin, radius) == CellsInRangeOfGrid(grid, origin, radius));
+			}
+		}
+	}
+}
+
+TEST_CASE("ForEachCellInRange benchmark", "[.][benchmark][cells]")
+{
+	// a handler looking for the cells near the player, a few times per update
+	for (uint32_t length : { 5u, 7u })
+	{
+		const auto grid = MakeGrid(length);
+		const auto attachedCells = ListAttachedCells(grid);
+		const RE::NiPoint3 origin(cellSize / 3, cellSize / 5, 0.0f);
+		const float range = 1.5f * cellSize;
+
+		BENCHMARK(fmt::format("std::function over the grid, {0}x{0}", length))
+		{
+			// the captures of the handlers make the std::function allocate
+			uint32_t count = 0;
+			const RE::NiPoint3 playerPos = origin;
+			const float maxDistance = range;
+			ForEachCellInRangeOfGrid(grid, origin, range, [&count, playerPos, maxDistance, &grid](const RE::TESObjectCELL* a_cell) {
+				count += a_cell != nullptr && playerPos.x < maxDistance && grid.length > 0;
+			});
+			return count;
+		};
+
+		BENCHMARK(fmt::format("template over the cell list, {0}x{0}", length))
+		{
+			uint32_t count = 0;
+			const RE::NiPoint3 playerPos = origin;
+			const float maxDistance = range;
+			Utils::ForEachCellInRange(attachedCells, origin, range, [&count, playerPos, maxDistance, &grid](const RE::TESObjectCELL* a_cell) {
+				count += a_cell != nullptr && playerPos.x < maxDistance && grid.length > 0;
+			});
+			return count;
+		};
+	}
+}
@@ -0,0 +1,261 @@
+#include "Catch.h"
+#include "Clipping.h"
+
+namespace
+{
+	struct ClipPoint
+	{
+		float x;
+		float y;
+		float z;
+		float w;
+	};
+
+	using Polygon = std::vector<ClipPoint>;
+
+	void Append(Clipping::VertexStream& a_stream, const Polygon& a_polygon)
+	{
+		for (const auto& point : a_polygon) a_stream.Push(point.x, point.y, point.z, point.w);
+	}
+
+	Polygon ToPolygon(const Clipping::VertexStream& a_stream)
+	{
+		Polygon polygon;
+		for (size_t i = 0; i < a_stream.Size(); i++) polygon.push_back({ a_stream.x[i], a_stream.y[i], a_stream.z[i], a_stream.w[i] });
+		return polygon;
+	}
+
+	// distance to the plane in the form the clipper uses, > 0 inside. Planes: left, right, bottom, top, near, far
+	float GetPlaneDistance(const ClipPoint& a_point, int a_plane, float a_canvasScale)
+	{
+		float sgn = a_plane % 2 == 0 ? -1.0f : 1.0f;
+		float scale = a_plane < 4 ? a_canvasScale : 1.0f;
+		float coord = a_plane < 2 ? a_point.x : (a_plane < 4 ? a_point.y : a_point.z);
+		return a_point.w * scale - sgn * coord;
+	}
+
+	// the textbook Sutherland-Hodgman on an array of points, one vector per plane
+	Polygon ReferenceClip(Polygon a_polygon, float a_canvasScale)
+	{
+		for (int plane = 0; plane < 6; plane++)
+		{
+			Polygon output;
+			for (size_t current = 0; current < a_polygon.size(); current++)
+			{
+				size_t prev = current == 0 ? a_polygon.size() - 1 : current - 1;
+				float currentDistance = GetPlaneDistance(a_polygon[current], plane, a_canvasScale);
+				float prevDistance = GetPlaneDistance(a_polygon[prev], plane, a_canvasScale);
+
+				if ((currentDistance > 0.0f) == (prevDistance < 0.0f))
+				{
+					float t = prevDistance / (prevDistance - currentDistance);
+					const auto& a = a_polygon[prev];
+					const auto& b = a_polygon[current];
+					output.push_back({ a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t, a.w + (b.w - a.w) * t });
+				}
+				if (currentDistance > 0.0f) output.push_back(a_polygon[current]);
+			}
+			a_polygon = std::move(output);
+		}
+		return a_polygon;
+	}
+
+	bool IsInside(const ClipPoint& a_point, float a_canvasScale)
+	{
+		for (int plane = 0; plane < 6; plane++)
+		{
+			if (GetPlaneDistance(a_point, plane, a_canvasScale) < -1e-3f * std::abs(a_point.w)) return false;
+		}
+		return true;
+	}
+
+	// triangles around the view, about a third of them crossing a plane and some behind the camera
+	std::vector<Polygon> MakeRandomPolygons(uint32_t a_count, uint32_t a_seed)
+	{
+		std::mt19937 random(a_seed);
+		std::uniform_real_distribution<float> center(-1.5f, 1.5f);
+		std::uniform_real_distribution<float> offset(-0.3f, 0.3f);
+		std::uniform_real_distribution<float> depth(-0.5f, 20.0f);
+		std::uniform_int_distribution<int> numberOfPoints(3, 5);
+
+		std::vector<Polygon> polygons;
+		for (uint32_t i = 0; i < a_count; i++)
+		{
+			float x = center(random);
+			float y = center(random);
+			float w = depth(random);
+
+			Polygon polygon;
+			int n = numberOfPoints(random);
+			for (int j = 0; j < n; j++)
+			{
+				float pointW = w + offset(random);
+				polygon.push_back({ (x + offset(random)) * pointW, (y + offset(random)) * pointW, (offset(random) * 2.0f) * pointW, pointW });
+			}
+			polygons.push_back(polygon);
+		}
+		return polygons;
+	}
+}
+
+TEST_CASE("A polygon inside the frustum is not changed", "[clipping]")
+{
+	Polygon triangle{ { -0.5f, -0.5f, 0.0f, 1.0f }, { 0.5f, -0.5f, 0.0f, 1.0f }, { 0.0f, 0.5f, 0.5f, 2.0f } };
+	Clipping::VertexStream stream;
+	Append(stream, triangle);
+
+	Clipping::PolygonClipper clipper;
+	auto clipped = clipper.Clip(stream, 0, 3, 1.0f);
+	REQUIRE(clipped);
+
+	auto result = ToPolygon(*clipped);
+	REQUIRE(result.size() == 3);
+	for (size_t i = 0; i < 3; i++)
+	{
+		CHECK(result[i].x == triangle[i].x);
+		CHECK(result[i].y == triangle[i].y);
+		CHECK(result[i].z == triangle[i].z);
+		CHECK(result[i].w == triangle[i].w);
+	}
+}
+
+TEST_CASE("A polygon outside one of the planes is culled", "[clipping]")
+{
+	// one triangle beyond each plane, in the order left, right, bottom, top, near, far
+	std::vector<Polygon> triangles{
+		{ { -2.0f, 0.0f, 0.0f, 1.0f }, { -3.0f, 0.5f, 0.0f, 1.0f }, { -2.5f, -0.5f, 0.0f, 1.0f } },
+		{ { 2.0f, 0.0f, 0.0f, 1.0f }, { 3.0f, 0.5f, 0.0f, 1.0f }, { 2.5f, -0.5f, 0.0f, 1.0f } },
+		{ { 0.0f, -2.0f, 0.0f, 1.0f }, { 0.5f, -3.0f, 0.0f, 1.0f }, { -0.5f, -2.5f, 0.0f, 1.0f } },
+		{ { 0.0f, 2.0f, 0.0f, 1.0f }, { 0.5f, 3.0f, 0.0f, 1.0f }, { -0.5f, 2.5f, 0.0f, 1.0f } },
+		{ { 0.0f, 0.0f, -2.0f, 1.0f }, { 0.5f, 0.0f, -3.0f, 1.0f }, { 0.0f, 0.5f, -2.5f, 1.0f } },
+		{ { 0.0f, 0.0f, 2.0f, 1.0f }, { 0.5f, 0.0f, 3.0f, 1.0f }, { 0.0f, 0.5f, 2.5f, 1.0f } },
+	};
+
+	Clipping::VertexStream stream;
+	for (const auto& triangle : triangles) Append(stream, triangle);
+
+	Clipping::PolygonClipper clipper;
+	for (uint32_t i = 0; i < triangles.size(); i++)
+	{
+		INFO("plane " << i);
+		CHECK(Clipping::PolygonClipper::IsOffScreen(stream, i * 3, 3, 1.0f));
+		CHECK(clipper.Clip(stream, i * 3, 3, 1.0f) == nullptr);
+	}
+}
+
+TEST_CASE("A triangle crossing a plane is cut at the plane", "[clipping]")
+{
+	// the first point is left of the frustum, the edges leaving it are cut at x = -w
+	Polygon triangle{ { -3.0f, 0.0f, 0.0f, 1.0f }, { 0.5f, -0.5f, 0.0f, 1.0f }, { 0.5f, 0.5f, 0.0f, 1.0f } };
+	Clipping::VertexStream stream;
+	Append(stream, triangle);
+
+	Clipping::PolygonClipper clipper;
+	auto clipped = clipper.Clip(stream, 0, 3, 1.0f);
+	REQUIRE(clipped);
+
+	auto result = ToPolygon(*clipped);
+	REQUIRE(result.size() == 4);
+
+	uint32_t pointsOnPlane = 0;
+	for (const auto& point : result)
+	{
+		CHECK(IsInside(point, 1.0f));
+		if (point.x == Approx(-point.w)) pointsOnPlane++;
+	}
+	CHECK(pointsOnPlane == 2);
+}
+
+TEST_CASE("The canvas scale moves the side planes in", "[clipping]")
+{
+	Polygon triangle{ { 0.7f, 0.0f, 0.0f, 1.0f }, { 0.9f, 0.1f, 0.0f, 1.0f }, { 0.9f, -0.1f, 0.0f, 1.0f } };
+	Clipping::VertexStream stream;
+	Append(stream, triangle);
+
+	Clipping::PolygonClipper clipper;
+	CHECK(clipper.Clip(stream, 0, 3, 1.0f));
+	CHECK(clipper.Clip(stream, 0, 3, 0.5f) == nullptr);
+
+	auto clipped = clipper.Clip(stream, 0, 3, 0.8f);
+	REQUIRE(clipped);
+	for (const auto& point : ToPolygon(*clipped)) CHECK(point.x <= Approx(0.8f * point.w));
+}
+
+TEST_CASE("Every range of the stream is clipped like the reference clipper", "[clipping]")
+{
+	auto canvasScale = GENERATE(1.0f, 0.8f);
+	auto polygons = MakeRandomPolygons(2000, 1);
+
+	Clipping::VertexStream stream;
+	std::vector<uint32_t> offsets;
+	for (const auto& polygon : polygons)
+	{
+		offsets.push_back(static_cast<uint32_t>(stream.Size()));
+		Append(stream, polygon);
+	}
+
+	Clipping::PolygonClipper clipper;
+	uint32_t numberOfClipped = 0;
+	for (uint32_t i = 0; i < polygons.size(); i++)
+	{
+		INFO("polygon " << i);
+		auto expected = ReferenceClip(polygons[i], canvasScale);
+		auto clipped = clipper.Clip(stream, offsets[i], static_cast<uint32_t>(polygons[i].size()), canvasScale);
+
+		// the early out only culls polygons the planes would have removed entirely
+		if (!clipped)
+		{
+			CHECK(expected.empty());
+			continue;
+		}
+
+		auto result = ToPolygon(*clipped);
+		REQUIRE(result.size() == expected.size());
+		if (result.size() != polygons[i].size()) numberOfClipped++;
+
+		for (size_t j = 0; j < result.size(); j++)
+		{
+			CHECK(IsInside(result[j], canvasScale));
+			CHECK(result[j].x == Approx(expected[j].x).margin(1e-4));
+			CHECK(result[j].y == Approx(expected[j].y).margin(1e-4));
+			CHECK(result[j].z == Approx(expected[j].z).margin(1e-4));
+			CHECK(result[j].w == Approx(expected[j].w).margin(1e-4));
+		}
+	}
+	CHECK(numberOfClipped > 100); // the test data has to cross the planes
+}
+
+TEST_CASE("Clipping benchmark", "[.][benchmark][clipping]")
+{
+	auto polygons = MakeRandomPolygons(20000, 2);
+
+	Clipping::VertexStream stream;
+	std::vector<uint32_t> offsets;
+	for (const auto& polygon : polygons)
+	{
+		offsets.push_back(static_cast<uint32_t>(stream.Size()));
+		Append(stream, polygon);
+	}
+
+	Clipping::PolygonClipper clipper;
+	BENCHMARK("20k polygons, one stream and reused scratch buffers")
+	{
+		size_t numberOfPoints = 0;
+		for (uint32_t i = 0; i < polygons.size(); i++)
+		{
+			auto clipped = clipper.Clip(stream, offsets[i], static_cast<uint32_t>(polygons[i].size()), 1.0f);
+			if (clipped) numberOfPoints += clipped->Size();
+		}
+		return numberOfPoints;
+	};
+
+	BENCHMARK("20k polygons, a vector per polygon and plane")
+	{
+		size_t numberOfPoints = 0;
+		for (const auto& polygon : polygons)
+		{
+			numberOfPoints += ReferenceClip(polygon, 1.0f).size();
+		}
+		return numberOfPoints;
+	};
+}
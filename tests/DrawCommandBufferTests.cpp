@@ -0,0 +1,213 @@
+#include "Catch.h"
+#include "DrawCommandBuffer.h"
+
+using Opcode = DrawCommandBuffer::Opcode;
+
+namespace
+{
+	struct Command
+	{
+		Opcode				opcode;
+		std::vector<double>	arguments;
+
+		bool operator==(const Command&) const = default;
+	};
+
+	std::vector<Command> Decode(std::span<const double> a_data, bool& a_isValid)
+	{
+		std::vector<Command> commands;
+		a_isValid = DrawCommandBuffer::ForEachCommand(a_data, [&](Opcode a_opcode, std::span<const double> a_arguments) {
+			commands.push_back({ a_opcode, { a_arguments.begin(), a_arguments.end() } });
+		});
+		return commands;
+	}
+
+	// records a random frame into the buffer, and returns the commands it should decode into
+	std::vector<Command> RecordRandomFrame(std::mt19937& a_rng, DrawCommandBuffer& a_buffer, size_t a_numberOfCommands)
+	{
+		std::uniform_int_distribution<uint32_t> opcode(0, static_cast<uint32_t>(Opcode::kEndFill));
+		std::uniform_int_distribution<uint32_t> color(0, 0xFFFFFF);
+		std::uniform_int_distribution<uint32_t> alpha(0, 100);
+		std::uniform_real_distribution<double> coordinate(-5000.0, 5000.0);
+
+		std::vector<Command> commands;
+		for (size_t i = 0; i < a_numberOfCommands; i++)
+		{
+			const auto op = static_cast<Opcode>(opcode(a_rng));
+			Command command{ op, {} };
+			switch (op)
+			{
+				case Opcode::kClear:
+					a_buffer.Clear();
+					break;
+				case Opcode::kLineStyle:
+					command.arguments = { coordinate(a_rng), static_cast<double>(color(a_rng)), static_cast<double>(alpha(a_rng)) };
+					a_buffer.LineStyle(command.arguments[0], static_cast<uint32_t>(command.arguments[1]), static_cast<uint32_t>(command.arguments[2]));
+					break;
+				case Opcode::kBeginFill:
+					command.arguments = { static_cast<double>(color(a_rng)), static_cast<double>(alpha(a_rng)) };
+					a_buffer.BeginFill(static_cast<uint32_t>(command.arguments[0]), static_cast<uint32_t>(command.arguments[1]));
+					break;
+				case Opcode::kMoveTo:
+					command.arguments = { coordinate(a_rng), coordinate(a_rng) };
+					a_buffer.MoveTo(command.arguments[0], command.arguments[1]);
+					break;
+				case Opcode::kLineTo:
+					command.arguments = { coordinate(a_rng), coordinate(a_rng) };
+					a_buffer.LineTo(command.arguments[0], command.arguments[1]);
+					break;
+				case Opcode::kCurveTo:
+					command.arguments = { coordinate(a_rng), coordinate(a_rng), coordinate(a_rng), coordinate(a_rng) };
+					a_buffer.CurveTo(command.arguments[0], command.arguments[1], command.arguments[2], command.arguments[3]);
+					break;
+				case Opcode::kEndFill:
+					a_buffer.EndFill();
+					break;
+			}
+			commands.push_back(std::move(command));
+		}
+		return commands;
+	}
+}
+
+TEST_CASE("DrawCommandBuffer replays the commands in the order they were recorded", "[drawcommands]")
+{
+	std::mt19937 rng(60);
+	DrawCommandBuffer buffer;
+	CHECK(buffer.IsEmpty());
+
+	for (const size_t count : { 0, 1, 7, 1000 })
+	{
+		buffer.Reset();
+		const auto expected = RecordRandomFrame(rng, buffer, count);
+		CHECK(buffer.GetNumberOfCommands() == count);
+
+		bool isValid = false;
+		const auto commands = Decode(buffer.GetData(), isValid);
+		INFO("count " << count);
+		CHECK(isValid);
+		CHECK(commands == expected);
+	}
+}
+
+TEST_CASE("DrawCommandBuffer keeps its memory across frames", "[drawcommands]")
+{
+	std::mt19937 rng(61);
+	DrawCommandBuffer buffer;
+	RecordRandomFrame(rng, buffer, 500);
+	const auto data = buffer.GetData().data();
+	const auto size = buffer.GetData().size();
+
+	buffer.Reset();
+	CHECK(buffer.IsEmpty());
+	CHECK(buffer.GetData().empty());
+
+	// a frame no larger than the last one is recorded into the same memory
+	while (buffer.GetData().size() + 5 <= size) buffer.CurveTo(1.0, 2.0, 3.0, 4.0);
+	CHECK(buffer.GetData().data() == data);
+}
+
+TEST_CASE("DrawCommandBuffer rejects malformed data", "[drawcommands]")
+{
+	bool isValid = true;
+
+	SECTION("opcodes that are not whole numbers in range")
+	{
+		for (const double opcode : { -1.0, 7.0, 2.5, 1e300, -0.5, std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::infinity() })
+		{
+			const double data[]{ 0.0, opcode, 0.0, 0.0, 0.0, 0.0 };
+			INFO("opcode " << opcode);
+			const auto commands = Decode(data, isValid);
+			CHECK_FALSE(isValid);
+			CHECK(commands.size() == 1); // the commands before it are still called
+		}
+	}
+
+	SECTION("missing arguments")
+	{
+		DrawCommandBuffer buffer;
+		buffer.MoveTo(1.0, 2.0);
+		buffer.CurveTo(1.0, 2.0, 3.0, 4.0);
+		const auto data = buffer.GetData();
+		for (size_t size = 4; size < data.size(); size++)
+		{
+			INFO("size " << size);
+			CHECK(Decode(data.first(size), isValid).size() == 1);
+			CHECK_FALSE(isValid);
+		}
+		CHECK(Decode(data.first(3), isValid).size() == 1);
+		CHECK(isValid);
+	}
+
+	SECTION("empty data")
+	{
+		CHECK(Decode({}, isValid).empty());
+		CHECK(isValid);
+	}
+}
+
+TEST_CASE("DrawCommandBuffer survives random data", "[drawcommands][fuzz]")
+{
+	std::mt19937 rng(62);
+	std::uniform_int_distribution<uint32_t> size(0, 64);
+	std::uniform_int_distribution<int> smallValue(-2, 8);
+	std::uniform_real_distribution<double> anyValue(-10.0, 10.0);
+
+	for (int i = 0; i < 50000; i++)
+	{
+		// mostly small whole numbers, so many of them are valid opcodes
+		std::vector<double> data(size(rng));
+		for (auto& value : data) value = i % 2 == 0 ? smallValue(rng) : anyValue(rng);
+
+		size_t consumed = 0;
+		bool isInBounds = true;
+		const bool isValid = DrawCommandBuffer::ForEachCommand(data, [&](Opcode a_opcode, std::span<const double> a_arguments) {
+			isInBounds &= a_arguments.data() == data.data() + consumed + 1;
+			isInBounds &= a_arguments.size() == DrawCommandBuffer::GetNumberOfArguments(a_opcode);
+			consumed += 1 + a_arguments.size();
+		});
+
+		INFO("iteration " << i);
+		CHECK(isInBounds);
+		CHECK(consumed <= data.size());
+		CHECK(isValid == (consumed == data.size()));
+	}
+}
+
+TEST_CASE("DrawCommandBuffer benchmark", "[.][benchmark][drawcommands]")
+{
+	// a frame of 2000 filled quads, about what a dense navmesh draws
+	DrawCommandBuffer buffer;
+	auto recordFrame = [&]() {
+		buffer.Reset();
+		for (int i = 0; i < 2000; i++)
+		{
+			const double x = i % 50 * 20.0;
+			const double y = i / 50 * 20.0;
+			buffer.LineStyle(1.0, 0xFFFFFF, 80);
+			buffer.BeginFill(0x00FF00, 30);
+			buffer.MoveTo(x, y);
+			buffer.LineTo(x + 20.0, y);
+			buffer.LineTo(x + 20.0, y + 20.0);
+			buffer.LineTo(x, y + 20.0);
+			buffer.LineTo(x, y);
+			buffer.EndFill();
+		}
+	};
+
+	BENCHMARK("record")
+	{
+		recordFrame();
+		return buffer.GetNumberOfCommands();
+	};
+
+	recordFrame();
+	BENCHMARK("decode")
+	{
+		double sum = 0.0;
+		DrawCommandBuffer::ForEachCommand(buffer.GetData(), [&](Opcode, std::span<const double> a_arguments) {
+			for (const double argument : a_arguments) sum += argument;
+		});
+		return sum;
+	};
+}
@@ -0,0 +1,181 @@
+#include "Catch.h"
+#include "Linalg.h"
+
+namespace
+{
+	Linalg::Matrix4 RandomMatrix(std::mt19937& a_rng)
+	{
+		std::uniform_real_distribution<float> value(-2.0f, 2.0f);
+		Linalg::Matrix4 matrix;
+		for (auto& row : matrix.entry)
+			for (auto& entry : row) entry = value(a_rng);
+		return matrix;
+	}
+
+	std::vector<RE::NiPoint3> RandomPoints(std::mt19937& a_rng, size_t a_count)
+	{
+		std::uniform_real_distribution<float> coordinate(-100000.0f, 100000.0f);
+		std::vector<RE::NiPoint3> points(a_count);
+		for (auto& point : points) point = RE::NiPoint3(coordinate(a_rng), coordinate(a_rng), coordinate(a_rng));
+		return points;
+	}
+
+	// compares the bits, so a -0 against +0 counts as a difference as well
+	bool IsBitExact(float a_lhs, float a_rhs)
+	{
+		return std::bit_cast<uint32_t>(a_lhs) == std::bit_cast<uint32_t>(a_rhs);
+	}
+}
+
+TEST_CASE("TransformPoints matches the scalar transform bit for bit", "[linalg]")
+{
+	std::mt19937 rng(2);
+	INFO("avx2: " << Linalg::HasAVX2());
+
+	// up to 40 points covers the avx2 blocks of 8, the sse blocks of 4 and the scalar tail in every combination,
+	// and the offset into the array moves the loads off their alignment
+	for (size_t count = 0; count <= 40; count++)
+	{
+		for (size_t offset = 0; offset < 4; offset++)
+		{
+			const auto matrix = RandomMatrix(rng);
+			const auto points = RandomPoints(rng, offset + count);
+			const RE::NiPoint3* input = points.data() + offset;
+
+			std::vector<float> x(count), y(count), z(count), w(count);
+			Linalg::TransformPoints(matrix, input, count, x.data(), y.data(), z.data(), w.data());
+
+			for (size_t i = 0; i < count; i++)
+			{
+				const Linalg::Vector4 expected = matrix * Linalg::Vector4(input[i]);
+				INFO("count " << count << ", offset " << offset << ", point " << i);
+				CHECK(IsBitExact(x[i], expected.x));
+				CHECK(IsBitExact(y[i], expected.y));
+				CHECK(IsBitExact(z[i], expected.z));
+				CHECK(IsBitExact(w[i], expected.w));
+			}
+		}
+	}
+}
+
+TEST_CASE("TransformPoints into Vector4 matches across its blocks", "[linalg]")
+{
+	std::mt19937 rng(3);
+	const auto matrix = RandomMatrix(rng);
+
+	// more than one block of 64, ending in a partial one
+	for (const size_t count : { 63, 64, 65, 200 })
+	{
+		const auto points = RandomPoints(rng, count);
+		std::vector<Linalg::Vector4> out(count);
+		Linalg::TransformPoints(matrix, points.data(), count, out.data());
+
+		for (size_t i = 0; i < count; i++)
+		{
+			const Linalg::Vector4 expected = matrix * Linalg::Vector4(points[i]);
+			INFO("count " << count << ", point " << i);
+			CHECK(IsBitExact(out[i].x, expected.x));
+			CHECK(IsBitExact(out[i].y, expected.y));
+			CHECK(IsBitExact(out[i].z, expected.z));
+			CHECK(IsBitExact(out[i].w, expected.w));
+		}
+	}
+}
+
+TEST_CASE("TransformPoints benchmark", "[.][benchmark][linalg]")
+{
+	std::mt19937 rng(4);
+	const auto matrix = RandomMatrix(rng);
+	constexpr size_t count = 10000;
+	const auto points = RandomPoints(rng, count);
+	std::vector<Linalg::Vector4> out(count);
+
+	BENCHMARK("scalar")
+	{
+		for (size_t i = 0; i < count; i++) out[i] = matrix * Linalg::Vector4(points[i]);
+		return out.back().x;
+	};
+
+	BENCHMARK("TransformPoints")
+	{
+		Linalg::TransformPoints(matrix, points.data(), count, out.data());
+		return out.back().x;
+	};
+}
+
+TEST_CASE("DequantizePoints matches the scalar expression bit for bit", "[linalg]")
+{
+	std::mt19937 rng(20);
+	std::uniform_int_distribution<uint32_t> quantized(0, 0xFFFF);
+	std::uniform_real_distribution<float> value(-1000.0f, 1000.0f);
+
+	// up to 20 points covers the sse blocks of 4 and every length of the scalar tail
+	for (size_t count = 0; count <= 20; count++)
+	{
+		std::vector<uint16_t> input(3 * count);
+		for (auto& q : input) q = static_cast<uint16_t>(quantized(rng));
+		const float scale = value(rng) / 0xFFFF;
+		const float offset[3]{ value(rng), value(rng), value(rng) };
+
+		// the bounds are grown, so they start out with values of earlier points
+		float min[3]{ value(rng), value(rng), value(rng) };
+		float max[3]{ min[0] + 10.0f, min[1] + 10.0f, min[2] + 10.0f };
+		float expectedMin[3]{ min[0], min[1], min[2] };
+		float expectedMax[3]{ max[0], max[1], max[2] };
+
+		std::vector<float> out(3 * count);
+		Linalg::DequantizePoints(input.data(), count, scale, offset, out.data(), min, max);
+
+		for (size_t i = 0; i < count; i++)
+		{
+			for (int axis = 0; axis < 3; axis++)
+			{
+				const float expected = input[3 * i + axis] * scale + offset[axis];
+				INFO("count " << count << ", point " << i << ", axis " << axis);
+				CHECK(IsBitExact(out[3 * i + axis], expected));
+				expectedMin[axis] = std::min(expectedMin[axis], expected);
+				expectedMax[axis] = std::max(expectedMax[axis], expected);
+			}
+		}
+		for (int axis = 0; axis < 3; axis++)
+		{
+			INFO("count " << count << ", axis " << axis);
+			CHECK(IsBitExact(min[axis], expectedMin[axis]));
+			CHECK(IsBitExact(max[axis], expectedMax[axis]));
+		}
+	}
+}
+
+TEST_CASE("DequantizePoints benchmark", "[.][benchmark][linalg]")
+{
+	std::mt19937 rng(21);
+	std::uniform_int_distribution<uint32_t> quantized(0, 0xFFFF);
+	constexpr size_t count = 10000;
+	std::vector<uint16_t> input(3 * count);
+	for (auto& q : input) q = static_cast<uint16_t>(quantized(rng));
+	std::vector<float> out(3 * count);
+	const float offset[3]{ -100.0f, 50.0f, 3.0f };
+	const float scale = 0.01f;
+
+	BENCHMARK("scalar")
+	{
+		float min[3]{ FLT_MAX, FLT_MAX, FLT_MAX };
+		float max[3]{ -FLT_MAX, -FLT_MAX, -FLT_MAX };
+		for (size_t i = 0; i < 3 * count; i++)
+		{
+			const int axis = static_cast<int>(i % 3);
+			out[i] = input[i] * scale + offset[axis];
+			min[axis] = std::min(min[axis], out[i]);
+			max[axis] = std::max(max[axis], out[i]);
+		}
+		return min[0] + max[0];
+	};
+
+	BENCHMARK("DequantizePoints")
+	{
+		float min[3]{ FLT_MAX, FLT_MAX, FLT_MAX };
+		float max[3]{ -FLT_MAX, -FLT_MAX, -FLT_MAX };
+		Linalg::DequantizePoints(input.data(), count, scale, offset, out.data(), min, max);
+		return min[0] + max[0];
+	};
+}
@@ -0,0 +1,3 @@
+// only built with Catch2 v2, v3 links its own main
+#define CATCH_CONFIG_MAIN
+#include "Catch.h"
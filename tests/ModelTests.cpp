@@ -0,0 +1,439 @@
+#include "Catch.h"
+#include "Renderer/Model.h"
+
+using namespace Renderer;
+
+namespace
+{
+	// the 12 triangles of a unit cube as a triangle soup, 36 vertices on 8 positions
+	std::vector<vec3u> GetCubeSoup()
+	{
+		const vec3u corners[8]{
+			{ 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 }, { 0, 1, 0 },
+			{ 0, 0, 1 }, { 1, 0, 1 }, { 1, 1, 1 }, { 0, 1, 1 }
+		};
+		const uint32_t quads[6][4]{ { 0, 3, 2, 1 }, { 4, 5, 6, 7 }, { 0, 1, 5, 4 }, { 2, 3, 7, 6 }, { 1, 2, 6, 5 }, { 0, 4, 7, 3 } };
+
+		std::vector<vec3u> soup;
+		for (const auto& quad : quads)
+		{
+			for (const uint32_t corner : { quad[0], quad[1], quad[2], quad[0], quad[2], quad[3] }) soup.push_back(corners[corner]);
+		}
+		return soup;
+	}
+
+	// the welded mesh draws the same triangles as the input, and has no duplicate positions
+	void CheckWelded(const Model::PositionMesh& a_mesh, const std::vector<vec3u>& a_expectedTriangles)
+	{
+		REQUIRE(a_mesh.indices.size() == a_expectedTriangles.size());
+		for (size_t i = 0; i < a_mesh.indices.size(); i++)
+		{
+			REQUIRE(a_mesh.indices[i] < a_mesh.positions.size());
+			CHECK(a_mesh.positions[a_mesh.indices[i]] == a_expectedTriangles[i]);
+		}
+
+		std::unordered_set<vec3u> unique(a_mesh.positions.begin(), a_mesh.positions.end());
+		CHECK(unique.size() == a_mesh.positions.size());
+	}
+}
+
+TEST_CASE("WeldVertices merges a triangle soup", "[model]")
+{
+	const auto soup = GetCubeSoup();
+	const auto mesh = Model::WeldVertices(soup);
+
+	CHECK(mesh.positions.size() == 8);
+	CHECK(mesh.UsesShortIndices());
+	CheckWelded(mesh, soup);
+}
+
+TEST_CASE("WeldVertices with indices drops unused vertices", "[model]")
+{
+	const std::vector<vec3u> vertices{ { 0, 0, 0 }, { 9, 9, 9 }, { 1, 0, 0 }, { 0, 1, 0 }, { 1, 0, 0 } };
+	const std::vector<uint32_t> indices{ 0, 2, 3, 3, 4, 0 };
+	const auto mesh = Model::WeldVertices(vertices, indices);
+
+	CHECK(mesh.positions.size() == 3); // the unused vertex is gone, and both copies of (1, 0, 0) are one
+	CheckWelded(mesh, { vertices[0], vertices[2], vertices[3], vertices[3], vertices[4], vertices[0] });
+}
+
+TEST_CASE("WeldVertices treats -0 and +0 as the same position", "[model]")
+{
+	const std::vector<vec3u> soup{ { 0.0f, 0.0f, 0.0f }, { 1, 0, 0 }, { 0, 1, 0 }, { -0.0f, -0.0f, -0.0f }, { 0, 1, 0 }, { 1, 0, 0 } };
+	const auto mesh = Model::WeldVertices(soup);
+
+	CHECK(mesh.positions.size() == 3);
+	CHECK(mesh.indices[0] == mesh.indices[3]);
+}
+
+TEST_CASE("WeldVertices drops triangles it can't build", "[model]")
+{
+	const std::vector<vec3u> vertices{ { 0, 0, 0 }, { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } };
+
+	SECTION("an index past the end")
+	{
+		const auto mesh = Model::WeldVertices(vertices, { 0, 1, 2, 0, 1, 4, 1, 2, 3 });
+		CheckWelded(mesh, { vertices[0], vertices[1], vertices[2], vertices[1], vertices[2], vertices[3] });
+	}
+
+	SECTION("indices that are not a multiple of 3")
+	{
+		const auto mesh = Model::WeldVertices(vertices, { 0, 1, 2, 3, 0 });
+		CheckWelded(mesh, { vertices[0], vertices[1], vertices[2] });
+	}
+
+	SECTION("vertices that are not a multiple of 3")
+	{
+		const auto mesh = Model::WeldVertices(vertices);
+		CheckWelded(mesh, { vertices[0], vertices[1], vertices[2] });
+	}
+
+	SECTION("nothing")
+	{
+		const auto mesh = Model::WeldVertices({});
+		CHECK(mesh.positions.empty());
+		CHECK(mesh.indices.empty());
+	}
+}
+
+TEST_CASE("WeldVertices of random meshes", "[model][fuzz]")
+{
+	std::mt19937 rng(22);
+	std::uniform_int_distribution<int> coordinate(-5, 5); // a small grid, so many positions are shared
+
+	for (int iteration = 0; iteration < 200; iteration++)
+	{
+		std::vector<vec3u> vertices(std::uniform_int_distribution<size_t>(0, 600)(rng));
+		for (auto& vertex : vertices) vertex = vec3u(coordinate(rng), coordinate(rng), coordinate(rng));
+
+		std::vector<uint32_t> indices;
+		if (iteration % 2 == 1)
+		{
+			// a few indices past the end, which drop their triangles
+			std::uniform_int_distribution<uint32_t> index(0, static_cast<uint32_t>(vertices.size() + 2));
+			indices.resize(std::uniform_int_distribution<size_t>(0, 900)(rng));
+			for (auto& i : indices) i = index(rng);
+		}
+
+		std::vector<vec3u> expected;
+		const size_t numIndices = indices.empty() ? vertices.size() - vertices.size() % 3 : indices.size() - indices.size() % 3;
+		for (size_t i = 0; i < numIndices; i += 3)
+		{
+			const uint32_t triangle[3]{
+				indices.empty() ? static_cast<uint32_t>(i) : indices[i],
+				indices.empty() ? static_cast<uint32_t>(i + 1) : indices[i + 1],
+				indices.empty() ? static_cast<uint32_t>(i + 2) : indices[i + 2] };
+			if (std::ranges::any_of(triangle, [&](uint32_t a_index) { return a_index >= vertices.size(); })) continue;
+			for (const uint32_t index : triangle) expected.push_back(vertices[index]);
+		}
+
+		INFO("iteration " << iteration);
+		CheckWelded(Model::WeldVertices(vertices, indices), expected);
+	}
+}
+
+TEST_CASE("WeldVertices benchmark", "[.][benchmark][model]")
+{
+	// a 256 x 256 grid of quads as a triangle soup, as the collision meshes come in
+	std::vector<vec3u> soup;
+	for (int y = 0; y < 256; y++)
+	{
+		for (int x = 0; x < 256; x++)
+		{
+			const vec3u a(x, y, 0), b(x + 1, y, 0), c(x + 1, y + 1, 0), d(x, y + 1, 0);
+			for (const auto& vertex : { a, b, c, a, c, d }) soup.push_back(vertex);
+		}
+	}
+
+	BENCHMARK("393k vertices")
+	{
+		return Model::WeldVertices(soup).positions.size();
+	};
+}
+
+namespace
+{
+	struct TestMesh
+	{
+		std::string				name;
+		std::vector<Model::Vertex>	vertices;
+		std::vector<uint16_t>	shortIndices;
+		std::vector<uint32_t>	indices;
+
+		Model::MeshView GetView() const { return { name, vertices, shortIndices, indices }; }
+	};
+
+	TestMesh RandomMesh(std::mt19937& a_rng, const std::string& a_name, size_t a_numVertices, int a_indexSize)
+	{
+		std::uniform_real_distribution<float> value(-100.0f, 100.0f);
+		TestMesh mesh{ a_name, {}, {}, {} };
+		mesh.vertices.resize(a_numVertices);
+		for (auto& vertex : mesh.vertices)
+		{
+			vertex.position = vec3u(value(a_rng), value(a_rng), value(a_rng));
+			vertex.uv = vec2u(value(a_rng), value(a_rng));
+			vertex.normal = vec3u(value(a_rng), value(a_rng), value(a_rng));
+			vertex.color = vec4u(value(a_rng), value(a_rng), value(a_rng), 1.0f);
+		}
+
+		if (a_numVertices == 0 || a_indexSize == 0) return mesh;
+		std::uniform_int_distribution<uint32_t> index(0, static_cast<uint32_t>(a_numVertices - 1));
+		const size_t numIndices = 3 * std::uniform_int_distribution<size_t>(1, 100)(a_rng);
+		for (size_t i = 0; i < numIndices; i++)
+		{
+			if (a_indexSize == 2) mesh.shortIndices.push_back(static_cast<uint16_t>(index(a_rng)));
+			else mesh.indices.push_back(index(a_rng));
+		}
+		return mesh;
+	}
+
+	std::vector<TestMesh> RandomMeshes(std::mt19937& a_rng)
+	{
+		return {
+			RandomMesh(a_rng, "triangles", 30, 0),
+			RandomMesh(a_rng, "short indices", 17, 2),
+			RandomMesh(a_rng, "indices", 70000, 4),
+			RandomMesh(a_rng, "", 0, 0)
+		};
+	}
+
+	std::vector<uint8_t> Serialize(const std::vector<TestMesh>& a_meshes)
+	{
+		std::vector<Model::MeshView> views;
+		for (const auto& mesh : a_meshes) views.push_back(mesh.GetView());
+		return Model::Serialize(views);
+	}
+
+	// the v1 layout: the header, then every mesh header directly followed by its vertices
+	std::vector<uint8_t> SerializeV1(const std::vector<TestMesh>& a_meshes)
+	{
+		std::vector<uint8_t> data(sizeof(Model::ModelHeader));
+		const Model::ModelHeader header{ Model::modelTag, 1, static_cast<uint32_t>(a_meshes.size()) };
+		std::memcpy(data.data(), &header, sizeof(header));
+
+		for (const auto& mesh : a_meshes)
+		{
+			uint8_t meshHeader[sizeof(Model::MeshHeader)] = {};
+			const auto numVertices = static_cast<uint32_t>(mesh.vertices.size());
+			std::memcpy(meshHeader, mesh.name.data(), std::min(mesh.name.size(), sizeof(Model::MeshHeader::name) - 1));
+			std::memcpy(meshHeader + offsetof(Model::MeshHeader, numVertices), &numVertices, sizeof(numVertices));
+			data.insert(data.end(), meshHeader, meshHeader + sizeof(meshHeader));
+
+			auto vertices = reinterpret_cast<const uint8_t*>(mesh.vertices.data());
+			data.insert(data.end(), vertices, vertices + mesh.vertices.size() * sizeof(Model::Vertex));
+		}
+		return data;
+	}
+
+	bool IsSame(const Model::Vertex& a_lhs, const Model::Vertex& a_rhs)
+	{
+		return std::memcmp(&a_lhs, &a_rhs, sizeof(Model::Vertex)) == 0;
+	}
+
+	// a view that was loaded points into the data, and its indices address its vertices
+	void CheckInBounds(const Model::ModelView& a_view, std::span<const uint8_t> a_data)
+	{
+		auto isInData = [&](const void* a_begin, size_t a_size)
+		{
+			auto begin = reinterpret_cast<const uint8_t*>(a_begin);
+			return a_size == 0 || (begin >= a_data.data() && begin + a_size <= a_data.data() + a_data.size());
+		};
+
+		CHECK(a_view.meshes.size() == a_view.header.numMeshes);
+		for (const auto& mesh : a_view.meshes)
+		{
+			CHECK(isInData(mesh.name.data(), mesh.name.size()));
+			CHECK(isInData(mesh.vertices.data(), mesh.vertices.size_bytes()));
+			CHECK(isInData(mesh.shortIndices.data(), mesh.shortIndices.size_bytes()));
+			CHECK(isInData(mesh.indices.data(), mesh.indices.size_bytes()));
+			CHECK(std::ranges::all_of(mesh.shortIndices, [&](uint16_t a_index) { return a_index < mesh.vertices.size(); }));
+			CHECK(std::ranges::all_of(mesh.indices, [&](uint32_t a_index) { return a_index < mesh.vertices.size(); }));
+		}
+	}
+}
+
+TEST_CASE("Model v2 round trip", "[model]")
+{
+	std::mt19937 rng(23);
+	const auto meshes = RandomMeshes(rng);
+	const auto data = Serialize(meshes);
+	CHECK(data.size() % Model::sectionAlignment == 0);
+
+	Model::ModelView view;
+	REQUIRE(Model::Load(data, view));
+	CHECK(view.header.version == 2);
+	REQUIRE(view.meshes.size() == meshes.size());
+	CheckInBounds(view, data);
+
+	for (size_t i = 0; i < meshes.size(); i++)
+	{
+		const auto& mesh = view.meshes[i];
+		INFO("mesh " << i);
+		CHECK(mesh.name == meshes[i].name);
+		CHECK(reinterpret_cast<uintptr_t>(mesh.vertices.data()) % Model::sectionAlignment == 0);
+		CHECK(std::ranges::equal(mesh.vertices, meshes[i].vertices, IsSame));
+		CHECK(std::ranges::equal(mesh.shortIndices, meshes[i].shortIndices));
+		CHECK(std::ranges::equal(mesh.indices, meshes[i].indices));
+	}
+
+	Model::Model model;
+	REQUIRE(Model::Load(data, model));
+	REQUIRE(model.meshes.size() == meshes.size());
+	for (size_t i = 0; i < meshes.size(); i++)
+	{
+		CHECK(std::string_view(model.meshes[i].header.name) == meshes[i].name);
+		CHECK(model.meshes[i].header.numVertices == meshes[i].vertices.size());
+		CHECK(std::ranges::equal(model.meshes[i].vertices, meshes[i].vertices, IsSame));
+	}
+}
+
+TEST_CASE("Model v1 files still load", "[model]")
+{
+	std::mt19937 rng(24);
+	const std::vector<TestMesh> meshes{ RandomMesh(rng, "first", 12, 0), RandomMesh(rng, std::string(200, 'x'), 3, 0) };
+	const auto data = SerializeV1(meshes);
+
+	Model::ModelView view;
+	REQUIRE(Model::Load(data, view));
+	CHECK(view.header.version == 1);
+	REQUIRE(view.meshes.size() == 2);
+	CheckInBounds(view, data);
+	CHECK(view.meshes[0].name == "first");
+	CHECK(view.meshes[1].name == std::string(127, 'x')); // the name is cut to fit its terminator
+	for (size_t i = 0; i < meshes.size(); i++) CHECK(std::ranges::equal(view.meshes[i].vertices, meshes[i].vertices, IsSame));
+}
+
+TEST_CASE("Model rejects invalid files", "[model]")
+{
+	std::mt19937 rng(25);
+	const auto meshes = RandomMeshes(rng);
+	Model::ModelView view;
+
+	SECTION("wrong tag or version")
+	{
+		auto data = Serialize(meshes);
+		data[0] ^= 1;
+		CHECK_FALSE(Model::Load(data, view));
+
+		data = Serialize(meshes);
+		data[4] = 3;
+		CHECK_FALSE(Model::Load(data, view));
+	}
+
+	SECTION("checksum")
+	{
+		auto data = Serialize(meshes);
+		data.back() ^= 0x80; // in the padding after the last section
+		CHECK_FALSE(Model::Load(data, view));
+	}
+
+	SECTION("misaligned v2 data")
+	{
+		const auto data = Serialize(meshes);
+		std::vector<uint8_t> shifted(data.size() + 1);
+		std::memcpy(shifted.data() + 1, data.data(), data.size());
+		CHECK_FALSE(Model::Load(std::span<const uint8_t>(shifted).subspan(1), view));
+	}
+
+	SECTION("an index past the vertices")
+	{
+		auto copy = meshes;
+		copy[1].shortIndices[4] = static_cast<uint16_t>(copy[1].vertices.size());
+		CHECK_FALSE(Model::Load(Serialize(copy), view));
+	}
+
+	CHECK(view.meshes.empty()); // a failed load leaves nothing behind
+}
+
+TEST_CASE("Model load fuzz", "[model][fuzz]")
+{
+	std::mt19937 rng(26);
+	std::vector<TestMesh> meshes{ RandomMesh(rng, "a", 20, 2), RandomMesh(rng, "b", 9, 4), RandomMesh(rng, "c", 6, 0) };
+	const auto v1 = SerializeV1(meshes);
+	const auto v2 = Serialize(meshes);
+
+	std::uniform_int_distribution<uint32_t> byte(0, 0xFF);
+	for (const auto& original : { v1, v2 })
+	{
+		std::uniform_int_distribution<size_t> position(0, original.size() - 1);
+		size_t loaded = 0;
+		for (int iteration = 0; iteration < 5000; iteration++)
+		{
+			auto data = original;
+			const int flips = std::uniform_int_distribution<int>(1, 4)(rng);
+			for (int i = 0; i < flips; i++) data[position(rng)] = static_cast<uint8_t>(byte(rng));
+			if (iteration % 3 == 0) data.resize(position(rng));
+
+			// the checksum rejects nearly every flip in a v2 file, so half of them get a fixed up checksum
+			if (original[4] == 2 && iteration % 2 == 0 && data.size() >= sizeof(Model::ModelHeader) + sizeof(Model::ModelInfo))
+			{
+				Model::ModelInfo info;
+				std::memcpy(&info, data.data() + sizeof(Model::ModelHeader), sizeof(info));
+				const size_t entriesOffset = sizeof(Model::ModelHeader) + sizeof(Model::ModelInfo);
+				info.checksum = Model::GetChecksum(std::span<const uint8_t>(data).subspan(entriesOffset));
+				info.size = data.size();
+				std::memcpy(data.data() + sizeof(Model::ModelHeader), &info, sizeof(info));
+			}
+
+			Model::ModelView view;
+			if (Model::Load(data, view))
+			{
+				loaded++;
+				INFO("version " << static_cast<int>(original[4]) << ", iteration " << iteration);
+				CheckInBounds(view, data);
+			}
+		}
+		CHECK(loaded > 0); // the fuzz has to reach past the header checks
+	}
+}
+
+TEST_CASE("Model load benchmark", "[.][benchmark][model]")
+{
+	// a model file with a few large meshes, read from disk the way the plugin loads them
+	std::mt19937 rng(27);
+	std::vector<TestMesh> meshes;
+	for (int i = 0; i < 8; i++) meshes.push_back(RandomMesh(rng, fmt::format("mesh{}", i), 50000, 4));
+
+	const auto directory = std::filesystem::temp_directory_path();
+	const auto v1Path = directory / "DebugMenuTests_v1.mdl";
+	const auto v2Path = directory / "DebugMenuTests_v2.mdl";
+	auto writeFile = [](const std::filesystem::path& a_path, const std::vector<uint8_t>& a_data)
+	{
+		std::ofstream(a_path, std::ios::binary).write(reinterpret_cast<const char*>(a_data.data()), a_data.size());
+	};
+	writeFile(v1Path, SerializeV1(meshes));
+	writeFile(v2Path, Serialize(meshes));
+
+	auto readFile = [](const std::filesystem::path& a_path)
+	{
+		std::ifstream stream(a_path, std::ios::binary);
+		std::vector<uint8_t> data(std::filesystem::file_size(a_path));
+		stream.read(reinterpret_cast<char*>(data.data()), data.size());
+		return data;
+	};
+
+	BENCHMARK("v1, read and copied")
+	{
+		Model::Model model;
+		Model::Load(readFile(v1Path), model);
+		return model.meshes.size();
+	};
+
+	BENCHMARK("v2, read and copied")
+	{
+		Model::Model model;
+		Model::Load(readFile(v2Path), model);
+		return model.meshes.size();
+	};
+
+	BENCHMARK("v2, read and viewed")
+	{
+		const auto data = readFile(v2Path);
+		Model::ModelView view;
+		Model::Load(data, view);
+		return view.meshes.size();
+	};
+
+	std::filesystem::remove(v1Path);
+	std::filesystem::remove(v2Path);
+}
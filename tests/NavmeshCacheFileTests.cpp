@@ -0,0 +1,274 @@
+#include "Catch.h"
+#include "DebugMenu/NavmeshCacheFile.h"
+
+using namespace DebugMenu;
+
+namespace
+{
+	struct TestNavmesh
+	{
+		RE::FormID						formID = 0;
+		RE::NiPoint3					origin;
+		RE::NiPoint3					step;
+		std::vector<PackedVertex>		vertices;
+		std::vector<PackedTriangle>		triangles;
+		std::vector<std::string_view>	sourceFiles;
+	};
+
+	struct TestCell
+	{
+		RE::FormID					cellID = 0;
+		std::vector<TestNavmesh>	navmeshes;
+	};
+
+	const std::string longName(300, 'a'); // longer than the length prefix allows
+
+	TestNavmesh RandomNavmesh(std::mt19937& a_rng, RE::FormID a_formID)
+	{
+		static const std::string_view names[]{ "Skyrim.esm"sv, "Update.esm"sv, "Dawnguard.esm"sv, std::string_view(longName) };
+
+		std::uniform_int_distribution<uint32_t> value(0, 0xFFFF);
+		std::uniform_real_distribution<float> coordinate(-100000.0f, 100000.0f);
+
+		TestNavmesh navmesh;
+		navmesh.formID = a_formID;
+		navmesh.origin = RE::NiPoint3(coordinate(a_rng), coordinate(a_rng), coordinate(a_rng));
+		navmesh.step = RE::NiPoint3(0.06f, 0.07f, 0.01f);
+
+		navmesh.vertices.resize(std::uniform_int_distribution<size_t>(1, 200)(a_rng));
+		for (auto& vertex : navmesh.vertices)
+		{
+			vertex = PackedVertex{ static_cast<uint16_t>(value(a_rng)), static_cast<uint16_t>(value(a_rng)), static_cast<uint16_t>(value(a_rng)) };
+		}
+
+		std::uniform_int_distribution<uint32_t> vertexIndex(0, static_cast<uint32_t>(navmesh.vertices.size() - 1));
+		navmesh.triangles.resize(std::uniform_int_distribution<size_t>(0, 300)(a_rng));
+		for (auto& triangle : navmesh.triangles)
+		{
+			for (auto& vertex : triangle.vertices) vertex = static_cast<uint16_t>(vertexIndex(a_rng));
+			triangle.triangleFlags = static_cast<uint16_t>(value(a_rng));
+			triangle.traversalFlags = static_cast<uint16_t>(value(a_rng));
+			triangle.edgeLinks = static_cast<uint8_t>(value(a_rng) & 0x3F);
+		}
+
+		navmesh.sourceFiles.assign(names, names + std::uniform_int_distribution<size_t>(0, std::size(names))(a_rng));
+		return navmesh;
+	}
+
+	// writes the file the way NavmeshDiskCache::Serialize does
+	std::vector<uint8_t> WriteFile(const std::vector<TestCell>& a_cells, uint64_t a_loadOrderHash)
+	{
+		std::vector<uint8_t> buffer;
+		std::vector<NavmeshCacheFile::CellEntry> cellIndex;
+		NavmeshCacheFile::ReserveHeader(buffer);
+
+		for (const auto& cell : a_cells)
+		{
+			NavmeshCacheFile::CellEntry entry{};
+			entry.cellID = cell.cellID;
+			entry.numberOfNavmeshes = static_cast<uint32_t>(cell.navmeshes.size());
+			entry.offset = buffer.size();
+			for (const auto& navmesh : cell.navmeshes)
+			{
+				NavmeshCacheFile::WriteNavmesh(buffer, navmesh.formID, navmesh.origin, navmesh.step, navmesh.vertices, navmesh.triangles, navmesh.sourceFiles);
+			}
+			entry.size = buffer.size() - entry.offset;
+			cellIndex.push_back(entry);
+		}
+
+		NavmeshCacheFile::WriteCellIndex(buffer, a_loadOrderHash, cellIndex);
+		return buffer;
+	}
+
+	std::vector<TestCell> RandomCells(std::mt19937& a_rng, size_t a_count)
+	{
+		std::vector<TestCell> cells(a_count);
+		RE::FormID formID = 0x1000;
+		for (size_t i = 0; i < a_count; i++)
+		{
+			cells[i].cellID = static_cast<RE::FormID>(0x100 + i);
+			cells[i].navmeshes.resize(std::uniform_int_distribution<size_t>(1, 3)(a_rng));
+			for (auto& navmesh : cells[i].navmeshes) navmesh = RandomNavmesh(a_rng, formID++);
+		}
+		return cells;
+	}
+
+	void CheckEqual(const NavmeshCacheFile::Navmesh& a_read, const TestNavmesh& a_written)
+	{
+		CHECK(a_read.formID == a_written.formID);
+		CHECK(a_read.origin == a_written.origin);
+		CHECK(a_read.step == a_written.step);
+
+		REQUIRE(a_read.vertices.size() == a_written.vertices.size());
+		for (size_t i = 0; i < a_read.vertices.size(); i++)
+		{
+			CHECK(a_read.vertices[i].x == a_written.vertices[i].x);
+			CHECK(a_read.vertices[i].y == a_written.vertices[i].y);
+			CHECK(a_read.vertices[i].z == a_written.vertices[i].z);
+		}
+
+		REQUIRE(a_read.triangles.size() == a_written.triangles.size());
+		for (size_t i = 0; i < a_read.triangles.size(); i++)
+		{
+			const auto& read = a_read.triangles[i];
+			const auto& written = a_written.triangles[i];
+			CHECK(std::ranges::equal(read.vertices, written.vertices));
+			CHECK(read.triangleFlags == written.triangleFlags);
+			CHECK(read.traversalFlags == written.traversalFlags);
+			CHECK(read.edgeLinks == written.edgeLinks);
+		}
+
+		REQUIRE(a_read.sourceFiles.size() == a_written.sourceFiles.size());
+		for (size_t i = 0; i < a_read.sourceFiles.size(); i++)
+		{
+			CHECK(a_read.sourceFiles[i] == a_written.sourceFiles[i].substr(0, 0xFF));
+		}
+	}
+
+	// a cell that could be read has to be safe to draw: every triangle uses a vertex of its navmesh
+	bool AreIndicesValid(const std::vector<NavmeshCacheFile::Navmesh>& a_navmeshes)
+	{
+		return std::ranges::all_of(a_navmeshes, [](const NavmeshCacheFile::Navmesh& a_navmesh)
+		{
+			return std::ranges::all_of(a_navmesh.triangles, [&](const PackedTriangle& a_triangle)
+			{
+				return std::ranges::all_of(a_triangle.vertices, [&](uint16_t a_vertex) { return a_vertex < a_navmesh.vertices.size(); });
+			});
+		});
+	}
+}
+
+TEST_CASE("Navmesh cache file round trip", "[navmeshcache]")
+{
+	std::mt19937 rng(8);
+	const auto cells = RandomCells(rng, 20);
+	const auto file = WriteFile(cells, 0x1234);
+
+	std::vector<NavmeshCacheFile::CellEntry> cellIndex;
+	REQUIRE(NavmeshCacheFile::ReadCellIndex(file, 0x1234, cellIndex));
+	REQUIRE(cellIndex.size() == cells.size());
+
+	for (size_t i = 0; i < cells.size(); i++)
+	{
+		INFO("cell " << i);
+		CHECK(cellIndex[i].cellID == cells[i].cellID);
+		CHECK(NavmeshCacheFile::IsInFile(file, cellIndex[i]));
+
+		std::vector<NavmeshCacheFile::Navmesh> navmeshes;
+		REQUIRE(NavmeshCacheFile::ReadCell(file, cellIndex[i], navmeshes));
+		REQUIRE(navmeshes.size() == cells[i].navmeshes.size());
+		for (size_t j = 0; j < navmeshes.size(); j++) CheckEqual(navmeshes[j], cells[i].navmeshes[j]);
+	}
+}
+
+TEST_CASE("Navmesh cache file is rejected for another load order or version", "[navmeshcache]")
+{
+	std::mt19937 rng(9);
+	auto file = WriteFile(RandomCells(rng, 3), 0x1234);
+	std::vector<NavmeshCacheFile::CellEntry> cellIndex;
+
+	CHECK_FALSE(NavmeshCacheFile::ReadCellIndex(file, 0x4321, cellIndex));
+	CHECK(cellIndex.empty());
+
+	NavmeshCacheFile::Header header;
+	std::memcpy(&header, file.data(), sizeof(header));
+	header.version++;
+	std::memcpy(file.data(), &header, sizeof(header));
+	CHECK_FALSE(NavmeshCacheFile::ReadCellIndex(file, 0x1234, cellIndex));
+
+	CHECK_FALSE(NavmeshCacheFile::ReadCellIndex({}, 0x1234, cellIndex));
+}
+
+TEST_CASE("Navmesh cache file with an index past the end is rejected", "[navmeshcache]")
+{
+	std::mt19937 rng(10);
+	auto file = WriteFile(RandomCells(rng, 3), 0x1234);
+	std::vector<NavmeshCacheFile::CellEntry> cellIndex;
+
+	NavmeshCacheFile::Header header;
+	std::memcpy(&header, file.data(), sizeof(header));
+	header.numberOfCells = 4;
+	std::memcpy(file.data(), &header, sizeof(header));
+	CHECK_FALSE(NavmeshCacheFile::ReadCellIndex(file, 0x1234, cellIndex));
+
+	header.numberOfCells = 3;
+	header.cellIndexOffset = file.size() + 1;
+	std::memcpy(file.data(), &header, sizeof(header));
+	CHECK_FALSE(NavmeshCacheFile::ReadCellIndex(file, 0x1234, cellIndex));
+}
+
+TEST_CASE("Navmesh cache cell with a triangle using a missing vertex is rejected", "[navmeshcache]")
+{
+	std::mt19937 rng(11);
+	auto cells = RandomCells(rng, 1);
+	auto& navmesh = cells[0].navmeshes[0];
+	navmesh.triangles.resize(std::max<size_t>(navmesh.triangles.size(), 1));
+	navmesh.triangles.back().vertices[2] = static_cast<uint16_t>(navmesh.vertices.size());
+	const auto file = WriteFile(cells, 0x1234);
+
+	std::vector<NavmeshCacheFile::CellEntry> cellIndex;
+	REQUIRE(NavmeshCacheFile::ReadCellIndex(file, 0x1234, cellIndex));
+
+	std::vector<NavmeshCacheFile::Navmesh> navmeshes;
+	CHECK_FALSE(NavmeshCacheFile::ReadCell(file, cellIndex[0], navmeshes));
+	CHECK(navmeshes.empty());
+}
+
+TEST_CASE("Navmesh cache cells cut short are rejected", "[navmeshcache]")
+{
+	std::mt19937 rng(12);
+	const auto cells = RandomCells(rng, 2);
+	const auto file = WriteFile(cells, 0x1234);
+
+	std::vector<NavmeshCacheFile::CellEntry> cellIndex;
+	REQUIRE(NavmeshCacheFile::ReadCellIndex(file, 0x1234, cellIndex));
+
+	// every shorter size of the entry, and every shorter file the entry no longer fits in
+	for (auto entry : cellIndex)
+	{
+		const uint64_t size = entry.size;
+		for (entry.size = 0; entry.size < size; entry.size++)
+		{
+			std::vector<NavmeshCacheFile::Navmesh> navmeshes;
+			INFO("size " << entry.size << " of " << size);
+			CHECK_FALSE(NavmeshCacheFile::ReadCell(file, entry, navmeshes));
+			CHECK(navmeshes.empty());
+		}
+
+		entry.size = size;
+		const std::span<const uint8_t> truncated(file.data(), static_cast<size_t>(entry.offset + entry.size - 1));
+		std::vector<NavmeshCacheFile::Navmesh> navmeshes;
+		CHECK_FALSE(NavmeshCacheFile::IsInFile(truncated, entry));
+		CHECK_FALSE(NavmeshCacheFile::ReadCell(truncated, entry, navmeshes));
+	}
+}
+
+TEST_CASE("Navmesh cache file fuzz", "[navmeshcache][fuzz]")
+{
+	std::mt19937 rng(13);
+	const auto original = WriteFile(RandomCells(rng, 4), 0x1234);
+	std::uniform_int_distribution<size_t> position(0, original.size() - 1);
+	std::uniform_int_distribution<uint32_t> byte(0, 0xFF);
+
+	// corrupted bytes anywhere, and truncated files. Nothing may read out of bounds, and whatever is read has valid indices
+	for (int iteration = 0; iteration < 3000; iteration++)
+	{
+		auto file = original;
+		const int flips = std::uniform_int_distribution<int>(1, 8)(rng);
+		for (int i = 0; i < flips; i++) file[position(rng)] = static_cast<uint8_t>(byte(rng));
+		if (iteration % 4 == 0) file.resize(position(rng));
+
+		std::vector<NavmeshCacheFile::CellEntry> cellIndex;
+		if (!NavmeshCacheFile::ReadCellIndex(file, 0x1234, cellIndex)) continue;
+
+		for (const auto& entry : cellIndex)
+		{
+			std::vector<NavmeshCacheFile::Navmesh> navmeshes;
+			if (NavmeshCacheFile::ReadCell(file, entry, navmeshes))
+			{
+				INFO("iteration " << iteration);
+				CHECK(AreIndicesValid(navmeshes));
+			}
+		}
+	}
+}
@@ -0,0 +1,171 @@
+#include "Catch.h"
+#include "DebugMenu/NavmeshGrid.h"
+
+namespace
+{
+	struct Triangle
+	{
+		RE::NiPoint2 vertices[3];
+	};
+
+	std::vector<Triangle> RandomTriangles(std::mt19937& a_rng, size_t a_count, float a_extent)
+	{
+		std::uniform_real_distribution<float> position(-a_extent, a_extent);
+		std::uniform_real_distribution<float> offset(-300.0f, 300.0f);
+		std::vector<Triangle> triangles(a_count);
+		for (auto& triangle : triangles)
+		{
+			RE::NiPoint2 center(position(a_rng), position(a_rng));
+			for (auto& vertex : triangle.vertices) vertex = center + RE::NiPoint2(offset(a_rng), offset(a_rng));
+		}
+		return triangles;
+	}
+
+	RE::NiPoint2 GetLowerCorner(const Triangle& a_triangle)
+	{
+		return RE::NiPoint2(
+			std::min({ a_triangle.vertices[0].x, a_triangle.vertices[1].x, a_triangle.vertices[2].x }),
+			std::min({ a_triangle.vertices[0].y, a_triangle.vertices[1].y, a_triangle.vertices[2].y }));
+	}
+
+	bool IsInRange(const Triangle& a_triangle, const RE::NiPoint2& a_origin, float a_range)
+	{
+		return std::ranges::all_of(a_triangle.vertices, [&](const RE::NiPoint2& a_vertex) { return (a_vertex - a_origin).SqrLength() <= a_range * a_range; });
+	}
+
+	// builds the grid the way NavmeshHandler does, and sorts the triangles with the returned order
+	std::vector<Triangle> BuildSorted(DebugMenu::NavmeshGrid& a_grid, const std::vector<Triangle>& a_triangles, float a_cellSize = 512.0f, uint32_t a_maxWidth = 64)
+	{
+		std::vector<RE::NiPoint2> corners;
+		for (const auto& triangle : a_triangles) corners.push_back(GetLowerCorner(triangle));
+
+		const auto order = a_grid.Build(corners, a_cellSize, a_maxWidth);
+		std::vector<Triangle> sorted;
+		for (const uint32_t index : order) sorted.push_back(a_triangles[index]);
+		return sorted;
+	}
+
+	std::vector<uint32_t> QueryInRange(const DebugMenu::NavmeshGrid& a_grid, const std::vector<Triangle>& a_sorted, const RE::NiPoint2& a_origin, float a_range)
+	{
+		std::vector<uint32_t> found;
+		a_grid.ForEachInRange(a_origin, a_range, [&](uint32_t a_begin, uint32_t a_end)
+		{
+			for (uint32_t t = a_begin; t < a_end; t++)
+			{
+				if (IsInRange(a_sorted[t], a_origin, a_range)) found.push_back(t);
+			}
+		});
+		return found;
+	}
+}
+
+TEST_CASE("NavmeshGrid sorts the items into continuous cell ranges", "[navmeshgrid]")
+{
+	std::mt19937 rng(5);
+	const auto triangles = RandomTriangles(rng, 3000, 20000.0f);
+
+	DebugMenu::NavmeshGrid grid;
+	const auto sorted = BuildSorted(grid, triangles);
+
+	REQUIRE(sorted.size() == triangles.size());
+	REQUIRE(grid.width >= 1);
+	REQUIRE(grid.width <= 65);
+	REQUIRE(grid.cellStarts.size() == grid.width * grid.height + 1);
+	CHECK(grid.cellStarts.front() == 0);
+	CHECK(grid.cellStarts.back() == triangles.size());
+	CHECK(std::ranges::is_sorted(grid.cellStarts));
+
+	for (uint32_t cell = 0; cell + 1 < grid.cellStarts.size(); cell++)
+	{
+		for (uint32_t t = grid.cellStarts[cell]; t < grid.cellStarts[cell + 1]; t++)
+		{
+			const auto corner = GetLowerCorner(sorted[t]);
+			CHECK(grid.GetCellY(corner.y) * grid.width + grid.GetCellX(corner.x) == cell);
+		}
+	}
+}
+
+TEST_CASE("NavmeshGrid finds the same triangles in range as a full scan", "[navmeshgrid]")
+{
+	std::mt19937 rng(6);
+	const float extent = GENERATE(1000.0f, 20000.0f, 200000.0f); // one cell, the minimum cell size, and cells grown to the max width
+	const auto triangles = RandomTriangles(rng, 2000, extent);
+
+	DebugMenu::NavmeshGrid grid;
+	const auto sorted = BuildSorted(grid, triangles);
+
+	std::uniform_real_distribution<float> position(-1.5f * extent, 1.5f * extent);
+	std::uniform_real_distribution<float> range(0.0f, 8000.0f);
+	for (int query = 0; query < 300; query++)
+	{
+		const RE::NiPoint2 origin(position(rng), position(rng));
+		const float queryRange = range(rng);
+
+		std::vector<uint32_t> expected;
+		for (uint32_t t = 0; t < sorted.size(); t++)
+		{
+			if (IsInRange(sorted[t], origin, queryRange)) expected.push_back(t);
+		}
+
+		auto found = QueryInRange(grid, sorted, origin, queryRange);
+		std::ranges::sort(found);
+		INFO("extent " << extent << ", query " << query);
+		CHECK(found == expected);
+	}
+}
+
+TEST_CASE("NavmeshGrid handles empty and degenerate input", "[navmeshgrid]")
+{
+	DebugMenu::NavmeshGrid grid;
+	CHECK(grid.Build({}, 512.0f, 64).empty());
+	CHECK(grid.width == 0);
+
+	bool called = false;
+	grid.ForEachInRange(RE::NiPoint2(), 1000.0f, [&](uint32_t, uint32_t) { called = true; });
+	CHECK_FALSE(called);
+
+	// all items on one point give a single cell
+	const std::vector<RE::NiPoint2> corners(10, RE::NiPoint2(5.0f, 5.0f));
+	CHECK(grid.Build(corners, 512.0f, 64).size() == 10);
+	CHECK(grid.width == 1);
+	CHECK(grid.height == 1);
+
+	uint32_t count = 0;
+	grid.ForEachInRange(RE::NiPoint2(5.0f, 5.0f), 0.0f, [&](uint32_t a_begin, uint32_t a_end) { count += a_end - a_begin; });
+	CHECK(count == 10);
+}
+
+TEST_CASE("NavmeshGrid benchmark", "[.][benchmark][navmeshgrid]")
+{
+	std::mt19937 rng(7);
+	const auto triangles = RandomTriangles(rng, 20000, 30000.0f);
+
+	DebugMenu::NavmeshGrid grid;
+	const auto sorted = BuildSorted(grid, triangles);
+
+	std::uniform_real_distribution<float> position(-30000.0f, 30000.0f);
+	std::vector<RE::NiPoint2> origins(64);
+	for (auto& origin : origins) origin = RE::NiPoint2(position(rng), position(rng));
+	constexpr float range = 4000.0f;
+
+	BENCHMARK("full scan")
+	{
+		size_t count = 0;
+		for (const auto& origin : origins)
+			for (const auto& triangle : sorted) count += IsInRange(triangle, origin, range);
+		return count;
+	};
+
+	BENCHMARK("grid")
+	{
+		size_t count = 0;
+		for (const auto& origin : origins) count += QueryInRange(grid, sorted, origin, range).size();
+		return count;
+	};
+
+	BENCHMARK("build")
+	{
+		DebugMenu::NavmeshGrid rebuilt;
+		return BuildSorted(rebuilt, triangles).size();
+	};
+}
@@ -0,0 +1,173 @@
+#include "Catch.h"
+#include "Renderer/OverlayGeometry.h"
+
+using Renderer::LineVertex;
+using Renderer::OverlayGeometry;
+
+namespace
+{
+	// distance of the point from the infinite line through a and b
+	float DistanceToLine(const glm::vec3& a_point, const glm::vec3& a_a, const glm::vec3& a_b)
+	{
+		return glm::length(glm::cross(a_point - a_a, glm::normalize(a_b - a_a)));
+	}
+
+	float TriangleArea(const LineVertex& a_p1, const LineVertex& a_p2, const LineVertex& a_p3)
+	{
+		return 0.5f * glm::length(glm::cross(a_p2.pos - a_p1.pos, a_p3.pos - a_p1.pos));
+	}
+}
+
+TEST_CASE("LineVertex packs colors as RGBA8 with red in the lowest byte", "[overlay]")
+{
+	CHECK(LineVertex::PackColor(glm::vec4(1.0f, 0.0f, 0.0f, 1.0f)) == 0xFF0000FF);
+	CHECK(LineVertex::PackColor(glm::vec4(0.0f, 0.0f, 1.0f, 0.0f)) == 0x00FF0000);
+	CHECK(LineVertex::PackColor(glm::vec4(0.5f, 0.2f, 0.0f, 1.0f)) == 0xFF003380); // rounded, not truncated
+	CHECK(LineVertex::PackColor(glm::vec4(2.0f, -1.0f, 0.0f, 1.5f)) == 0xFF0000FF); // clamped
+
+	CHECK(LineVertex::PackColor(0x112233, 100) == 0xFF332211);
+	CHECK(LineVertex::PackColor(0x112233, 0) == 0x00332211);
+	CHECK(LineVertex::PackColor(0xFFFFFF, 50) == 0x80FFFFFF);
+	CHECK(LineVertex::PackColor(0xFFFFFF, 1000) == 0xFFFFFFFF); // the alpha is at most 100
+
+	// both overloads agree on the DrawHandler colors
+	CHECK(LineVertex::PackColor(0xFF8000, 100) == LineVertex::PackColor(glm::vec4(1.0f, 128.0f / 255.0f, 0.0f, 1.0f)));
+}
+
+TEST_CASE("OverlayGeometry fans polygons into triangles", "[overlay]")
+{
+	const std::vector<glm::vec3> points{ { 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 }, { 0.5f, 1.5f, 0 }, { 0, 1, 0 } };
+
+	for (size_t count = 0; count <= points.size(); count++)
+	{
+		std::vector<LineVertex> output;
+		OverlayGeometry::TriangulateFan(std::span(points).first(count), 7, output);
+
+		INFO("count " << count);
+		const size_t triangles = count < 3 ? 0 : count - 2;
+		REQUIRE(output.size() == 3 * triangles);
+		for (size_t i = 0; i < triangles; i++)
+		{
+			CHECK(output[3 * i].pos == points[0]);
+			CHECK(output[3 * i + 1].pos == points[i + 1]);
+			CHECK(output[3 * i + 2].pos == points[i + 2]);
+			CHECK(output[3 * i].col == 7);
+		}
+	}
+}
+
+TEST_CASE("OverlayGeometry expands lines to face the camera", "[overlay]")
+{
+	const glm::vec3 start(0.0f, 0.0f, 0.0f);
+	const glm::vec3 end(100.0f, 0.0f, 0.0f);
+	const glm::vec3 camera(50.0f, -300.0f, 200.0f);
+
+	std::vector<LineVertex> output;
+	OverlayGeometry::ExpandLine(start, end, 4.0f, 10.0f, 1, camera, output);
+	REQUIRE(output.size() == 6);
+
+	// the two triangles cover the trapezoid of the widths, without overlapping
+	CHECK(TriangleArea(output[0], output[1], output[2]) + TriangleArea(output[3], output[4], output[5]) == Approx(100.0f * (4.0f + 10.0f) / 2.0f));
+
+	const glm::vec3 toCamera = glm::normalize(camera - (start + end) * 0.5f);
+	for (const auto& vertex : output)
+	{
+		const bool isAtStart = std::abs(vertex.pos.x) < 1e-3f;
+		CHECK(DistanceToLine(vertex.pos, start, end) == Approx(isAtStart ? 2.0f : 5.0f));
+		// widened sideways as seen from the camera, not towards it
+		CHECK(glm::dot(vertex.pos - (isAtStart ? start : end), toCamera) == Approx(0.0f).margin(1e-3f));
+	}
+}
+
+TEST_CASE("OverlayGeometry skips lines that cover nothing", "[overlay]")
+{
+	std::vector<LineVertex> output;
+	const glm::vec3 point(10.0f, 20.0f, 30.0f);
+
+	OverlayGeometry::ExpandLine(point, point, 5.0f, 5.0f, 1, glm::vec3(0.0f), output);
+	CHECK(output.empty());
+
+	// looked at straight along the line
+	OverlayGeometry::ExpandLine(glm::vec3(0.0f, 0.0f, 10.0f), glm::vec3(0.0f, 0.0f, 20.0f), 5.0f, 5.0f, 1, glm::vec3(0.0f), output);
+	CHECK(output.empty());
+}
+
+TEST_CASE("OverlayGeometry expands discs into closed fans", "[overlay]")
+{
+	const glm::vec3 center(5.0f, 6.0f, 7.0f);
+	const glm::vec3 right(1.0f, 0.0f, 0.0f);
+	const glm::vec3 up(0.0f, 0.0f, 1.0f);
+
+	std::vector<LineVertex> output;
+	OverlayGeometry::ExpandDisc(center, 3.0f, 9, right, up, output);
+	REQUIRE(output.size() == 3 * OverlayGeometry::discSegments);
+
+	for (uint32_t i = 0; i < OverlayGeometry::discSegments; i++)
+	{
+		INFO("segment " << i);
+		CHECK(output[3 * i].pos == center);
+		CHECK(glm::distance(output[3 * i + 2].pos, center) == Approx(3.0f));
+		CHECK(output[3 * i + 2].pos.y == Approx(center.y)); // in the plane of right and up
+		if (i > 0) CHECK(output[3 * i + 1].pos == output[3 * i - 1].pos);
+	}
+	// the last segment ends exactly where the first starts, so there is no gap
+	CHECK(output.back().pos == output[1].pos);
+}
+
+TEST_CASE("OverlayGeometry rebuilds the strokes from the lines and discs", "[overlay]")
+{
+	OverlayGeometry geometry;
+	CHECK_FALSE(geometry.HasStrokes());
+
+	const std::vector<glm::vec3> square{ { 0, 0, 0 }, { 100, 0, 0 }, { 100, 100, 0 }, { 0, 100, 0 } };
+	geometry.AddPolygon(square, 1);
+	geometry.AddPolygonBorder(square, 2.0f, 2);
+	geometry.AddDisc(glm::vec3(50.0f, 50.0f, 0.0f), 4.0f, 3);
+	CHECK(geometry.GetFills().size() == 6);
+	CHECK(geometry.HasStrokes());
+	CHECK(geometry.GetStrokes().empty()); // until they are built
+
+	const glm::vec3 camera(50.0f, 50.0f, 500.0f);
+	geometry.BuildStrokes(camera, glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), 2.0f);
+	const auto strokes = geometry.GetStrokes();
+	REQUIRE(strokes.size() == 4 * 6 + 3 * OverlayGeometry::discSegments);
+
+	// the border is closed, and the widths and radii are scaled
+	for (size_t i = 0; i < 4 * 6; i++)
+	{
+		CHECK(strokes[i].col == 2);
+		CHECK(DistanceToLine(strokes[i].pos, square[i / 6], square[(i / 6 + 1) % 4]) == Approx(2.0f));
+	}
+	CHECK(glm::distance(strokes.back().pos, glm::vec3(50.0f, 50.0f, 0.0f)) == Approx(8.0f));
+
+	// building again replaces the strokes
+	geometry.BuildStrokes(camera, glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), 2.0f);
+	CHECK(geometry.GetStrokes().size() == strokes.size());
+
+	geometry.Clear();
+	CHECK(geometry.GetFills().empty());
+	CHECK(geometry.GetStrokes().empty());
+	CHECK_FALSE(geometry.HasStrokes());
+}
+
+TEST_CASE("OverlayGeometry benchmark", "[.][benchmark][overlay]")
+{
+	std::mt19937 rng(70);
+	std::uniform_real_distribution<float> coordinate(-5000.0f, 5000.0f);
+
+	// about a dense navmesh: every triangle filled, with its border
+	OverlayGeometry geometry;
+	for (int i = 0; i < 5000; i++)
+	{
+		const glm::vec3 triangle[3]{ { coordinate(rng), coordinate(rng), 0.0f }, { coordinate(rng), coordinate(rng), 0.0f }, { coordinate(rng), coordinate(rng), 0.0f } };
+		geometry.AddPolygon(triangle, 0xFF00FF00);
+		geometry.AddPolygonBorder(triangle, 2.0f, 0xFFFFFFFF);
+	}
+	for (int i = 0; i < 1000; i++) geometry.AddDisc(glm::vec3(coordinate(rng), coordinate(rng), 0.0f), 5.0f, 0xFF0000FF);
+
+	BENCHMARK("BuildStrokes")
+	{
+		geometry.BuildStrokes(glm::vec3(0.0f, 0.0f, 3000.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), 1.0f);
+		return geometry.GetStrokes().size();
+	};
+}
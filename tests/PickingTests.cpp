@@ -0,0 +1,246 @@
+#include "Catch.h"
+#include "Picking.h"
+
+using Picking::Ray;
+using RE::NiPoint3;
+
+namespace
+{
+	struct Shape
+	{
+		enum class Type
+		{
+			kTriangle,
+			kSegment,
+			kSphere
+		};
+
+		Type		type;
+		NiPoint3	points[3];
+		float		radius = 0.0f;
+	};
+
+	// shapes of navmesh and marker sizes, spread over a few cells on either side of 0
+	std::vector<Shape> RandomShapes(std::mt19937& a_rng, size_t a_count, float a_extent)
+	{
+		std::uniform_real_distribution<float> coordinate(-a_extent, a_extent);
+		std::uniform_real_distribution<float> height(-200.0f, 200.0f);
+		std::uniform_real_distribution<float> size(-300.0f, 300.0f);
+		std::uniform_real_distribution<float> radius(1.0f, 30.0f);
+		std::uniform_int_distribution<int> type(0, 5);
+
+		std::vector<Shape> shapes(a_count);
+		for (auto& shape : shapes)
+		{
+			const NiPoint3 center(coordinate(a_rng), coordinate(a_rng), height(a_rng));
+			const int kind = type(a_rng);
+			shape.type = kind < 4 ? Shape::Type::kTriangle : (kind == 4 ? Shape::Type::kSegment : Shape::Type::kSphere);
+			for (auto& point : shape.points) point = center + NiPoint3(size(a_rng), size(a_rng), size(a_rng) * 0.2f);
+			shape.points[0] = center;
+			shape.radius = shape.type == Shape::Type::kTriangle ? 0.0f : radius(a_rng);
+		}
+		return shapes;
+	}
+
+	Picking::ShapeGrid MakeGrid(const std::vector<Shape>& a_shapes, float a_cellSize)
+	{
+		Picking::ShapeGrid grid(a_cellSize);
+		for (uint32_t id = 0; id < a_shapes.size(); id++)
+		{
+			const auto& shape = a_shapes[id];
+			switch (shape.type)
+			{
+				case Shape::Type::kTriangle:	grid.AddTriangle(shape.points[0], shape.points[1], shape.points[2], id); break;
+				case Shape::Type::kSegment:		grid.AddSegment(shape.points[0], shape.points[1], shape.radius, id); break;
+				case Shape::Type::kSphere:		grid.AddSphere(shape.points[0], shape.radius, id); break;
+			}
+		}
+		grid.Build();
+		return grid;
+	}
+
+	bool Intersect(const Shape& a_shape, const Ray& a_ray, float a_radiusScale, float& a_t)
+	{
+		switch (a_shape.type)
+		{
+			case Shape::Type::kTriangle:	return Picking::IntersectTriangle(a_ray, a_shape.points[0], a_shape.points[1], a_shape.points[2], a_t);
+			case Shape::Type::kSegment:		return Picking::IntersectSegment(a_ray, a_shape.points[0], a_shape.points[1], a_shape.radius * a_radiusScale, a_t);
+			default:						return Picking::IntersectSphere(a_ray, a_shape.points[0], a_shape.radius * a_radiusScale, a_t);
+		}
+	}
+
+	// every shape tested, the closest t and the ids hit at it
+	float PickAll(const std::vector<Shape>& a_shapes, const Ray& a_ray, float a_radiusScale, std::vector<uint32_t>& a_ids)
+	{
+		float closest = std::numeric_limits<float>::max();
+		a_ids.clear();
+		for (uint32_t id = 0; id < a_shapes.size(); id++)
+		{
+			float t;
+			if (!Intersect(a_shapes[id], a_ray, a_radiusScale, t) || t > closest) continue;
+			if (t < closest) a_ids.clear();
+			closest = t;
+			a_ids.push_back(id);
+		}
+		return closest;
+	}
+
+	Ray RandomRay(std::mt19937& a_rng, float a_extent)
+	{
+		std::uniform_real_distribution<float> coordinate(-a_extent, a_extent);
+		std::uniform_real_distribution<float> direction(-1.0f, 1.0f);
+
+		Ray ray;
+		ray.origin = NiPoint3(coordinate(a_rng), coordinate(a_rng), 500.0f);
+		ray.direction = NiPoint3(direction(a_rng), direction(a_rng), -std::abs(direction(a_rng)));
+		if (std::uniform_int_distribution<int>(0, 9)(a_rng) == 0) ray.direction = NiPoint3(0.0f, 0.0f, -1.0f); // straight down
+		ray.direction.Unitize();
+		ray.length = std::uniform_real_distribution<float>(100.0f, 2 * a_extent)(a_rng);
+		ray.slope = std::uniform_real_distribution<float>(0.0f, 0.01f)(a_rng);
+		return ray;
+	}
+}
+
+TEST_CASE("Picking intersects triangles from both sides", "[picking]")
+{
+	const NiPoint3 p1(0, 0, 0), p2(10, 0, 0), p3(0, 10, 0);
+	Ray ray{ NiPoint3(2, 2, 5), NiPoint3(0, 0, -1), 100.0f, 0.0f };
+
+	float t = 0.0f;
+	REQUIRE(Picking::IntersectTriangle(ray, p1, p2, p3, t));
+	CHECK(t == Approx(5.0f));
+
+	ray = Ray{ NiPoint3(2, 2, -5), NiPoint3(0, 0, 1), 100.0f, 0.0f };
+	REQUIRE(Picking::IntersectTriangle(ray, p1, p2, p3, t));
+	CHECK(t == Approx(5.0f));
+
+	ray.length = 4.0f; // too short
+	CHECK_FALSE(Picking::IntersectTriangle(ray, p1, p2, p3, t));
+
+	ray = Ray{ NiPoint3(2, 2, 5), NiPoint3(0, 0, 1), 100.0f, 0.0f }; // behind the origin
+	CHECK_FALSE(Picking::IntersectTriangle(ray, p1, p2, p3, t));
+
+	ray = Ray{ NiPoint3(8, 8, 5), NiPoint3(0, 0, -1), 100.0f, 0.0f }; // outside
+	CHECK_FALSE(Picking::IntersectTriangle(ray, p1, p2, p3, t));
+}
+
+TEST_CASE("Picking hits segments and spheres within their radius and the slope", "[picking]")
+{
+	Ray ray{ NiPoint3(0, 0, 10), NiPoint3(0, 0, -1), 100.0f, 0.0f };
+	float t = 0.0f;
+
+	// a segment passing 3 units beside the ray, 10 units down
+	REQUIRE(Picking::IntersectSegment(ray, NiPoint3(-5, 3, 0), NiPoint3(5, 3, 0), 3.5f, t));
+	CHECK(t == Approx(10.0f));
+	CHECK_FALSE(Picking::IntersectSegment(ray, NiPoint3(-5, 3, 0), NiPoint3(5, 3, 0), 2.5f, t));
+	ray.slope = 0.1f; // one more unit of tolerance at t = 10
+	CHECK(Picking::IntersectSegment(ray, NiPoint3(-5, 3, 0), NiPoint3(5, 3, 0), 2.5f, t));
+	ray.slope = 0.0f;
+
+	// beyond the end of the segment, the end is the closest point
+	CHECK_FALSE(Picking::IntersectSegment(ray, NiPoint3(4, 0, 0), NiPoint3(10, 0, 0), 3.5f, t));
+	CHECK(Picking::IntersectSegment(ray, NiPoint3(3, 0, 0), NiPoint3(10, 0, 0), 3.5f, t));
+
+	// a segment without length is a sphere
+	CHECK(Picking::IntersectSegment(ray, NiPoint3(1, 1, 2), NiPoint3(1, 1, 2), 2.0f, t));
+	CHECK(t == Approx(8.0f));
+
+	REQUIRE(Picking::IntersectSphere(ray, NiPoint3(1, 0, -20), 1.5f, t));
+	CHECK(t == Approx(30.0f));
+	CHECK_FALSE(Picking::IntersectSphere(ray, NiPoint3(2, 0, -20), 1.5f, t));
+	CHECK_FALSE(Picking::IntersectSphere(ray, NiPoint3(0, 0, 20), 1.5f, t)); // behind the origin
+}
+
+TEST_CASE("ShapeGrid picks the same shape as testing every shape", "[picking]")
+{
+	std::mt19937 rng(90);
+	const float extent = GENERATE(300.0f, 3000.0f);
+	const float cellSize = GENERATE(128.0f, 512.0f);
+
+	const auto shapes = RandomShapes(rng, 2000, extent);
+	auto grid = MakeGrid(shapes, cellSize);
+	CHECK_FALSE(grid.IsEmpty());
+
+	std::vector<uint32_t> expectedIDs;
+	uint32_t hits = 0;
+	for (int i = 0; i < 2000; i++)
+	{
+		const auto ray = RandomRay(rng, extent);
+		const float radiusScale = std::uniform_real_distribution<float>(0.5f, 3.0f)(rng);
+		const float expected = PickAll(shapes, ray, radiusScale, expectedIDs);
+		const auto hit = grid.Pick(ray, radiusScale);
+
+		INFO("extent " << extent << ", cell size " << cellSize << ", ray " << i);
+		REQUIRE(static_cast<bool>(hit) == !expectedIDs.empty());
+		CHECK(grid.GetTestsOfLastPick() <= shapes.size());
+		if (!hit) continue;
+
+		hits++;
+		CHECK(hit.t == expected);
+		CHECK(std::ranges::find(expectedIDs, hit.id) != expectedIDs.end());
+		CHECK(hit.position.GetDistance(ray.origin + ray.direction * hit.t) < 1e-3f);
+	}
+	CHECK(hits > 100); // the scene is dense enough that the comparison means something
+}
+
+TEST_CASE("ShapeGrid fans polygons, and is empty after Clear", "[picking]")
+{
+	Picking::ShapeGrid grid;
+	const NiPoint3 square[]{ { 0, 0, 0 }, { 100, 0, 0 }, { 100, 100, 0 }, { 0, 100, 0 } };
+	grid.AddPolygon(square, 7);
+	grid.Build();
+
+	// both triangles of the fan carry the id
+	CHECK(grid.Pick(Ray{ NiPoint3(90, 10, 5), NiPoint3(0, 0, -1), 10.0f, 0.0f }, 1.0f).id == 7);
+	CHECK(grid.Pick(Ray{ NiPoint3(10, 90, 5), NiPoint3(0, 0, -1), 10.0f, 0.0f }, 1.0f).id == 7);
+
+	grid.Clear();
+	grid.Build();
+	CHECK(grid.IsEmpty());
+	CHECK_FALSE(grid.Pick(Ray{ NiPoint3(90, 10, 5), NiPoint3(0, 0, -1), 10.0f, 0.0f }, 1.0f));
+}
+
+TEST_CASE("ShapeGrid only tests the shapes near the ray", "[picking]")
+{
+	std::mt19937 rng(91);
+	const auto shapes = RandomShapes(rng, 20000, 20000.0f);
+	auto grid = MakeGrid(shapes, 512.0f);
+
+	// a short ray looking down, as at the crosshair, tests a few cells of the 80 x 80
+	const Ray ray{ NiPoint3(100.0f, 100.0f, 500.0f), NiPoint3(0.3f, 0.0f, -1.0f), 1000.0f, 0.002f };
+	grid.Pick(ray, 1.0f);
+	CHECK(grid.GetTestsOfLastPick() < shapes.size() / 50);
+}
+
+TEST_CASE("ShapeGrid benchmark", "[.][benchmark][picking]")
+{
+	std::mt19937 rng(92);
+	const auto shapes = RandomShapes(rng, 20000, 20000.0f);
+	auto grid = MakeGrid(shapes, 512.0f);
+	std::vector<Ray> rays(64);
+	for (auto& ray : rays)
+	{
+		ray = RandomRay(rng, 20000.0f);
+		ray.length = 3000.0f;
+	}
+
+	BENCHMARK("test every shape")
+	{
+		std::vector<uint32_t> ids;
+		float sum = 0.0f;
+		for (const auto& ray : rays) sum += PickAll(shapes, ray, 1.0f, ids);
+		return sum;
+	};
+
+	BENCHMARK("ShapeGrid::Pick")
+	{
+		float sum = 0.0f;
+		for (const auto& ray : rays) sum += grid.Pick(ray, 1.0f).t;
+		return sum;
+	};
+
+	BENCHMARK("ShapeGrid::Build")
+	{
+		return MakeGrid(shapes, 512.0f).IsEmpty();
+	};
+}
@@ -0,0 +1,267 @@
+#include "Catch.h"
+#include "Profiler.h"
+
+using Profiler::QuantileEstimator;
+using Profiler::Sample;
+using Profiler::SampleRing;
+
+namespace
+{
+	double ExactQuantile(std::vector<double> a_values, double a_quantile)
+	{
+		std::sort(a_values.begin(), a_values.end());
+		return a_values[static_cast<size_t>(std::round(a_quantile * (a_values.size() - 1)))];
+	}
+
+	// the value is derived from the other fields, so a sample read while it was being overwritten is noticed
+	Sample MakeSample(uint32_t a_thread, int64_t a_index)
+	{
+		return { a_index, a_index * 31 + a_thread, a_thread };
+	}
+
+	bool IsConsistent(const Sample& a_sample)
+	{
+		return a_sample.value == a_sample.start * 31 + a_sample.threadID;
+	}
+
+	// zones live as long as the program, so every test uses names of its own and leaves the profiler disabled
+	struct EnabledProfiler
+	{
+		EnabledProfiler() { Profiler::SetEnabled(true); }
+		~EnabledProfiler() { Profiler::SetEnabled(false); }
+	};
+}
+
+TEST_CASE("QuantileEstimator is exact for the first values", "[profiler]")
+{
+	QuantileEstimator median(0.5);
+	CHECK(median.Get() == 0.0);
+
+	const double values[]{ 9.0, 1.0, 5.0, 3.0 };
+	std::vector<double> added;
+	for (const double value : values)
+	{
+		median.Add(value);
+		added.push_back(value);
+		CHECK(median.Get() == ExactQuantile(added, 0.5));
+	}
+	CHECK(median.GetCount() == 4);
+}
+
+TEST_CASE("QuantileEstimator follows the exact quantiles", "[profiler]")
+{
+	std::mt19937 rng(50);
+	constexpr size_t count = 100000;
+
+	// frame times are skewed, with a long tail, so an exponential distribution is tested besides the symmetric ones
+	const auto distribution = GENERATE(0, 1, 2);
+	std::vector<double> values(count);
+	if (distribution == 0)
+	{
+		std::uniform_real_distribution<double> value(0.0, 1000.0);
+		for (auto& v : values) v = value(rng);
+	}
+	else if (distribution == 1)
+	{
+		std::normal_distribution<double> value(500.0, 100.0);
+		for (auto& v : values) v = value(rng);
+	}
+	else
+	{
+		std::exponential_distribution<double> value(1.0 / 200.0);
+		for (auto& v : values) v = value(rng);
+	}
+
+	for (const double quantile : { 0.5, 0.95, 0.99 })
+	{
+		QuantileEstimator estimator(quantile);
+		for (const double value : values) estimator.Add(value);
+
+		const double exact = ExactQuantile(values, quantile);
+		INFO("distribution " << distribution << ", quantile " << quantile);
+		CHECK(estimator.GetCount() == count);
+		CHECK(estimator.Get() == Approx(exact).epsilon(0.02));
+	}
+}
+
+TEST_CASE("QuantileEstimator of a constant is the constant", "[profiler]")
+{
+	QuantileEstimator estimator(0.95);
+	for (int i = 0; i < 1000; i++) estimator.Add(42.0);
+	CHECK(estimator.Get() == 42.0);
+}
+
+TEST_CASE("SampleRing reads what was recorded, oldest first", "[profiler]")
+{
+	SampleRing ring;
+	std::vector<Sample> samples;
+	uint64_t dropped = 0;
+
+	for (int64_t i = 0; i < 100; i++) ring.Record(MakeSample(0, i));
+	uint64_t position = ring.Read(0, samples, dropped);
+	CHECK(position == 100);
+	CHECK(dropped == 0);
+	REQUIRE(samples.size() == 100);
+	for (int64_t i = 0; i < 100; i++) CHECK(samples[i].start == i);
+
+	// nothing new
+	samples.clear();
+	CHECK(ring.Read(position, samples, dropped) == 100);
+	CHECK(samples.empty());
+}
+
+TEST_CASE("SampleRing counts the samples that were overwritten before they were read", "[profiler]")
+{
+	SampleRing ring;
+	const int64_t total = SampleRing::capacity * 3 + 17;
+	for (int64_t i = 0; i < total; i++) ring.Record(MakeSample(0, i));
+
+	std::vector<Sample> samples;
+	uint64_t dropped = 0;
+	CHECK(ring.Read(0, samples, dropped) == static_cast<uint64_t>(total));
+	CHECK(dropped == total - SampleRing::capacity);
+	REQUIRE(samples.size() == SampleRing::capacity);
+	CHECK(samples.front().start == total - SampleRing::capacity);
+	CHECK(samples.back().start == total - 1);
+}
+
+TEST_CASE("SampleRing with concurrent writers never returns a torn sample", "[profiler][stress]")
+{
+	constexpr uint32_t writers = 4;
+	constexpr int64_t samplesPerWriter = 200000;
+
+	SampleRing ring;
+	std::atomic<uint32_t> finishedWriters = 0;
+	std::vector<std::thread> threads;
+	for (uint32_t writer = 0; writer < writers; writer++)
+	{
+		threads.emplace_back([&ring, &finishedWriters, writer]() {
+			for (int64_t i = 0; i < samplesPerWriter; i++) ring.Record(MakeSample(writer, i));
+			finishedWriters++;
+		});
+	}
+
+	// read while the writers are writing, like Collect does once per frame
+	uint64_t position = 0;
+	uint64_t dropped = 0;
+	uint64_t read = 0;
+	bool isConsistent = true;
+	std::vector<int64_t> lastIndex(writers, -1);
+	bool isInOrder = true;
+	std::vector<Sample> samples;
+	while (true)
+	{
+		const bool isFinished = finishedWriters == writers;
+		samples.clear();
+		position = ring.Read(position, samples, dropped);
+		for (const auto& sample : samples)
+		{
+			isConsistent &= IsConsistent(sample);
+			if (sample.threadID < writers)
+			{
+				isInOrder &= sample.start > lastIndex[sample.threadID];
+				lastIndex[sample.threadID] = sample.start;
+			}
+		}
+		read += samples.size();
+		if (isFinished && position == ring.GetWritePosition()) break;
+	}
+
+	for (auto& thread : threads) thread.join();
+	CHECK(isConsistent);
+	CHECK(isInOrder);
+	CHECK(read + dropped == writers * samplesPerWriter); // every sample is either read or counted as dropped
+}
+
+TEST_CASE("Zone statistics and the dumps", "[profiler]")
+{
+	EnabledProfiler enabled;
+	auto& timer = Profiler::GetZone("Tests/Timer");
+	auto& counter = Profiler::GetZone("Tests/Counter", Profiler::ZoneType::kCounter);
+	CHECK(&Profiler::GetZone("Tests/Timer") == &timer);
+
+	for (int64_t value = 1; value <= 100; value++)
+	{
+		timer.Record(value, value * 1000);
+		Profiler::RecordValue(counter, value);
+	}
+	Profiler::Collect();
+
+	const auto stats = counter.GetStats();
+	CHECK(stats.count == 100);
+	CHECK(stats.dropped == 0);
+	CHECK(stats.min == 1);
+	CHECK(stats.max == 100);
+	CHECK(stats.Mean() == Approx(50.5));
+	CHECK(stats.p50 == Approx(50.5).margin(2.0));
+
+	const auto csv = Profiler::ToCSV();
+	CHECK(csv.find("\"Tests/Timer\",us,100,0,1.000,50.500,") != std::string::npos);
+	CHECK(csv.find("\"Tests/Counter\",value,100,0,1.000,50.500,") != std::string::npos);
+
+	const auto trace = Profiler::ToChromeTrace();
+	CHECK(trace.find("{\"name\":\"Tests/Timer\",\"ph\":\"X\",\"pid\":1,\"tid\":") != std::string::npos);
+	CHECK(trace.find("\"ph\":\"C\"") != std::string::npos);
+
+	// enabling again starts over
+	Profiler::SetEnabled(false);
+	Profiler::SetEnabled(true);
+	CHECK(timer.GetStats().count == 0);
+}
+
+TEST_CASE("A disabled profiler records nothing", "[profiler]")
+{
+	auto& zone = Profiler::GetZone("Tests/Disabled");
+	const uint64_t position = zone.GetRecentSamples().size();
+	for (int i = 0; i < 10; i++)
+	{
+		PROFILE_SCOPE("Tests/Disabled");
+	}
+	CHECK(zone.GetRecentSamples().size() == position);
+
+	EnabledProfiler enabled;
+	for (int i = 0; i < 10; i++)
+	{
+		PROFILE_SCOPE("Tests/Disabled");
+	}
+	CHECK(zone.GetRecentSamples().size() == position + 10);
+}
+
+TEST_CASE("Profiler benchmark", "[.][benchmark][profiler]")
+{
+	std::mt19937 rng(51);
+	std::exponential_distribution<double> value(1.0 / 200.0);
+	std::vector<double> values(10000);
+	for (auto& v : values) v = value(rng);
+
+	// the percentiles the COLLISIONS_PROFILING block took, by sorting a copy of the whole history
+	BENCHMARK("sorted percentiles")
+	{
+		return ExactQuantile(values, 0.5) + ExactQuantile(values, 0.95) + ExactQuantile(values, 0.99);
+	};
+
+	BENCHMARK("QuantileEstimator")
+	{
+		QuantileEstimator p50(0.5), p95(0.95), p99(0.99);
+		for (const double v : values)
+		{
+			p50.Add(v);
+			p95.Add(v);
+			p99.Add(v);
+		}
+		return p50.Get() + p95.Get() + p99.Get();
+	};
+
+	BENCHMARK("disabled scope")
+	{
+		PROFILE_SCOPE("Tests/Benchmark");
+		return 0;
+	};
+
+	EnabledProfiler enabled;
+	BENCHMARK("enabled scope")
+	{
+		PROFILE_SCOPE("Tests/Benchmark");
+		return 0;
+	};
+}
@@ -0,0 +1,190 @@
+#include "Catch.h"
+#include "QuickHull.h"
+
+namespace
+{
+	using Faces = std::vector<std::vector<uint16_t>>;
+
+	// Newell's method, so the normal of a polygon does not depend on which of its vertices are picked
+	glm::dvec3 GetNormal(const std::vector<glm::dvec3>& a_points, const std::vector<uint16_t>& a_face)
+	{
+		glm::dvec3 normal{ 0.0 };
+		for (size_t i = 0; i < a_face.size(); i++)
+		{
+			const auto& current = a_points[a_face[i]];
+			const auto& next = a_points[a_face[(i + 1) % a_face.size()]];
+			normal.x += (current.y - next.y) * (current.z + next.z);
+			normal.y += (current.z - next.z) * (current.x + next.x);
+			normal.z += (current.x - next.x) * (current.y + next.y);
+		}
+		return glm::normalize(normal);
+	}
+
+	// every point is on or below the plane of every face, and the vertices of a face are on its plane
+	void CheckConvex(const std::vector<glm::dvec3>& a_points, const Faces& a_faces, double a_tolerance)
+	{
+		for (const auto& face : a_faces)
+		{
+			REQUIRE(face.size() >= 3);
+			const auto normal = GetNormal(a_points, face);
+			const double offset = glm::dot(normal, a_points[face[0]]);
+
+			for (const auto vertex : face) CHECK(std::abs(glm::dot(normal, a_points[vertex]) - offset) <= a_tolerance);
+			for (const auto& point : a_points) CHECK(glm::dot(normal, point) - offset <= a_tolerance);
+		}
+	}
+
+	// every edge is used once in each direction, so the faces are consistently oriented and close the hull
+	void CheckClosed(const Faces& a_faces)
+	{
+		std::map<std::pair<uint16_t, uint16_t>, int> edges;
+		for (const auto& face : a_faces)
+		{
+			for (size_t i = 0; i < face.size(); i++) edges[{ face[i], face[(i + 1) % face.size()] }]++;
+		}
+		for (const auto& [edge, count] : edges)
+		{
+			INFO("edge " << edge.first << " -> " << edge.second);
+			CHECK(count == 1);
+			CHECK(edges.contains({ edge.second, edge.first }));
+		}
+	}
+
+	std::vector<glm::dvec3> GetCube(double a_size)
+	{
+		std::vector<glm::dvec3> points;
+		for (int i = 0; i < 8; i++)
+		{
+			// the game stores the vertices as floats
+			points.emplace_back(static_cast<float>(i & 1 ? a_size : -a_size), static_cast<float>(i & 2 ? a_size : -a_size), static_cast<float>(i & 4 ? a_size : -a_size));
+		}
+		return points;
+	}
+
+	std::vector<glm::dvec3> GetSpherePoints(std::mt19937& a_rng, size_t a_count, double a_radius)
+	{
+		std::normal_distribution<double> normal;
+		std::vector<glm::dvec3> points;
+		for (size_t i = 0; i < a_count; i++)
+		{
+			auto point = glm::normalize(glm::dvec3(normal(a_rng), normal(a_rng), normal(a_rng))) * a_radius;
+			points.emplace_back(static_cast<float>(point.x), static_cast<float>(point.y), static_cast<float>(point.z));
+		}
+		return points;
+	}
+}
+
+TEST_CASE("QuickHull merges the triangles of a cube into its 6 sides", "[quickhull]")
+{
+	std::mt19937 rng(15);
+	auto points = GetCube(50.0);
+
+	// points inside the cube and on its sides are not part of the hull
+	std::uniform_real_distribution<double> inside(-49.0, 49.0);
+	for (int i = 0; i < 50; i++) points.emplace_back(inside(rng), inside(rng), inside(rng));
+	points.emplace_back(50.0, 0.0, 0.0);
+
+	Utils::QuickHull hull{ points };
+	REQUIRE(hull.Build());
+
+	const auto faces = hull.GetFaces();
+	REQUIRE(faces.size() == 6);
+	for (const auto& face : faces)
+	{
+		CHECK(face.size() == 4);
+		for (const auto vertex : face) CHECK(vertex < 8);
+	}
+	CheckConvex(points, faces, 1e-3);
+	CheckClosed(faces);
+}
+
+TEST_CASE("QuickHull merges almost coplanar triangles", "[quickhull]")
+{
+	// corners moved by less than float precision allows, which is what ensureConnectivity fails on
+	std::mt19937 rng(16);
+	std::uniform_real_distribution<double> jitter(-2e-5, 2e-5);
+	auto points = GetCube(500.0);
+	for (auto& point : points) point += glm::dvec3(jitter(rng), jitter(rng), jitter(rng));
+
+	Utils::QuickHull hull{ points };
+	REQUIRE(hull.Build());
+	CHECK(hull.GetFaces().size() == 6);
+}
+
+TEST_CASE("QuickHull of points on a sphere", "[quickhull]")
+{
+	std::mt19937 rng(17);
+	const size_t count = GENERATE(4, 10, 100, 1000);
+	auto points = GetSpherePoints(rng, count, 100.0);
+
+	Utils::QuickHull hull{ points };
+	REQUIRE(hull.Build());
+
+	const auto faces = hull.GetFaces();
+	CheckConvex(points, faces, 1e-3);
+	CheckClosed(faces);
+
+	// all points are on the sphere, so every one of them is a vertex of the hull
+	std::set<uint16_t> vertices;
+	for (const auto& face : faces) vertices.insert(face.begin(), face.end());
+	CHECK(vertices.size() == points.size());
+}
+
+TEST_CASE("QuickHull rejects degenerate input", "[quickhull]")
+{
+	SECTION("too few points")
+	{
+		std::vector<glm::dvec3> points{ { 0.0, 0.0, 0.0 }, { 1.0, 0.0, 0.0 }, { 0.0, 1.0, 0.0 } };
+		Utils::QuickHull hull{ points };
+		CHECK_FALSE(hull.Build());
+	}
+
+	SECTION("coplanar points")
+	{
+		std::mt19937 rng(18);
+		std::uniform_real_distribution<double> value(-100.0, 100.0);
+		std::vector<glm::dvec3> points;
+		for (int i = 0; i < 100; i++) points.emplace_back(value(rng), value(rng), 7.0);
+		Utils::QuickHull hull{ points };
+		CHECK_FALSE(hull.Build());
+	}
+
+	SECTION("collinear points")
+	{
+		std::vector<glm::dvec3> points;
+		for (int i = 0; i < 10; i++) points.emplace_back(i, 2.0 * i, -i);
+		Utils::QuickHull hull{ points };
+		CHECK_FALSE(hull.Build());
+	}
+
+	SECTION("the same point")
+	{
+		std::vector<glm::dvec3> points(10, glm::dvec3(3.0, 4.0, 5.0));
+		Utils::QuickHull hull{ points };
+		CHECK_FALSE(hull.Build());
+	}
+}
+
+TEST_CASE("QuickHull benchmark", "[.][benchmark][quickhull]")
+{
+	std::mt19937 rng(19);
+	const auto sphere = GetSpherePoints(rng, 1000, 100.0);
+
+	// a typical convex shape: few vertices, many of them on the same planes
+	auto box = GetCube(50.0);
+	for (auto point : GetCube(50.0)) box.push_back(point * 0.5 + glm::dvec3(0.0, 0.0, 25.0));
+
+	BENCHMARK("box")
+	{
+		Utils::QuickHull hull{ box };
+		hull.Build();
+		return hull.GetFaces().size();
+	};
+
+	BENCHMARK("1000 points on a sphere")
+	{
+		Utils::QuickHull hull{ sphere };
+		hull.Build();
+		return hull.GetFaces().size();
+	};
+}
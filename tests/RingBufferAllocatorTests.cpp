@@ -0,0 +1,109 @@
+#include "Catch.h"
+#include "Renderer/RingBufferAllocator.h"
+
+using Renderer::RingBufferAllocator;
+
+TEST_CASE("RingBufferAllocator appends until the buffer is full", "[ringbuffer]")
+{
+	RingBufferAllocator ring(100);
+
+	auto first = ring.Allocate(40); // starts full, so the first frame discards
+	CHECK(first.offset == 0);
+	CHECK(first.discard);
+	CHECK_FALSE(first.grow);
+
+	auto second = ring.Allocate(40);
+	CHECK(second.offset == 40);
+	CHECK_FALSE(second.discard);
+
+	auto exact = ring.Allocate(20); // fills the buffer exactly
+	CHECK(exact.offset == 80);
+	CHECK_FALSE(exact.discard);
+
+	auto wrapped = ring.Allocate(1);
+	CHECK(wrapped.offset == 0);
+	CHECK(wrapped.discard);
+	CHECK_FALSE(wrapped.grow);
+	CHECK(ring.Capacity() == 100);
+}
+
+TEST_CASE("RingBufferAllocator grows to the next power of two", "[ringbuffer]")
+{
+	RingBufferAllocator ring(64);
+
+	auto grown = ring.Allocate(65);
+	CHECK(grown.offset == 0);
+	CHECK(grown.discard);
+	CHECK(grown.grow);
+	CHECK(ring.Capacity() == 128);
+
+	auto next = ring.Allocate(63);
+	CHECK(next.offset == 65);
+	CHECK_FALSE(next.discard);
+	CHECK_FALSE(next.grow);
+
+	CHECK(ring.Allocate(1).discard);
+}
+
+TEST_CASE("RingBufferAllocator with empty allocations", "[ringbuffer]")
+{
+	RingBufferAllocator ring(16);
+	ring.Allocate(16);
+
+	auto empty = ring.Allocate(0); // a full buffer still has room for nothing
+	CHECK(empty.offset == 16);
+	CHECK_FALSE(empty.discard);
+	CHECK_FALSE(empty.grow);
+}
+
+TEST_CASE("RingBufferAllocator never hands out memory the gpu may still read", "[ringbuffer][fuzz]")
+{
+	std::mt19937 rng(14);
+	std::uniform_int_distribution<uint32_t> smallCount(0, 3000);
+	std::uniform_int_distribution<uint32_t> largeCount(0, 200000);
+
+	RingBufferAllocator ring(1 << 12);
+	uint32_t capacity = ring.Capacity();
+
+	// the ranges written since the last discard, which the gpu may still be reading
+	std::vector<std::pair<uint32_t, uint32_t>> inFlight;
+	bool isFirst = true;
+
+	for (int frame = 0; frame < 20000; frame++)
+	{
+		const uint32_t count = frame % 50 == 0 ? largeCount(rng) : smallCount(rng);
+		const auto allocation = ring.Allocate(count);
+		INFO("frame " << frame << ", count " << count);
+
+		if (isFirst) CHECK(allocation.discard);
+		isFirst = false;
+
+		if (allocation.grow)
+		{
+			CHECK(allocation.discard);
+			CHECK(count > capacity);
+			CHECK(ring.Capacity() == std::bit_ceil(count));
+			capacity = ring.Capacity();
+		}
+		else
+		{
+			CHECK(ring.Capacity() == capacity);
+		}
+
+		REQUIRE(allocation.offset + count <= ring.Capacity());
+
+		if (allocation.discard)
+		{
+			CHECK(allocation.offset == 0);
+			inFlight.clear();
+		}
+		else
+		{
+			for (const auto& [offset, size] : inFlight)
+			{
+				CHECK((allocation.offset >= offset + size || allocation.offset + count <= offset));
+			}
+		}
+		if (count > 0) inFlight.emplace_back(allocation.offset, count);
+	}
+}
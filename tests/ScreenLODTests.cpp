@@ -0,0 +1,254 @@
+#include "Catch.h"
+#include "ScreenLOD.h"
+
+using RE::NiPoint2;
+using RE::NiPoint3;
+using ScreenLOD::PolygonStyle;
+using ScreenLOD::Thresholds;
+
+namespace
+{
+	// Newell's method, the length is twice the area
+	NiPoint3 GetAreaVector(const std::vector<NiPoint3>& a_polygon)
+	{
+		NiPoint3 normal;
+		for (size_t i = 0; i < a_polygon.size(); i++)
+		{
+			const auto& current = a_polygon[i];
+			const auto& next = a_polygon[(i + 1) % a_polygon.size()];
+			normal.x += (current.y - next.y) * (current.z + next.z);
+			normal.y += (current.z - next.z) * (current.x + next.x);
+			normal.z += (current.x - next.x) * (current.y + next.y);
+		}
+		return normal;
+	}
+
+	double GetArea(const std::vector<NiPoint3>& a_polygon)
+	{
+		return a_polygon.size() < 3 ? 0.0 : GetAreaVector(a_polygon).Length() / 2.0;
+	}
+
+	// polygons within about 0.8 degrees of each other count as coplanar, so the points can be off the plane by a little
+	bool IsConvexAndPlanar(const std::vector<NiPoint3>& a_polygon)
+	{
+		auto normal = GetAreaVector(a_polygon);
+		normal.Unitize();
+		const size_t n = a_polygon.size();
+
+		float size = 0.0f;
+		for (const auto& point : a_polygon) size = std::max(size, point.GetDistance(a_polygon[0]));
+
+		for (size_t i = 0; i < n; i++)
+		{
+			const auto edge1 = a_polygon[(i + 1) % n] - a_polygon[i];
+			const auto edge2 = a_polygon[(i + 2) % n] - a_polygon[(i + 1) % n];
+			if (edge1.Cross(edge2).Dot(normal) < -1e-3f * edge1.Length() * edge2.Length()) return false;
+			if (std::abs((a_polygon[i] - a_polygon[0]).Dot(normal)) > 0.02f * size) return false;
+		}
+		return true;
+	}
+
+	// two triangles per cell of a grid, wound counter clockwise seen from above, so neighbours share their edges
+	// in opposite order. The height comes from the function, so the grid can be folded
+	template <class F>
+	std::vector<std::vector<NiPoint3>> MakeTriangleGrid(uint32_t a_size, float a_step, F&& a_height)
+	{
+		auto point = [&](uint32_t a_x, uint32_t a_y) { return NiPoint3(a_x * a_step, a_y * a_step, a_height(a_x, a_y)); };
+
+		std::vector<std::vector<NiPoint3>> triangles;
+		for (uint32_t y = 0; y < a_size; y++)
+		{
+			for (uint32_t x = 0; x < a_size; x++)
+			{
+				triangles.push_back({ point(x, y), point(x + 1, y), point(x + 1, y + 1) });
+				triangles.push_back({ point(x, y), point(x + 1, y + 1), point(x, y + 1) });
+			}
+		}
+		return triangles;
+	}
+
+	uint32_t Merge(std::vector<std::vector<NiPoint3>>& a_polygons, const std::vector<PolygonStyle>& a_styles, uint32_t a_maxPoints = 8)
+	{
+		std::vector<std::vector<NiPoint3>*> pointers;
+		for (auto& polygon : a_polygons) pointers.push_back(&polygon);
+		return ScreenLOD::MergeCoplanarPolygons(pointers, a_styles, a_maxPoints);
+	}
+
+	size_t CountNonEmpty(const std::vector<std::vector<NiPoint3>>& a_polygons)
+	{
+		return std::count_if(a_polygons.begin(), a_polygons.end(), [](const auto& a_polygon) { return !a_polygon.empty(); });
+	}
+}
+
+TEST_CASE("ScreenLOD measures polygons on the canvas", "[screenlod]")
+{
+	const NiPoint2 square[]{ { 0, 0 }, { 10, 0 }, { 10, 10 }, { 0, 10 } };
+	const NiPoint2 reversed[]{ { 0, 10 }, { 10, 10 }, { 10, 0 }, { 0, 0 } };
+	const NiPoint2 triangle[]{ { 0, 0 }, { 30, 0 }, { 0, 4 } };
+
+	CHECK(ScreenLOD::GetPolygonArea(square, 4) == 100.0f);
+	CHECK(ScreenLOD::GetPolygonArea(reversed, 4) == 100.0f); // either winding
+	CHECK(ScreenLOD::GetPolygonArea(triangle, 3) == 60.0f);
+	CHECK(ScreenLOD::GetPolygonArea(square, 2) == 0.0f);
+
+	CHECK(ScreenLOD::GetPolygonPerimeter(square, 4) == 40.0f);
+	CHECK(ScreenLOD::GetPolygonPerimeter(triangle, 3) == Approx(34.0f + std::sqrt(916.0f)));
+	CHECK(ScreenLOD::GetPolygonPerimeter(square, 1) == 0.0f);
+
+	CHECK(ScreenLOD::GetExtent(triangle, 3) == 30.0f);
+	CHECK(ScreenLOD::GetExtent(square, 0) == 0.0f);
+}
+
+TEST_CASE("ScreenLOD culls shapes below the thresholds", "[screenlod]")
+{
+	const Thresholds thresholds{ 20.0f, 3.0f, 6.0f };
+	const NiPoint2 small[]{ { 0, 0 }, { 4, 0 }, { 4, 4 } };			// area 8, extent 4
+	const NiPoint2 thin[]{ { 0, 0 }, { 2, 0 }, { 2, 100 } };		// area 100, extent 100
+	const NiPoint2 sliver[]{ { 0, 0 }, { 2, 0 }, { 2, 2 } };		// area 2, extent 2
+
+	CHECK(ScreenLOD::IsPolygonTooSmall(small, 3, 0.0f, thresholds));
+	CHECK_FALSE(ScreenLOD::IsPolygonTooSmall(thin, 3, 0.0f, thresholds));
+	CHECK(ScreenLOD::IsPolygonTooSmall(sliver, 3, 0.0f, thresholds));
+	// half of the border is outside the polygon: 8 + 13.66 * 2 / 2 is enough, and it widens the extent as well
+	CHECK_FALSE(ScreenLOD::IsPolygonTooSmall(small, 3, 2.0f, thresholds));
+	CHECK(ScreenLOD::IsPolygonTooSmall(sliver, 3, 0.5f, thresholds));
+
+	CHECK(ScreenLOD::IsLineTooSmall({ 0, 0 }, { 1, 0 }, 1.0f, thresholds)); // shorter than the extent
+	CHECK(ScreenLOD::IsLineTooSmall({ 0, 0 }, { 10, 0 }, 1.0f, thresholds)); // covers 10 px^2
+	CHECK_FALSE(ScreenLOD::IsLineTooSmall({ 0, 0 }, { 0, 10 }, 2.0f, thresholds));
+
+	CHECK(ScreenLOD::IsPointTooSmall(1.0f, thresholds)); // 2 px across
+	CHECK(ScreenLOD::IsPointTooSmall(2.0f, thresholds)); // 12.6 px^2
+	CHECK_FALSE(ScreenLOD::IsPointTooSmall(3.0f, thresholds));
+
+	// nothing is culled without thresholds
+	CHECK_FALSE(ScreenLOD::IsPolygonTooSmall(sliver, 3, 0.0f, {}));
+	CHECK_FALSE(ScreenLOD::IsPointTooSmall(0.0f, {}));
+}
+
+TEST_CASE("ScreenLOD gives small circles fewer segments", "[screenlod]")
+{
+	const Thresholds thresholds{ 0.0f, 0.0f, 8.0f };
+
+	uint32_t previous = 0;
+	for (float radius = -1.0f; radius < 20.0f; radius += 0.25f)
+	{
+		const uint32_t segments = ScreenLOD::GetCircleSegments(radius, thresholds);
+		INFO("radius " << radius);
+		CHECK(segments >= ScreenLOD::minCircleSegments);
+		CHECK(segments <= ScreenLOD::maxCircleSegments);
+		CHECK(segments >= previous);
+		previous = segments;
+	}
+	CHECK(ScreenLOD::GetCircleSegments(0.0f, thresholds) == ScreenLOD::minCircleSegments);
+	CHECK(ScreenLOD::GetCircleSegments(8.0f, thresholds) == ScreenLOD::maxCircleSegments);
+	CHECK(ScreenLOD::GetCircleSegments(0.0f, {}) == ScreenLOD::maxCircleSegments); // the lod is off
+}
+
+TEST_CASE("MergeCoplanarPolygons merges a flat grid into convex polygons", "[screenlod]")
+{
+	auto polygons = MakeTriangleGrid(16, 100.0f, [](uint32_t, uint32_t) { return 5.0f; });
+	const size_t total = polygons.size();
+	const std::vector<PolygonStyle> styles(total);
+
+	const uint32_t merged = Merge(polygons, styles);
+	CHECK(merged == total - CountNonEmpty(polygons));
+	CHECK(CountNonEmpty(polygons) <= total / 3);
+
+	double area = 0.0;
+	for (const auto& polygon : polygons)
+	{
+		if (polygon.empty()) continue;
+		CHECK(polygon.size() <= 8);
+		CHECK(IsConvexAndPlanar(polygon));
+		area += GetArea(polygon);
+	}
+	CHECK(area == Approx(1600.0 * 1600.0));
+}
+
+TEST_CASE("MergeCoplanarPolygons keeps styles, planes and the point limit apart", "[screenlod]")
+{
+	SECTION("different styles")
+	{
+		std::vector<std::vector<NiPoint3>> polygons{ { { 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 } }, { { 0, 0, 0 }, { 1, 1, 0 }, { 0, 1, 0 } } };
+		std::vector<PolygonStyle> styles(2);
+		styles[1].borderThickness = 2.0f;
+		CHECK(Merge(polygons, styles) == 0);
+		CHECK(CountNonEmpty(polygons) == 2);
+	}
+
+	SECTION("folded along the shared edge")
+	{
+		std::vector<std::vector<NiPoint3>> polygons{ { { 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 } }, { { 0, 0, 0 }, { 1, 1, 0 }, { 0, 1, 0.5f } } };
+		CHECK(Merge(polygons, std::vector<PolygonStyle>(2)) == 0);
+	}
+
+	SECTION("concave result")
+	{
+		// an arrow head: the two triangles share an edge, but together they are not convex
+		std::vector<std::vector<NiPoint3>> polygons{ { { 0, 0, 0 }, { 2, 1, 0 }, { 1, 1, 0 } }, { { 0, 0, 0 }, { 1, 1, 0 }, { 0, 2, 0 } } };
+		CHECK(Merge(polygons, std::vector<PolygonStyle>(2)) == 0);
+	}
+
+	SECTION("point limit")
+	{
+		auto polygons = MakeTriangleGrid(1, 1.0f, [](uint32_t, uint32_t) { return 0.0f; });
+		CHECK(Merge(polygons, std::vector<PolygonStyle>(2), 3) == 0);
+		CHECK(Merge(polygons, std::vector<PolygonStyle>(2), 4) == 1);
+		CHECK(CountNonEmpty(polygons) == 1);
+	}
+}
+
+TEST_CASE("MergeCoplanarPolygons on random terrain", "[screenlod][fuzz]")
+{
+	std::mt19937 rng(80);
+
+	for (int iteration = 0; iteration < 50; iteration++)
+	{
+		// terraces of random heights, with a few slopes, and polygons in one of two styles
+		std::uniform_int_distribution<int> height(0, 3);
+		std::vector<int> heights(32 * 32);
+		for (auto& h : heights) h = height(rng);
+		auto polygons = MakeTriangleGrid(30, 64.0f, [&](uint32_t a_x, uint32_t a_y) { return 100.0f * heights[a_y / 4 * 32 + a_x / 4] + (a_x % 7 == 0 ? 10.0f * a_y : 0.0f); });
+
+		std::uniform_int_distribution<int> styleIndex(0, 9);
+		std::vector<PolygonStyle> styles(polygons.size());
+		for (auto& style : styles) style.color = styleIndex(rng) == 0 ? 1 : 0;
+
+		double areaBefore[2]{};
+		for (size_t i = 0; i < polygons.size(); i++) areaBefore[styles[i].color] += GetArea(polygons[i]);
+
+		const uint32_t maxPoints = std::uniform_int_distribution<uint32_t>(3, 10)(rng);
+		const uint32_t merged = Merge(polygons, styles, maxPoints);
+
+		INFO("iteration " << iteration << ", max points " << maxPoints);
+		CHECK(merged == polygons.size() - CountNonEmpty(polygons));
+
+		double areaAfter[2]{};
+		bool isValid = true;
+		for (size_t i = 0; i < polygons.size(); i++)
+		{
+			if (polygons[i].empty()) continue;
+			isValid &= polygons[i].size() <= std::max(maxPoints, 3u);
+			isValid &= IsConvexAndPlanar(polygons[i]);
+			areaAfter[styles[i].color] += GetArea(polygons[i]);
+		}
+		CHECK(isValid);
+		// a polygon keeps its style, so the area of each style stays the same
+		CHECK(areaAfter[0] == Approx(areaBefore[0]));
+		CHECK(areaAfter[1] == Approx(areaBefore[1]));
+	}
+}
+
+TEST_CASE("MergeCoplanarPolygons benchmark", "[.][benchmark][screenlod]")
+{
+	// 20000 triangles, on terraces like a navmesh of a town
+	const auto grid = MakeTriangleGrid(100, 64.0f, [](uint32_t a_x, uint32_t a_y) { return 100.0f * ((a_x / 10 + a_y / 10) % 3); });
+	const std::vector<PolygonStyle> styles(grid.size());
+
+	BENCHMARK_ADVANCED("MergeCoplanarPolygons")(Catch::Benchmark::Chronometer meter)
+	{
+		std::vector<std::vector<std::vector<NiPoint3>>> copies(meter.runs(), grid);
+		meter.measure([&](int a_run) { return Merge(copies[a_run], styles); });
+	};
+}
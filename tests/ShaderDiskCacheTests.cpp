@@ -0,0 +1,298 @@
+#include "Catch.h"
+#include "Renderer/ShaderDiskCache.h"
+
+using Renderer::ShaderCompileJob;
+using Renderer::ShaderDiskCache;
+
+namespace
+{
+	constexpr uint64_t compilerVersion = 47;
+	constexpr size_t headerSize = 32; // ShaderDiskCache::Header
+	constexpr size_t versionOffset = 4;
+
+	// the bytecode is derived from the job, so a wrong entry is noticed
+	std::vector<uint8_t> FakeBytecode(const ShaderCompileJob& a_job)
+	{
+		std::vector<uint8_t> bytecode(a_job.source.begin(), a_job.source.end());
+		bytecode.insert(bytecode.end(), a_job.entryName.begin(), a_job.entryName.end());
+		return bytecode;
+	}
+
+	class CountingCompiler : public Renderer::ShaderCompiler
+	{
+		public:
+			CountingCompiler(std::atomic<uint32_t>& a_compiles) : compiles(a_compiles) {}
+
+			uint64_t GetVersion() const override { return compilerVersion; }
+
+			std::vector<uint8_t> Compile(const ShaderCompileJob& a_job) override
+			{
+				compiles++;
+				if (a_job.source.empty()) return {}; // fails to compile
+				return FakeBytecode(a_job);
+			}
+
+		private:
+			std::atomic<uint32_t>& compiles;
+	};
+
+	ShaderCompileJob MakeJob(size_t a_index)
+	{
+		return { a_index, fmt::format("float4 main() : SV_Target {{ return {}; }}", a_index), "main", "ps_5_0" };
+	}
+
+	ShaderDiskCache::Entries RandomEntries(std::mt19937& a_rng, size_t a_count)
+	{
+		std::uniform_int_distribution<uint64_t> key;
+		std::uniform_int_distribution<size_t> size(1, 300);
+		std::uniform_int_distribution<uint32_t> byte(0, 0xFF);
+
+		ShaderDiskCache::Entries entries;
+		while (entries.size() < a_count)
+		{
+			auto& bytecode = entries[key(a_rng)];
+			bytecode.resize(size(a_rng));
+			for (auto& value : bytecode) value = static_cast<uint8_t>(byte(a_rng));
+		}
+		return entries;
+	}
+
+	// a directory of its own, removed with everything in it when the test ends
+	struct TempDirectory
+	{
+		std::filesystem::path path;
+
+		TempDirectory()
+		{
+			path = std::filesystem::temp_directory_path() / fmt::format("DebugMenuTests-{}", std::random_device()());
+			std::filesystem::create_directories(path);
+		}
+
+		~TempDirectory()
+		{
+			std::error_code error;
+			std::filesystem::remove_all(path, error);
+		}
+	};
+}
+
+TEST_CASE("ShaderDiskCache serializes and deserializes the entries", "[shadercache]")
+{
+	std::mt19937 rng(30);
+
+	for (const size_t count : { 0, 1, 2, 50 })
+	{
+		const auto entries = RandomEntries(rng, count);
+		const auto data = ShaderDiskCache::Serialize(entries, compilerVersion);
+
+		ShaderDiskCache::Entries output;
+		INFO("count " << count);
+		REQUIRE(ShaderDiskCache::Deserialize(data, compilerVersion, output));
+		CHECK(output == entries);
+
+		// the same entries give the same file, whatever the order of the map
+		ShaderDiskCache::Entries reordered;
+		reordered.rehash(entries.size() * 7 + 13);
+		reordered.insert(entries.begin(), entries.end());
+		CHECK(ShaderDiskCache::Serialize(reordered, compilerVersion) == data);
+	}
+}
+
+TEST_CASE("ShaderDiskCache rejects files of other versions or with damaged data", "[shadercache]")
+{
+	std::mt19937 rng(31);
+	const auto data = ShaderDiskCache::Serialize(RandomEntries(rng, 5), compilerVersion);
+	ShaderDiskCache::Entries output{ { 1, { 1 } } };
+
+	SECTION("other compiler version")
+	{
+		CHECK_FALSE(ShaderDiskCache::Deserialize(data, compilerVersion + 1, output));
+	}
+
+	SECTION("other file version")
+	{
+		auto changed = data;
+		changed[versionOffset]++;
+		CHECK_FALSE(ShaderDiskCache::Deserialize(changed, compilerVersion, output));
+	}
+
+	SECTION("changed bytecode")
+	{
+		auto changed = data;
+		changed.back() ^= 1;
+		CHECK_FALSE(ShaderDiskCache::Deserialize(changed, compilerVersion, output));
+	}
+
+	SECTION("every truncation")
+	{
+		for (size_t size = 0; size < data.size(); size++)
+		{
+			INFO("size " << size);
+			CHECK_FALSE(ShaderDiskCache::Deserialize(std::span(data).first(size), compilerVersion, output));
+		}
+	}
+
+	CHECK(output.empty()); // a rejected file leaves nothing behind
+}
+
+TEST_CASE("ShaderDiskCache survives damaged files", "[shadercache][fuzz]")
+{
+	std::mt19937 rng(32);
+	std::uniform_int_distribution<uint32_t> byte(0, 0xFF);
+	const auto data = ShaderDiskCache::Serialize(RandomEntries(rng, 8), compilerVersion);
+
+	// the checksum rejects almost everything, so it is recomputed with Serialize's layout to reach the entry parsing
+	std::uniform_int_distribution<size_t> position(headerSize, data.size() - 1);
+	for (int i = 0; i < 20000; i++)
+	{
+		auto changed = data;
+		const int changes = 1 + i % 4;
+		for (int j = 0; j < changes; j++) changed[position(rng)] = static_cast<uint8_t>(byte(rng));
+		if (i % 3 == 0) changed.resize(std::uniform_int_distribution<size_t>(headerSize, changed.size())(rng));
+
+		uint64_t checksum = 0xcbf29ce484222325;
+		for (size_t j = headerSize; j < changed.size(); j++)
+		{
+			checksum ^= changed[j];
+			checksum *= 0x100000001b3;
+		}
+		std::memcpy(changed.data() + 16, &checksum, sizeof(checksum));
+
+		ShaderDiskCache::Entries output;
+		if (ShaderDiskCache::Deserialize(changed, compilerVersion, output))
+		{
+			// anything accepted must serialize back to the same bytes
+			INFO("iteration " << i);
+			CHECK(ShaderDiskCache::Serialize(output, compilerVersion).size() == changed.size());
+		}
+	}
+}
+
+TEST_CASE("ShaderDiskCache keys depend on every part of the job", "[shadercache]")
+{
+	const auto job = MakeJob(3);
+	const uint64_t key = ShaderDiskCache::GetKey(job, compilerVersion);
+	CHECK(ShaderDiskCache::GetKey(MakeJob(3), compilerVersion) == key);
+
+	auto changed = job;
+	changed.source += " ";
+	CHECK(ShaderDiskCache::GetKey(changed, compilerVersion) != key);
+
+	changed = job;
+	changed.entryName = "main2";
+	CHECK(ShaderDiskCache::GetKey(changed, compilerVersion) != key);
+
+	changed = job;
+	changed.target = "vs_5_0";
+	CHECK(ShaderDiskCache::GetKey(changed, compilerVersion) != key);
+
+	changed = job;
+	changed.infoHash++;
+	CHECK(ShaderDiskCache::GetKey(changed, compilerVersion) != key);
+
+	CHECK(ShaderDiskCache::GetKey(job, compilerVersion + 1) != key);
+
+	// the strings are not just concatenated
+	changed = job;
+	changed.source += "m";
+	changed.entryName = "ain";
+	CHECK(ShaderDiskCache::GetKey(changed, compilerVersion) != key);
+}
+
+TEST_CASE("ShaderDiskCache compiles each shader once across sessions", "[shadercache]")
+{
+	TempDirectory directory;
+	const auto path = directory.path / "cache" / "Shaders.bin"; // the directory is created when the file is written
+
+	std::vector<ShaderCompileJob> jobs;
+	for (size_t i = 0; i < 20; i++) jobs.push_back(MakeJob(i));
+	auto failing = MakeJob(100);
+	failing.source.clear();
+
+	{
+		std::atomic<uint32_t> compiles = 0;
+		ShaderDiskCache cache(path, std::make_unique<CountingCompiler>(compiles));
+		auto prefetched = jobs;
+		prefetched.push_back(failing);
+		cache.Prefetch(prefetched);
+
+		for (const auto& job : jobs) CHECK(cache.GetBytecode(job) == FakeBytecode(job));
+		CHECK(cache.GetBytecode(failing).empty()); // compiled again, to log the errors
+		cache.Wait();
+		CHECK(compiles == jobs.size() + 2);
+	}
+	REQUIRE(std::filesystem::exists(path));
+	CHECK_FALSE(std::filesystem::exists(path.string() + ".tmp"));
+
+	SECTION("the next session reads the file")
+	{
+		std::atomic<uint32_t> compiles = 0;
+		ShaderDiskCache cache(path, std::make_unique<CountingCompiler>(compiles));
+		cache.Prefetch(jobs);
+
+		for (const auto& job : jobs) CHECK(cache.GetBytecode(job) == FakeBytecode(job));
+		CHECK(compiles == 0);
+	}
+
+	SECTION("a shader that is not prefetched is compiled on the calling thread and written")
+	{
+		std::atomic<uint32_t> compiles = 0;
+		{
+			ShaderDiskCache cache(path, std::make_unique<CountingCompiler>(compiles));
+			cache.Prefetch(jobs);
+			const auto extra = MakeJob(50);
+			CHECK(cache.GetBytecode(extra) == FakeBytecode(extra));
+			CHECK(compiles == 1);
+		}
+
+		ShaderDiskCache::Entries entries;
+		std::ifstream stream(path, std::ios::binary);
+		std::vector<uint8_t> data{ std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>() };
+		REQUIRE(ShaderDiskCache::Deserialize(data, compilerVersion, entries));
+		CHECK(entries.size() == jobs.size() + 1);
+	}
+
+	SECTION("a changed shader is compiled again, and the old entry dropped")
+	{
+		std::atomic<uint32_t> compiles = 0;
+		{
+			ShaderDiskCache cache(path, std::make_unique<CountingCompiler>(compiles));
+			auto changed = jobs;
+			changed[0].source += " ";
+			cache.Prefetch(changed);
+			CHECK(cache.GetBytecode(changed[0]) == FakeBytecode(changed[0]));
+			CHECK(cache.GetBytecode(changed[1]) == FakeBytecode(changed[1]));
+			cache.Wait();
+			CHECK(compiles == 1);
+		}
+
+		ShaderDiskCache::Entries entries;
+		std::ifstream stream(path, std::ios::binary);
+		std::vector<uint8_t> data{ std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>() };
+		REQUIRE(ShaderDiskCache::Deserialize(data, compilerVersion, entries));
+		CHECK(entries.size() == jobs.size());
+		CHECK_FALSE(entries.contains(ShaderDiskCache::GetKey(jobs[0], compilerVersion)));
+	}
+
+	SECTION("a damaged file is rebuilt")
+	{
+		{
+			std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+			stream << "not a cache file";
+		}
+
+		std::atomic<uint32_t> compiles = 0;
+		{
+			ShaderDiskCache cache(path, std::make_unique<CountingCompiler>(compiles));
+			cache.Prefetch(jobs);
+			for (const auto& job : jobs) CHECK(cache.GetBytecode(job) == FakeBytecode(job));
+			CHECK(compiles == jobs.size());
+		}
+
+		std::atomic<uint32_t> recompiles = 0;
+		ShaderDiskCache cache(path, std::make_unique<CountingCompiler>(recompiles));
+		cache.Prefetch(jobs);
+		cache.Wait();
+		CHECK(recompiles == 0);
+	}
+}
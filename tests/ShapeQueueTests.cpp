@@ -0,0 +1,282 @@
+#include "Catch.h"
+#include "Clipping.h"
+#include "DrawCommandBuffer.h"
+#include "ShapeQueue.h"
+
+// Every allocation of the test program goes through here, and is counted while a test asks for it
+namespace
+{
+	std::atomic<bool>		isCounting = false;
+	std::atomic<uint64_t>	allocations = 0;
+}
+
+void* operator new(std::size_t a_size)
+{
+	if (isCounting.load(std::memory_order_relaxed)) allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* memory = std::malloc(a_size ? a_size : 1)) return memory;
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t a_size)
+{
+	return operator new(a_size);
+}
+
+void operator delete(void* a_memory) noexcept
+{
+	std::free(a_memory);
+}
+
+void operator delete[](void* a_memory) noexcept
+{
+	std::free(a_memory);
+}
+
+void operator delete(void* a_memory, std::size_t) noexcept
+{
+	std::free(a_memory);
+}
+
+void operator delete[](void* a_memory, std::size_t) noexcept
+{
+	std::free(a_memory);
+}
+
+namespace
+{
+	// the number of allocations a_function makes. Nothing in it may use Catch, which allocates itself
+	template <class F>
+	uint64_t CountAllocations(F&& a_function)
+	{
+		allocations = 0;
+		isCounting = true;
+		a_function();
+		isCounting = false;
+		return allocations;
+	}
+
+	struct TestMetaData
+	{
+		uint32_t formID = 0;
+	};
+
+	using Shapes = ShapeQueue<TestMetaData>;
+
+	// about what a navmesh and its markers queue in an update: triangles, their edge links and cover, and points
+	struct Scene
+	{
+		std::vector<std::array<RE::NiPoint3, 3>>	triangles;
+		std::vector<std::array<RE::NiPoint3, 4>>	quads;
+		std::vector<RE::NiPoint3>					points;
+	};
+
+	Scene MakeScene(std::mt19937& a_rng, size_t a_triangles)
+	{
+		std::uniform_real_distribution<float> coordinate(-4000.0f, 4000.0f);
+		std::uniform_real_distribution<float> offset(-100.0f, 100.0f);
+
+		Scene scene;
+		scene.triangles.resize(a_triangles);
+		for (auto& triangle : scene.triangles)
+		{
+			const RE::NiPoint3 center(coordinate(a_rng), coordinate(a_rng), 0.0f);
+			for (auto& point : triangle) point = center + RE::NiPoint3(offset(a_rng), offset(a_rng), offset(a_rng) * 0.1f);
+		}
+		scene.quads.resize(a_triangles / 4);
+		for (auto& quad : scene.quads)
+		{
+			const RE::NiPoint3 center(coordinate(a_rng), coordinate(a_rng), 0.0f);
+			quad = { center, center + RE::NiPoint3(50, 0, 0), center + RE::NiPoint3(50, 0, 80), center + RE::NiPoint3(0, 0, 80) };
+		}
+		scene.points.resize(a_triangles / 4);
+		for (auto& point : scene.points) point = RE::NiPoint3(coordinate(a_rng), coordinate(a_rng), 0.0f);
+		return scene;
+	}
+
+	void QueueScene(Shapes& a_shapes, const Scene& a_scene)
+	{
+		a_shapes.Clear();
+		uint32_t formID = 0;
+		for (const auto& triangle : a_scene.triangles) a_shapes.AddPolygon(triangle, 2.0f, 0x00FF00, 30, 0xFFFFFF, 80, { formID++ });
+		for (const auto& quad : a_scene.quads) a_shapes.AddPolygon(quad, 1.0f, 0xFF0000, 50, 0xFF0000, 100, { formID++ });
+		for (const auto& point : a_scene.points)
+		{
+			a_shapes.points.emplace_back(point, 5.0f, 0xFFFFFF, 100, TestMetaData{ formID++ });
+			a_shapes.lines.emplace_back(point, point + RE::NiPoint3(0, 0, 100), 2.0f, 0xFFFFFF, 100, true, TestMetaData{});
+		}
+	}
+
+	// the shapes as they were queued before: one allocation per shape record, and one more for the points of each polygon
+	struct PolygonRecord
+	{
+		std::vector<RE::NiPoint3>	positions;
+		float						borderThickness;
+		uint32_t					color;
+		uint32_t					baseAlpha;
+		uint32_t					borderColor;
+		uint32_t					borderAlpha;
+		TestMetaData				metaData;
+	};
+
+	struct PerShapeQueue
+	{
+		std::vector<std::unique_ptr<Shapes::PointData>>	points;
+		std::vector<std::unique_ptr<Shapes::LineData>>	lines;
+		std::vector<std::unique_ptr<PolygonRecord>>		polygons;
+	};
+
+	void QueueScene(PerShapeQueue& a_shapes, const Scene& a_scene)
+	{
+		a_shapes.points.clear();
+		a_shapes.lines.clear();
+		a_shapes.polygons.clear();
+		uint32_t formID = 0;
+		for (const auto& triangle : a_scene.triangles)
+		{
+			std::vector<RE::NiPoint3> positions(triangle.begin(), triangle.end());
+			a_shapes.polygons.push_back(std::make_unique<PolygonRecord>(PolygonRecord{ std::move(positions), 2.0f, 0x00FF00, 30, 0xFFFFFF, 80, { formID++ } }));
+		}
+		for (const auto& quad : a_scene.quads)
+		{
+			std::vector<RE::NiPoint3> positions(quad.begin(), quad.end());
+			a_shapes.polygons.push_back(std::make_unique<PolygonRecord>(PolygonRecord{ std::move(positions), 1.0f, 0xFF0000, 50, 0xFF0000, 100, { formID++ } }));
+		}
+		for (const auto& point : a_scene.points)
+		{
+			a_shapes.points.push_back(std::make_unique<Shapes::PointData>(point, 5.0f, 0xFFFFFF, 100, TestMetaData{ formID++ }));
+			a_shapes.lines.push_back(std::make_unique<Shapes::LineData>(point, point + RE::NiPoint3(0, 0, 100), 2.0f, 0xFFFFFF, 100, true, TestMetaData{}));
+		}
+	}
+
+	// the walk DrawHandler does over the queue: the points of every polygon, in order
+	float SumPositions(const Shapes& a_shapes)
+	{
+		float sum = 0.0f;
+		for (const auto& polygon : a_shapes.polygons)
+		{
+			for (const auto& position : a_shapes.GetPositions(polygon)) sum += position.x;
+		}
+		return sum;
+	}
+
+	float SumPositions(const PerShapeQueue& a_shapes)
+	{
+		float sum = 0.0f;
+		for (const auto& polygon : a_shapes.polygons)
+		{
+			for (const auto& position : polygon->positions) sum += position.x;
+		}
+		return sum;
+	}
+}
+
+TEST_CASE("ShapeQueue keeps the points of each polygon in the arena", "[shapequeue]")
+{
+	Shapes shapes;
+	const RE::NiPoint3 triangle[]{ { 1, 2, 3 }, { 4, 5, 6 }, { 7, 8, 9 } };
+	const RE::NiPoint3 quad[]{ { 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 }, { 0, 1, 0 } };
+	shapes.AddPolygon(triangle, 2.0f, 1, 2, 3, 4, { 10 });
+	shapes.AddPolygon(quad, 1.0f, 5, 6, 7, 8, { 11 });
+
+	REQUIRE(shapes.polygons.size() == 2);
+	CHECK(shapes.positions.size() == 7);
+	CHECK(std::ranges::equal(shapes.GetPositions(shapes.polygons[0]), triangle));
+	CHECK(std::ranges::equal(shapes.GetPositions(shapes.polygons[1]), quad));
+
+	const auto& polygon = shapes.polygons[1];
+	CHECK(polygon.borderThickness == 1.0f);
+	CHECK(polygon.color == 5);
+	CHECK(polygon.baseAlpha == 6);
+	CHECK(polygon.borderColor == 7);
+	CHECK(polygon.borderAlpha == 8);
+	CHECK(polygon.metaData.formID == 11);
+
+	shapes.Clear();
+	CHECK(shapes.polygons.empty());
+	CHECK(shapes.positions.empty());
+}
+
+TEST_CASE("Queueing and clipping an update stops allocating once the buffers have grown", "[shapequeue]")
+{
+	std::mt19937 rng(100);
+	const auto large = MakeScene(rng, 4000);
+	const auto small = MakeScene(rng, 1000);
+
+	Shapes shapes;
+	Clipping::PolygonClipper clipper;
+	Clipping::VertexStream clipPoints;
+	DrawCommandBuffer commands;
+
+	// a stand-in for the rest of DrawHandler::Update: the points go to clip space (here a fixed camera looking down at the
+	// scene), are clipped, and the visible polygons are recorded into the commands of the frame
+	auto update = [&](const Scene& a_scene) {
+		QueueScene(shapes, a_scene);
+
+		clipPoints.Clear();
+		for (const auto& position : shapes.positions) clipPoints.Push(position.x / 2000.0f, position.y / 2000.0f, 0.5f, 1.0f);
+
+		commands.Reset();
+		uint32_t offset = 0;
+		for (const auto& polygon : shapes.polygons)
+		{
+			const auto clipped = clipper.Clip(clipPoints, offset, polygon.positionCount, 1.0f);
+			offset += polygon.positionCount;
+			if (!clipped) continue;
+
+			commands.LineStyle(polygon.borderThickness, polygon.borderColor, polygon.borderAlpha);
+			commands.BeginFill(polygon.color, polygon.baseAlpha);
+			commands.MoveTo(clipped->x[0], clipped->y[0]);
+			for (size_t i = 1; i < clipped->Size(); i++) commands.LineTo(clipped->x[i], clipped->y[i]);
+			commands.EndFill();
+		}
+	};
+
+	const uint64_t first = CountAllocations([&]() { update(large); });
+	CHECK(first > 0);
+
+	// the same update, a smaller one and the large one again all fit in the buffers of the first
+	CHECK(CountAllocations([&]() { update(large); }) == 0);
+	CHECK(CountAllocations([&]() { update(small); }) == 0);
+	CHECK(CountAllocations([&]() { update(large); }) == 0);
+	CHECK(commands.GetNumberOfCommands() > 0);
+}
+
+TEST_CASE("Queueing shapes by value allocates far less than one record per shape", "[shapequeue]")
+{
+	std::mt19937 rng(101);
+	const auto scene = MakeScene(rng, 4000);
+
+	PerShapeQueue perShape;
+	QueueScene(perShape, scene);
+	const uint64_t perShapeAllocations = CountAllocations([&]() { QueueScene(perShape, scene); });
+
+	Shapes shapes;
+	QueueScene(shapes, scene);
+	const uint64_t byValueAllocations = CountAllocations([&]() { QueueScene(shapes, scene); });
+
+	// two allocations per polygon and one per point and line, every update
+	CHECK(perShapeAllocations == 2 * (scene.triangles.size() + scene.quads.size()) + 2 * scene.points.size());
+	CHECK(byValueAllocations == 0);
+	CHECK(SumPositions(perShape) == SumPositions(shapes));
+}
+
+TEST_CASE("ShapeQueue benchmark", "[.][benchmark][shapequeue]")
+{
+	// 20000 triangles, 5000 quads, 5000 points and lines per update
+	std::mt19937 rng(102);
+	const auto scene = MakeScene(rng, 20000);
+
+	PerShapeQueue perShape;
+	BENCHMARK("one allocation per shape")
+	{
+		QueueScene(perShape, scene);
+		return SumPositions(perShape);
+	};
+
+	Shapes shapes;
+	BENCHMARK("ShapeQueue")
+	{
+		QueueScene(shapes, scene);
+		return SumPositions(shapes);
+	};
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+// Stands in for src/PCH.h. CommonLibSSE, D3D and the Windows headers are not available on the host, so the few game types
+// the tested code uses are declared here, with the members and behaviour they have in CommonLibSSE
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <ranges>
+#include <set>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+
+#ifdef TESTS_WITH_GLM
+#	define GLM_ENABLE_EXPERIMENTAL
+#	include <glm/glm.hpp>
+#	include <glm/gtc/constants.hpp>
+#	include <glm/gtx/hash.hpp>
+
+using vec2u = glm::vec<2, float, glm::highp>;
+using vec3u = glm::vec<3, float, glm::highp>;
+using vec4u = glm::vec<4, float, glm::highp>;
+#endif
+
+using namespace std::literals;
+
+namespace logger
+{
+	template <class... Args> void trace(Args&&...) {}
+	template <class... Args> void debug(Args&&...) {}
+	template <class... Args> void info(Args&&...) {}
+	template <class... Args> void warn(Args&&...) {}
+	template <class... Args> void error(Args&&...) {}
+	template <class... Args> void critical(Args&&...) {}
+}
+
+namespace RE
+{
+	using FormID = std::uint32_t;
+
+	class TESObjectCELL;
+
+	class NiPoint2
+	{
+		public:
+			float x{ 0.0f };
+			float y{ 0.0f };
+
+			constexpr NiPoint2() noexcept = default;
+			constexpr NiPoint2(float a_x, float a_y) noexcept : x(a_x), y(a_y) {}
+
+			bool		operator==(const NiPoint2& a_rhs) const = default;
+			NiPoint2	operator+(const NiPoint2& a_rhs) const { return NiPoint2(x + a_rhs.x, y + a_rhs.y); }
+			NiPoint2	operator-(const NiPoint2& a_rhs) const { return NiPoint2(x - a_rhs.x, y - a_rhs.y); }
+			NiPoint2	operator*(float a_scalar) const { return NiPoint2(x * a_scalar, y * a_scalar); }
+			NiPoint2	operator/(float a_scalar) const { return NiPoint2(x / a_scalar, y / a_scalar); }
+
+			float		Dot(const NiPoint2& a_rhs) const { return x * a_rhs.x + y * a_rhs.y; }
+			float		Length() const { return std::sqrt(x * x + y * y); }
+			float		SqrLength() const { return x * x + y * y; }
+	};
+
+	class NiPoint3
+	{
+		public:
+			float x{ 0.0f };
+			float y{ 0.0f };
+			float z{ 0.0f };
+
+			constexpr NiPoint3() noexcept = default;
+			constexpr NiPoint3(float a_x, float a_y, float a_z) noexcept : x(a_x), y(a_y), z(a_z) {}
+
+			float&			operator[](std::size_t a_idx) { return std::addressof(x)[a_idx]; }
+			const float&	operator[](std::size_t a_idx) const { return std::addressof(x)[a_idx]; }
+
+			bool		operator==(const NiPoint3& a_rhs) const = default;
+			NiPoint3	operator+(const NiPoint3& a_rhs) const { return NiPoint3(x + a_rhs.x, y + a_rhs.y, z + a_rhs.z); }
+			NiPoint3	operator-(const NiPoint3& a_rhs) const { return NiPoint3(x - a_rhs.x, y - a_rhs.y, z - a_rhs.z); }
+			NiPoint3	operator*(float a_scalar) const { return NiPoint3(x * a_scalar, y * a_scalar, z * a_scalar); }
+			NiPoint3	operator/(float a_scalar) const { return operator*(1.0f / a_scalar); }
+			NiPoint3	operator-() const { return NiPoint3(-x, -y, -z); }
+			NiPoint3&	operator+=(const NiPoint3& a_rhs) { return *this = *this + a_rhs; }
+			NiPoint3&	operator-=(const NiPoint3& a_rhs) { return *this = *this - a_rhs; }
+			NiPoint3&	operator*=(float a_scalar) { return *this = *this * a_scalar; }
+			NiPoint3&	operator/=(float a_scalar) { return *this = *this / a_scalar; }
+
+			float		Dot(const NiPoint3& a_rhs) const { return x * a_rhs.x + y * a_rhs.y + z * a_rhs.z; }
+			NiPoint3	Cross(const NiPoint3& a_rhs) const { return NiPoint3(y * a_rhs.z - z * a_rhs.y, z * a_rhs.x - x * a_rhs.z, x * a_rhs.y - y * a_rhs.x); }
+			float		Length() const { return std::sqrt(SqrLength()); }
+			float		SqrLength() const { return x * x + y * y + z * z; }
+			float		GetDistance(const NiPoint3& a_point) const { return (*this - a_point).Length(); }
+			float		GetSquaredDistance(const NiPoint3& a_point) const { return (*this - a_point).SqrLength(); }
+
+			float Unitize()
+			{
+				float length = Length();
+				if (length == 1.0f) return length;
+				if (length > std::numeric_limits<float>::epsilon()) *this /= length;
+				else *this = NiPoint3();
+				return length;
+			}
+	};
+
+	class NiMatrix3
+	{
+		public:
+			float entry[3][3]{};
+	};
+}
@@ -0,0 +1,277 @@
+#include "Catch.h"
+#include "DebugMenu/WorkerPool.h"
+
+using DebugMenu::HandoffQueue;
+using DebugMenu::WorkerPool;
+
+namespace
+{
+	// waits for the counter to reach the value, failing the test instead of hanging if it never does
+	bool WaitFor(const std::atomic<uint32_t>& a_counter, uint32_t a_value)
+	{
+		const auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+		while (a_counter.load() < a_value)
+		{
+			if (std::chrono::steady_clock::now() > timeout) return false;
+			std::this_thread::yield();
+		}
+		return true;
+	}
+
+	// a stand-in for CollisionHandler::ShapeDescription, built into the lines of the box edges
+	struct SyntheticShape
+	{
+		uint32_t	key;
+		float		halfExtent;
+	};
+
+	struct SyntheticGeometry
+	{
+		uint32_t			key;
+		std::vector<float>	lineEnds; // x, y, z of both ends of every line
+	};
+
+	SyntheticGeometry BuildGeometry(const SyntheticShape& a_shape)
+	{
+		SyntheticGeometry geometry{ a_shape.key, {} };
+		for (int corner = 0; corner < 8; corner++)
+		{
+			for (int axis = 0; axis < 3; axis++)
+			{
+				const int other = corner ^ (1 << axis);
+				if (other < corner) continue;
+				for (const int end : { corner, other })
+				{
+					for (int i = 0; i < 3; i++) geometry.lineEnds.push_back(end & (1 << i) ? a_shape.halfExtent : -a_shape.halfExtent);
+				}
+			}
+		}
+		return geometry;
+	}
+}
+
+TEST_CASE("HandoffQueue hands over everything once, in the order of each producer", "[workerpool]")
+{
+	constexpr uint32_t producers = 4;
+	constexpr uint32_t valuesPerProducer = 50000;
+
+	HandoffQueue<std::pair<uint32_t, uint32_t>> queue;
+	std::vector<std::thread> threads;
+	for (uint32_t producer = 0; producer < producers; producer++)
+	{
+		threads.emplace_back([&queue, producer]() {
+			for (uint32_t i = 0; i < valuesPerProducer; i++) queue.Push({ producer, i });
+		});
+	}
+
+	// taken while the producers are still pushing
+	std::vector<uint32_t> next(producers, 0);
+	uint32_t received = 0;
+	bool isInOrder = true;
+	while (received < producers * valuesPerProducer)
+	{
+		for (const auto& [producer, value] : queue.TakeAll())
+		{
+			isInOrder &= value == next[producer];
+			next[producer] = value + 1;
+			received++;
+		}
+	}
+
+	for (auto& thread : threads) thread.join();
+	CHECK(isInOrder);
+	CHECK(received == producers * valuesPerProducer);
+	CHECK(queue.TakeAll().empty());
+}
+
+TEST_CASE("HandoffQueue frees what was never taken", "[workerpool]")
+{
+	auto value = std::make_shared<int>(1);
+	{
+		HandoffQueue<std::shared_ptr<int>> queue;
+		for (int i = 0; i < 10; i++) queue.Push(value);
+		CHECK(value.use_count() == 11);
+	}
+	CHECK(value.use_count() == 1);
+}
+
+TEST_CASE("WorkerPool with one thread runs the tasks in the order they were submitted", "[workerpool]")
+{
+	std::vector<uint32_t> order;
+	std::atomic<uint32_t> finished = 0;
+	{
+		WorkerPool pool(1);
+		CHECK(pool.GetNumberOfThreads() == 1);
+		for (uint32_t i = 0; i < 1000; i++)
+		{
+			pool.Submit([&order, &finished, i]() {
+				order.push_back(i);
+				finished++;
+			});
+		}
+		REQUIRE(WaitFor(finished, 1000));
+	}
+
+	std::vector<uint32_t> expected(1000);
+	std::iota(expected.begin(), expected.end(), 0u);
+	CHECK(order == expected);
+}
+
+TEST_CASE("WorkerPool does not wait for running tasks when it shrinks", "[workerpool]")
+{
+	std::atomic<bool> isReleased = false;
+	std::atomic<uint32_t> started = 0;
+	std::atomic<uint32_t> finished = 0;
+	{
+		WorkerPool pool(4);
+		for (int i = 0; i < 4; i++)
+		{
+			pool.Submit([&]() {
+				started++;
+				while (!isReleased) std::this_thread::yield();
+				finished++;
+			});
+		}
+		REQUIRE(WaitFor(started, 4));
+
+		// would deadlock if it joined the threads it stops, since the tasks are only released after it returns
+		pool.Resize(1);
+		CHECK(pool.GetNumberOfThreads() == 1);
+		pool.Resize(3);
+		CHECK(pool.GetNumberOfThreads() == 3);
+
+		isReleased = true;
+		CHECK(WaitFor(finished, 4));
+
+		// the tasks are run by the threads that are left
+		std::atomic<uint32_t> more = 0;
+		for (int i = 0; i < 100; i++) pool.Submit([&more]() { more++; });
+		CHECK(WaitFor(more, 100));
+		pool.Resize(2); // joins the stopped threads that have exited
+	}
+	CHECK(finished == 4);
+}
+
+TEST_CASE("WorkerPool keeps the queued tasks while it is resized", "[workerpool]")
+{
+	constexpr uint32_t tasks = 20000;
+	std::atomic<uint32_t> finished = 0;
+	WorkerPool pool(0);
+	CHECK(pool.GetNumberOfThreads() == 1); // at least one thread
+
+	std::thread producer([&]() {
+		for (uint32_t i = 0; i < tasks; i++) pool.Submit([&finished]() { finished++; });
+	});
+
+	// resized from the main thread while the producer submits, as the MCM does when it is closed
+	std::mt19937 rng(40);
+	std::uniform_int_distribution<uint32_t> size(1, 8);
+	for (int i = 0; i < 200; i++)
+	{
+		const uint32_t threads = size(rng);
+		pool.Resize(threads);
+		CHECK(pool.GetNumberOfThreads() == threads);
+	}
+
+	producer.join();
+	CHECK(WaitFor(finished, tasks));
+	CHECK(pool.GetNumberOfQueuedTasks() == 0);
+}
+
+TEST_CASE("WorkerPool discards the tasks that did not start when it is destroyed", "[workerpool]")
+{
+	std::atomic<uint32_t> started = 0;
+	std::atomic<uint32_t> destroyed = 0;
+	std::atomic<bool> isReleased = false;
+	std::thread release;
+	{
+		WorkerPool pool(2);
+		for (uint32_t i = 0; i < 100; i++)
+		{
+			// destroying the task without running it still runs the deleter, which is how the shader prefetch finishes
+			std::shared_ptr<void> finish(nullptr, [&destroyed](void*) { destroyed++; });
+			pool.Submit([&started, &isReleased, finish = std::move(finish)]() {
+				started++;
+				while (!isReleased) std::this_thread::yield();
+			});
+		}
+		REQUIRE(WaitFor(started, 2));
+		CHECK(pool.GetNumberOfQueuedTasks() == 98);
+
+		// the destructor clears the queue before joining, so the running tasks are released once the others are gone
+		release = std::thread([&]() {
+			WaitFor(destroyed, 98);
+			isReleased = true;
+		});
+	}
+	release.join();
+
+	CHECK(started == 2);
+	CHECK(destroyed == 100);
+}
+
+// The collision pipeline in small: shapes are described on the main thread, built on the workers and published
+// through a handoff queue on a later update, with a shape that is in flight never being built twice
+TEST_CASE("Geometry built on the workers is published once per shape", "[workerpool][stress]")
+{
+	constexpr uint32_t updates = 2000;
+	constexpr uint32_t shapes = 500;
+
+	WorkerPool pool(4);
+	HandoffQueue<SyntheticGeometry> built;
+	std::unordered_set<uint32_t> inFlight;
+	std::unordered_map<uint32_t, SyntheticGeometry> published;
+	std::vector<uint32_t> buildsPerShape(shapes, 0);
+	std::mutex buildsLock;
+	bool isCorrect = true;
+
+	std::mt19937 rng(41);
+	std::uniform_int_distribution<uint32_t> shape(0, shapes - 1);
+	std::uniform_int_distribution<uint32_t> refsPerUpdate(0, 20);
+
+	auto publish = [&]() {
+		for (auto& geometry : built.TakeAll())
+		{
+			isCorrect &= inFlight.erase(geometry.key) == 1;
+			isCorrect &= geometry.lineEnds == BuildGeometry({ geometry.key, 1.0f + geometry.key }).lineEnds;
+			isCorrect &= published.emplace(geometry.key, std::move(geometry)).second;
+		}
+	};
+
+	for (uint32_t update = 0; update < updates; update++)
+	{
+		publish();
+
+		const uint32_t refs = refsPerUpdate(rng);
+		for (uint32_t i = 0; i < refs; i++)
+		{
+			const SyntheticShape description{ shape(rng), 0.0f };
+			if (published.contains(description.key) || !inFlight.insert(description.key).second) continue;
+
+			pool.Submit([&, description]() {
+				{
+					std::lock_guard<std::mutex> guard(buildsLock);
+					buildsPerShape[description.key]++;
+				}
+				built.Push(BuildGeometry({ description.key, 1.0f + description.key }));
+			});
+		}
+	}
+
+	// the last geometries are published on the updates after the workers finish
+	const auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+	while (!inFlight.empty() && std::chrono::steady_clock::now() < timeout)
+	{
+		publish();
+		std::this_thread::yield();
+	}
+
+	CHECK(isCorrect);
+	CHECK(inFlight.empty());
+	std::lock_guard<std::mutex> guard(buildsLock);
+	for (uint32_t key = 0; key < shapes; key++)
+	{
+		INFO("shape " << key);
+		CHECK(buildsPerShape[key] == (published.contains(key) ? 1u : 0u));
+	}
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+// Stand-in for src/MCM.h, which pulls in SimpleIni and the game. Only the settings the tested code reads are here
+namespace MCM
+{
+	struct settings
+	{
+		static inline uint32_t workerThreads = 2;
+	};
+}